@@ -0,0 +1,156 @@
+#include "../DeteccionCodigos/CodeDetector.h"
+#include "../DeteccionCodigos/TaskScheduler.h"
+#include "Benchmark.h"
+#include <thread>
+
+/**
+ * @file BatchThroughput.cpp
+ * @brief Rendimiento (imgenes/s) del procesamiento por lotes frente a `detect` en un bucle.
+ *
+ * Carga las imgenes de `Imagenes/` y, para cada tamao de lote, mide `detectLoop/batch:N` (N llamadas a
+ * `detect`) y `detectBatch/batch:N` (una llamada a `detectBatch` con N imgenes), con los mismos hilos de
+ * OpenCV en ambos casos. Tambin mide `detectTasks/batch:N` (`detectBatch` con un `CTaskScheduler` de
+ * `--threads` trabajadores, fijados en `--cores` si se indica, y OpenCV en un solo hilo dentro de cada
+ * tarea). Antes de medir comprueba que las dos variantes de `detectBatch` devuelven exactamente los mismos
+ * cdigos que `detect` para todas las imgenes. El JSON incluye `items_per_second` (imgenes por segundo)
+ * y, al terminar, se muestran las estadsticas de cada trabajador del planificador.
+ *
+ * Uso: BatchThroughput [directorioImagenes] [--batch N]... [--threads N] [--cores lista|node:N] [--fixed-point]
+ *                      [--benchmark_filter=regex] [--benchmark_min_time=s]
+ *                      [--benchmark_repetitions=N] [--benchmark_out=resultados.json]
+ */
+
+/**
+ * @brief Indica si dos listas de cdigos son idnticas (cdigo, bounding box, ngulo y confianzas).
+ *
+ * @param a Cdigos de `detect`.
+ * @param b Cdigos de `detectBatch`.
+ * @return bool true si coinciden.
+ */
+static bool sameCodes(const std::vector<DecodedCode> &a, const std::vector<DecodedCode> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].code != b[i].code || a[i].boundingBox != b[i].boundingBox || a[i].angle != b[i].angle ||
+            a[i].digitConfidence != b[i].digitConfidence) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    // Paso 1: Opciones propias (el resto las interpreta el ejecutor)
+    CBenchmarkRunner runner(argc, argv);
+    std::string directory = "Imagenes";
+    std::vector<int> batchSizes;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    bool fixedPoint = false;
+    std::string cores;
+    const std::vector<std::string> &args = runner.getRemainingArgs();
+    for (size_t a = 0; a < args.size(); ++a) {
+        if (args[a] == "--batch" && a + 1 < args.size()) batchSizes.push_back(std::max(1, std::atoi(args[++a].c_str())));
+        else if (args[a] == "--threads" && a + 1 < args.size()) numThreads = std::max(1, std::atoi(args[++a].c_str()));
+        else if (args[a] == "--cores" && a + 1 < args.size()) cores = args[++a];
+        else if (args[a] == "--fixed-point") fixedPoint = true;
+        else directory = args[a];
+    }
+    if (batchSizes.empty()) {
+        batchSizes = { 1, 8, 32 };
+    }
+
+    setNumThreads(numThreads);
+    runner.addContext("opencv_version", CV_VERSION);
+    runner.addContext("opencv_threads", std::to_string(numThreads));
+    runner.addContext("images", directory);
+    runner.addContext("fixed_point", fixedPoint ? "true" : "false");
+    runner.addContext("scheduler_cores", cores.empty() ? "any" : cores);
+
+    TaskSchedulerParams schedulerParams;
+    schedulerParams.numWorkers = numThreads;
+    CpuPlacement::parse(cores, schedulerParams.placement);
+    CTaskScheduler scheduler(schedulerParams);
+
+    // Paso 2: Cargar todas las imgenes; la decodificacin JPEG no forma parte de la medida
+    std::vector<String> files;
+    glob(directory + "/*.jpg", files, false);
+    std::vector<Mat> images;
+    std::vector<std::string> imageFiles;
+    for (const auto &file : files) {
+        Mat image = imread(file, IMREAD_COLOR);
+        if (!image.empty()) {
+            images.push_back(image);
+            imageFiles.push_back(file);
+        }
+    }
+    if (images.empty()) {
+        std::cerr << "No se han encontrado imagenes en " << directory << std::endl;
+        return 1;
+    }
+    std::cout << "Imagenes cargadas: " << images.size() << ", hilos: " << numThreads << std::endl;
+
+    DetectorParams params;
+    params.fixedPoint = fixedPoint;
+    CCodeDetector detector(params);
+
+    // Paso 3: Comprobar que los lotes dan el mismo resultado que el bucle de `detect`
+    std::vector<std::vector<DecodedCode>> batchCodes = detector.detectBatch(images);
+    std::vector<std::vector<DecodedCode>> taskCodes = detector.detectBatch(images, scheduler);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        std::vector<DecodedCode> codes = detector.detect(images[i]);
+        if (!sameCodes(codes, batchCodes[i]) || !sameCodes(codes, taskCodes[i])) {
+            std::cerr << "Resultado distinto en " << imageFiles[i] << std::endl;
+            mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        std::cerr << mismatches << " imagenes con resultados distintos entre detect y detectBatch" << std::endl;
+        return 1;
+    }
+
+    // Paso 4: Medir cada tamao de lote, recorriendo las imgenes de forma circular
+    for (int batchSize : batchSizes) {
+        std::vector<std::vector<Mat>> batches;
+        for (size_t start = 0; start < images.size(); start += batchSize) {
+            std::vector<Mat> batch;
+            for (int k = 0; k < batchSize; ++k) {
+                batch.push_back(images[( start + k ) % images.size()]);
+            }
+            batches.push_back(batch);
+        }
+
+        size_t next = 0;
+        runner.run("detectLoop/batch:" + std::to_string(batchSize), [&]() {
+            for (const Mat &image : batches[next++ % batches.size()]) {
+                doNotOptimize(detector.detect(image));
+            }
+        }, batchSize);
+
+        next = 0;
+        runner.run("detectBatch/batch:" + std::to_string(batchSize), [&]() {
+            doNotOptimize(detector.detectBatch(batches[next++ % batches.size()]));
+        }, batchSize);
+
+        // El planificador reparte los ncleos entre las tareas: OpenCV en un solo hilo dentro de cada una
+        next = 0;
+        setNumThreads(1);
+        runner.run("detectTasks/batch:" + std::to_string(batchSize), [&]() {
+            doNotOptimize(detector.detectBatch(batches[next++ % batches.size()], scheduler));
+        }, batchSize);
+        setNumThreads(numThreads);
+    }
+
+    // Paso 5: Reparto de las tareas entre los trabajadores del planificador
+    std::vector<WorkerStats> workerStats = scheduler.getStats();
+    for (size_t w = 0; w < workerStats.size(); ++w) {
+        std::cout << "Trabajador " << w << " (nucleo " << workerStats[w].core << "): " << workerStats[w].executedTasks
+                  << " tareas, " << workerStats[w].stolenTasks << " robadas, " << workerStats[w].busyUs / 1000.0 << " ms ocupado" << std::endl;
+    }
+
+    // Paso 6: Resultados en JSON
+    return runner.writeJson() ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <thread>
+
+/**
+ * @brief Escapa una cadena para incluirla en JSON.
+ *
+ * @param text Texto original.
+ * @return std::string Texto escapado (sin comillas).
+ */
+static std::string jsonEscape(const std::string &text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>( c ) < 0x20) {
+            out += ' ';
+        }
+        else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+
+/**
+ * @brief Constructor de la clase CBenchmarkRunner.
+ *
+ * Interpreta las opciones `--benchmark_filter=`, `--benchmark_min_time=`, `--benchmark_repetitions=`
+ * y `--benchmark_out=`. El sufijo "s" de `--benchmark_min_time` (p. ej. "0.5s") es opcional.
+ *
+ * @param argc Nmero de argumentos.
+ * @param argv Argumentos.
+ */
+CBenchmarkRunner::CBenchmarkRunner(int argc, char *argv[])
+{
+    executable = argc > 0 ? argv[0] : "";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const std::string &prefix) { return arg.substr(prefix.size()); };
+        if (arg.rfind("--benchmark_filter=", 0) == 0) {
+            options.filter = value("--benchmark_filter=");
+        }
+        else if (arg.rfind("--benchmark_min_time=", 0) == 0) {
+            options.minTimeSec = std::max(0.001, std::atof(value("--benchmark_min_time=").c_str()));
+        }
+        else if (arg.rfind("--benchmark_repetitions=", 0) == 0) {
+            options.repetitions = std::max(1, std::atoi(value("--benchmark_repetitions=").c_str()));
+        }
+        else if (arg.rfind("--benchmark_out=", 0) == 0) {
+            options.outFile = value("--benchmark_out=");
+        }
+        else {
+            remainingArgs.push_back(arg);
+        }
+    }
+}
+
+
+/**
+ * @brief Devuelve los argumentos que no son opciones del ejecutor.
+ */
+const std::vector<std::string> &CBenchmarkRunner::getRemainingArgs() const {
+    return remainingArgs;
+}
+
+
+/**
+ * @brief Aade un valor al bloque "context" del JSON.
+ *
+ * @param key Clave.
+ * @param value Valor.
+ */
+void CBenchmarkRunner::addContext(const std::string &key, const std::string &value) {
+    context[key] = value;
+}
+
+
+/**
+ * @brief Indica si un benchmark pasa el filtro.
+ *
+ * @param name Nombre del benchmark.
+ *
+ * @return bool true si no hay filtro o el nombre lo cumple.
+ */
+bool CBenchmarkRunner::isEnabled(const std::string &name) const {
+    return options.filter.empty() || std::regex_search(name, std::regex(options.filter));
+}
+
+
+/**
+ * @brief Ejecuta y mide un benchmark si pasa el filtro.
+ *
+ * Antes de medir se ejecuta una iteracin de calentamiento (reserva de memoria, cachs, inicializacin
+ * perezosa de OpenCV).
+ *
+ * @param name Nombre del benchmark.
+ * @param body Funcin que ejecuta una iteracin.
+ * @param itemsPerIteration Elementos que procesa cada iteracin (0 = no se calcula `items_per_second`).
+ */
+void CBenchmarkRunner::run(const std::string &name, const std::function<void()> &body, double itemsPerIteration) {
+    if (!isEnabled(name)) {
+        return;
+    }
+
+    // Paso 1: Calentamiento
+    body();
+
+    // Paso 2: Medir cada repeticin
+    std::vector<BenchmarkResult> repetitions;
+    for (int r = 0; r < options.repetitions; ++r) {
+        BenchmarkResult result;
+        result.name = name;
+        result.runName = name;
+        result.runType = "iteration";
+        result.repetitionIndex = r;
+        measure(body, result);
+        if (itemsPerIteration > 0 && result.realTimeUs > 0) {
+            result.itemsPerSecond = itemsPerIteration * 1e6 / result.realTimeUs;
+        }
+        printResult(result);
+        results.push_back(result);
+        repetitions.push_back(result);
+    }
+
+    // Paso 3: Agregados si hay varias repeticiones
+    if (repetitions.size() > 1) {
+        addAggregates(name, repetitions);
+    }
+}
+
+
+/**
+ * @brief Mide una repeticin calibrando el nmero de iteraciones.
+ *
+ * Empieza con una iteracin y, mientras el tiempo total no supere el mnimo, estima cuntas iteraciones
+ * hacen falta (con un margen del 40%, como Google Benchmark) y vuelve a medir.
+ *
+ * @param body Funcin que ejecuta una iteracin.
+ * @param result Resultado a completar.
+ */
+void CBenchmarkRunner::measure(const std::function<void()> &body, BenchmarkResult &result) const {
+    uint64_t iterations = 1;
+    while (true) {
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpuElapsed = static_cast<double>( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+
+        if (elapsed >= options.minTimeSec || iterations >= 1000000000ull) {
+            result.iterations = iterations;
+            result.realTimeUs = elapsed * 1e6 / iterations;
+            result.cpuTimeUs = cpuElapsed * 1e6 / iterations;
+            return;
+        }
+
+        double factor = elapsed > 0 ? options.minTimeSec * 1.4 / elapsed : 10.0;
+        iterations = std::max(iterations + 1, static_cast<uint64_t>( iterations * std::min(factor, 10.0) ));
+    }
+}
+
+
+/**
+ * @brief Aade la media, la mediana y la desviacin tpica de las repeticiones de un benchmark.
+ *
+ * @param runName Nombre del benchmark.
+ * @param repetitions Resultados de cada repeticin.
+ */
+void CBenchmarkRunner::addAggregates(const std::string &runName, const std::vector<BenchmarkResult> &repetitions) {
+    size_t n = repetitions.size();
+    std::vector<double> real, cpu, items;
+    for (const auto &r : repetitions) {
+        real.push_back(r.realTimeUs);
+        cpu.push_back(r.cpuTimeUs);
+        items.push_back(r.itemsPerSecond);
+    }
+
+    auto mean = [n](const std::vector<double> &v) {
+        double sum = 0;
+        for (double x : v) sum += x;
+        return sum / n;
+    };
+    auto median = [](std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        return v.size() % 2 ? v[v.size() / 2] : ( v[v.size() / 2 - 1] + v[v.size() / 2] ) / 2;
+    };
+    auto stddev = [n, &mean](const std::vector<double> &v) {
+        double m = mean(v);
+        double sum = 0;
+        for (double x : v) sum += ( x - m ) * ( x - m );
+        return std::sqrt(sum / ( n - 1 ));
+    };
+
+    const std::pair<const char *, std::function<double(const std::vector<double> &)>> aggregates[] = {
+        { "mean", mean }, { "median", median }, { "stddev", stddev } };
+    for (const auto &aggregate : aggregates) {
+        BenchmarkResult result;
+        result.name = runName + "_" + aggregate.first;
+        result.runName = runName;
+        result.runType = "aggregate";
+        result.aggregateName = aggregate.first;
+        result.iterations = n;
+        result.realTimeUs = aggregate.second(real);
+        result.cpuTimeUs = aggregate.second(cpu);
+        result.itemsPerSecond = aggregate.second(items);
+        printResult(result);
+        results.push_back(result);
+    }
+}
+
+
+/**
+ * @brief Muestra un resultado por la salida estndar, con una cabecera la primera vez.
+ *
+ * @param result Resultado a mostrar.
+ */
+void CBenchmarkRunner::printResult(const BenchmarkResult &result) {
+    if (!headerPrinted) {
+        std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(14) << "Time"
+                  << std::setw(14) << "CPU" << std::setw(12) << "Iterations" << "\n"
+                  << std::string(88, '-') << std::endl;
+        headerPrinted = true;
+    }
+    std::cout << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(11) << result.realTimeUs << " us" << std::setw(11) << result.cpuTimeUs << " us"
+              << std::setw(12) << result.iterations;
+    if (result.itemsPerSecond > 0) {
+        std::cout << std::setw(12) << result.itemsPerSecond << " items/s";
+    }
+    std::cout << std::endl;
+}
+
+
+/**
+ * @brief Escribe los resultados en JSON con el esquema de Google Benchmark.
+ *
+ * @return bool true si no haba fichero o se ha escrito correctamente.
+ */
+bool CBenchmarkRunner::writeJson() const {
+    if (options.outFile.empty()) {
+        return true;
+    }
+    std::ofstream out(options.outFile);
+    if (!out.is_open()) {
+        std::cerr << "No se ha podido crear " << options.outFile << std::endl;
+        return false;
+    }
+
+    // Paso 1: Contexto de la ejecucin
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"" << jsonEscape(executable) << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"";
+#else
+        << "    \"library_build_type\": \"debug\"";
+#endif
+    for (const auto &entry : context) {
+        out << ",\n    \"" << jsonEscape(entry.first) << "\": \"" << jsonEscape(entry.second) << "\"";
+    }
+    out << "\n  },\n  \"benchmarks\": [";
+
+    // Paso 2: Un objeto por resultado
+    out << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        out << ( i ? "," : "" ) << "\n    {\n"
+            << "      \"name\": \"" << jsonEscape(r.name) << "\",\n"
+            << "      \"run_name\": \"" << jsonEscape(r.runName) << "\",\n"
+            << "      \"run_type\": \"" << r.runType << "\",\n"
+            << "      \"repetitions\": " << options.repetitions << ",\n";
+        if (r.runType == "aggregate") {
+            out << "      \"aggregate_name\": \"" << r.aggregateName << "\",\n";
+        }
+        else {
+            out << "      \"repetition_index\": " << r.repetitionIndex << ",\n";
+        }
+        out << "      \"threads\": 1,\n"
+            << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"real_time\": " << r.realTimeUs << ",\n"
+            << "      \"cpu_time\": " << r.cpuTimeUs << ",\n";
+        if (r.itemsPerSecond > 0) {
+            out << "      \"items_per_second\": " << r.itemsPerSecond << ",\n";
+        }
+        out << "      \"time_unit\": \"us\"\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.good();
+}
+
+
+/**
+ * @brief Devuelve todos los resultados medidos.
+ */
+const std::vector<BenchmarkResult> &CBenchmarkRunner::getResults() const {
+    return results;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @struct BenchmarkOptions
+ * @brief Opciones del ejecutor de benchmarks (mismos nombres que Google Benchmark).
+ */
+struct BenchmarkOptions {
+    std::string filter;            /**< `--benchmark_filter`: expresin regular sobre el nombre (vaco = todos) */
+    double minTimeSec = 0.5;       /**< `--benchmark_min_time`: tiempo mnimo por repeticin, en segundos */
+    int repetitions = 1;           /**< `--benchmark_repetitions`: repeticiones de cada benchmark */
+    std::string outFile;           /**< `--benchmark_out`: fichero JSON de resultados (vaco = no se escribe) */
+};
+
+/**
+ * @struct BenchmarkResult
+ * @brief Resultado de una repeticin de un benchmark (o de un agregado de varias repeticiones).
+ */
+struct BenchmarkResult {
+    std::string name;              /**< Nombre completo, p. ej. "BlurImage/real/1080p" (con sufijo si es agregado) */
+    std::string runName;           /**< Nombre sin sufijo de agregado */
+    std::string runType;           /**< "iteration" o "aggregate" */
+    std::string aggregateName;     /**< "mean", "median" o "stddev" (solo agregados) */
+    int repetitionIndex = 0;       /**< ndice de la repeticin (solo "iteration") */
+    uint64_t iterations = 0;       /**< Iteraciones medidas */
+    double realTimeUs = 0;         /**< Tiempo real por iteracin, en microsegundos */
+    double cpuTimeUs = 0;          /**< Tiempo de CPU del proceso por iteracin, en microsegundos */
+    double itemsPerSecond = 0;     /**< Elementos (p. ej. imgenes) procesados por segundo; 0 si no se ha indicado */
+};
+
+/**
+ * @brief Impide que el compilador elimine el clculo de un valor que no se usa.
+ *
+ * @param value Valor a conservar.
+ */
+template <class T>
+inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = static_cast<const void *>(&value);
+#endif
+}
+
+/**
+ * @class CBenchmarkRunner
+ * @brief Ejecutor mnimo de microbenchmarks con salida JSON compatible con Google Benchmark.
+ *
+ * Cada benchmark es una funcin que ejecuta una iteracin; el ejecutor calibra el nmero de iteraciones
+ * hasta superar el tiempo mnimo, repite la medida si se pide y calcula la media, la mediana y la
+ * desviacin tpica. El JSON resultante tiene el mismo esquema que el de Google Benchmark, de modo que
+ * puede compararse entre versiones con sus herramientas (`compare.py`) o con cualquier script.
+ */
+class CBenchmarkRunner
+{
+public:
+    /**
+     * @brief Constructor de la clase CBenchmarkRunner.
+     *
+     * @param argc Nmero de argumentos.
+     * @param argv Argumentos; se consumen los `--benchmark_*` y el resto queda en `getRemainingArgs`.
+     */
+    CBenchmarkRunner(int argc, char *argv[]);
+
+    /**
+     * @brief Devuelve los argumentos que no son opciones del ejecutor.
+     */
+    const std::vector<std::string> &getRemainingArgs() const;
+
+    /**
+     * @brief Aade un valor al bloque "context" del JSON.
+     *
+     * @param key Clave.
+     * @param value Valor.
+     */
+    void addContext(const std::string &key, const std::string &value);
+
+    /**
+     * @brief Indica si un benchmark pasa el filtro (para evitar preparar entradas innecesarias).
+     *
+     * @param name Nombre del benchmark.
+     */
+    bool isEnabled(const std::string &name) const;
+
+    /**
+     * @brief Ejecuta y mide un benchmark si pasa el filtro.
+     *
+     * @param name Nombre del benchmark.
+     * @param body Funcin que ejecuta una iteracin.
+     * @param itemsPerIteration Elementos que procesa cada iteracin, para calcular `items_per_second` (0 = no se calcula).
+     */
+    void run(const std::string &name, const std::function<void()> &body, double itemsPerIteration = 0);
+
+    /**
+     * @brief Escribe los resultados en el fichero `--benchmark_out`, si se ha indicado.
+     *
+     * @return bool true si no haba fichero o se ha escrito correctamente.
+     */
+    bool writeJson() const;
+
+    /**
+     * @brief Devuelve todos los resultados medidos.
+     */
+    const std::vector<BenchmarkResult> &getResults() const;
+
+private:
+    /**
+     * @brief Mide una repeticin: calibra las iteraciones hasta superar el tiempo mnimo.
+     *
+     * @param body Funcin que ejecuta una iteracin.
+     * @param result Resultado a completar.
+     */
+    void measure(const std::function<void()> &body, BenchmarkResult &result) const;
+
+    /**
+     * @brief Aade la media, la mediana y la desviacin tpica de las repeticiones de un benchmark.
+     *
+     * @param runName Nombre del benchmark.
+     * @param repetitions Resultados de cada repeticin.
+     */
+    void addAggregates(const std::string &runName, const std::vector<BenchmarkResult> &repetitions);
+
+    /**
+     * @brief Muestra un resultado por la salida estndar.
+     *
+     * @param result Resultado a mostrar.
+     */
+    void printResult(const BenchmarkResult &result);
+
+    BenchmarkOptions options;                      /**< Opciones de ejecucin */
+    std::vector<std::string> remainingArgs;        /**< Argumentos no consumidos */
+    std::string executable;                        /**< Ruta del ejecutable */
+    std::map<std::string, std::string> context;    /**< Valores adicionales del bloque "context" */
+    std::vector<BenchmarkResult> results;          /**< Resultados medidos */
+    bool headerPrinted = false;                    /**< Indica si ya se ha mostrado la cabecera de la tabla */
+};
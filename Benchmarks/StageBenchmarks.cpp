@@ -0,0 +1,431 @@
+#include "../DeteccionCodigos/CodeDetector.h"
+#include "../DeteccionCodigos/DetectorVariants.h"
+#include "../DeteccionCodigos/MotionGate.h"
+#include "Benchmark.h"
+#include "SyntheticScene.h"
+
+/**
+ * @file StageBenchmarks.cpp
+ * @brief Microbenchmarks de cada etapa del pipeline de `CCodeDetector`.
+ *
+ * Cada etapa se mide con sus entradas reales, calculadas una vez con las etapas anteriores, sobre dos
+ * fuentes (fotogramas de `Imagenes/` y escenas sintticas con varios cdigos) y tres resoluciones
+ * (720p, 1080p y 4K). Los nombres siguen el formato `<etapa>/<fuente>/<resolucin>`, p. ej.
+ * `sobelFilter/real/1080p`. Las etapas de decodificacin (`thresholdImage`, `getContours`,
+ * `filterInsideContours`, `decodeNumber`) se miden por recorte. `detect` mide el pipeline completo.
+ * `maskedGrayImages` (las dos mscaras aplicadas en una pasada, con los rangos fijados en compilacin) y
+ * `detectSpecialized` (la variante de `createDetectorPipeline` para los parmetros) se comparan con
+ * las etapas de mscara por separado y con `detect`. `detectRoi` mide `detect` con una ROI en la franja
+ * central (un tercio de la altura), como una cinta transportadora. `motionGateCheck` mide la comprobacin
+ * de movimiento con la que se omiten los fotogramas sin cambios (`CMotionGate`). `findMarkers` (Sobel y
+ * contornos de las dos mscaras) se compara con `findComponentMarkers` (componentes conexas de las dos mscaras
+ * en una pasada, `DetectorParams::componentLocator`), y `detectComponents` mide `detect` con ese localizador;
+ * al preparar las entradas se indica por la salida de error cuntos marcadores encuentra cada uno.
+ * `decodeContours` (umbral adaptativo, contornos y `decodeNumber` de un recorte) se compara con
+ * `decodeScanlines` (perfiles de proyeccin, `DetectorParams::scanlineDecoder`), y se indica cuntos recortes
+ * decodifican igual los dos.
+ *
+ * Adems, el grupo de escalado (`matchContours/codes:N`, `decodeCodes/codes:N`) mide cmo crece la latencia
+ * con el nmero de cdigos por fotograma (1 a 64) en escenas sintticas 4K. Los marcadores se toman del
+ * ground truth del generador, ya que `findFilteredContours` descarta los de menos del 1% de la imagen y
+ * en un fotograma no caben ms de unos 15 cdigos de ese tamao.
+ *
+ * `--fixed-point` mide la variante entera del detector (`DetectorParams::fixedPoint`); el contexto del JSON
+ * lo indica, para comparar las dos ejecuciones etapa a etapa.
+ *
+ * Uso: StageBenchmarks [directorioImagenes] [--frames N] [--threads N] [--fixed-point]
+ *                      [--benchmark_filter=regex] [--benchmark_min_time=s]
+ *                      [--benchmark_repetitions=N] [--benchmark_out=resultados.json]
+ */
+
+/**
+ * @struct StageInputs
+ * @brief Entradas de cada etapa para un conjunto de fotogramas de una fuente y resolucin.
+ */
+struct StageInputs {
+    std::vector<Mat> frames;                                                   /**< Fotogramas BGR */
+    std::vector<Mat> blurred;                                                  /**< Salida de BlurImage */
+    std::vector<Mat> hsv;                                                      /**< Salida de convertHSVImage */
+    std::vector<Mat> gray;                                                     /**< Gris del fotograma desenfocado */
+    std::vector<Mat> redMask;                                                  /**< Salida de getRedMask */
+    std::vector<Mat> redMasked;                                                /**< Gris con la mscara roja aplicada */
+    std::vector<Mat> greenMasked;                                              /**< Gris con la mscara verde aplicada */
+    std::vector<std::vector<std::vector<Point>>> redContours;                  /**< Salida de findFilteredContours (rojo) */
+    std::vector<std::vector<ContourInfo>> redInfo;                             /**< Salida de extractContourInfo (rojo) */
+    std::vector<std::vector<ContourInfo>> greenInfo;                           /**< Salida de extractContourInfo (verde) */
+    std::vector<std::vector<std::pair<ContourInfo, ContourInfo>>> matches;     /**< Salida de matchContours */
+    std::vector<Mat> crops;                                                    /**< Recortes en gris y desenfocados */
+    std::vector<Mat> thresholded;                                              /**< Salida de thresholdImage */
+    std::vector<std::vector<std::vector<Point>>> rectangular;                  /**< Entrada de filterInsideContours */
+    std::vector<std::vector<SegmentInfo>> segmentInfo;                         /**< Entrada de decodeNumber */
+};
+
+/** Nombres de las etapas medidas, en el orden en que se ejecutan */
+static const char *stageNames[] = { "motionGateCheck", "BlurImage", "convertHSVImage", "getRedMask", "getGreenMask",
+                                    "applyMaskToImage", "maskedGrayImages", "sobelFilter", "findFilteredContours",
+                                    "extractContourInfo", "findMarkers", "findComponentMarkers", "matchContours", "cutBoundingBox", "thresholdImage",
+                                    "getContours", "filterInsideContours", "decodeNumber", "decodeContours", "decodeScanlines", "detect",
+                                    "detectSpecialized", "detectRoi", "detectComponents" };
+
+/**
+ * @brief Contornos candidatos de un recorte, igual que `getContours` antes de `filterInsideContours`.
+ *
+ * @param detector Detector.
+ * @param thresholded Recorte binarizado.
+ * @param crop Recorte en gris.
+ * @return Contornos rectangulares que pasan los filtros de rea y borde.
+ */
+static std::vector<std::vector<Point>> candidateContours(CCodeDetector &detector, const Mat &thresholded, const Mat &crop) {
+    std::vector<std::vector<Point>> contours;
+    std::vector<Vec4i> hierarchy;
+    findContours(thresholded, contours, hierarchy, RETR_TREE, CHAIN_APPROX_SIMPLE);
+
+    std::vector<std::vector<Point>> filtered;
+    double imageArea = crop.rows * crop.cols;
+    for (const auto &contour : contours) {
+        double area = contourArea(contour);
+        Rect box = boundingRect(contour);
+        if (area >= 200 && area <= 25000 && area / imageArea >= 0.01 &&
+            box.x > 10 && box.y > 10 && box.x + box.width < crop.cols - 10 && box.y + box.height < crop.rows - 10) {
+            filtered.push_back(contour);
+        }
+    }
+    return detector.classifyContours(filtered, crop.size()).second;
+}
+
+
+/**
+ * @brief Calcula las entradas de todas las etapas ejecutando el pipeline una vez sobre cada fotograma.
+ *
+ * @param detector Detector.
+ * @param frames Fotogramas BGR.
+ * @return StageInputs Las entradas de cada etapa.
+ */
+static StageInputs prepareInputs(CCodeDetector &detector, const std::vector<Mat> &frames) {
+    const DetectorParams &params = detector.getParams();
+    StageInputs in;
+    in.frames = frames;
+    size_t contourMarkers = 0, componentMarkers = 0, scanlineAgreements = 0;
+
+    for (const Mat &frame : frames) {
+        // Etapa de segmentacin
+        Mat blurred = detector.BlurImage(frame, params.blurKernelSize);
+        Mat hsv = detector.convertHSVImage(blurred);
+        Mat gray = detector.convertGrayImage(blurred);
+        Mat redMask = detector.getRedMask(hsv);
+        Mat redMasked = detector.applyMaskToImage(gray, redMask);
+        Mat greenMasked = detector.applyMaskToImage(gray, detector.getGreenMask(hsv));
+        std::vector<std::vector<Point>> redContours = detector.findFilteredContours(redMasked);
+        std::vector<ContourInfo> redInfo = detector.extractContourInfo(redContours);
+        std::vector<ContourInfo> greenInfo = detector.extractContourInfo(detector.findFilteredContours(greenMasked));
+        std::vector<std::pair<ContourInfo, ContourInfo>> matches = detector.matchContours(redInfo, greenInfo);
+
+        in.blurred.push_back(blurred);
+        in.hsv.push_back(hsv);
+        in.gray.push_back(gray);
+        in.redMask.push_back(redMask);
+        in.redMasked.push_back(redMasked);
+        in.greenMasked.push_back(greenMasked);
+        in.redContours.push_back(redContours);
+        in.redInfo.push_back(redInfo);
+        in.greenInfo.push_back(greenInfo);
+        in.matches.push_back(matches);
+
+        // Marcadores que encuentra el localizador de componentes conexas, para compararlo con el de contornos
+        std::vector<ContourInfo> redComponents, greenComponents;
+        detector.findComponentMarkers(redMasked, greenMasked, 0.0, redComponents, greenComponents);
+        contourMarkers += redInfo.size() + greenInfo.size();
+        componentMarkers += redComponents.size() + greenComponents.size();
+
+        // Etapa de decodificacin, por recorte (las parejas cuyo recorte se sale de la imagen no tienen recorte)
+        for (Mat crop : detector.cutBoundingBox(matches, frame)) {
+            if (crop.empty()) {
+                continue;
+            }
+            crop = detector.BlurImage(detector.convertGrayImage(crop), params.decodeBlurKernelSize);
+            Mat thresholded = detector.thresholdImage(crop, params.thresholdOffset);
+            std::vector<std::vector<Point>> contours = detector.getContours(thresholded, crop);
+            std::vector<std::vector<std::vector<Point>>> ordered =
+                detector.orderContours(detector.separateContoursBySegments(contours, crop.cols));
+
+            in.crops.push_back(crop);
+            in.thresholded.push_back(thresholded);
+            in.rectangular.push_back(candidateContours(detector, thresholded, crop));
+            in.segmentInfo.push_back(detector.getSegmentInfo(ordered, crop));
+
+            // Cdigo que decodifica el decodificador por perfiles, para compararlo con el de contornos
+            if (detector.decodeNumber(detector.getScanlineSegmentInfo(crop)) == detector.decodeNumber(in.segmentInfo.back())) {
+                scanlineAgreements++;
+            }
+        }
+    }
+    std::cerr << "Marcadores en " << frames.size() << " fotogramas: " << contourMarkers << " con contornos, "
+              << componentMarkers << " con componentes conexas" << std::endl;
+    std::cerr << "Recortes decodificados igual con perfiles que con contornos: " << scanlineAgreements << " de "
+              << in.crops.size() << std::endl;
+    return in;
+}
+
+
+/**
+ * @brief Ejecuta los benchmarks de todas las etapas para una fuente y resolucin.
+ *
+ * Cada iteracin procesa el siguiente fotograma (o recorte) de forma circular, para no medir siempre
+ * los mismos datos en cach.
+ *
+ * @param runner Ejecutor de benchmarks.
+ * @param detector Detector.
+ * @param pipeline Variante especializada del detector con los mismos parmetros.
+ * @param in Entradas de cada etapa.
+ * @param suffix Sufijo del nombre, p. ej. "real/1080p".
+ */
+static void runStages(CBenchmarkRunner &runner, CCodeDetector &detector, CDetectorPipeline &pipeline, const StageInputs &in, const std::string &suffix) {
+    const DetectorParams &params = detector.getParams();
+    const size_t numFrames = in.frames.size();
+    const size_t numCrops = in.crops.size();
+    size_t i = 0;
+
+    auto frameBench = [&](const std::string &stage, const std::function<void(size_t)> &body) {
+        i = 0;
+        runner.run(stage + "/" + suffix, [&]() { body(i++ % numFrames); });
+    };
+    auto cropBench = [&](const std::string &stage, const std::function<void(size_t)> &body) {
+        if (numCrops == 0) {
+            if (runner.isEnabled(stage + "/" + suffix)) {
+                std::cerr << "Sin recortes para " << stage << "/" << suffix << ": se omite" << std::endl;
+            }
+            return;
+        }
+        i = 0;
+        runner.run(stage + "/" + suffix, [&]() { body(i++ % numCrops); });
+    };
+
+    // Comprobacin de movimiento previa al pipeline (cuesta lo mismo tanto si indica procesar como si no)
+    CMotionGate gate;
+    frameBench("motionGateCheck", [&](size_t f) { doNotOptimize(gate.check(in.frames[f])); });
+
+    // Etapa de segmentacin (por fotograma)
+    frameBench("BlurImage", [&](size_t f) { doNotOptimize(detector.BlurImage(in.frames[f], params.blurKernelSize)); });
+    frameBench("convertHSVImage", [&](size_t f) { doNotOptimize(detector.convertHSVImage(in.blurred[f])); });
+    frameBench("getRedMask", [&](size_t f) { doNotOptimize(detector.getRedMask(in.hsv[f])); });
+    frameBench("getGreenMask", [&](size_t f) { doNotOptimize(detector.getGreenMask(in.hsv[f])); });
+    frameBench("applyMaskToImage", [&](size_t f) { doNotOptimize(detector.applyMaskToImage(in.gray[f], in.redMask[f])); });
+    frameBench("maskedGrayImages", [&](size_t f) {
+        Mat redMasked, greenMasked;
+        maskedGrayImages<DefaultColorRanges>(in.hsv[f], in.gray[f], redMasked, greenMasked);
+        doNotOptimize(redMasked);
+        doNotOptimize(greenMasked);
+    });
+    frameBench("sobelFilter", [&](size_t f) { doNotOptimize(detector.sobelFilter(in.redMasked[f], params.sobelKernelSize)); });
+    frameBench("findFilteredContours", [&](size_t f) { doNotOptimize(detector.findFilteredContours(in.redMasked[f])); });
+    frameBench("extractContourInfo", [&](size_t f) { doNotOptimize(detector.extractContourInfo(in.redContours[f])); });
+
+    // Localizacin de los marcadores de las dos mscaras: Sobel y contornos frente a componentes conexas
+    DetectorParams componentParams = params;
+    componentParams.componentLocator = true;
+    CCodeDetector componentDetector(componentParams);
+    const Rect fullFrame(Point(0, 0), in.frames.front().size());
+    auto markersBench = [&](const std::string &stage, CCodeDetector &locator) {
+        frameBench(stage, [&](size_t f) {
+            Mat redMasked = in.redMasked[f], greenMasked = in.greenMasked[f];
+            std::vector<ContourInfo> redInfo, greenInfo;
+            locator.findMarkers(redMasked, greenMasked, fullFrame, fullFrame.size(), 1.0, redInfo, greenInfo);
+            doNotOptimize(redInfo);
+            doNotOptimize(greenInfo);
+        });
+    };
+    markersBench("findMarkers", detector);
+    markersBench("findComponentMarkers", componentDetector);
+    frameBench("matchContours", [&](size_t f) { doNotOptimize(detector.matchContours(in.redInfo[f], in.greenInfo[f])); });
+    frameBench("cutBoundingBox", [&](size_t f) { doNotOptimize(detector.cutBoundingBox(in.matches[f], in.frames[f])); });
+
+    // Etapa de decodificacin (por recorte)
+    cropBench("thresholdImage", [&](size_t c) { doNotOptimize(detector.thresholdImage(in.crops[c], params.thresholdOffset)); });
+    cropBench("getContours", [&](size_t c) { doNotOptimize(detector.getContours(in.thresholded[c], in.crops[c])); });
+    cropBench("filterInsideContours", [&](size_t c) { doNotOptimize(detector.filterInsideContours(in.rectangular[c])); });
+    cropBench("decodeNumber", [&](size_t c) { doNotOptimize(detector.decodeNumber(in.segmentInfo[c])); });
+
+    // Decodificacin completa de un recorte: contornos frente a perfiles de proyeccin
+    cropBench("decodeContours", [&](size_t c) {
+        const Mat &crop = in.crops[c];
+        Mat thresholded = detector.thresholdImage(crop, params.thresholdOffset);
+        std::vector<std::vector<std::vector<Point>>> ordered =
+            detector.orderContours(detector.separateContoursBySegments(detector.getContours(thresholded, crop), crop.cols));
+        doNotOptimize(detector.decodeNumber(detector.getSegmentInfo(ordered, crop)));
+    });
+    cropBench("decodeScanlines", [&](size_t c) { doNotOptimize(detector.decodeNumber(detector.getScanlineSegmentInfo(in.crops[c]))); });
+
+    // Pipeline completo (referencia)
+    frameBench("detect", [&](size_t f) { doNotOptimize(detector.detect(in.frames[f])); });
+    frameBench("detectSpecialized", [&](size_t f) { doNotOptimize(pipeline.detect(in.frames[f], nullptr)); });
+
+    // Pipeline completo limitado a una franja central de un tercio de la altura
+    DetectorParams roiParams = params;
+    const Size frameSize = in.frames.front().size();
+    roiParams.rois = { { Point(0, frameSize.height / 3), Point(frameSize.width, frameSize.height / 3),
+                         Point(frameSize.width, 2 * frameSize.height / 3), Point(0, 2 * frameSize.height / 3) } };
+    CCodeDetector roiDetector(roiParams);
+    frameBench("detectRoi", [&](size_t f) { doNotOptimize(roiDetector.detect(in.frames[f])); });
+
+    // Pipeline completo con el localizador de componentes conexas
+    frameBench("detectComponents", [&](size_t f) { doNotOptimize(componentDetector.detect(in.frames[f])); });
+}
+
+
+/**
+ * @brief Decodifica todos los cdigos emparejados de un fotograma, igual que el bucle por cdigo de `detect`.
+ *
+ * @param detector Detector.
+ * @param matches Contornos emparejados.
+ * @param frame Fotograma BGR.
+ * @return std::vector<std::string> Los cdigos decodificados.
+ */
+static std::vector<std::string> decodeCodes(CCodeDetector &detector, const std::vector<std::pair<ContourInfo, ContourInfo>> &matches,
+                                            const Mat &frame) {
+    const DetectorParams &params = detector.getParams();
+    std::vector<std::string> codes;
+    for (Mat crop : detector.cutBoundingBox(matches, frame)) {
+        if (crop.empty()) {
+            codes.push_back("X");
+            continue;
+        }
+        crop = detector.BlurImage(detector.convertGrayImage(crop), params.decodeBlurKernelSize);
+        Mat thresholded = detector.thresholdImage(crop, params.thresholdOffset);
+        std::vector<std::vector<Point>> contours = detector.getContours(thresholded, crop);
+        std::vector<std::vector<std::vector<Point>>> ordered =
+            detector.orderContours(detector.separateContoursBySegments(contours, crop.cols));
+        std::vector<SegmentInfo> segmentInfo = detector.getSegmentInfo(ordered, crop);
+        codes.push_back(detector.decodeNumber(segmentInfo));
+        doNotOptimize(detector.getDigitConfidences(segmentInfo));
+    }
+    return codes;
+}
+
+
+/**
+ * @brief Mide cmo escalan `matchContours` y el bucle de decodificacin con el nmero de cdigos.
+ *
+ * @param runner Ejecutor de benchmarks.
+ * @param detector Detector.
+ */
+static void runScaling(CBenchmarkRunner &runner, CCodeDetector &detector) {
+    for (int numCodes : { 1, 2, 4, 8, 16, 32, 64 }) {
+        std::string suffix = "codes:" + std::to_string(numCodes);
+        if (!runner.isEnabled("matchContours/" + suffix) && !runner.isEnabled("decodeCodes/" + suffix)) {
+            continue;
+        }
+
+        // Escena 4K con cdigos pequeos (60 px de lado) para que quepan 64 sin solaparse
+        SyntheticSceneParams params;
+        params.frameSize = Size(3840, 2160);
+        params.numCodes = numCodes;
+        params.minSquareSize = 60;
+        RNG rng(2000 + numCodes);
+        std::vector<SyntheticCode> codes;
+        Mat scene = renderSyntheticScene(params, rng, &codes);
+        if (static_cast<int>( codes.size() ) < numCodes) {
+            std::cerr << "Solo caben " << codes.size() << " codigos en la escena de " << suffix << std::endl;
+        }
+
+        // Marcadores del ground truth (el orden verde se invierte para que el emparejamiento tenga que buscar)
+        std::vector<std::vector<Point>> redMarkers, greenMarkers;
+        for (const SyntheticCode &code : codes) {
+            redMarkers.push_back(code.redCorners);
+            greenMarkers.insert(greenMarkers.begin(), code.greenCorners);
+        }
+        std::vector<ContourInfo> redInfo = detector.extractContourInfo(redMarkers);
+        std::vector<ContourInfo> greenInfo = detector.extractContourInfo(greenMarkers);
+        std::vector<std::pair<ContourInfo, ContourInfo>> matches = detector.matchContours(redInfo, greenInfo);
+
+        runner.run("matchContours/" + suffix, [&]() { doNotOptimize(detector.matchContours(redInfo, greenInfo)); });
+        runner.run("decodeCodes/" + suffix, [&]() { doNotOptimize(decodeCodes(detector, matches, scene)); });
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    // Paso 1: Opciones propias (el resto las interpreta el ejecutor)
+    CBenchmarkRunner runner(argc, argv);
+    std::string directory = "Imagenes";
+    int numFrames = 4;
+    int numThreads = 1;
+    bool fixedPoint = false;
+    const std::vector<std::string> &args = runner.getRemainingArgs();
+    for (size_t a = 0; a < args.size(); ++a) {
+        if (args[a] == "--frames" && a + 1 < args.size()) numFrames = std::max(1, std::atoi(args[++a].c_str()));
+        else if (args[a] == "--threads" && a + 1 < args.size()) numThreads = std::max(1, std::atoi(args[++a].c_str()));
+        else if (args[a] == "--fixed-point") fixedPoint = true;
+        else directory = args[a];
+    }
+
+    // Paso 2: Por defecto OpenCV en un solo hilo, para que las medidas por etapa sean estables
+    setNumThreads(numThreads);
+    runner.addContext("opencv_version", CV_VERSION);
+    runner.addContext("opencv_threads", std::to_string(numThreads));
+    runner.addContext("frames_per_input", std::to_string(numFrames));
+    runner.addContext("images", directory);
+    runner.addContext("fixed_point", fixedPoint ? "true" : "false");
+
+    // Paso 3: Fotogramas reales repartidos uniformemente por el conjunto
+    std::vector<String> files;
+    glob(directory + "/*.jpg", files, false);
+    std::vector<Mat> realFrames;
+    for (int f = 0; f < numFrames && !files.empty(); ++f) {
+        Mat image = imread(files[f * files.size() / numFrames], IMREAD_COLOR);
+        if (!image.empty()) {
+            realFrames.push_back(image);
+        }
+    }
+    if (realFrames.empty()) {
+        std::cerr << "No se han encontrado imagenes en " << directory << ": solo se mediran escenas sinteticas" << std::endl;
+    }
+
+    // Paso 4: Ejecutar cada combinacin de fuente y resolucin, preparando sus entradas solo si hace falta
+    const std::pair<const char *, Size> resolutions[] = {
+        { "720p", Size(1280, 720) }, { "1080p", Size(1920, 1080) }, { "4k", Size(3840, 2160) } };
+    DetectorParams params;
+    params.fixedPoint = fixedPoint;
+    CCodeDetector detector(params);
+    std::unique_ptr<CDetectorPipeline> pipeline = createDetectorPipeline(params, false);
+    runner.addContext("detector_variant", pipeline->getName());
+    for (const auto &resolution : resolutions) {
+        for (const std::string source : { "real", "synthetic" }) {
+            std::string suffix = source + "/" + resolution.first;
+            bool enabled = false;
+            for (const char *stage : stageNames) {
+                enabled = enabled || runner.isEnabled(std::string(stage) + "/" + suffix);
+            }
+            if (!enabled) {
+                continue;
+            }
+
+            std::vector<Mat> frames;
+            if (source == "real") {
+                for (const Mat &image : realFrames) {
+                    Mat resized;
+                    resize(image, resized, resolution.second, 0, 0, INTER_LINEAR);
+                    frames.push_back(resized);
+                }
+            }
+            else {
+                for (int f = 0; f < numFrames; ++f) {
+                    RNG rng(1000 + f);
+                    frames.push_back(makeCrowdedScene(resolution.second, rng));
+                }
+            }
+            if (frames.empty()) {
+                continue;
+            }
+
+            StageInputs inputs = prepareInputs(detector, frames);
+            runStages(runner, detector, *pipeline, inputs, suffix);
+        }
+    }
+
+    // Paso 5: Escalado con el nmero de cdigos por fotograma
+    runScaling(runner, detector);
+
+    // Paso 6: Resultados en JSON para seguir las regresiones por etapa entre versiones
+    return runner.writeJson() ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+#include "SyntheticScene.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @struct LocalFrame
+ * @brief Sistema de coordenadas de una etiqueta: u a lo largo de la lnea rojo -> verde, v perpendicular.
+ */
+struct LocalFrame {
+    Point2f center;   /**< Centro de la etiqueta en la escena */
+    float cosA;       /**< Coseno del ngulo */
+    float sinA;       /**< Seno del ngulo */
+    float unit;       /**< Pxeles por unidad (lado del cuadrado) */
+
+    /**
+     * @brief Convierte un punto en unidades de la etiqueta a coordenadas de la escena.
+     */
+    Point2f toScene(float u, float v) const {
+        return Point2f(center.x + ( u * cosA - v * sinA ) * unit, center.y + ( u * sinA + v * cosA ) * unit);
+    }
+};
+
+
+/**
+ * @brief Rellena un rectngulo expresado en unidades de la etiqueta.
+ *
+ * @param scene Imagen de destino.
+ * @param frame Sistema de coordenadas de la etiqueta.
+ * @param rect Rectngulo (x, y, ancho, alto) en unidades del lado del cuadrado.
+ * @param color Color BGR.
+ * @param corners Si no es nullptr, recibe las cuatro esquinas en la escena.
+ */
+static void fillLocalRect(Mat &scene, const LocalFrame &frame, const Rect2f &rect, const Scalar &color,
+                          std::vector<Point> *corners = nullptr) {
+    Point2f pts[4] = { frame.toScene(rect.x, rect.y),
+                       frame.toScene(rect.x + rect.width, rect.y),
+                       frame.toScene(rect.x + rect.width, rect.y + rect.height),
+                       frame.toScene(rect.x, rect.y + rect.height) };
+    std::vector<Point> poly;
+    for (const Point2f &p : pts) {
+        poly.emplace_back(cvRound(p.x), cvRound(p.y));
+    }
+    fillConvexPoly(scene, poly, color, LINE_AA);
+    if (corners) {
+        corners->insert(corners->end(), poly.begin(), poly.end());
+    }
+}
+
+
+/**
+ * @brief Devuelve las barras (en unidades del lado del cuadrado, relativas al centro del segmento) de un dgito.
+ *
+ * Las proporciones reproducen los umbrales de `decodeNumber`: una barra vertical fina (rea < 0.15 del
+ * segmento) es un 1 y una gruesa un 5; con dos barras, la relacin de reas decide entre 3/7/9 (horizontales)
+ * y 2/6/4 (verticales).
+ *
+ * @param digit Dgito ('0'-'9').
+ * @return std::vector<Rect2f> Las barras del dgito.
+ */
+static std::vector<Rect2f> digitBars(char digit) {
+    switch (digit) {
+        case '8': return { Rect2f(-0.30f, -0.06f, 0.60f, 0.12f) };
+        case '1': return { Rect2f(-0.06f, -0.30f, 0.12f, 0.60f) };
+        case '5': return { Rect2f(-0.15f, -0.30f, 0.30f, 0.60f) };
+        case '3': return { Rect2f(-0.30f, -0.21f, 0.60f, 0.12f), Rect2f(-0.30f, 0.09f, 0.60f, 0.12f) };
+        case '7': return { Rect2f(-0.30f, -0.25f, 0.60f, 0.16f), Rect2f(-0.30f, 0.10f, 0.60f, 0.10f) };
+        case '9': return { Rect2f(-0.30f, -0.20f, 0.60f, 0.10f), Rect2f(-0.30f, 0.09f, 0.60f, 0.16f) };
+        case '2': return { Rect2f(-0.21f, -0.30f, 0.12f, 0.60f), Rect2f(0.09f, -0.30f, 0.12f, 0.60f) };
+        case '6': return { Rect2f(-0.25f, -0.30f, 0.16f, 0.60f), Rect2f(0.10f, -0.30f, 0.10f, 0.60f) };
+        case '4': return { Rect2f(-0.20f, -0.30f, 0.10f, 0.60f), Rect2f(0.09f, -0.30f, 0.16f, 0.60f) };
+        default:  return {};
+    }
+}
+
+
+/**
+ * @brief Dibuja un cdigo sobre una imagen BGR.
+ *
+ * Esta funcin dibuja la etiqueta blanca, los marcadores rojo y verde (cuadrados huecos) en los segmentos
+ * primero y ltimo y las barras de cada dgito en gris oscuro. Los segmentos tienen el mismo ancho que los
+ * cuadrados, de modo que al dividir el recorte del detector en cuartos cada dgito cae en su cuarto.
+ *
+ * @param scene Imagen BGR de destino.
+ * @param code Cdigo de 4 dgitos.
+ * @param center Centro de la etiqueta.
+ * @param squareSize Lado de los cuadrados, en pxeles.
+ * @param angle ngulo de la lnea rojo -> verde, en grados.
+ *
+ * @return SyntheticCode El cdigo dibujado con su bounding box.
+ */
+SyntheticCode drawSyntheticCode(Mat &scene, const std::string &code, Point2f center, float squareSize, float angle) {
+    LocalFrame frame;
+    frame.center = center;
+    frame.cosA = std::cos(angle * static_cast<float>( CV_PI ) / 180.0f);
+    frame.sinA = std::sin(angle * static_cast<float>( CV_PI ) / 180.0f);
+    frame.unit = squareSize;
+
+    const Scalar white(235, 235, 235);
+    const Scalar red(40, 40, 210);
+    const Scalar green(60, 160, 60);
+    const Scalar bar(95, 95, 100);
+    const float border = std::max(2.0f / squareSize, 0.05f);
+
+    // Paso 1: Etiqueta blanca
+    fillLocalRect(scene, frame, Rect2f(-2.3f, -0.7f, 4.6f, 1.4f), white);
+
+    // Paso 2: Marcadores rojo (segmento 0) y verde (segmento 3), como cuadrados huecos
+    std::vector<Point> redCorners, greenCorners;
+    for (int segment : { 0, 3 }) {
+        float cu = segment - 1.5f;
+        fillLocalRect(scene, frame, Rect2f(cu - 0.5f, -0.5f, 1.0f, 1.0f), segment == 0 ? red : green,
+                      segment == 0 ? &redCorners : &greenCorners);
+        fillLocalRect(scene, frame, Rect2f(cu - 0.5f + border, -0.5f + border, 1.0f - 2 * border, 1.0f - 2 * border), white);
+    }
+
+    // Paso 3: Barras de cada dgito, centradas en su segmento
+    for (int segment = 0; segment < 4 && segment < static_cast<int>( code.size() ); ++segment) {
+        float cu = segment - 1.5f;
+        for (const Rect2f &r : digitBars(code[segment])) {
+            fillLocalRect(scene, frame, Rect2f(cu + r.x, r.y, r.width, r.height), bar);
+        }
+    }
+
+    SyntheticCode result;
+    result.code = code;
+    result.center = center;
+    result.squareSize = squareSize;
+    result.angle = angle;
+    std::vector<Point> markerCorners = redCorners;
+    markerCorners.insert(markerCorners.end(), greenCorners.begin(), greenCorners.end());
+    result.boundingBox = boundingRect(markerCorners);
+    result.redCorners = redCorners;
+    result.greenCorners = greenCorners;
+    return result;
+}
+
+
+/**
+ * @brief Lado de cuadrado adecuado para una resolucin (15.5% del alto de la imagen).
+ *
+ * @param frameSize Tamao de la escena.
+ *
+ * @return float Lado de los cuadrados, en pxeles.
+ */
+float syntheticSquareSize(const Size &frameSize) {
+    return 0.155f * frameSize.height;
+}
+
+
+/**
+ * @brief Genera un cdigo aleatorio de 4 dgitos.
+ *
+ * @param rng Generador aleatorio.
+ *
+ * @return std::string El cdigo.
+ */
+std::string randomSyntheticCode(RNG &rng) {
+    std::string code;
+    for (int i = 0; i < 4; ++i) {
+        code += static_cast<char>( '0' + rng.uniform(0, 10) );
+    }
+    return code;
+}
+
+
+/**
+ * @brief Crea un fondo gris con un degradado horizontal suave.
+ *
+ * @param frameSize Tamao de la escena.
+ *
+ * @return Mat El fondo BGR.
+ */
+static Mat makeBackground(const Size &frameSize) {
+    Mat scene(frameSize, CV_8UC3);
+    for (int x = 0; x < frameSize.width; ++x) {
+        int level = 130 + 40 * x / std::max(1, frameSize.width - 1);
+        scene.col(x).setTo(Scalar(level, level, level + 5));
+    }
+    return scene;
+}
+
+
+/**
+ * @brief Dibuja manchas pequeas rojas, verdes y grises (por debajo del 1% de la imagen, como el ruido real).
+ *
+ * @param scene Imagen de destino.
+ * @param rng Generador aleatorio.
+ * @param count Nmero de manchas.
+ * @param squareSize Lado de los cuadrados de los cdigos (el radio mximo es el 20% del lado).
+ */
+static void drawDistractors(Mat &scene, RNG &rng, int count, float squareSize) {
+    const Scalar colors[] = { Scalar(40, 40, 200), Scalar(60, 160, 60), Scalar(90, 90, 90) };
+    for (int i = 0; i < count; ++i) {
+        Point p(rng.uniform(0, scene.cols), rng.uniform(0, scene.rows));
+        circle(scene, p, rng.uniform(3, std::max(4, cvRound(squareSize * 0.2f))), colors[i % 3], FILLED, LINE_AA);
+    }
+}
+
+
+/**
+ * @brief Genera una escena con tantos cdigos como caben en una rejilla, con distractores de colores.
+ *
+ * El fondo es un degradado gris. Cada celda de la rejilla contiene un cdigo con un giro aleatorio de
+ * 12 grados (la mitad de ellos con el rojo a la derecha, como en las imgenes reales). Entre los cdigos
+ * se dibujan manchas rojas, verdes y grises pequeas que el detector debe descartar.
+ *
+ * @param frameSize Tamao de la escena.
+ * @param rng Generador aleatorio.
+ * @param codes Si no es nullptr, recibe los cdigos dibujados.
+ *
+ * @return Mat La escena BGR.
+ */
+Mat makeCrowdedScene(const Size &frameSize, RNG &rng, std::vector<SyntheticCode> *codes) {
+    // Paso 1: Fondo y distractores
+    Mat scene = makeBackground(frameSize);
+    float squareSize = syntheticSquareSize(frameSize);
+    drawDistractors(scene, rng, 40, squareSize);
+
+    // Paso 2: Un cdigo por celda de la rejilla
+    float cellWidth = 5.2f * squareSize;
+    float cellHeight = 2.8f * squareSize;
+    int cols = std::max(1, static_cast<int>( frameSize.width / cellWidth ));
+    int rows = std::max(1, static_cast<int>( frameSize.height / cellHeight ));
+    float marginX = ( frameSize.width - cols * cellWidth ) / 2;
+    float marginY = ( frameSize.height - rows * cellHeight ) / 2;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            Point2f center(marginX + ( c + 0.5f ) * cellWidth, marginY + ( r + 0.5f ) * cellHeight);
+            float angle = rng.uniform(-12.0f, 12.0f) + ( rng.uniform(0, 2) ? 180.0f : 0.0f );
+            SyntheticCode code = drawSyntheticCode(scene, randomSyntheticCode(rng), center, squareSize, angle);
+            if (codes) {
+                codes->push_back(code);
+            }
+        }
+    }
+
+    return scene;
+}
+
+
+/**
+ * @brief Genera una escena con cdigos colocados al azar sin solaparse, con desenfoque y ruido opcionales.
+ *
+ * Cada cdigo recibe un tamao y un giro aleatorios dentro de los lmites de `params` y se coloca en una
+ * posicin libre (se descartan las posiciones cuya caja girada se solapa con otra etiqueta). Si tras
+ * varios intentos no cabe, se deja de aadir cdigos: `codes` contiene solo los colocados. El desenfoque y
+ * el ruido se aplican al final, sobre toda la escena.
+ *
+ * @param params Parmetros de la escena.
+ * @param rng Generador aleatorio.
+ * @param codes Si no es nullptr, recibe los cdigos colocados.
+ *
+ * @return Mat La escena BGR.
+ */
+Mat renderSyntheticScene(const SyntheticSceneParams &params, RNG &rng, std::vector<SyntheticCode> *codes) {
+    // Paso 1: Fondo y distractores
+    float minSize = params.minSquareSize > 0 ? params.minSquareSize : syntheticSquareSize(params.frameSize);
+    float maxSize = std::max(minSize, params.maxSquareSize);
+    Mat scene = makeBackground(params.frameSize);
+    drawDistractors(scene, rng, params.numDistractors, minSize);
+
+    // Paso 2: Colocar los cdigos en posiciones libres
+    std::vector<Rect> occupied;
+    for (int n = 0; n < params.numCodes; ++n) {
+        bool placed = false;
+        for (int attempt = 0; attempt < 200 && !placed; ++attempt) {
+            float size = minSize < maxSize ? rng.uniform(minSize, maxSize) : minSize;
+            float angle = params.maxAngle > 0 ? rng.uniform(-params.maxAngle, params.maxAngle) : 0.0f;
+            if (params.allowFlip && rng.uniform(0, 2)) {
+                angle += 180.0f;
+            }
+
+            // Caja de la etiqueta girada (4.6 x 1.4 lados de cuadrado), con un margen de medio lado
+            float rad = angle * static_cast<float>( CV_PI ) / 180.0f;
+            float halfW = ( 2.3f * std::abs(std::cos(rad)) + 0.7f * std::abs(std::sin(rad)) + 0.5f ) * size;
+            float halfH = ( 2.3f * std::abs(std::sin(rad)) + 0.7f * std::abs(std::cos(rad)) + 0.5f ) * size;
+            if (2 * halfW >= params.frameSize.width || 2 * halfH >= params.frameSize.height) {
+                continue;
+            }
+            Point2f center(rng.uniform(halfW, params.frameSize.width - halfW),
+                           rng.uniform(halfH, params.frameSize.height - halfH));
+            Rect box(cvRound(center.x - halfW), cvRound(center.y - halfH), cvRound(2 * halfW), cvRound(2 * halfH));
+
+            bool overlaps = false;
+            for (const Rect &other : occupied) {
+                if (( box & other ).area() > 0) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (overlaps) {
+                continue;
+            }
+
+            SyntheticCode code = drawSyntheticCode(scene, randomSyntheticCode(rng), center, size, angle);
+            occupied.push_back(box);
+            if (codes) {
+                codes->push_back(code);
+            }
+            placed = true;
+        }
+        if (!placed) {
+            break;
+        }
+    }
+
+    // Paso 3: Desenfoque y ruido de toda la escena
+    if (params.blurSigma > 0) {
+        GaussianBlur(scene, scene, Size(), params.blurSigma);
+    }
+    if (params.noiseSigma > 0) {
+        Mat noise(scene.size(), CV_16SC3);
+        randn(noise, Scalar::all(0), Scalar::all(params.noiseSigma));
+        Mat noisy;
+        scene.convertTo(noisy, CV_16SC3);
+        noisy += noise;
+        noisy.convertTo(scene, CV_8UC3);
+    }
+
+    return scene;
+}
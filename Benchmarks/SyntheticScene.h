@@ -0,0 +1,93 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include <string>
+#include <vector>
+
+using namespace cv;
+
+/**
+ * @struct SyntheticCode
+ * @brief Cdigo dibujado en una escena sinttica, junto con su posicin real (ground truth).
+ */
+struct SyntheticCode {
+    std::string code;          /**< Cdigo de 4 dgitos ('0'-'9') */
+    Point2f center;            /**< Centro de la etiqueta en la escena */
+    float squareSize = 0;      /**< Lado de los cuadrados rojo y verde, en pxeles */
+    float angle = 0;           /**< ngulo de la lnea rojo -> verde, en grados */
+    Rect boundingBox;          /**< Bounding box de los dos cuadrados en la escena */
+    std::vector<Point> redCorners;     /**< Esquinas del cuadrado rojo en la escena */
+    std::vector<Point> greenCorners;   /**< Esquinas del cuadrado verde en la escena */
+};
+
+/**
+ * @struct SyntheticSceneParams
+ * @brief Parmetros de una escena sinttica con cdigos colocados al azar.
+ */
+struct SyntheticSceneParams {
+    Size frameSize = Size(1920, 1080);   /**< Resolucin de la escena */
+    int numCodes = 4;                    /**< Cdigos a colocar (se colocan los que quepan sin solaparse) */
+    float minSquareSize = 0;             /**< Lado mnimo de los cuadrados, en pxeles (0 = `syntheticSquareSize`) */
+    float maxSquareSize = 0;             /**< Lado mximo de los cuadrados, en pxeles (0 = igual que el mnimo) */
+    float maxAngle = 15;                 /**< Giro mximo respecto a la horizontal, en grados (180 = cualquiera) */
+    bool allowFlip = true;               /**< Permite etiquetas con el rojo a la derecha (giro de 180 grados) */
+    double blurSigma = 0;                /**< Desenfoque gaussiano de la escena (0 = sin desenfoque) */
+    double noiseSigma = 0;               /**< Ruido gaussiano aadido a cada canal (0 = sin ruido) */
+    int numDistractors = 40;             /**< Manchas rojas, verdes y grises que el detector debe descartar */
+};
+
+/**
+ * @brief Dibuja un cdigo sobre una imagen BGR.
+ *
+ * La etiqueta reproduce el formato real: fondo blanco, cuadrado rojo (primer dgito), dos segmentos
+ * centrales y cuadrado verde (ltimo dgito), cada uno de lado `squareSize`. Cada dgito se dibuja con las
+ * barras que `CCodeDetector::decodeNumber` interpreta (una o dos barras horizontales o verticales con la
+ * relacin de reas correspondiente).
+ *
+ * @param scene Imagen BGR de destino.
+ * @param code Cdigo de 4 dgitos.
+ * @param center Centro de la etiqueta.
+ * @param squareSize Lado de los cuadrados, en pxeles.
+ * @param angle ngulo de la lnea rojo -> verde, en grados (sentido de `atan2` con el eje Y hacia abajo).
+ * @return SyntheticCode El cdigo dibujado con su bounding box.
+ */
+SyntheticCode drawSyntheticCode(Mat &scene, const std::string &code, Point2f center, float squareSize, float angle);
+
+/**
+ * @brief Lado de cuadrado adecuado para una resolucin.
+ *
+ * El detector exige que los marcadores ocupen ms del 1% de la imagen y que las barras no superen
+ * 25000 pxeles de rea; este tamao respeta ambos lmites en 720p, 1080p y 4K.
+ *
+ * @param frameSize Tamao de la escena.
+ * @return float Lado de los cuadrados, en pxeles.
+ */
+float syntheticSquareSize(const Size &frameSize);
+
+/**
+ * @brief Genera un cdigo aleatorio de 4 dgitos.
+ *
+ * @param rng Generador aleatorio.
+ * @return std::string El cdigo.
+ */
+std::string randomSyntheticCode(RNG &rng);
+
+/**
+ * @brief Genera una escena con tantos cdigos como caben en una rejilla, con distractores de colores.
+ *
+ * @param frameSize Tamao de la escena.
+ * @param rng Generador aleatorio.
+ * @param codes Si no es nullptr, recibe los cdigos dibujados (ground truth).
+ * @return Mat La escena BGR.
+ */
+Mat makeCrowdedScene(const Size &frameSize, RNG &rng, std::vector<SyntheticCode> *codes = nullptr);
+
+/**
+ * @brief Genera una escena con cdigos colocados al azar sin solaparse, con desenfoque y ruido opcionales.
+ *
+ * @param params Parmetros de la escena.
+ * @param rng Generador aleatorio.
+ * @param codes Si no es nullptr, recibe los cdigos colocados (ground truth).
+ * @return Mat La escena BGR.
+ */
+Mat renderSyntheticScene(const SyntheticSceneParams &params, RNG &rng, std::vector<SyntheticCode> *codes = nullptr);
@@ -0,0 +1,127 @@
+#include "../DeteccionCodigos/FrameDataset.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * @file DatasetPacker.cpp
+ * @brief Empaqueta un directorio de imgenes o un vdeo en un conjunto de fotogramas mapeable (.dcf).
+ *
+ * Por defecto guarda los fotogramas decodificados en BGR, de modo que al reprocesarlos (DetectorCLI,
+ * ParameterTuner) no hay que abrir ni decodificar ningn fichero: cada fotograma es una vista sobre el
+ * fichero mapeado en memoria. `--scale` los reduce antes de guardarlos (p. ej. 0.5 para reprocesar con
+ * `pyramidScale` = 1 a la mitad de resolucin) y `--jpeg` guarda los JPEG originales tal cual (fichero
+ * pequeo, pero con decodificacin al leer). La etiqueta de cada fotograma es el nombre del fichero
+ * original (ParameterTuner toma el cdigo de su prefijo) o "<video>#<n>" para los vdeos, y el instante es
+ * la fecha de modificacin del fichero o la posicin del fotograma en el vdeo.
+ *
+ * Uso: DatasetPacker <directorio|video> <salida.dcf> [--jpeg] [--scale s] [--quality q]
+ */
+
+/**
+ * @brief Instante de la ltima modificacin de un fichero, en ms desde epoch.
+ *
+ * @param path Ruta del fichero.
+ * @return int64_t Instante (0 si no se puede leer).
+ */
+static int64_t modificationTimeMs(const std::filesystem::path &path) {
+    std::error_code error;
+    std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return 0;
+    }
+    // C++17 no permite convertir directamente el reloj de ficheros al del sistema: se traslada la diferencia
+    // con el instante actual de cada reloj
+    auto systemTime = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        fileTime - std::filesystem::file_time_type::clock::now());
+    return std::chrono::duration_cast<std::chrono::milliseconds>(systemTime.time_since_epoch()).count();
+}
+
+
+int main(int argc, char *argv[])
+{
+    // Paso 1: Leer los argumentos de la lnea de comandos
+    if (argc < 3) {
+        std::cerr << "Uso: DatasetPacker <directorio|video> <salida.dcf> [--jpeg] [--scale s] [--quality q]" << std::endl;
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+    FrameDatasetParams params;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--jpeg") params.encoding = FrameDatasetParams::Jpeg;
+        else if (arg == "--scale" && i + 1 < argc) params.scale = std::atof(argv[++i]);
+        else if (arg == "--quality" && i + 1 < argc) params.jpegQuality = std::atoi(argv[++i]);
+    }
+
+    CFrameDatasetWriter writer(params);
+    if (!writer.open(output)) {
+        std::cerr << "No se ha podido crear " << output << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const bool copyJpeg = params.encoding == FrameDatasetParams::Jpeg && !( params.scale > 0 && params.scale < 1.0 );
+
+    // Paso 2: Aadir los fotogramas
+    if (std::filesystem::is_directory(input)) {
+        std::vector<String> files;
+        glob(input + "/*.jpg", files, false);
+        for (const auto &file : files) {
+            Mat image = imread(file, IMREAD_COLOR);
+            if (image.empty()) {
+                std::cerr << "No se ha podido leer " << file << std::endl;
+                continue;
+            }
+            std::filesystem::path path(file);
+            std::string label = path.filename().string();
+            int64_t timestampMs = modificationTimeMs(path);
+            bool added = false;
+            if (copyJpeg) {
+                // Los JPEG se copian tal cual, sin recodificarlos
+                std::ifstream in(file, std::ios::in | std::ios::binary);
+                std::vector<uchar> bytes(( std::istreambuf_iterator<char>(in) ), std::istreambuf_iterator<char>());
+                added = writer.addJpeg(bytes, image.size(), label, timestampMs);
+            }
+            else {
+                added = writer.addFrame(image, label, timestampMs);
+            }
+            if (!added) {
+                std::cerr << "No se ha podido escribir " << file << std::endl;
+                return 1;
+            }
+        }
+    }
+    else {
+        VideoCapture capture(input);
+        if (!capture.isOpened()) {
+            std::cerr << "No se ha podido abrir " << input << std::endl;
+            return 1;
+        }
+        std::string name = std::filesystem::path(input).filename().string();
+        Mat frame;
+        for (uint64_t index = 0; capture.read(frame); ++index) {
+            int64_t timestampMs = static_cast<int64_t>( capture.get(CAP_PROP_POS_MSEC) );
+            if (!writer.addFrame(frame, name + "#" + std::to_string(index), timestampMs)) {
+                std::cerr << "No se ha podido escribir el fotograma " << index << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // Paso 3: Cerrar el conjunto (ndice y etiquetas) y mostrar el resumen
+    size_t frames = writer.getFrameCount();
+    if (!writer.close()) {
+        std::cerr << "No se ha podido completar " << output << std::endl;
+        return 1;
+    }
+    double elapsedS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::error_code error;
+    double sizeMb = static_cast<double>( std::filesystem::file_size(output, error) ) / ( 1024.0 * 1024.0 );
+    std::cout << std::fixed << std::setprecision(1)
+              << "Fotogramas: " << frames << ", " << sizeMb << " MB ("
+              << ( params.encoding == FrameDatasetParams::Raw ? "BGR" : "JPEG" ) << "), " << elapsedS << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,2013 @@
+#include "CodeDetector.h"
+
+/**
+ * @brief Constructor de la clase CCodeDetector.
+ *
+ * @param params Parmetros iniciales del pipeline.
+ */
+CCodeDetector::CCodeDetector(const DetectorParams &params)
+    : params(params)
+{
+    updateColorLut();
+}
+
+
+/**
+ * @brief Devuelve los parmetros actuales del pipeline.
+ *
+ * @return const DetectorParams& Referencia a los parmetros en uso.
+ */
+const DetectorParams &CCodeDetector::getParams() const {
+    return params;
+}
+
+
+/**
+ * @brief Sustituye los parmetros del pipeline.
+ *
+ * @param newParams Nuevos parmetros a utilizar en las siguientes llamadas.
+ */
+void CCodeDetector::setParams(const DetectorParams &newParams) {
+    // El filtro de bordes especializado solo vale para el kernel y el modo con que se cre
+    if (newParams.sobelKernelSize != params.sobelKernelSize || newParams.fixedPoint != params.fixedPoint) {
+        edgeFilter = nullptr;
+    }
+    params = newParams;
+    updateColorLut();
+}
+
+
+/**
+ * @brief Sustituye el filtro de bordes de `findFilteredContours`.
+ *
+ * @param filter Filtro de bordes; nullptr para volver a `sobelFilter` con `params.sobelKernelSize`.
+ */
+void CCodeDetector::setEdgeFilter(EdgeFilter filter) {
+    edgeFilter = filter;
+}
+
+
+/**
+ * @brief Construye la tabla de colores si `params.colorLut` est activado y los rangos han cambiado.
+ *
+ * Construirla cuesta unos milisegundos (una conversin a HSV de 2^18 pxeles), as que se reutiliza mientras
+ * los rangos no cambien. Se comparte entre copias del detector y con los dems detectores del proceso con los
+ * mismos rangos (`CColorLut::get`), ya que no se modifica.
+ */
+void CCodeDetector::updateColorLut() {
+    if (!params.colorLut) {
+        colorLut.reset();
+    }
+    else if (!colorLut || !colorLut->matches(params)) {
+        colorLut = CColorLut::get(params);
+    }
+}
+
+
+/**
+ * @brief Mide las etapas de `detect` en un registro de mtricas.
+ *
+ * Las series son `dc_stage_seconds{stream, stage="locate"|"decode"}`. Sin registro no se toma ninguna medida.
+ *
+ * @param registry Registro de mtricas (nullptr para dejar de medir).
+ * @param streamId Identificador del flujo.
+ */
+void CCodeDetector::setMetrics(CMetricsRegistry *registry, const std::string &streamId) {
+    stageMetrics = DetectorStageMetrics();
+    if (registry != nullptr) {
+        const std::string help = "Duracion de cada etapa del detector, en segundos";
+        stageMetrics.locateSeconds = &registry->histogram("dc_stage_seconds", help, { { "stream", streamId }, { "stage", "locate" } });
+        stageMetrics.decodeSeconds = &registry->histogram("dc_stage_seconds", help, { { "stream", streamId }, { "stage", "decode" } });
+        stageMetrics.outOfBoundsCrops = &registry->counter("dc_crops_out_of_bounds_total",
+                                                           "Parejas de marcadores cuyo recorte se sale de la imagen", { { "stream", streamId } });
+    }
+}
+
+
+/**
+ * @brief Devuelve los histogramas de las etapas.
+ */
+const DetectorStageMetrics &CCodeDetector::getStageMetrics() const {
+    return stageMetrics;
+}
+
+
+/**
+ * @brief Carga los parmetros del pipeline desde un fichero de OpenCV (YAML o XML).
+ *
+ * Solo se sobrescriben los campos presentes en el fichero; el resto conserva su valor actual.
+ *
+ * @param fileName Ruta del fichero de parmetros.
+ *
+ * @return bool true si el fichero existe y se ha podido leer, false en caso contrario.
+ */
+bool CCodeDetector::loadParams(const std::string &fileName) {
+    // Paso 1: Abrir el fichero en modo lectura
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+
+    // Paso 2: Leer cada campo solo si est presente en el fichero
+    auto readInt = [&fs](const char *key, int &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    auto readDouble = [&fs](const char *key, double &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    auto readBool = [&fs](const char *key, bool &value) {
+        if (!fs[key].empty()) {
+            int v = 0;
+            fs[key] >> v;
+            value = v != 0;
+        }
+    };
+    auto readScalar = [&fs](const char *key, Scalar &value) {
+        if (!fs[key].empty()) {
+            std::vector<double> v;
+            fs[key] >> v;
+            if (v.size() == 3) value = Scalar(v[0], v[1], v[2]);
+        }
+    };
+
+    readInt("blurKernelSize", params.blurKernelSize);
+    readInt("sobelKernelSize", params.sobelKernelSize);
+    readInt("sobelThreshold", params.sobelThreshold);
+    readScalar("redLow1", params.redLow1);
+    readScalar("redHigh1", params.redHigh1);
+    readScalar("redLow2", params.redLow2);
+    readScalar("redHigh2", params.redHigh2);
+    readScalar("greenLow", params.greenLow);
+    readScalar("greenHigh", params.greenHigh);
+    readDouble("pyramidScale", params.pyramidScale);
+    readInt("decodeBlurKernelSize", params.decodeBlurKernelSize);
+    readInt("thresholdBlockSize", params.thresholdBlockSize);
+    readInt("thresholdOffset", params.thresholdOffset);
+    readBool("fixedPoint", params.fixedPoint);
+    readBool("colorLut", params.colorLut);
+    readBool("componentLocator", params.componentLocator);
+    readDouble("componentMinFill", params.componentMinFill);
+    readBool("scanlineDecoder", params.scanlineDecoder);
+    readDouble("scanlineMargin", params.scanlineMargin);
+
+    // Paso 3: Leer las ROI: cada una es una lista de coordenadas [x0, y0, x1, y1, ...] de un polgono, o
+    // [x, y, ancho, alto] de un rectngulo
+    FileNode roisNode = fs["rois"];
+    if (!roisNode.empty()) {
+        params.rois.clear();
+        for (const FileNode &roiNode : roisNode) {
+            std::vector<int> v;
+            roiNode >> v;
+            std::vector<Point> polygon;
+            if (v.size() == 4) {
+                Rect rect(v[0], v[1], v[2], v[3]);
+                polygon = { rect.tl(), Point(rect.x + rect.width, rect.y), rect.br(), Point(rect.x, rect.y + rect.height) };
+            }
+            else {
+                for (size_t k = 0; k + 1 < v.size(); k += 2) {
+                    polygon.push_back(Point(v[k], v[k + 1]));
+                }
+            }
+            if (polygon.size() >= 3) {
+                params.rois.push_back(polygon);
+            }
+        }
+    }
+
+    updateColorLut();
+    return true;
+}
+
+
+/**
+ * @brief Guarda los parmetros actuales del pipeline en un fichero de OpenCV (YAML o XML).
+ *
+ * @param fileName Ruta del fichero de salida. La extensin determina el formato.
+ *
+ * @return bool true si el fichero se ha podido escribir, false en caso contrario.
+ */
+bool CCodeDetector::saveParams(const std::string &fileName) const {
+    // Paso 1: Abrir el fichero en modo escritura
+    FileStorage fs(fileName, FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        return false;
+    }
+
+    // Paso 2: Escribir los rangos de color como vectores de 3 componentes (H, S, V)
+    auto toVector = [](const Scalar &s) {
+        return std::vector<double>{ s[0], s[1], s[2] };
+    };
+
+    fs << "blurKernelSize" << params.blurKernelSize;
+    fs << "sobelKernelSize" << params.sobelKernelSize;
+    fs << "sobelThreshold" << params.sobelThreshold;
+    fs << "redLow1" << toVector(params.redLow1);
+    fs << "redHigh1" << toVector(params.redHigh1);
+    fs << "redLow2" << toVector(params.redLow2);
+    fs << "redHigh2" << toVector(params.redHigh2);
+    fs << "greenLow" << toVector(params.greenLow);
+    fs << "greenHigh" << toVector(params.greenHigh);
+    fs << "pyramidScale" << params.pyramidScale;
+    fs << "decodeBlurKernelSize" << params.decodeBlurKernelSize;
+    fs << "thresholdBlockSize" << params.thresholdBlockSize;
+    fs << "thresholdOffset" << params.thresholdOffset;
+    fs << "fixedPoint" << static_cast<int>( params.fixedPoint );
+    fs << "colorLut" << static_cast<int>( params.colorLut );
+    fs << "componentLocator" << static_cast<int>( params.componentLocator );
+    fs << "componentMinFill" << params.componentMinFill;
+    fs << "scanlineDecoder" << static_cast<int>( params.scanlineDecoder );
+    fs << "scanlineMargin" << params.scanlineMargin;
+    fs << "rois" << "[";
+    for (const std::vector<Point> &roi : params.rois) {
+        std::vector<int> v;
+        for (const Point &p : roi) {
+            v.push_back(p.x);
+            v.push_back(p.y);
+        }
+        fs << v;
+    }
+    fs << "]";
+
+    return true;
+}
+
+
+/**
+ * @brief Reescala y desplaza la informacin geomtrica de un contorno.
+ *
+ * Multiplica las coordenadas y longitudes por `factor` y el rea por `factor` al cuadrado, y suma `offset`
+ * a las coordenadas. La relacin de aspecto y el ngulo no cambian con el escalado.
+ *
+ * @param info Informacin del contorno a reescalar.
+ * @param factor Factor de escala.
+ * @param offset Desplazamiento (p. ej. la esquina de la regin procesada) que se suma despus de escalar.
+ *
+ * @return ContourInfo La informacin del contorno en la nueva escala.
+ */
+ContourInfo CCodeDetector::scaleContourInfo(const ContourInfo &info, double factor, Point offset) {
+    ContourInfo scaled = info;
+    for (Point &corner : scaled.corners) {
+        corner = Point(cvRound(corner.x * factor) + offset.x, cvRound(corner.y * factor) + offset.y);
+    }
+    scaled.center = Point2f(static_cast<float>( info.center.x * factor + offset.x ), static_cast<float>( info.center.y * factor + offset.y ));
+    scaled.width = static_cast<float>( info.width * factor );
+    scaled.height = static_cast<float>( info.height * factor );
+    scaled.area = static_cast<float>( info.area * factor * factor );
+    scaled.perimeter = static_cast<float>( info.perimeter * factor );
+    return scaled;
+}
+
+
+/**
+ * @brief Aplica un filtro de desenfoque gaussiano a la imagen.
+ *
+ * Esta funcin aplica un desenfoque gaussiano a la imagen proporcionada para
+ * reducir el ruido y suavizar la imagen. El tamao del filtro se puede ajustar
+ * a travs del parmetro `kernerSsize`.
+ *
+ * @param image La imagen original sobre la que se aplicar el desenfoque.
+ * @param kernerSsize El tamao del kernel para el filtro de desenfoque (debe ser un nmero impar).
+ *
+ * @return Mat La imagen procesada con el desenfoque gaussiano aplicado.
+ */
+Mat CCodeDetector::BlurImage(const Mat &image, uint8_t kernerSsize) {
+    CTraceScope trace("blur");
+    // Aplicar el filtro de desenfoque gaussiano con el tamao de kernel especificado
+    Mat blurImage;
+    GaussianBlur(image, blurImage, Size(kernerSsize, kernerSsize), 0);
+    return blurImage;
+}
+
+
+/**
+ * @brief Convierte una imagen a escala de grises.
+ *
+ * Esta funcin toma una imagen en color (en formato BGR) y la convierte a una
+ * imagen en escala de grises. La conversin es til para simplificar el procesamiento
+ * de imgenes en tareas como la deteccin de bordes o la segmentacin.
+ *
+ * @param image La imagen original que se va a convertir (en formato BGR).
+ *
+ * @return Mat La imagen convertida a escala de grises.
+ */
+Mat CCodeDetector::convertGrayImage(const Mat &image) {
+    CTraceScope trace("gray");
+    // Convertir la imagen de BGR a escala de grises usando la funcin cvtColor
+    Mat grayImage;
+    cvtColor(image, grayImage, COLOR_BGR2GRAY);
+    return grayImage;
+}
+
+
+/**
+ * @brief Convierte una imagen al espacio de color HSV.
+ *
+ * Esta funcin toma una imagen en el formato BGR y la convierte a HSV (Hue, Saturation, Value).
+ * El espacio de color HSV es frecuentemente utilizado en procesamiento de imgenes para tareas como
+ * la segmentacin de colores y la deteccin de objetos, ya que separa la informacin de tono (hue)
+ * de la de intensidad (valor), lo que puede facilitar la deteccin de colores especficos.
+ *
+ * @param image La imagen original que se va a convertir (en formato BGR).
+ *
+ * @return Mat La imagen convertida al espacio de color HSV.
+ */
+Mat CCodeDetector::convertHSVImage(const Mat &image) {
+    CTraceScope trace("hsv");
+    // Convertir la imagen de BGR a HSV usando la funcin cvtColor
+    Mat hsvImage;
+    cvtColor(image, hsvImage, COLOR_BGR2HSV);
+    return hsvImage;
+}
+
+
+/**
+ * @brief Genera una mscara para detectar el color rojo en una imagen en espacio HSV.
+ *
+ * Esta funcin utiliza los valores del espacio de color HSV para crear una mscara que detecte
+ * los pxeles correspondientes al color rojo. Dado que el color rojo se encuentra en dos rangos
+ * en el espacio HSV, se crean dos mscaras que se combinan para cubrir ambos rangos del color rojo.
+ *
+ * @param image La imagen en espacio HSV sobre la que se aplicar la mscara.
+ *
+ * @return Mat La mscara generada donde los pxeles correspondientes al color rojo son blancos
+ *             (valor 255) y los dems son negros (valor 0).
+ */
+Mat CCodeDetector::getRedMask(const Mat &image) {
+    CTraceScope trace("redMask");
+    // Crear dos mscaras separadas para los dos rangos de color rojo en el espacio HSV
+    Mat mascaraRoja, mascaraRoja2;
+
+    // Rango 1: Detectar rojo en el rango de tono [0, 10] (valores por defecto de DetectorParams)
+    inRange(image, params.redLow1, params.redHigh1, mascaraRoja);
+
+    // Rango 2: Detectar rojo en el rango de tono [150, 179] (valores por defecto de DetectorParams)
+    inRange(image, params.redLow2, params.redHigh2, mascaraRoja2);
+
+    // Combinar las dos mscaras utilizando la operacin OR
+    mascaraRoja = mascaraRoja | mascaraRoja2;
+
+    // Retornar la mscara combinada
+    return mascaraRoja;
+}
+
+
+/**
+ * @brief Genera una mscara para detectar el color verde en una imagen en espacio HSV.
+ *
+ * Esta funcin utiliza los valores del espacio de color HSV para crear una mscara que detecte
+ * los pxeles correspondientes al color verde. La mscara es generada usando un rango especfico
+ * de valores para el tono (Hue), la saturacin (Saturation) y el valor (Value) en el espacio HSV.
+ *
+ * @param image La imagen en espacio HSV sobre la que se aplicar la mscara.
+ *
+ * @return Mat La mscara generada donde los pxeles correspondientes al color verde son blancos
+ *             (valor 255) y los dems son negros (valor 0).
+ */
+Mat CCodeDetector::getGreenMask(const Mat &image) {
+    CTraceScope trace("greenMask");
+    // Crear la mscara para el color verde en el espacio HSV con un rango ajustado
+    Mat mascaraVerde;
+
+    // Rango del verde en el espacio HSV (por defecto): H [30, 90], S [55, 255], V [55, 255]
+    inRange(image, params.greenLow, params.greenHigh, mascaraVerde);
+
+    // Retornar la mscara generada
+    return mascaraVerde;
+}
+
+
+/**
+ * @brief Aplica una mscara a una imagen.
+ *
+ * Esta funcin toma una imagen y una mscara binaria, y aplica la mscara a la imagen.
+ * Los pxeles de la imagen que corresponden a los valores no nulos de la mscara (generalmente 255)
+ * se mantienen intactos, mientras que los pxeles correspondientes a los valores cero de la mscara
+ * se establecen a cero en la imagen resultante.
+ *
+ * @param image La imagen original sobre la que se aplicar la mscara.
+ * @param mask La mscara binaria que se aplicar sobre la imagen. Los pxeles con valor 255
+ *             en la mscara se conservarn en la imagen final, mientras que los pxeles con valor 0
+ *             se eliminarn (se establecern en 0).
+ *
+ * @return Mat La imagen resultante con la mscara aplicada, donde los pxeles que no estn en la mscara
+ *             sern eliminados (negros) y los que estn en la mscara se mantendrn intactos.
+ */
+Mat CCodeDetector::applyMaskToImage(const Mat &image, Mat mask) {
+    CTraceScope trace("applyMask");
+    // Crear una copia de la imagen original y aplicar la mscara sobre ella.
+    Mat maskedImage;
+    // La funcin copyTo copia los pxeles de la imagen original a 'maskedImage', pero solo donde la mscara tiene valor 255
+    image.copyTo(maskedImage, mask);
+
+    // Retornar la imagen con la mscara aplicada
+    return maskedImage;
+}
+
+
+/**
+ * @brief Aplica el filtro Sobel para detectar bordes en una imagen.
+ *
+ * Esta funcin utiliza el filtro Sobel en las direcciones X e Y para calcular el gradiente de la imagen.
+ * Luego, calcula la magnitud del gradiente para detectar los bordes y aplica una umbralizacin binaria
+ * para obtener una imagen binaria donde los bordes son visibles.
+ *
+ * @param image La imagen de entrada sobre la que se aplicar el filtro Sobel. Debe ser una imagen en escala de grises.
+ * @param kernelSize El tamao del kernel que se utilizar para el filtro Sobel. Un valor tpico es 3 o 5.
+ *
+ * @return Mat La imagen resultante con los bordes detectados, en formato binario.
+ */
+Mat CCodeDetector::sobelFilter(const Mat &image, uint8_t kernelSize) {
+    // Variante en aritmtica entera (CodeDetectorFixed.cpp)
+    if (params.fixedPoint) {
+        return sobelFilterFixed(image, kernelSize);
+    }
+
+    // Declaracin de las imgenes intermedias para los resultados de los filtros Sobel en X y Y
+    Mat img_sobel_x, img_sobel_y, img_sobel, filtered_image;
+
+    // Aplicar el filtro Sobel en la direccin X (detecta bordes en la direccin horizontal)
+    Sobel(image, img_sobel_x, CV_64F, 1, 0, kernelSize);
+
+    // Aplicar el filtro Sobel en la direccin Y (detecta bordes en la direccin vertical)
+    Sobel(image, img_sobel_y, CV_64F, 0, 1, kernelSize);
+
+    // Calcular la magnitud del gradiente a partir de las imgenes resultantes de Sobel en X y Y
+    magnitude(img_sobel_x, img_sobel_y, img_sobel);
+
+    // Normalizar la imagen resultante para que los valores estn en el rango [0, 255]
+    // Esto es necesario para poder trabajar con una imagen de tipo CV_8U (escala de grises en 8 bits)
+    normalize(img_sobel, img_sobel, 0, 255, NORM_MINMAX, CV_8U);
+
+    // Aplicar umbralizacin binaria para resaltar los bordes detectados
+    // Los pxeles con un valor superior al umbral (30 por defecto) sern establecidos a 255 (blanco), el resto ser 0 (negro)
+    threshold(img_sobel, filtered_image, params.sobelThreshold, 255, THRESH_BINARY);
+
+    // Retornar la imagen con los bordes detectados
+    return filtered_image;
+}
+
+
+/**
+ * @brief Encuentra y filtra los contornos detectados en una imagen usando el filtro Sobel.
+ *
+ * Esta funcin aplica el filtro Sobel para detectar los bordes en la imagen, luego encuentra todos los contornos
+ * en la imagen binarizada resultante. Posteriormente, filtra los contornos segn su rea y aspecto (proporcin de
+ * ancho a altura) para asegurarse de que solo se retengan los contornos de inters.
+ *
+ * @param image La imagen de entrada sobre la cual se detectarn los contornos. La imagen debe estar en formato
+ *              de escala de grises (en el caso del filtro Sobel).
+ * @param referenceArea rea respecto a la que se calculan los umbrales de rea. Cuando `image` es una regin
+ *                      de la imagen, el rea de la imagen completa; 0 para usar el rea de `image`.
+ *
+ * @return std::vector<std::vector<Point>> Un vector de vectores de puntos que representan los contornos
+ *         detectados y filtrados. Cada contorno es un vector de puntos (Point) que forman el contorno de un objeto.
+ */
+std::vector<std::vector<Point>> CCodeDetector::findFilteredContours(const Mat &image, double referenceArea) {
+    // Paso 1: Aplicar el filtro Sobel para detectar los bordes (el de la variante especializada, si lo hay)
+    Mat sobelImage = edgeFilter != nullptr ? edgeFilter(*this, image) : sobelFilter(image, params.sobelKernelSize);
+
+    // Paso 2: Encontrar los contornos en la imagen binarizada obtenida del filtro Sobel
+    std::vector<std::vector<Point>> contours;
+    std::vector<Vec4i> hierarchy;
+    findContours(sobelImage, contours, hierarchy, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+
+    // Paso 3: Filtrar los contornos segn su rea y su aspecto (relacin entre ancho y alto)
+    std::vector<std::vector<Point>> filteredContours;
+    for (const auto &contour : contours) {
+        // Calcular el rea del contorno
+        double area = contourArea(contour);
+
+        // Calcular el rectngulo delimitador del contorno
+        Rect boundingBox = boundingRect(contour);
+
+        // Calcular el 1% del rea total de la imagen (para establecer umbrales de rea)
+        double areaImage = referenceArea > 0 ? referenceArea : image.rows * image.cols;
+        double umbralBajoArea = 0.01 * areaImage; // 5% del rea de la imagen
+        double umbralAltoArea = 0.25 * areaImage; // 25% del rea de la imagen
+
+        // Calcular la relacin de aspecto (aspect ratio) del rectngulo delimitador
+        double aspectRatio = static_cast<double>( boundingBox.width ) / boundingBox.height;
+
+        // Filtrar los contornos por rea y relacin de aspecto
+        // El contorno debe tener un rea dentro de un rango especfico y una relacin de aspecto entre 0.5 y 1.3
+        if (area > umbralBajoArea && area < umbralAltoArea && aspectRatio > 0.5 && aspectRatio < 1.3) {
+            filteredContours.push_back(contour);
+        }
+    }
+
+    // Paso 4: Devolver los contornos filtrados
+    return filteredContours;
+}
+
+/**
+ * @brief Extrae informacin relevante de los contornos proporcionados.
+ *
+ * Esta funcin toma un conjunto de contornos detectados y extrae caractersticas geomtricas importantes para
+ * cada uno de ellos, como el rea, el permetro, las esquinas del contorno, el centro, las dimensiones (ancho y alto),
+ * la relacin de aspecto, y el ngulo de orientacin.
+ *
+ * @param contours Un vector de vectores de puntos que representan los contornos de la imagen.
+ *                 Cada contorno es una secuencia cerrada de puntos que forma un objeto detectado.
+ *
+ * @return std::vector<ContourInfo> Un vector de estructuras `ContourInfo` que contienen la informacin
+ *         extrada de cada contorno. Cada estructura contiene los detalles geomtricos de un contorno.
+ */
+std::vector<ContourInfo> CCodeDetector::extractContourInfo(const std::vector<std::vector<Point>> &contours) {
+    // Variante en aritmtica entera (CodeDetectorFixed.cpp)
+    if (params.fixedPoint) {
+        return extractContourInfoFixed(contours);
+    }
+
+    // Paso 1: Declarar el vector que almacenar la informacin de cada contorno
+    std::vector<ContourInfo> contour_info;
+
+    // Paso 2: Iterar sobre cada contorno para extraer su informacin
+    for (const auto &contour : contours) {
+        ContourInfo info;
+
+        // Paso 3: Calcular el rea del contorno
+        info.area = contourArea(contour);
+
+        // Paso 4: Obtener el rectngulo delimitador del contorno (bounding box)
+        Rect boundingBox = boundingRect(contour);
+
+        // Paso 5: Calcular el permetro del contorno (longitud de su frontera)
+        info.perimeter = arcLength(contour, true);
+
+        // Paso 6: Obtener el rectngulo rotado que ajusta el contorno ms estrechamente
+        RotatedRect rect = minAreaRect(contour);
+        Point2f box[4];
+        rect.points(box); // Obtener las coordenadas de los 4 vrtices del rectngulo rotado
+
+        // Paso 7: Almacenar las esquinas del rectngulo en la estructura de informacin del contorno
+        for (int i = 0; i < 4; i++) {
+            info.corners.push_back(Point(static_cast<int>( box[i].x ), static_cast<int>( box[i].y )));
+        }
+
+        // Paso 8: Calcular el centro del contorno como el centro del rectngulo delimitador
+        info.center = Point2f(( boundingBox.x + boundingBox.width ) / 2.0,
+                              ( boundingBox.y + boundingBox.height ) / 2.0);
+
+        // Paso 9: Almacenar el ancho y el alto del rectngulo delimitador
+        info.width = boundingBox.width;
+        info.height = boundingBox.height;
+
+        // Paso 10: Calcular la relacin de aspecto (ancho/alto) del rectngulo y almacenarla
+        info.aspect_ratio = ( boundingBox.height != 0 ) ? boundingBox.width / static_cast<float>( boundingBox.height ) : 0;
+
+        // Paso 11: Almacenar el ngulo de rotacin del rectngulo respecto a la horizontal
+        info.angle = rect.angle;
+
+        // Paso 12: Aadir la informacin del contorno a la lista de resultados
+        contour_info.push_back(info);
+
+        // Paso 13 (opcional): Mostrar la informacin del contorno en el log para depuracin
+        /*qDebug() << "Area: " << info.area
+                 << " Perimetro: " << info.perimeter
+                 << " Centro: " << info.center.x << ", " << info.center.y
+                 << " Ancho: " << info.width
+                 << " Alto: " << info.height
+                 << " Relacion de aspecto: " << info.aspect_ratio
+                 << " Angulo: " << info.angle;*/
+    }
+
+    // Paso 14: Devolver el vector con la informacin de todos los contornos procesados
+    return contour_info;
+}
+
+
+/**
+ * @brief Encuentra los marcadores de una o dos mscaras con una sola pasada de componentes conexas.
+ *
+ * Las mscaras ya son casi binarias, as que no hace falta convertirlas en bordes (Sobel) ni recorrer los
+ * contornos: se binarizan una al lado de la otra en una misma imagen, separadas por una columna vaca para que
+ * ninguna componente pase de una a otra, y `connectedComponentsWithStats` las etiqueta en una sola pasada
+ * (algoritmo por bloques de OpenCV, paralelo si hay varios hilos). Las componentes se filtran con sus
+ * estadsticas, con los mismos umbrales de rea y aspecto que `findFilteredContours` y, adems, la fraccin del
+ * rectngulo envolvente que ocupan (`componentMinFill`). Solo para las que pasan el filtro se calcula el
+ * rectngulo rotado, a partir del primer y el ltimo pxel de cada fila (contienen la envolvente convexa).
+ *
+ * El rea es la de los pxeles de la componente, algo menor que la del contorno del Sobel, que incluye el
+ * ancho del borde; el centro y el resto de campos siguen el criterio de `extractContourInfo`, con el que se
+ * ajustaron las distancias de `matchContours`.
+ *
+ * @param first Gris con la mscara de un color aplicada.
+ * @param second Gris con la mscara del otro color, del mismo tamao (vaca para procesar solo `first`).
+ * @param referenceArea rea respecto a la que se calculan los umbrales de rea (0 = la de `first`).
+ * @param firstInfo Vector al que se aaden los marcadores de `first`.
+ * @param secondInfo Vector al que se aaden los marcadores de `second`.
+ */
+void CCodeDetector::findComponentMarkers(const Mat &first, const Mat &second, double referenceArea,
+                                         std::vector<ContourInfo> &firstInfo, std::vector<ContourInfo> &secondInfo) {
+    CTraceScope trace("findComponentMarkers");
+
+    // Paso 1: Binarizar las mscaras una junto a otra, separadas por una columna vaca
+    const bool both = !second.empty();
+    const int split = both ? first.cols + 1 : first.cols;
+    Mat binary(first.rows, both ? split + second.cols : first.cols, CV_8UC1);
+    Mat firstBinary = binary(Rect(0, 0, first.cols, first.rows));
+    threshold(first, firstBinary, 0, 255, THRESH_BINARY);
+    if (both) {
+        binary.col(first.cols).setTo(Scalar(0));
+        Mat secondBinary = binary(Rect(split, 0, second.cols, second.rows));
+        threshold(second, secondBinary, 0, 255, THRESH_BINARY);
+    }
+
+    // Paso 2: Etiquetar las componentes y calcular su rectngulo envolvente y su rea en la misma pasada
+    Mat labels, stats, centroids;
+    int numLabels = connectedComponentsWithStats(binary, labels, stats, centroids, 8, CV_32S, CCL_DEFAULT);
+
+    // Paso 3: Filtrar las componentes por rea, aspecto y relleno usando solo sus estadsticas
+    const double areaImage = referenceArea > 0 ? referenceArea : first.rows * first.cols;
+    const double umbralBajoArea = 0.01 * areaImage;
+    const double umbralAltoArea = 0.25 * areaImage;
+    std::vector<Point> extremes;
+    for (int label = 1; label < numLabels; ++label) {
+        const int *stat = stats.ptr<int>(label);
+        const int x = stat[CC_STAT_LEFT], y = stat[CC_STAT_TOP];
+        const int width = stat[CC_STAT_WIDTH], height = stat[CC_STAT_HEIGHT];
+        const double area = stat[CC_STAT_AREA];
+        const double aspectRatio = static_cast<double>( width ) / height;
+        const double fill = area / ( static_cast<double>( width ) * height );
+        if (area <= umbralBajoArea || area >= umbralAltoArea || aspectRatio <= 0.5 || aspectRatio >= 1.3 ||
+            fill < params.componentMinFill) {
+            continue;
+        }
+
+        // Paso 4: Primer y ltimo pxel de la componente en cada fila, en coordenadas de su mscara
+        const int offset = x >= split ? split : 0;
+        extremes.clear();
+        for (int row = y; row < y + height; ++row) {
+            const int *labelRow = labels.ptr<int>(row);
+            int left = x, right = x + width - 1;
+            while (left <= right && labelRow[left] != label) ++left;
+            while (right > left && labelRow[right] != label) --right;
+            if (left > right) {
+                continue;
+            }
+            extremes.push_back(Point(left - offset, row));
+            if (right != left) {
+                extremes.push_back(Point(right - offset, row));
+            }
+        }
+
+        // Paso 5: Informacin del marcador con el rectngulo rotado de esos puntos
+        RotatedRect rect = minAreaRect(extremes);
+        Point2f box[4];
+        rect.points(box);
+        ContourInfo info;
+        for (int i = 0; i < 4; i++) {
+            info.corners.push_back(Point(static_cast<int>( box[i].x ), static_cast<int>( box[i].y )));
+        }
+        info.area = static_cast<float>( area );
+        info.perimeter = 2 * ( rect.size.width + rect.size.height );
+        info.center = Point2f(( x - offset + width ) / 2.0f, ( y + height ) / 2.0f);
+        info.width = static_cast<float>( width );
+        info.height = static_cast<float>( height );
+        info.aspect_ratio = static_cast<float>( aspectRatio );
+        info.angle = rect.angle;
+        ( offset > 0 ? secondInfo : firstInfo ).push_back(info);
+    }
+}
+
+
+/**
+ * @brief Empareja contornos rojos con contornos verdes basndose en criterios geomtricos y de similitud.
+ *
+ * Esta funcin toma dos conjuntos de contornos detectados (uno rojo y otro verde) y los empareja en pares
+ * basndose en criterios como la proximidad entre sus centros, la diferencia en su orientacin (ngulo),
+ * y similitudes en el rea y el permetro. Solo se emparejan los contornos que cumplen con estos criterios.
+ *
+ * @param redContoursInfo Un vector de estructuras `ContourInfo` que contienen la informacin geomtrica
+ *                        de los contornos detectados en la mscara roja.
+ * @param greenContoursInfo Un vector de estructuras `ContourInfo` que contienen la informacin geomtrica
+ *                          de los contornos detectados en la mscara verde.
+ *
+ * @return std::vector<std::pair<ContourInfo, ContourInfo>> Un vector de pares de contornos emparejados.
+ *         Cada par contiene un contorno rojo y un contorno verde que se consideran coincidentes.
+ */
+std::vector<std::pair<ContourInfo, ContourInfo>> CCodeDetector::matchContours(
+    const std::vector<ContourInfo> &redContoursInfo,
+    const std::vector<ContourInfo> &greenContoursInfo) {
+    CTraceScope trace("matchContours");
+
+    // Variante en aritmtica entera (CodeDetectorFixed.cpp)
+    if (params.fixedPoint) {
+        return matchContoursFixed(redContoursInfo, greenContoursInfo);
+    }
+
+    // Paso 1: Declarar el vector que almacenar los pares de contornos emparejados
+    std::vector<std::pair<ContourInfo, ContourInfo>> matches;
+
+    // Paso 2: Crear conjuntos para llevar un seguimiento de los contornos ya emparejados
+    std::set<const ContourInfo *> usedRedContours;
+    std::set<const ContourInfo *> usedGreenContours;
+
+    // Paso 3: Iterar sobre cada contorno rojo
+    for (const auto &redContour : redContoursInfo) {
+        // Verificar si este contorno rojo ya est emparejado
+        if (usedRedContours.find(&redContour) != usedRedContours.end()) {
+            continue; // Saltar este contorno si ya est emparejado
+        }
+
+        // Paso 4: Inicializar variables para encontrar el mejor match para el contorno rojo actual
+        const ContourInfo *bestMatch = nullptr;               // Apuntador al mejor contorno verde encontrado
+        double bestAngleMatch = std::numeric_limits<double>::infinity(); // Mejor diferencia de ngulo
+        double bestScore = std::numeric_limits<double>::infinity();      // Mejor puntaje para desempatar
+
+        // Paso 5: Iterar sobre cada contorno verde
+        for (const auto &greenContour : greenContoursInfo) {
+            // Verificar si este contorno verde ya est emparejado
+            if (usedGreenContours.find(&greenContour) != usedGreenContours.end()) {
+                continue; // Saltar este contorno si ya est emparejado
+            }
+
+            // Paso 6: Calcular la distancia entre los centros de los contornos
+            double centerDistance = cv::norm(redContour.center - greenContour.center);
+
+            // Paso 7: Descartar contornos que estn demasiado lejos (ms de 3.5 veces el ancho del contorno rojo)
+            if (centerDistance >  redContour.perimeter / 2.5) {
+                continue; // Saltar este contorno verde por estar demasiado lejos
+            }
+
+            //// Paso 8: Descartar contornos que estn demasiado cerca (ms de 2.5 veces el ancho del contorno rojo)
+            if (centerDistance < redContour.perimeter / 3.5) {
+                continue; // Saltar este contorno verde por estar demasiado cerca
+            }
+
+            // Paso 9: Calcular la diferencia de ngulo entre los contornos
+            double angleDiff = std::abs(redContour.angle - greenContour.angle);
+
+            // Paso 10: Calcular diferencias en rea y permetro para usar como criterios de desempate
+            double areaDiff = std::abs(redContour.area - greenContour.area);
+            double perimeterDiff = std::abs(redContour.perimeter - greenContour.perimeter);
+
+            // Paso 11: Calcular un puntaje de desempate basado en las diferencias de rea y permetro
+            double score = areaDiff + perimeterDiff;
+
+            // Paso 12: Actualizar el mejor match si el ngulo es menor, o si el puntaje es menor en caso de empate
+            if (angleDiff < bestAngleMatch || ( angleDiff == bestAngleMatch && score < bestScore )) {
+                bestAngleMatch = angleDiff;
+                bestScore = score;
+                bestMatch = &greenContour; // Actualizar el mejor contorno verde encontrado
+            }
+        }
+
+        // Paso 13: Si se encontr un match vlido para el contorno rojo actual
+        if (bestMatch) {
+            // Aadir el par de contornos emparejados al vector de resultados
+            matches.emplace_back(redContour, *bestMatch);
+
+            // Marcar ambos contornos como emparejados
+            usedRedContours.insert(&redContour);
+            usedGreenContours.insert(bestMatch);
+        }
+    }
+
+    // Paso 14: Informacin de depuracin para verificar el nmero de contornos emparejados
+    /*qDebug() << "Numero de contornos emparejados: " << matches.size();*/
+
+    // Paso 15: Devolver el vector de pares de contornos emparejados
+    return matches;
+}
+
+
+/**
+ * @brief Extrae regiones de la imagen delimitadas por los contornos emparejados, alineando cada regin para que la lnea entre los contornos sea horizontal.
+ *
+ * Esta funcin toma un conjunto de contornos emparejados (rojo y verde) y recorta la regin de la imagen original
+ * que contiene ambos contornos. Adems, rota la imagen para alinear los contornos horizontalmente y recorta la regin resultante.
+ *
+ * @param matchedContours Un vector de pares de contornos emparejados (rojo y verde). Cada par contiene la informacin
+ *                        geomtrica de dos contornos que se han identificado como relacionados.
+ * @param image La imagen original de la cual se extraern las regiones delimitadas por los contornos.
+ *
+ * @return std::vector<Mat> Un recorte por cada par de contornos emparejados, en el mismo orden. Si el recorte
+ *         enderezado se sale de la imagen, su posicin queda vaca (y se cuenta en `outOfBoundsCrops`), de modo que
+ *         los cdigos siguen correspondiendo a su pareja.
+ */
+std::vector<Mat> CCodeDetector::cutBoundingBox(const std::vector<pair<ContourInfo, ContourInfo>> &matchedContours, const Mat &image) {
+    CTraceScope trace("cutBoundingBox");
+    // Variante en aritmtica entera (CodeDetectorFixed.cpp)
+    if (params.fixedPoint) {
+        return cutBoundingBoxFixed(matchedContours, image);
+    }
+
+    // Paso 1: Inicializar un vector con un recorte (vaco hasta que se extraiga) por pareja
+    std::vector<Mat> extractedImages(matchedContours.size());
+
+    // Paso 2: Iterar sobre cada par de contornos emparejados
+    for (size_t i = 0; i < matchedContours.size(); ++i) {
+        const auto &match = matchedContours[i];
+        const ContourInfo &redContour = match.first;
+        const ContourInfo &greenContour = match.second;
+
+        // Paso 3: Obtener los puntos de los contornos rojo y verde
+        std::vector<Point> redPoints = redContour.corners;
+        std::vector<Point> greenPoints = greenContour.corners;
+
+        // Paso 4: Combinar los puntos de ambos contornos en un solo vector
+        std::vector<Point> allPoints;
+        allPoints.insert(allPoints.end(), redPoints.begin(), redPoints.end());
+        allPoints.insert(allPoints.end(), greenPoints.begin(), greenPoints.end());
+
+        // Paso 5: Calcular el rectngulo delimitador (bounding box) que contenga todos los puntos
+        Rect boundingBox = boundingRect(allPoints);
+
+        // Paso 6: Calcular el centro del rectngulo delimitador
+        Point boundingBoxCenter = Point(boundingBox.x + boundingBox.width / 2, boundingBox.y + boundingBox.height / 2);
+
+        // Paso 7: Calcular el ngulo entre los centros de los contornos rojo y verde
+        double x0 = redContour.center.x;
+        double y0 = redContour.center.y;
+        double x1 = greenContour.center.x;
+        double y1 = greenContour.center.y;
+        double angle = atan2(y1 - y0, x1 - x0) * 180 / CV_PI;
+
+        // Paso 8: Rotar la imagen para que la lnea entre los contornos sea horizontal
+        Mat M = getRotationMatrix2D(boundingBoxCenter, angle, 1);
+        Mat rotatedImage;
+        warpAffine(image, rotatedImage, M, image.size());
+
+        // Paso 9: Rotar los puntos de los contornos usando la matriz de transformacin
+        std::vector<Point> transformedPoints;
+        for (const Point &pt : allPoints) {
+            double xNew = M.at<double>(0, 0) * pt.x + M.at<double>(0, 1) * pt.y + M.at<double>(0, 2);
+            double yNew = M.at<double>(1, 0) * pt.x + M.at<double>(1, 1) * pt.y + M.at<double>(1, 2);
+            transformedPoints.emplace_back(cvRound(xNew), cvRound(yNew));
+        }
+
+        // Paso 10: Calcular la nueva bounding box despus de la rotacin
+        Rect transformedBoundingBox = boundingRect(transformedPoints);
+
+        // Paso 11: Verificar si la bounding box transformada est dentro de los lmites de la imagen
+        if (transformedBoundingBox.x >= 0 && transformedBoundingBox.y >= 0 &&
+            transformedBoundingBox.x + transformedBoundingBox.width <= rotatedImage.cols &&
+            transformedBoundingBox.y + transformedBoundingBox.height <= rotatedImage.rows) {
+            // Paso 12: Recortar la regin de la imagen rotada
+            extractedImages[i] = rotatedImage(transformedBoundingBox);
+        }
+        else if (stageMetrics.outOfBoundsCrops) {
+            stageMetrics.outOfBoundsCrops->inc();
+        }
+    }
+
+    // Paso 13: Devolver el vector de imgenes recortadas
+    return extractedImages;
+}
+
+
+/**
+ * @brief Aplica un umbral adaptativo a la imagen y realiza operaciones morfolgicas para suavizar los bordes.
+ *
+ * Esta funcin convierte una imagen en escala de grises en una binaria utilizando un umbral adaptativo basado en
+ * el mtodo de medias ponderadas (GAUSSIAN). Posteriormente, aplica operaciones morfolgicas como cierre y erosin
+ * para eliminar imperfecciones en los bordes y suavizar el resultado.
+ *
+ * @param image La imagen en escala de grises sobre la que se aplicar el umbral adaptativo y las operaciones morfolgicas.
+ *              Se espera que esta imagen sea de tipo `CV_8UC1` (1 canal, escala de grises).
+ * @param threshold Un valor de ajuste para el clculo del umbral adaptativo. Este parmetro influye en la segmentacin
+ *                  de la imagen, permitiendo afinar los detalles capturados en la binarizacin.
+ *
+ * @return Mat La imagen resultante despus de aplicar el umbral adaptativo y las operaciones de cierre y erosin.
+ *             Es una imagen binaria donde los pxeles son 0 (negro) o 255 (blanco).
+ */
+Mat CCodeDetector::thresholdImage(const Mat &image, int threshold) {
+    // Paso 1: Aplicar umbral adaptativo con el mtodo GAUSSIAN
+    Mat imageThresholdGaussian;
+    adaptiveThreshold(image, imageThresholdGaussian, 255, ADAPTIVE_THRESH_GAUSSIAN_C, THRESH_BINARY, params.thresholdBlockSize, threshold);
+
+    // Paso 2: Crear un kernel para las operaciones morfolgicas
+    Mat kernel = Mat::ones(Size(3, 3), CV_8U);
+
+    // Paso 3: Aplicar la operacin morfolgica de cierre para unir regiones desconectadas
+    Mat closeImage;
+    morphologyEx(imageThresholdGaussian, closeImage, MORPH_CLOSE, kernel);
+
+    // Paso 4: Aplicar erosin para suavizar los bordes y reducir pequeas imperfecciones
+    Mat erodeImage;
+    erode(closeImage, erodeImage, kernel, Point(-1, -1), 1);
+
+    // Paso 5: Devolver la imagen binaria resultante
+    return erodeImage;
+}
+
+
+/**
+ * @brief Clasifica los contornos en cuadrados y rectngulos segn su relacin de aspecto y rea relativa.
+ *
+ * Esta funcin analiza un conjunto de contornos detectados y los clasifica en dos categoras:
+ * contornos cuadrados y contornos rectangulares. La clasificacin se basa en la relacin de aspecto (ancho/alto)
+ * y el rea relativa del contorno respecto al tamao de la imagen.
+ *
+ * @param contours Un vector de vectores de puntos que representan los contornos detectados.
+ *                 Cada contorno es una secuencia cerrada de puntos que forma una figura.
+ * @param imageShape Un objeto `Size` que especifica las dimensiones de la imagen original
+ *                   (ancho y alto) sobre la que se detectaron los contornos.
+ *
+ * @return pair<std::vector<std::vector<Point>>, std::vector<std::vector<Point>>>
+ *         Un par de vectores:
+ *         - El primer elemento contiene los contornos clasificados como cuadrados.
+ *         - El segundo elemento contiene los contornos clasificados como rectngulos.
+ */
+pair<std::vector<std::vector<Point>>, std::vector<std::vector<Point>>>
+CCodeDetector::classifyContours(const std::vector<std::vector<Point>> &contours, const Size &imageShape) {
+    // Paso 1: Declarar vectores para almacenar contornos cuadrados y rectangulares
+    std::vector<std::vector<Point>> squareContours;
+    std::vector<std::vector<Point>> rectangularContours;
+
+    // Paso 2: Iterar sobre los contornos para clasificarlos
+    for (const auto &contour : contours) {
+        // Calcular el rea del contorno
+        double area = contourArea(contour);
+
+        // Calcular la proporcin del rea del contorno con respecto al rea de la imagen
+        double areaRatio = area / ( imageShape.width * imageShape.height );
+
+        // Obtener el rectngulo delimitador del contorno
+        Rect boundingBox = boundingRect(contour);
+
+        // Calcular la relacin de aspecto (ancho/alto) del rectngulo delimitador
+        double aspectRatio = static_cast<double>( boundingBox.width ) / boundingBox.height;
+
+        // Paso 3: Clasificar el contorno segn la relacin de aspecto y el rea relativa
+        if (0.5 <= aspectRatio && aspectRatio <= 1.5 && areaRatio > 0.06) {
+            // Contornos con relacin de aspecto cercana a 1 y rea significativa: cuadrados
+            squareContours.push_back(contour);
+        }
+        else {
+            // Contornos restantes: rectngulos
+            rectangularContours.push_back(contour);
+        }
+    }
+
+    // Paso 4: Devolver los contornos clasificados como un par
+    return { squareContours, rectangularContours };
+}
+
+
+
+/**
+ * @brief Filtra contornos que estn completamente dentro de otros contornos ms grandes.
+ *
+ * Esta funcin elimina los contornos que estn completamente contenidos dentro de otros
+ * contornos ms grandes. Esto es til para evitar considerar contornos secundarios
+ * o ruidos dentro de reas cerradas que ya estn representadas por un contorno ms grande.
+ *
+ * @param contours Un vector de vectores de puntos que representan los contornos detectados.
+ *                 Cada contorno es una secuencia cerrada de puntos que forma una figura.
+ *
+ * @return std::vector<std::vector<Point>>
+ *         Un vector de contornos filtrados donde se han eliminado los contornos que estn
+ *         completamente contenidos dentro de otros.
+ */
+std::vector<std::vector<Point>>
+CCodeDetector::filterInsideContours(const std::vector<std::vector<Point>> &contours) {
+    // Paso 1: Declarar un vector para almacenar los contornos filtrados
+    std::vector<std::vector<Point>> filteredContours;
+
+    // Paso 2: Iterar sobre cada contorno en la lista original
+    for (size_t i = 0; i < contours.size(); ++i) {
+        const std::vector<Point> &contour = contours[i]; // Contorno actual
+        const std::vector<Point> *parentContour = nullptr; // Contorno padre potencial
+
+        // Paso 3: Comprobar si el contorno actual est dentro de otro contorno
+        for (size_t j = 0; j < contours.size(); ++j) {
+            if (i == j)
+                continue; // Saltar la comparacin del contorno consigo mismo
+
+            const std::vector<Point> &otherContour = contours[j];
+            bool isInside = true;
+
+            // Paso 4: Verificar si todos los puntos del contorno actual estn dentro del otro contorno
+            for (const Point &pt : contour) {
+                if (pointPolygonTest(otherContour, pt, false) <= 0) {
+                    // Si algn punto no est dentro, no es un contorno interno
+                    isInside = false;
+                    break;
+                }
+            }
+
+            // Paso 5: Actualizar el contorno padre si el contorno actual est contenido
+            if (isInside) {
+                if (parentContour == nullptr ||
+                    contourArea(otherContour) > contourArea(*parentContour)) {
+                    parentContour = &otherContour; // Actualizar al contorno ms grande
+                }
+            }
+        }
+
+        // Paso 6: Si no hay contorno padre, agregar el contorno actual a los resultados
+        if (parentContour == nullptr) {
+            filteredContours.push_back(contour);
+        }
+    }
+
+    // Paso 7: Devolver el vector de contornos filtrados
+    return filteredContours;
+}
+
+
+/**
+ * @brief Obtiene y filtra los contornos de una imagen binarizada.
+ *
+ * Esta funcin detecta contornos en una imagen umbralizada y aplica varios criterios de filtrado,
+ * como el rea, la influencia relativa al tamao de la imagen, y la posicin dentro de los lmites
+ * de la imagen. Tambin clasifica los contornos detectados en cuadrados y rectngulos, y elimina
+ * aquellos que estn completamente contenidos dentro de otros ms grandes.
+ *
+ * @param thresholdedImage Imagen binarizada en la que se buscarn los contornos.
+ * @param image Imagen original utilizada para calcular el rea relativa y validar los lmites.
+ *
+ * @return std::vector<std::vector<Point>>
+ *         Un vector de contornos filtrados que cumplen con los criterios de tamao, forma, y posicin.
+ */
+std::vector<std::vector<Point>>
+CCodeDetector::getContours(const Mat &thresholdedImage, const Mat &image) {
+    // Paso 1: Declarar los vectores para almacenar los contornos y la jerarqua
+    std::vector<std::vector<Point>> contours;
+    std::vector<Vec4i> hierarchy;
+
+    // Paso 2: Detectar los contornos en la imagen umbralizada
+    findContours(thresholdedImage, contours, hierarchy, RETR_TREE, CHAIN_APPROX_SIMPLE);
+
+    // Paso 3: Declarar un vector para almacenar los contornos que pasen los filtros iniciales
+    std::vector<std::vector<Point>> filteredContours;
+
+    // Paso 4: Calcular el rea de la imagen y establecer el umbral mnimo de influencia
+    double imageArea = image.rows * image.cols;
+    double minInfluence = 0.01;
+
+    // Paso 5: Filtrar contornos segn el rea, la influencia, y su proximidad al borde
+    for (const auto &contour : contours) {
+        double area = contourArea(contour); // Calcular el rea del contorno
+        Rect boundingBox = boundingRect(contour); // Obtener la bounding box del contorno
+        double influence = area / imageArea; // Calcular la influencia relativa del contorno
+
+        // Aplicar criterios de filtrado
+        if (area >= 200 && area <= 25000 && influence >= minInfluence) {
+            // Ignorar contornos cercanos al borde
+            if (boundingBox.x > 10 && boundingBox.y > 10 &&
+                boundingBox.x + boundingBox.width < image.cols - 10 &&
+                boundingBox.y + boundingBox.height < image.rows - 10) {
+                filteredContours.push_back(contour); // Agregar el contorno filtrado
+            }
+        }
+    }
+
+    // Paso 6: Clasificar los contornos filtrados en cuadrados y rectngulos
+    auto [squareContours, rectangularContours] = classifyContours(filteredContours, image.size());
+
+    // Paso 7: Filtrar contornos que estn completamente contenidos dentro de otros
+    filteredContours = filterInsideContours(rectangularContours);
+
+    // Paso 8: Devolver el conjunto final de contornos filtrados
+    return filteredContours;
+}
+
+
+/**
+ * @brief Separa los contornos en segmentos horizontales segn su posicin en la imagen.
+ *
+ * Esta funcin divide los contornos en cuatro segmentos horizontales, basndose en la posicin
+ * del centro del contorno dentro de la anchura de la imagen. Cada segmento representa una
+ * divisin igual del ancho total de la imagen.
+ *
+ * @param contours Un vector de contornos representados como vectores de puntos.
+ *                 Cada contorno es una secuencia de puntos que define un objeto detectado.
+ * @param imageWidth La anchura de la imagen, utilizada para calcular los lmites de cada segmento.
+ *
+ * @return std::vector<std::vector<std::vector<Point>>>
+ *         Un vector que contiene cuatro vectores, donde cada uno corresponde a un segmento
+ *         horizontal de la imagen y almacena los contornos pertenecientes a dicho segmento.
+ */
+std::vector<std::vector<std::vector<Point>>>
+CCodeDetector::separateContoursBySegments(const std::vector<std::vector<Point>> &contours, int imageWidth) {
+    // Paso 1: Crear un vector de 4 segmentos para almacenar los contornos
+    std::vector<std::vector<std::vector<Point>>> segments(4);
+
+    // Paso 2: Iterar sobre cada contorno para clasificarlo en un segmento
+    for (const auto &contour : contours) {
+        // Paso 3: Calcular la bounding box del contorno
+        Rect boundingBox = boundingRect(contour);
+
+        // Paso 4: Calcular la posicin del centro en el eje X
+        int centerX = boundingBox.x + boundingBox.width / 2;
+
+        // Paso 5: Determinar a qu segmento pertenece el contorno
+        int segment = centerX / ( imageWidth / 4 );
+
+        // Paso 6: Asegurarse de que el segmento sea vlido y agregar el contorno
+        if (segment >= 0 && segment < 4) {
+            segments[segment].push_back(contour);
+        }
+    }
+
+    // Paso 7: Devolver los contornos clasificados por segmentos
+    return segments;
+}
+
+/**
+ * @brief Ordena los contornos dentro de cada segmento horizontal.
+ *
+ * Esta funcin organiza los contornos dentro de cada segmento en funcin de su orientacin y
+ * la posicin de su rectngulo delimitador (bounding box). Si hay dos contornos en un segmento,
+ * la funcin los ordena segn la coordenada X o Y dependiendo de si los contornos son ms anchos
+ * o ms altos. Si hay un solo contorno en el segmento, no se realiza ningn orden.
+ *
+ * @param segments Un vector de vectores de contornos, donde cada subvector representa un segmento
+ *                 horizontal en la imagen. Cada contorno es un vector de puntos que define un objeto detectado.
+ *
+ * @return std::vector<std::vector<std::vector<Point>>> Un vector que contiene los segmentos ordenados,
+ *         cada uno con los contornos ordenados por su coordenada X o Y, dependiendo de su forma.
+ */
+std::vector<std::vector<std::vector<Point>>> CCodeDetector::orderContours(
+    const std::vector<std::vector<std::vector<Point>>> &segments) {
+
+    // Paso 1: Crear el vector que almacenar los segmentos ordenados
+    std::vector<std::vector<std::vector<Point>>> orderedSegments;
+
+    // Paso 2: Iterar sobre cada segmento para ordenarlo si es necesario
+    for (const auto &segment : segments) {
+        if (segment.size() <= 1) {
+            // Si el segmento tiene 0 o 1 contorno, no se realiza ordenacin
+            orderedSegments.push_back(segment);
+        }
+        else if (segment.size() == 2) {
+            // Si el segmento tiene exactamente 2 contornos
+            Rect boundingBox1 = boundingRect(segment[0]);
+            Rect boundingBox2 = boundingRect(segment[1]);
+
+            // Determinar si los contornos son ms anchos (wide) que altos (no wide)
+            bool isWide1 = boundingBox1.width > boundingBox1.height;
+            bool isWide2 = boundingBox2.width > boundingBox2.height;
+
+            // Copiar el segmento para ordenarlo
+            std::vector<std::vector<Point>> sortedSegment = segment;
+
+            if (isWide1 && isWide2) {
+                // Si ambos contornos son anchos, ordenar por la coordenada Y de su rectngulo delimitador
+                sort(sortedSegment.begin(), sortedSegment.end(),
+                     [](const std::vector<Point> &a, const std::vector<Point> &b) {
+                    return boundingRect(a).y < boundingRect(b).y;
+                });
+            }
+            else if (!isWide1 && !isWide2) {
+                // Si ambos contornos no son anchos, ordenar por la coordenada X de su rectngulo delimitador
+                sort(sortedSegment.begin(), sortedSegment.end(),
+                     [](const std::vector<Point> &a, const std::vector<Point> &b) {
+                    return boundingRect(a).x < boundingRect(b).x;
+                });
+            }
+
+            // Aadir el segmento ordenado a la lista
+            orderedSegments.push_back(sortedSegment);
+        }
+    }
+
+    // Paso 3: Devolver los segmentos ordenados
+    return orderedSegments;
+}
+
+
+/**
+ * @brief Calcula la relacin entre el rea de cada contorno y el rea de una cuarta parte de la imagen.
+ *
+ * Esta funcin toma los contornos detectados en una imagen y calcula la relacin entre el rea de cada contorno
+ * y el rea de una cuarta parte de la imagen. Esta relacin es til para determinar qu tan grande es un contorno
+ * con respecto al tamao total de la imagen, lo que puede ayudar a filtrar contornos pequeos o grandes segn se desee.
+ *
+ * @param contours Un vector de vectores de puntos que representan los contornos detectados en la imagen.
+ *                 Cada contorno es una secuencia cerrada de puntos que forma un objeto detectado.
+ * @param image La imagen en la que se detectaron los contornos. Se usa para calcular el rea total de la imagen.
+ *
+ * @return std::vector<double> Un vector que contiene la relacin del rea de cada contorno con respecto
+ *         al rea de una cuarta parte de la imagen. El valor de cada elemento es un nmero decimal que
+ *         representa esta relacin.
+ */
+std::vector<double> CCodeDetector::getAreaRatio(const std::vector<std::vector<Point>> &contours, const Mat &image) {
+    // Paso 1: Calcular el rea total de la imagen dividida por 4
+    double imageArea = ( image.rows * image.cols ) / 4.0;
+
+    // Paso 2: Crear el vector para almacenar las relaciones de rea
+    std::vector<double> areaRatios;
+
+    // Paso 3: Iterar sobre cada contorno para calcular su relacin de rea
+    for (const auto &contour : contours) {
+        // Calcular el rea del contorno
+        double area = contourArea(contour);
+
+        // Calcular la relacin entre el rea del contorno y el rea de la imagen
+        double areaRatio = area / imageArea;
+
+        // Almacenar la relacin de rea calculada en el vector
+        areaRatios.push_back(areaRatio);
+    }
+
+    // Paso 4: Devolver el vector con las relaciones de rea
+    return areaRatios;
+}
+
+/**
+ * @brief Obtiene informacin detallada sobre los segmentos de contornos, incluyendo el nmero de contornos,
+ *        sus orientaciones, relaciones de rea y otras mtricas relevantes.
+ *
+ * Esta funcin toma los segmentos de contornos previamente ordenados y calcula varios detalles sobre cada segmento.
+ * Entre las mtricas calculadas estn el nmero de contornos por segmento, la orientacin (horizontal o vertical)
+ * de cada contorno, la relacin del rea de cada contorno respecto al rea de una cuarta parte de la imagen,
+ * y la relacin entre reas de los contornos si un segmento tiene exactamente dos contornos.
+ *
+ * @param orderedSegments Un vector de segmentos, donde cada segmento es un conjunto de contornos detectados
+ *                        que estn organizados en 4 grupos en funcin de su posicin en la imagen.
+ * @param image La imagen original, que se utiliza para calcular la relacin de reas de los contornos.
+ *
+ * @return std::vector<SegmentInfo> Un vector de estructuras `SegmentInfo` donde cada estructura contiene
+ *         la informacin detallada sobre un segmento de contornos. Cada estructura incluye:
+ *         - El nmero de contornos en el segmento.
+ *         - La orientacin de cada contorno (horizontal o vertical).
+ *         - Las relaciones de rea de los contornos.
+ *         - La relacin entre reas si hay exactamente 2 contornos en el segmento.
+ */
+std::vector<SegmentInfo> CCodeDetector::getSegmentInfo(const std::vector<std::vector<std::vector<Point>>> &orderedSegments, const Mat &image) {
+    // Paso 1: Crear un vector para almacenar la informacin de los segmentos
+    std::vector<SegmentInfo> segmentInfoList;
+
+    // Paso 2: Iterar sobre cada segmento
+    for (const auto &segment : orderedSegments) {
+        SegmentInfo info;
+        info.numContours = segment.size(); // Paso 2.1: Establecer el nmero de contornos en el segmento
+
+        // Paso 3: Calcular las orientaciones de los contornos en el segmento
+        for (const auto &contour : segment) {
+            Rect boundingBox = boundingRect(contour); // Paso 3.1: Obtener el rectngulo delimitador del contorno
+            string orientation = ( boundingBox.width > boundingBox.height ) ? "horizontal" : "vertical"; // Paso 3.2: Determinar la orientacin
+            info.orientations.push_back(orientation); // Paso 3.3: Almacenar la orientacin
+        }
+
+        // Paso 4: Calcular las relaciones de rea de los contornos
+        info.areaRatios = getAreaRatio(segment, image); // Paso 4.1: Llamar a `getAreaRatio` para obtener las relaciones de rea
+
+        // Paso 5: Calcular la relacin de reas si hay exactamente 2 contornos
+        if (info.numContours == 2) {
+            double area1 = contourArea(segment[0]); // Paso 5.1: Calcular el rea del primer contorno
+            double area2 = contourArea(segment[1]); // Paso 5.2: Calcular el rea del segundo contorno
+            info.areaRatioRelation = ( area1 / area2 ); // Paso 5.3: Calcular la relacin entre las reas
+        }
+        else {
+            info.areaRatioRelation = -1; // Paso 5.4: Usar -1 para indicar que no es aplicable si no hay exactamente 2 contornos
+        }
+
+        // Paso 6: Aadir la informacin del segmento a la lista
+        segmentInfoList.push_back(info);
+    }
+
+    // Paso 7: Devolver el vector con la informacin de todos los segmentos
+    return segmentInfoList;
+}
+
+
+/**
+ * @brief Decodifica el nmero representado por los segmentos de contornos en la imagen.
+ *
+ * Esta funcin interpreta la informacin de cada segmento de contornos (nmero de contornos, orientaciones,
+ * relacin de reas) para decodificar un nmero en formato de cadena de 4 dgitos. La decodificacin se basa en una lgica
+ * definida por las caractersticas de los contornos (por ejemplo, nmero de contornos, orientacin, y relacin de reas).
+ *
+ * @param segmentInfo Un vector de objetos `SegmentInfo` que contienen informacin sobre los segmentos,
+ *                    tales como el nmero de contornos, sus orientaciones, relaciones de rea, etc.
+ *
+ * @return std::string Un nmero decodificado representado como una cadena de caracteres. Si la decodificacin no es
+ *                     posible en un segmento, se usa el carcter 'X'. Si no hay suficiente informacin, tambin se devuelve 'X'.
+ */
+std::string CCodeDetector::decodeNumber(const std::vector<SegmentInfo> &segmentInfo) {
+    std::string segmentNumber;
+
+    // Paso 1: Iterar sobre los 4 segmentos
+    for (int i = 0; i < 4; ++i) {
+        // Paso 2: Validar si el segmento tiene informacin
+        if (i >= segmentInfo.size()) {
+            segmentNumber += 'X';  // Si no hay informacin en el segmento, se asigna 'X'
+            continue;
+        }
+
+        const SegmentInfo &info = segmentInfo[i];
+        size_t numContours = info.numContours;  // Paso 3: Nmero de contornos en el segmento
+        const std::vector<std::string> &orientations = info.orientations;  // Paso 4: Orientaciones de los contornos
+        const std::vector<double> &areaRatios = info.areaRatios;  // Paso 5: Relaciones de rea de los contornos
+        double areaRatioRelation = info.areaRatioRelation;  // Paso 6: Relacin entre las reas si hay exactamente 2 contornos
+
+        // Paso 7: Decodificar el nmero basado en el nmero de contornos
+        if (numContours == 0) {
+            segmentNumber += '0';  // Si no hay contornos, se asigna el dgito '0'
+        }
+        else if (numContours == 1) {
+            // Paso 8: Si hay un solo contorno
+            if (orientations[0] == "horizontal") {
+                segmentNumber += '8';  // Si es horizontal, asigna el dgito '8'
+            }
+            else {
+                if (areaRatios[0] < 0.15) {
+                    segmentNumber += '1';  // Si el rea es pequea, asigna el dgito '1'
+                }
+                else {
+                    segmentNumber += '5';  // Si el rea es mayor, asigna el dgito '5'
+                }
+            }
+        }
+        else if (numContours == 2) {
+            // Paso 9: Si hay dos contornos
+            if (orientations[0] == "horizontal") {
+                if (areaRatioRelation > 1.2) {
+                    segmentNumber += '7';  // Si la relacin de reas es grande, asigna el dgito '7'
+                }
+                else if (areaRatioRelation < 0.8) {
+                    segmentNumber += '9';  // Si la relacin de reas es pequea, asigna el dgito '9'
+                }
+                else {
+                    segmentNumber += '3';  // Si la relacin de reas est en el medio, asigna el dgito '3'
+                }
+            }
+            else {
+                if (areaRatioRelation > 1.2) {
+                    segmentNumber += '6';  // Si la relacin de reas es grande, asigna el dgito '6'
+                }
+                else if (areaRatioRelation < 0.8) {
+                    segmentNumber += '4';  // Si la relacin de reas es pequea, asigna el dgito '4'
+                }
+                else {
+                    segmentNumber += '2';  // Si la relacin de reas est en el medio, asigna el dgito '2'
+                }
+            }
+        }
+        else {
+            segmentNumber += 'X';  // Si no hay un nmero de contornos esperado, asigna 'X'
+        }
+    }
+
+    // Paso 10: Retornar el nmero decodificado como cadena
+    return segmentNumber;
+}
+
+
+/**
+ * @brief Calcula la confianza de cada dgito decodificado por `decodeNumber`.
+ *
+ * La confianza refleja la distancia de la caracterstica usada para decidir el dgito (relacin de reas
+ * o rea relativa) al umbral de decisin ms cercano de `decodeNumber`: 0.5 justo en el umbral y 1 cuando
+ * el valor est claramente dentro de su intervalo. Los dgitos que no dependen de ningn umbral ('0', '8')
+ * tienen confianza 1 y los no reconocidos ('X'), confianza 0.
+ *
+ * @param segmentInfo Un vector de objetos `SegmentInfo` con la informacin de los 4 segmentos.
+ *
+ * @return std::vector<double> La confianza de cada uno de los 4 dgitos, en el mismo orden que el cdigo.
+ */
+std::vector<double> CCodeDetector::getDigitConfidences(const std::vector<SegmentInfo> &segmentInfo) {
+    std::vector<double> confidences;
+
+    // Paso 1: Funcin auxiliar que convierte una distancia al umbral en una confianza en [0.5, 1]
+    auto margin = [](double distance, double scale) {
+        return std::min(1.0, 0.5 + 0.5 * std::max(0.0, distance) / scale);
+    };
+
+    // Paso 2: Iterar sobre los 4 segmentos siguiendo la misma lgica que `decodeNumber`
+    for (size_t i = 0; i < 4; ++i) {
+        if (i >= segmentInfo.size()) {
+            confidences.push_back(0.0);
+            continue;
+        }
+
+        const SegmentInfo &info = segmentInfo[i];
+        if (info.numContours == 0) {
+            confidences.push_back(1.0);
+        }
+        else if (info.numContours == 1) {
+            if (info.orientations[0] == "horizontal") {
+                confidences.push_back(1.0);
+            }
+            else {
+                // Dgitos '1' y '5': umbral de rea relativa en 0.15
+                confidences.push_back(margin(std::abs(info.areaRatios[0] - 0.15), 0.15));
+            }
+        }
+        else if (info.numContours == 2) {
+            // Dgitos con dos barras: umbrales de relacin de reas en 0.8 y 1.2
+            double r = info.areaRatioRelation;
+            if (r > 1.2) {
+                confidences.push_back(margin(r - 1.2, 0.4));
+            }
+            else if (r < 0.8) {
+                confidences.push_back(margin(0.8 - r, 0.4));
+            }
+            else {
+                confidences.push_back(margin(std::min(r - 0.8, 1.2 - r), 0.2));
+            }
+        }
+        else {
+            confidences.push_back(0.0);
+        }
+    }
+
+    // Paso 3: Devolver las confianzas
+    return confidences;
+}
+
+
+
+/**
+ * @brief Localiza y decodifica todos los cdigos presentes en la imagen.
+ *
+ * Esta funcin lleva a cabo el proceso de segmentacin y decodificacin de los contornos rojos y verdes en la imagen.
+ * Se extraen los contornos de ambas mscaras, se emparejan, y luego se recortan las reas correspondientes.
+ * Despus, se procesa cada imagen recortada para decodificar el nmero representado por los contornos.
+ * Si `pyramidScale` es menor que 1, la localizacin de los marcadores se realiza sobre una versin reducida
+ * de la imagen y los contornos se devuelven a la resolucin original antes del recorte.
+ *
+ * @param imagen La imagen original (BGR) sobre la cual se buscan los cdigos.
+ *
+ * @return std::vector<DecodedCode> Un resultado por cada pareja de marcadores emparejada, con su cdigo,
+ *         su bounding box y su ngulo.
+ */
+std::vector<DecodedCode> CCodeDetector::detect(const Mat &imagen) {
+    std::vector<std::pair<ContourInfo, ContourInfo>> pairs;
+    {
+        CMetricTimer timer(stageMetrics.locateSeconds);
+        CTraceScope trace("locate");
+        pairs = locateMarkers(imagen);
+    }
+    CMetricTimer timer(stageMetrics.decodeSeconds);
+    CTraceScope trace("decode");
+    return decodeMarkers(pairs, imagen);
+}
+
+
+/**
+ * @brief Localiza las parejas de marcadores rojo y verde de la imagen (etapa de segmentacin de `detect`).
+ *
+ * @param imagen La imagen original (BGR).
+ *
+ * @return std::vector<std::pair<ContourInfo, ContourInfo>> Las parejas de marcadores, en coordenadas de la imagen original.
+ */
+std::vector<std::pair<ContourInfo, ContourInfo>> CCodeDetector::locateMarkers(const Mat &imagen) {
+    // Paso 1: Escala de localizacin (1 si no se ha configurado una escala menor que 1)
+    double scale = params.pyramidScale;
+    if (scale <= 0 || scale >= 1.0) {
+        scale = 1.0;
+    }
+
+    // Paso 2: Procesar cada regin (la imagen completa si no hay ROI configuradas)
+    std::vector<ContourInfo> redContoursInfo;
+    std::vector<ContourInfo> greenContoursInfo;
+    for (const Rect &region : getProcessingRegions(imagen.size())) {
+        // Paso 2.1: Reducir la regin si se ha configurado una escala de localizacin menor que 1. En punto
+        // fijo se usa la interpolacin bilineal exacta, que es entera en 8 bits (INTER_AREA usa pesos flotantes)
+        Mat locateImage = imagen(region);
+        if (scale != 1.0) {
+            CTraceScope trace("resize");
+            resize(imagen(region), locateImage, Size(), scale, scale, params.fixedPoint ? INTER_LINEAR_EXACT : INTER_AREA);
+        }
+
+        // Paso 2.2: Aplicar un filtro de desenfoque para reducir el ruido
+        Mat blurImage = BlurImage(locateImage, params.blurKernelSize);
+
+        // Paso 2.3: Convertir la imagen a escala de grises para facilitar el procesamiento
+        Mat grayImage = convertGrayImage(blurImage);
+
+        Mat redMask, greenMask;
+        if (colorLut) {
+            // Paso 2.4: Con la tabla de colores, las mscaras se obtienen directamente de la imagen BGR con una
+            // consulta por pxel y se aplican sobre el gris en la misma pasada
+            CTraceScope trace("masks");
+            colorLut->maskedGrayImages(blurImage, grayImage, redMask, greenMask);
+        }
+        else {
+            // Paso 2.4: Convertir la imagen a espacio de color HSV para una mejor segmentacin
+            Mat hsvImage = convertHSVImage(blurImage);
+
+            // Paso 2.5: Obtener las mscaras para los colores rojo y verde en la imagen
+            redMask = getRedMask(hsvImage);
+            greenMask = getGreenMask(hsvImage);
+
+            // Paso 2.6: Aplicar las mscaras sobre la imagen original para aislar las reas rojas y verdes
+            redMask = applyMaskToImage(grayImage, redMask);
+            greenMask = applyMaskToImage(grayImage, greenMask);
+        }
+
+        // Paso 2.7: Encontrar los marcadores de la regin, en coordenadas de la imagen original
+        findMarkers(redMask, greenMask, region, imagen.size(), scale, redContoursInfo, greenContoursInfo);
+    }
+
+    // Paso 3: Emparejar los marcadores rojos y verdes de todas las regiones
+    return matchContours(redContoursInfo, greenContoursInfo);
+}
+
+
+/**
+ * @brief Calcula las regiones de la imagen que se procesan al localizar los marcadores.
+ *
+ * Sin ROI configuradas se procesa la imagen completa. Con ROI, cada una se sustituye por su rectngulo
+ * envolvente ampliado con el margen de los filtros (desenfoque y Sobel), para que los pxeles del borde de
+ * la ROI se filtren igual que en la imagen completa. Las regiones que se solapan se unen, para no encontrar
+ * dos veces el mismo marcador.
+ *
+ * @param frameSize Tamao de la imagen original.
+ *
+ * @return std::vector<Rect> Las regiones, en coordenadas de la imagen original.
+ */
+std::vector<Rect> CCodeDetector::getProcessingRegions(Size frameSize) const {
+    const Rect frame(Point(0, 0), frameSize);
+    if (params.rois.empty()) {
+        return { frame };
+    }
+
+    // Paso 1: Rectngulo envolvente de cada ROI, ampliado con el margen de los filtros en la escala de localizacin
+    const double scale = params.pyramidScale > 0 && params.pyramidScale < 1.0 ? params.pyramidScale : 1.0;
+    const int margin = cvCeil(( params.blurKernelSize / 2 + params.sobelKernelSize / 2 + 1 ) / scale);
+    std::vector<Rect> regions;
+    for (const std::vector<Point> &roi : params.rois) {
+        if (roi.size() < 3) {
+            continue;
+        }
+        Rect box = boundingRect(roi);
+        box = Rect(box.x - margin, box.y - margin, box.width + 2 * margin, box.height + 2 * margin) & frame;
+        if (box.area() > 0) {
+            regions.push_back(box);
+        }
+    }
+
+    // Paso 2: Unir las regiones que se solapan hasta que no quede ninguna pareja solapada
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < regions.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < regions.size(); ++j) {
+                if (( regions[i] & regions[j] ).area() > 0) {
+                    regions[i] |= regions[j];
+                    regions.erase(regions.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    return regions;
+}
+
+
+/**
+ * @brief Encuentra los marcadores de una regin a partir de sus imgenes en gris con las mscaras ya aplicadas.
+ *
+ * Con `componentLocator`, los dos colores se procesan en una sola pasada de `findComponentMarkers`.
+ *
+ * @param redMasked Gris de la regin con la mscara roja aplicada (se anula fuera de las ROI).
+ * @param greenMasked Gris de la regin con la mscara verde aplicada (se anula fuera de las ROI).
+ * @param region Regin de la imagen original a la que corresponden las mscaras.
+ * @param frameSize Tamao de la imagen original.
+ * @param scale Escala a la que se han calculado las mscaras respecto a la imagen original.
+ * @param redInfo Vector al que se aaden los marcadores rojos, en coordenadas de la imagen original.
+ * @param greenInfo Vector al que se aaden los marcadores verdes, en coordenadas de la imagen original.
+ */
+void CCodeDetector::findMarkers(Mat &redMasked, Mat &greenMasked, const Rect &region, Size frameSize, double scale,
+                                std::vector<ContourInfo> &redInfo, std::vector<ContourInfo> &greenInfo) {
+    CTraceScope trace("findMarkers");
+    if (!params.componentLocator) {
+        findColorMarkers(redMasked, region, frameSize, scale, redInfo);
+        findColorMarkers(greenMasked, region, frameSize, scale, greenInfo);
+        return;
+    }
+
+    // Componentes conexas de las dos mscaras en una sola pasada
+    double referenceArea = clipToRois(redMasked, region, frameSize, scale);
+    clipToRois(greenMasked, region, frameSize, scale);
+    std::vector<ContourInfo> red, green;
+    findComponentMarkers(redMasked, greenMasked, referenceArea, red, green);
+    addMarkers(red, region, scale, redInfo);
+    addMarkers(green, region, scale, greenInfo);
+}
+
+
+/**
+ * @brief Encuentra los marcadores de un color en una regin.
+ *
+ * @param masked Gris de la regin con la mscara del color aplicada (se anula fuera de las ROI).
+ * @param region Regin de la imagen original a la que corresponde la mscara.
+ * @param frameSize Tamao de la imagen original.
+ * @param scale Escala a la que se ha calculado la mscara respecto a la imagen original.
+ * @param info Vector al que se aaden los marcadores, en coordenadas de la imagen original.
+ */
+void CCodeDetector::findColorMarkers(Mat &masked, const Rect &region, Size frameSize, double scale,
+                                     std::vector<ContourInfo> &info) {
+    // Paso 1: Anular la mscara fuera de las ROI
+    double referenceArea = clipToRois(masked, region, frameSize, scale);
+
+    // Paso 2: Encontrar los marcadores de la mscara (contornos filtrados del Sobel o componentes conexas)
+    std::vector<ContourInfo> contoursInfo;
+    if (params.componentLocator) {
+        std::vector<ContourInfo> unused;
+        findComponentMarkers(masked, Mat(), referenceArea, contoursInfo, unused);
+    }
+    else {
+        contoursInfo = extractContourInfo(findFilteredContours(masked, referenceArea));
+    }
+
+    // Paso 3: Llevar los marcadores a la resolucin y a las coordenadas de la imagen original
+    addMarkers(contoursInfo, region, scale, info);
+}
+
+
+/**
+ * @brief Anula los pxeles de una mscara que quedan fuera de las ROI.
+ *
+ * @param masked Gris de la regin con la mscara aplicada.
+ * @param region Regin de la imagen original a la que corresponde la mscara.
+ * @param frameSize Tamao de la imagen original.
+ * @param scale Escala a la que se ha calculado la mscara respecto a la imagen original.
+ *
+ * @return double rea de referencia de los umbrales de rea: sin ROI, 0 (la de la mscara); con ROI, la de la
+ *         imagen completa a la escala de la mscara, no la de la regin.
+ */
+double CCodeDetector::clipToRois(Mat &masked, const Rect &region, Size frameSize, double scale) const {
+    if (params.rois.empty()) {
+        return 0.0;
+    }
+
+    // Polgonos llevados a las coordenadas de la regin
+    std::vector<std::vector<Point>> polygons;
+    for (const std::vector<Point> &roi : params.rois) {
+        std::vector<Point> polygon;
+        for (const Point &p : roi) {
+            polygon.push_back(Point(cvRound(( p.x - region.x ) * scale), cvRound(( p.y - region.y ) * scale)));
+        }
+        polygons.push_back(polygon);
+    }
+    Mat outside(masked.size(), CV_8UC1, Scalar(255));
+    fillPoly(outside, polygons, Scalar(0));
+    masked.setTo(Scalar(0), outside);
+    return static_cast<double>( frameSize.area() ) * scale * scale;
+}
+
+
+/**
+ * @brief Lleva unos marcadores a la resolucin y a las coordenadas de la imagen original y los aade a un vector.
+ *
+ * @param markers Marcadores en coordenadas de la regin reducida (se modifican).
+ * @param region Regin de la imagen original.
+ * @param scale Escala de la regin respecto a la imagen original.
+ * @param info Vector al que se aaden.
+ */
+void CCodeDetector::addMarkers(std::vector<ContourInfo> &markers, const Rect &region, double scale, std::vector<ContourInfo> &info) {
+    if (scale != 1.0 || region.tl() != Point(0, 0)) {
+        for (auto &marker : markers) marker = scaleContourInfo(marker, 1.0 / scale, region.tl());
+    }
+    info.insert(info.end(), markers.begin(), markers.end());
+}
+
+
+/**
+ * @brief Recorta y decodifica los cdigos de las parejas de marcadores (etapa de decodificacin de `detect`).
+ *
+ * @param matchedContours Parejas de marcadores devueltas por `locateMarkers`.
+ * @param imagen La imagen original (BGR).
+ *
+ * @return std::vector<DecodedCode> Un resultado por cada pareja de marcadores.
+ */
+std::vector<DecodedCode> CCodeDetector::decodeMarkers(const std::vector<std::pair<ContourInfo, ContourInfo>> &matchedContours,
+                                                      const Mat &imagen) {
+    // Paso 1: Recortar las regiones de inters de la imagen (bounding boxes) de los contornos emparejados
+    std::vector<Mat> extractedImages = cutBoundingBox(matchedContours, imagen);
+
+    // Paso 2: Decodificar cada imagen recortada
+    std::vector<std::string> decodedCodes(extractedImages.size());
+    std::vector<std::vector<double>> decodedConfidences(extractedImages.size());
+    for (size_t i = 0; i < extractedImages.size(); ++i) {
+        decodeCrop(extractedImages[i], decodedCodes[i], decodedConfidences[i]);
+    }
+
+    // Paso 3: Construir un resultado por cada pareja de contornos emparejada
+    return buildDecodedCodes(matchedContours, decodedCodes, decodedConfidences);
+}
+
+
+/**
+ * @brief Obtiene la informacin de los segmentos a partir de perfiles de proyeccin de cada cuarto del recorte.
+ *
+ * Los recortes llegan enderezados y las barras de los dgitos son rectngulos alineados con los ejes, as que no
+ * hace falta trazar sus contornos: basta con contar los pxeles oscuros de cada columna y de cada fila de un
+ * cuarto. Los tramos del perfil de columnas que superan una fraccin de su mximo son las barras verticales y los
+ * del perfil de filas las horizontales; dos tramos en un perfil y uno en el otro son dos barras paralelas, uno y
+ * uno es una sola barra, cuya orientacin es la del lado largo de su rectngulo. El rea de cada barra es la suma
+ * de su tramo, y se normaliza como en `getAreaRatio` para que `decodeNumber` y `getDigitConfidences` la
+ * interpreten igual.
+ *
+ * Se binariza con Otsu y no con el umbral adaptativo de `thresholdImage`: con bloques pequeos el umbral
+ * adaptativo vaca el interior de las barras gruesas, que es justo lo que distingue un 1 de un 5. Los bordes de
+ * cada cuarto (`scanlineMargin`) se descartan para dejar fuera los marcos de los marcadores, que
+ * `getContours` descartaba por su forma cuadrada y su distancia al borde.
+ *
+ * @param grayCrop Recorte en escala de grises (ya desenfocado), como el que recibe `getContours`.
+ *
+ * @return std::vector<SegmentInfo> La informacin de los 4 segmentos, de izquierda a derecha.
+ */
+std::vector<SegmentInfo> CCodeDetector::getScanlineSegmentInfo(const Mat &grayCrop) {
+    CTraceScope trace("getScanlineSegmentInfo", "decode");
+    // Fraccin del mximo del perfil a partir de la cual una columna o fila pertenece a una barra
+    const double runThreshold = 0.3;
+
+    // Paso 1: Binarizar el recorte (1 = pxel oscuro) con un umbral global
+    Mat dark;
+    threshold(grayCrop, dark, 0, 1, THRESH_BINARY_INV | THRESH_OTSU);
+
+    // Paso 2: Calcular los umbrales de rea igual que `getContours` y la referencia de `getAreaRatio`
+    const double cropArea = static_cast<double>( grayCrop.cols ) * grayCrop.rows;
+    const double minArea = std::max(200.0, 0.01 * cropArea);
+    const double quarterArea = cropArea / 4.0;
+    const int quarterWidth = grayCrop.cols / 4;
+
+    // Tramos [inicio, fin) de un perfil por encima del umbral con suma suficiente para ser una barra
+    auto findRuns = [&](const std::vector<int> &profile) {
+        std::vector<std::pair<int, int>> runs;
+        const int maxValue = profile.empty() ? 0 : *std::max_element(profile.begin(), profile.end());
+        const double limit = runThreshold * maxValue;
+        int start = -1;
+        double sum = 0;
+        for (size_t i = 0; i <= profile.size(); i++) {
+            const bool inside = i < profile.size() && profile[i] > limit;
+            if (inside) {
+                if (start < 0) {
+                    start = static_cast<int>( i );
+                    sum = 0;
+                }
+                sum += profile[i];
+            }
+            else if (start >= 0) {
+                if (sum >= minArea) {
+                    runs.push_back({ start, static_cast<int>( i ) });
+                }
+                start = -1;
+            }
+        }
+        return runs;
+    };
+    auto runSum = [](const std::vector<int> &profile, const std::pair<int, int> &run) {
+        return static_cast<double>( std::accumulate(profile.begin() + run.first, profile.begin() + run.second, 0) );
+    };
+
+    std::vector<SegmentInfo> segmentInfoList;
+    for (int quarter = 0; quarter < 4; quarter++) {
+        SegmentInfo info;
+        info.numContours = 0;
+        info.areaRatioRelation = -1;
+
+        // Paso 3: Recortar el interior del cuarto, sin los bordes donde quedan los marcos
+        const int margin = static_cast<int>( params.scanlineMargin * std::min(quarterWidth, grayCrop.rows) );
+        Rect cellRect(quarter * quarterWidth + margin, margin, quarterWidth - 2 * margin, grayCrop.rows - 2 * margin);
+        if (cellRect.width <= 0 || cellRect.height <= 0) {
+            segmentInfoList.push_back(info);
+            continue;
+        }
+        Mat cell = dark(cellRect);
+
+        // Paso 4: Perfiles de proyeccin: pxeles oscuros de cada columna y de cada fila
+        std::vector<int> columns(cell.cols, 0), rows(cell.rows, 0);
+        int total = 0;
+        for (int y = 0; y < cell.rows; y++) {
+            const uchar *row = cell.ptr<uchar>(y);
+            int rowSum = 0;
+            for (int x = 0; x < cell.cols; x++) {
+                columns[x] += row[x];
+                rowSum += row[x];
+            }
+            rows[y] = rowSum;
+            total += rowSum;
+        }
+
+        // Paso 5: Un cuarto sin pxeles oscuros suficientes no tiene barras (dgito 0)
+        if (total < minArea) {
+            segmentInfoList.push_back(info);
+            continue;
+        }
+
+        // Paso 6: Interpretar los tramos de los dos perfiles
+        std::vector<std::pair<int, int>> columnRuns = findRuns(columns);
+        std::vector<std::pair<int, int>> rowRuns = findRuns(rows);
+        if (columnRuns.size() == 1 && rowRuns.size() == 1) {
+            // Paso 6.1: Una barra: su orientacin es la del lado largo y su rea la de los pxeles de su rectngulo
+            Rect bar(columnRuns[0].first, rowRuns[0].first,
+                     columnRuns[0].second - columnRuns[0].first, rowRuns[0].second - rowRuns[0].first);
+            info.numContours = 1;
+            info.orientations.push_back(( bar.width > bar.height ) ? "horizontal" : "vertical");
+            info.areaRatios.push_back(countNonZero(cell(bar)) / quarterArea);
+        }
+        else if (columnRuns.size() == 2 && rowRuns.size() == 1) {
+            // Paso 6.2: Dos barras verticales, de izquierda a derecha
+            const double area1 = runSum(columns, columnRuns[0]);
+            const double area2 = runSum(columns, columnRuns[1]);
+            info.numContours = 2;
+            info.orientations = { "vertical", "vertical" };
+            info.areaRatios = { area1 / quarterArea, area2 / quarterArea };
+            info.areaRatioRelation = area1 / area2;
+        }
+        else if (rowRuns.size() == 2 && columnRuns.size() == 1) {
+            // Paso 6.3: Dos barras horizontales, de arriba abajo
+            const double area1 = runSum(rows, rowRuns[0]);
+            const double area2 = runSum(rows, rowRuns[1]);
+            info.numContours = 2;
+            info.orientations = { "horizontal", "horizontal" };
+            info.areaRatios = { area1 / quarterArea, area2 / quarterArea };
+            info.areaRatioRelation = area1 / area2;
+        }
+        else {
+            // Paso 6.4: Cualquier otra combinacin no es un dgito vlido (se decodifica como X)
+            info.numContours = std::max<size_t>(3, std::max(columnRuns.size(), rowRuns.size()));
+        }
+        segmentInfoList.push_back(info);
+    }
+
+    // Paso 7: Devolver la informacin de los 4 segmentos
+    return segmentInfoList;
+}
+
+
+/**
+ * @brief Decodifica un cdigo recortado y enderezado.
+ *
+ * @param crop Recorte BGR del cdigo, como los que devuelve `cutBoundingBox` (vaco si se sale de la imagen).
+ * @param code Cdigo decodificado (con "X" en los dgitos que no se reconocen; "X" si no hay recorte).
+ * @param confidences Confianza [0, 1] de cada uno de los 4 dgitos.
+ */
+void CCodeDetector::decodeCrop(const Mat &crop, std::string &code, std::vector<double> &confidences) {
+    CTraceScope trace("decodeCode", "decode");
+    // Una pareja cuyo recorte se sale de la imagen no se puede decodificar
+    if (crop.empty()) {
+        code = "X";
+        confidences.assign(4, 0.0);
+        return;
+    }
+
+    // Paso 1: Convertir la imagen recortada a escala de grises
+    Mat grayCrop = convertGrayImage(crop);
+
+    // Paso 2: Aplicar un filtro gaussiano para reducir el ruido en la imagen recortada (no se aplica con un
+    // kernel de 1, que es como lo desactiva el control de calidad cuando falta tiempo)
+    if (params.decodeBlurKernelSize > 1) {
+        grayCrop = BlurImage(grayCrop, params.decodeBlurKernelSize);
+    }
+
+    // Paso 2.1: Con el decodificador por perfiles, obtener la informacin de los segmentos sin buscar contornos
+    if (params.scanlineDecoder) {
+        std::vector<SegmentInfo> segmentInfo = getScanlineSegmentInfo(grayCrop);
+        code = decodeNumber(segmentInfo);
+        confidences = getDigitConfidences(segmentInfo);
+        return;
+    }
+
+    // Paso 3: Aplicar un umbral para binarizar la imagen y resaltar los contornos
+    Mat thresholded = thresholdImage(grayCrop, params.thresholdOffset);
+
+    // Paso 4: Obtener los contornos de la imagen binarizada
+    std::vector<std::vector<Point>> contours = getContours(thresholded, grayCrop);
+
+    // Paso 5: Separar los contornos en segmentos segn su posicin en la imagen
+    std::vector<std::vector<std::vector<Point>>> segments = separateContoursBySegments(contours, grayCrop.cols);
+
+    // Paso 6: Ordenar los contornos dentro de cada segmento para facilitar la decodificacin
+    std::vector<std::vector<std::vector<Point>>> orderedSegments = orderContours(segments);
+
+    // Paso 7: Obtener informacin detallada sobre los segmentos de contornos
+    std::vector<SegmentInfo> segmentInfo = getSegmentInfo(orderedSegments, grayCrop);
+
+    // Paso 8: Decodificar el nmero representado por los contornos junto a su confianza
+    code = decodeNumber(segmentInfo);
+    confidences = getDigitConfidences(segmentInfo);
+}
+
+
+/**
+ * @brief Construye un resultado por cada pareja de marcadores.
+ *
+ * @param matchedContours Parejas de marcadores rojo y verde.
+ * @param decodedCodes Cdigo decodificado de cada pareja.
+ * @param decodedConfidences Confianzas de los dgitos de cada pareja.
+ *
+ * @return std::vector<DecodedCode> Un resultado por cada pareja, con su bounding box, ngulo, cdigo y confianza.
+ */
+std::vector<DecodedCode> CCodeDetector::buildDecodedCodes(const std::vector<std::pair<ContourInfo, ContourInfo>> &matchedContours,
+                                                          const std::vector<std::string> &decodedCodes,
+                                                          const std::vector<std::vector<double>> &decodedConfidences) const {
+    std::vector<DecodedCode> results;
+    for (size_t i = 0; i < matchedContours.size(); ++i) {
+        const ContourInfo &redContour = matchedContours[i].first;
+        const ContourInfo &greenContour = matchedContours[i].second;
+
+        // Paso 1: Calcular la bounding box que contiene las esquinas de ambos marcadores
+        std::vector<Point> allPoints = redContour.corners;
+        allPoints.insert(allPoints.end(), greenContour.corners.begin(), greenContour.corners.end());
+
+        DecodedCode result;
+        result.boundingBox = boundingRect(allPoints);
+        result.redCorners = redContour.corners;
+        result.greenCorners = greenContour.corners;
+        result.angle = atan2(greenContour.center.y - redContour.center.y,
+                             greenContour.center.x - redContour.center.x) * 180 / CV_PI;
+
+        // Paso 2: Asociar el cdigo decodificado (si no hay nmero, usar "X") y su confianza
+        result.code = i < decodedCodes.size() ? decodedCodes[i] : "X";
+        result.digitConfidence = i < decodedConfidences.size() ? decodedConfidences[i] : std::vector<double>(4, 0.0);
+        result.confidence = *std::min_element(result.digitConfidence.begin(), result.digitConfidence.end());
+        results.push_back(result);
+    }
+    return results;
+}
+
+
+/**
+ * @brief Muestra las imgenes de los cdigos emparejados, destacando los contornos rojos y verdes con sus respectivos cdigos decodificados.
+ *
+ * Esta funcin ejecuta el pipeline completo mediante `detect` y dibuja los cuadros delimitadores
+ * (bounding boxes) y los nmeros decodificados sobre una copia de la imagen original.
+ * La interfaz no la utiliza: compone las anotaciones de `buildOverlay` en la vista, sin copiar el fotograma.
+ *
+ * @param imagen La imagen original sobre la cual se procesan los contornos.
+ *               Esta imagen es utilizada para realizar la segmentacin y para mostrar los resultados finales.
+ *
+ * @return Mat La imagen con los cuadros delimitadores de los contornos emparejados y los cdigos decodificados
+ *             visualizados sobre ella.
+ */
+Mat CCodeDetector::getSegmentedImage(const Mat &imagen) {
+    CTraceScope trace("getSegmentedImage");
+
+    // Paso 1: Localizar y decodificar los cdigos
+    FrameOverlay overlay = buildOverlay(detect(imagen));
+
+    // Paso 2: Dibujarlos sobre una copia de la imagen original para no alterarla
+    CTraceScope drawTrace("drawOverlay");
+    Mat copiaImagen = imagen.clone();
+    drawOverlay(copiaImagen, overlay);
+    return copiaImagen;
+}
+
+
+/**
+ * @brief Genera las anotaciones de los cdigos decodificados sin tocar la imagen.
+ *
+ * Cada cdigo produce una bounding box y un texto con el nmero decodificado encima de ella. La capa de
+ * visualizacin decide cmo y a qu resolucin dibujarlos; una aplicacin sin interfaz puede no llamar
+ * a esta funcin.
+ *
+ * @param codes Los cdigos devueltos por `detect`.
+ *
+ * @return FrameOverlay Las anotaciones en coordenadas de la imagen original.
+ */
+FrameOverlay CCodeDetector::buildOverlay(const std::vector<DecodedCode> &codes) const {
+    FrameOverlay overlay;
+    overlay.boxes.reserve(codes.size());
+    overlay.labels.reserve(codes.size());
+
+    for (const DecodedCode &code : codes) {
+        OverlayBox box;
+        box.rect = code.boundingBox;
+        overlay.boxes.push_back(box);
+
+        OverlayLabel label;
+        label.text = code.code;
+        label.origin = Point(code.boundingBox.x, code.boundingBox.y - 10);
+        overlay.labels.push_back(label);
+    }
+
+    // Zonas procesadas, si se han configurado ROI
+    for (const std::vector<Point> &roi : params.rois) {
+        if (roi.size() >= 3) {
+            OverlayBox box;
+            box.rect = boundingRect(roi);
+            box.color = Scalar(0, 255, 255);
+            box.thickness = 1;
+            overlay.boxes.push_back(box);
+        }
+    }
+
+    return overlay;
+}
+
+
+/**
+ * @brief Genera un overlay que muestra solo los pxeles activos de una mscara.
+ *
+ * Sustituye a `applyMaskToImage` en la visualizacin: en lugar de copiar la imagen completa aplicando la
+ * mscara, la mscara se compone sobre el fotograma ya reducido al tamao de la vista.
+ *
+ * @param mask Mscara binaria (CV_8UC1) del tamao de la imagen.
+ *
+ * @return FrameOverlay Overlay con la mscara como nica regin visible.
+ */
+FrameOverlay CCodeDetector::buildMaskOverlay(const Mat &mask) const {
+    FrameOverlay overlay;
+    OverlayMask overlayMask;
+    overlayMask.roi = Rect(0, 0, mask.cols, mask.rows);
+    overlayMask.mask = mask;
+    overlay.masks.push_back(overlayMask);
+    return overlay;
+}
@@ -0,0 +1,644 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include "Overlay.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "ColorLut.h"
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+#include <memory>
+#include <set>
+
+using namespace cv;
+using namespace std;
+
+class CTaskScheduler;
+
+/**
+ * @struct ContourInfo
+ * @brief Estructura para almacenar la informacin de un contorno.
+ *
+ * Esta estructura almacena datos relacionados con un contorno detectado en una imagen, como sus esquinas,
+ * el centro, las dimensiones (ancho, alto), rea, relacin de aspecto, permetro y ngulo de rotacin.
+ */
+struct ContourInfo {
+    std::vector<Point> corners;   /**< Esquinas del contorno */
+    Point2f center;               /**< Centro del contorno */
+    float width;                  /**< Ancho del contorno */
+    float height;                 /**< Alto del contorno */
+    float area;                   /**< rea del contorno */
+    float aspect_ratio;           /**< Relacin de aspecto del contorno */
+    float perimeter;              /**< Permetro del contorno */
+    float angle;                  /**< ngulo de rotacin del contorno */
+};
+
+/**
+ * @struct SegmentInfo
+ * @brief Estructura para almacenar la informacin de un segmento de contornos.
+ *
+ * Esta estructura almacena datos sobre los segmentos de contornos, como el nmero de contornos, sus orientaciones,
+ * las relaciones de rea y la relacin entre reas si el segmento tiene exactamente dos contornos.
+ */
+struct SegmentInfo {
+    size_t numContours;                         /**< Nmero de contornos en el segmento */
+    std::vector<std::string> orientations;      /**< Orientacin de cada contorno (horizontal o vertical) */
+    std::vector<double> areaRatios;             /**< Relacin de reas de cada contorno respecto a la imagen */
+    double areaRatioRelation;                   /**< Relacin entre las reas de los contornos (solo si hay 2) */
+};
+
+/**
+ * @struct DetectorParams
+ * @brief Parmetros ajustables del pipeline de localizacin y decodificacin.
+ *
+ * Agrupa los valores que antes estaban fijos en el cdigo (tamaos de kernel, rangos HSV,
+ * umbrales), de forma que puedan ajustarse por despliegue o buscarse automticamente con
+ * la herramienta ParameterTuner. Los valores por defecto reproducen el comportamiento original.
+ */
+struct DetectorParams {
+    int blurKernelSize = 7;                      /**< Kernel del desenfoque gaussiano previo a la segmentacin */
+    int sobelKernelSize = 11;                    /**< Kernel del filtro Sobel usado para localizar los marcadores */
+    int sobelThreshold = 30;                     /**< Umbral binario aplicado a la magnitud del gradiente */
+    Scalar redLow1 = Scalar(0, 50, 50);          /**< Lmite inferior HSV del primer rango de rojo */
+    Scalar redHigh1 = Scalar(10, 255, 255);      /**< Lmite superior HSV del primer rango de rojo */
+    Scalar redLow2 = Scalar(150, 50, 50);        /**< Lmite inferior HSV del segundo rango de rojo */
+    Scalar redHigh2 = Scalar(179, 255, 255);     /**< Lmite superior HSV del segundo rango de rojo */
+    Scalar greenLow = Scalar(30, 55, 55);        /**< Lmite inferior HSV del verde */
+    Scalar greenHigh = Scalar(90, 255, 255);     /**< Lmite superior HSV del verde */
+    double pyramidScale = 1.0;                   /**< Escala (0, 1] a la que se localizan los marcadores */
+    int decodeBlurKernelSize = 11;               /**< Kernel del desenfoque aplicado a cada cdigo recortado (1 = sin desenfoque) */
+    int thresholdBlockSize = 11;                 /**< Tamao de bloque del umbral adaptativo de `thresholdImage` */
+    int thresholdOffset = 2;                     /**< Constante restada en el umbral adaptativo de `thresholdImage` */
+    bool fixedPoint = false;                     /**< Localiza y recorta con aritmtica entera (equipos sin FPU potente) */
+    bool colorLut = false;                       /**< Clasifica los colores con una tabla BGR precalculada (`CColorLut`),
+                                                      sin convertir a HSV; la activa la calibracin de color */
+    bool componentLocator = false;               /**< Localiza los marcadores con componentes conexas sobre las mscaras
+                                                      (`findComponentMarkers`), sin Sobel ni contornos */
+    double componentMinFill = 0.4;               /**< Fraccin mnima del rectngulo envolvente que ocupa un marcador
+                                                      con `componentLocator` (un cuadrado girado 45 ocupa la mitad) */
+    bool scanlineDecoder = false;                /**< Decodifica con perfiles de proyeccin por cuarto del recorte
+                                                      (`getScanlineSegmentInfo`), sin umbral adaptativo ni contornos */
+    double scanlineMargin = 0.15;                /**< Fraccin de cada cuarto que se descarta en sus bordes con
+                                                      `scanlineDecoder` (deja fuera los marcos de los marcadores) */
+    std::vector<std::vector<Point>> rois;        /**< Zonas de la imagen donde pueden aparecer cdigos (polgonos en
+                                                      coordenadas de la imagen original); vaco = imagen completa */
+};
+
+/**
+ * @struct DecodedCode
+ * @brief Resultado de la decodificacin de un cdigo localizado en la imagen.
+ */
+struct DecodedCode {
+    std::string code;      /**< Cdigo decodificado (4 caracteres, 'X' en los dgitos no reconocidos) */
+    Rect boundingBox;      /**< Bounding box de la pareja de marcadores en coordenadas de la imagen */
+    double angle = 0;      /**< ngulo (en grados) de la lnea que une el marcador rojo con el verde */
+    std::vector<double> digitConfidence; /**< Confianza [0, 1] de cada uno de los 4 dgitos */
+    double confidence = 0; /**< Confianza global del cdigo (mnimo de las confianzas de los dgitos) */
+    std::vector<Point> redCorners;   /**< Esquinas del marcador rojo, en coordenadas de la imagen */
+    std::vector<Point> greenCorners; /**< Esquinas del marcador verde, en coordenadas de la imagen */
+};
+
+/**
+ * @struct DetectorStageMetrics
+ * @brief Histogramas de duracin de las etapas de `detect` y contadores del detector (nullptr = no se mide).
+ */
+struct DetectorStageMetrics {
+    CMetricHistogram *locateSeconds = nullptr;   /**< Localizacin de los marcadores (mscaras, contornos, emparejamiento) */
+    CMetricHistogram *decodeSeconds = nullptr;   /**< Recorte y decodificacin de los candidatos */
+    CMetricCounter *outOfBoundsCrops = nullptr;  /**< Parejas cuyo recorte enderezado se sale de la imagen */
+};
+
+/**
+ * @struct DetectorBatchBuffers
+ * @brief Imgenes intermedias de `detectBatch`, que se conservan entre lotes para no volver a reservarlas.
+ *
+ * Cada vector tiene una imagen por regin procesada del lote (un fotograma por regin si no hay ROI).
+ */
+struct DetectorBatchBuffers {
+    std::vector<Mat> locate;        /**< Regin reducida a la escala de localizacin */
+    std::vector<Mat> blurred;       /**< Salida del desenfoque */
+    std::vector<Mat> hsv;           /**< Imagen HSV */
+    std::vector<Mat> gray;          /**< Imagen en gris */
+    std::vector<Mat> redMask;       /**< Mscara roja */
+    std::vector<Mat> redMask2;      /**< Mscara del segundo rango de rojo */
+    std::vector<Mat> greenMask;     /**< Mscara verde */
+    std::vector<Mat> redMasked;     /**< Gris con la mscara roja aplicada */
+    std::vector<Mat> greenMasked;   /**< Gris con la mscara verde aplicada */
+};
+
+/**
+ * @class CCodeDetector
+ * @brief Pipeline de localizacin y decodificacin de cdigos, independiente de la interfaz grfica.
+ *
+ * Contiene todas las etapas de segmentacin (mscaras de color, Sobel, contornos, emparejamiento)
+ * y de decodificacin (umbral, clasificacin de contornos, segmentos). No depende de Qt, por lo que
+ * puede usarse tanto desde la aplicacin grfica como desde herramientas de consola.
+ */
+class CCodeDetector
+{
+public:
+    /**
+     * @brief Constructor de la clase CCodeDetector.
+     *
+     * @param params Parmetros del pipeline (por defecto, los valores originales).
+     */
+    CCodeDetector(const DetectorParams &params = DetectorParams());
+
+    /**
+     * @brief Devuelve los parmetros actuales del pipeline.
+     */
+    const DetectorParams &getParams() const;
+
+    /**
+     * @brief Sustituye los parmetros del pipeline.
+     *
+     * @param params Nuevos parmetros.
+     */
+    void setParams(const DetectorParams &params);
+
+    /**
+     * @brief Carga los parmetros desde un fichero YAML/XML de OpenCV.
+     *
+     * Los campos ausentes en el fichero conservan su valor actual.
+     *
+     * @param fileName Ruta del fichero.
+     * @return true si el fichero se ha podido abrir.
+     */
+    bool loadParams(const std::string &fileName);
+
+    /**
+     * @brief Guarda los parmetros actuales en un fichero YAML/XML de OpenCV.
+     *
+     * @param fileName Ruta del fichero.
+     * @return true si el fichero se ha podido escribir.
+     */
+    bool saveParams(const std::string &fileName) const;
+
+    /**
+     * @brief Mide las etapas de `detect` en un registro de mtricas (`dc_stage_seconds`).
+     *
+     * @param registry Registro de mtricas (nullptr para dejar de medir).
+     * @param streamId Identificador del flujo (etiqueta `stream`).
+     */
+    void setMetrics(CMetricsRegistry *registry, const std::string &streamId);
+
+    /**
+     * @brief Devuelve los histogramas de las etapas (tambin los usan las variantes especializadas).
+     */
+    const DetectorStageMetrics &getStageMetrics() const;
+
+    /**
+     * @brief Localiza y decodifica todos los cdigos presentes en la imagen.
+     *
+     * @param imagen Imagen original en formato BGR.
+     * @return Cdigos decodificados, uno por cada pareja de marcadores emparejada.
+     */
+    std::vector<DecodedCode> detect(const Mat &imagen);
+
+    /**
+     * @brief Localiza las parejas de marcadores de la imagen (etapa de segmentacin de `detect`).
+     *
+     * @param imagen Imagen original en formato BGR.
+     * @return Parejas de marcadores rojo y verde, en coordenadas de la imagen original.
+     */
+    std::vector<std::pair<ContourInfo, ContourInfo>> locateMarkers(const Mat &imagen);
+
+    /**
+     * @brief Regiones de la imagen que procesa `locateMarkers`.
+     *
+     * Sin ROI configuradas es la imagen completa. Con ROI, el rectngulo envolvente de cada una, ampliado con
+     * el margen de los filtros y recortado a la imagen; las regiones que se solapan se unen en una sola.
+     *
+     * @param frameSize Tamao de la imagen original.
+     * @return Regiones en coordenadas de la imagen original.
+     */
+    std::vector<Rect> getProcessingRegions(Size frameSize) const;
+
+    /**
+     * @brief Encuentra los marcadores de una regin a partir de sus imgenes en gris con las mscaras aplicadas.
+     *
+     * Si hay ROI configuradas, antes se anulan los pxeles de las mscaras que quedan fuera de ellas (por eso
+     * se modifican `redMasked` y `greenMasked`). El filtro de rea usa el rea de la imagen completa, de modo
+     * que un marcador se acepta igual tanto si se procesa la imagen entera como una regin.
+     *
+     * @param redMasked Gris de la regin con la mscara roja aplicada.
+     * @param greenMasked Gris de la regin con la mscara verde aplicada.
+     * @param region Regin de la imagen original (de `getProcessingRegions`).
+     * @param frameSize Tamao de la imagen original.
+     * @param scale Escala de las mscaras respecto a la imagen original (`pyramidScale`).
+     * @param redInfo Marcadores rojos encontrados, en coordenadas de la imagen original (se aaden al final).
+     * @param greenInfo Marcadores verdes encontrados, en coordenadas de la imagen original (se aaden al final).
+     */
+    void findMarkers(Mat &redMasked, Mat &greenMasked, const Rect &region, Size frameSize, double scale,
+                     std::vector<ContourInfo> &redInfo, std::vector<ContourInfo> &greenInfo);
+
+    /**
+     * @brief Recorta y decodifica los cdigos de las parejas de marcadores (etapa de decodificacin de `detect`).
+     *
+     * @param matchedContours Parejas de marcadores devueltas por `locateMarkers`.
+     * @param imagen Imagen original en formato BGR.
+     * @return Cdigos decodificados, uno por cada pareja.
+     */
+    std::vector<DecodedCode> decodeMarkers(const std::vector<std::pair<ContourInfo, ContourInfo>> &matchedContours, const Mat &imagen);
+
+    /**
+     * @brief Localiza y decodifica los cdigos de un lote de fotogramas (reprocesado offline).
+     *
+     * Ejecuta cada etapa para todos los fotogramas del lote antes de pasar a la siguiente, repartiendo los
+     * fotogramas (y despus los recortes) entre los hilos de OpenCV y reutilizando las imgenes intermedias
+     * entre lotes. El resultado es el mismo que el de llamar a `detect` con cada fotograma. No debe llamarse
+     * a la vez desde varios hilos con el mismo detector.
+     *
+     * @param frames Fotogramas BGR.
+     * @return Cdigos decodificados de cada fotograma, en el mismo orden.
+     */
+    std::vector<std::vector<DecodedCode>> detectBatch(const std::vector<Mat> &frames);
+
+    /**
+     * @brief Localiza y decodifica los cdigos de varios fotogramas como tareas de un planificador con robo de trabajo.
+     *
+     * Cada etapa es una tarea pequea: las mscaras de cada regin, la bsqueda de contornos de cada color y el
+     * recorte y la decodificacin de cada candidato. As se aprovechan todos los ncleos tanto con un fotograma
+     * con muchos cdigos como con muchos fotogramas con un cdigo cada uno. El resultado (tambin el orden de
+     * los cdigos de cada fotograma) es el mismo que el de `detect`. No usa las imgenes de `batchBuffers`, por
+     * lo que puede llamarse a la vez desde varios hilos (p. ej. uno por flujo) con el mismo detector.
+     *
+     * @param frames Fotogramas BGR (pueden ser de flujos distintos).
+     * @param scheduler Planificador en el que se ejecutan las tareas.
+     * @return Cdigos decodificados de cada fotograma, en el mismo orden.
+     */
+    std::vector<std::vector<DecodedCode>> detectBatch(const std::vector<Mat> &frames, CTaskScheduler &scheduler);
+
+    /// Funciones de segmentacin de imagen
+    /**
+     * @brief Aplica un filtro de desenfoque a la imagen.
+     *
+     * @param image Imagen de entrada.
+     * @param kernelSize Tamao del ncleo del filtro de desenfoque.
+     * @return Imagen desenfocada.
+     */
+    Mat BlurImage(const Mat &image, uint8_t kernelSize);
+
+    /**
+     * @brief Convierte una imagen a escala de grises.
+     *
+     * @param image Imagen de entrada.
+     * @return Imagen convertida a escala de grises.
+     */
+    Mat convertGrayImage(const Mat &image);
+
+    /**
+     * @brief Convierte una imagen a espacio de color HSV.
+     *
+     * @param image Imagen de entrada.
+     * @return Imagen convertida a HSV.
+     */
+    Mat convertHSVImage(const Mat &image);
+
+    /**
+     * @brief Obtiene la mscara de color rojo de una imagen en HSV.
+     *
+     * @param image Imagen en HSV.
+     * @return Mscara de color rojo.
+     */
+    Mat getRedMask(const Mat &image);
+
+    /**
+     * @brief Obtiene la mscara de color verde de una imagen en HSV.
+     *
+     * @param image Imagen en HSV.
+     * @return Mscara de color verde.
+     */
+    Mat getGreenMask(const Mat &image);
+
+    /**
+     * @brief Aplica una mscara a la imagen.
+     *
+     * @param image Imagen de entrada.
+     * @param mask Mscara a aplicar.
+     * @return Imagen con la mscara aplicada.
+     */
+    Mat applyMaskToImage(const Mat &image, Mat mask);
+
+    /**
+     * @brief Aplica un filtro de Sobel a la imagen.
+     *
+     * @param image Imagen de entrada.
+     * @param kernelSize Tamao del filtro.
+     * @return Imagen filtrada.
+     */
+    Mat sobelFilter(const Mat &image, uint8_t kernelSize);
+
+    /**
+     * @brief Filtro Sobel en aritmtica entera con los kernels de tamao K generados en compilacin.
+     *
+     * Instanciado para los tamaos impares de 3 a 11 (CodeDetectorFixed.cpp).
+     *
+     * @tparam K Tamao del filtro.
+     * @param image Imagen de entrada en escala de grises (CV_8U).
+     * @return Imagen binaria con los bordes detectados.
+     */
+    template <int K>
+    Mat sobelFilterFixed(const Mat &image);
+
+    /**
+     * @brief Funcin que calcula los bordes de una mscara en lugar de `sobelFilter(image, params.sobelKernelSize)`.
+     */
+    using EdgeFilter = Mat (*)(CCodeDetector &detector, const Mat &image);
+
+    /**
+     * @brief Sustituye el filtro de bordes de `findFilteredContours` (lo usan las variantes especializadas).
+     *
+     * El filtro se descarta si `setParams` cambia `sobelKernelSize` o `fixedPoint`.
+     *
+     * @param filter Filtro de bordes (nullptr para volver a `sobelFilter`).
+     */
+    void setEdgeFilter(EdgeFilter filter);
+
+    /**
+     * @brief Encuentra los contornos filtrados en una imagen.
+     *
+     * @param image Imagen filtrada.
+     * @param referenceArea rea respecto a la que se calculan los umbrales de rea (0 = la de `image`).
+     * @return Contornos encontrados.
+     */
+    std::vector<std::vector<Point>> findFilteredContours(const Mat &image, double referenceArea = 0.0);
+
+    /**
+     * @brief Encuentra los marcadores de una o dos mscaras con una sola pasada de componentes conexas.
+     *
+     * Alternativa a `findFilteredContours` + `extractContourInfo` (`DetectorParams::componentLocator`).
+     *
+     * @param first Gris con la mscara de un color aplicada.
+     * @param second Gris con la mscara del otro color, del mismo tamao (vaca para procesar solo `first`).
+     * @param referenceArea rea respecto a la que se calculan los umbrales de rea (0 = la de `first`).
+     * @param firstInfo Marcadores de `first` (se aaden al final).
+     * @param secondInfo Marcadores de `second` (se aaden al final).
+     */
+    void findComponentMarkers(const Mat &first, const Mat &second, double referenceArea,
+                              std::vector<ContourInfo> &firstInfo, std::vector<ContourInfo> &secondInfo);
+
+    /**
+     * @brief Extrae informacin relevante de los contornos.
+     *
+     * @param contours Contornos encontrados.
+     * @return Informacin de los contornos.
+     */
+    std::vector<ContourInfo> extractContourInfo(const vector<vector<Point>> &contours);
+
+    /**
+     * @brief Empareja los contornos rojos y verdes.
+     *
+     * @param redContoursInfo Informacin de los contornos rojos.
+     * @param greenContoursInfo Informacin de los contornos verdes.
+     * @return Emparejamiento de los contornos rojos y verdes.
+     */
+    std::vector<std::pair<ContourInfo, ContourInfo>> matchContours(const std::vector<ContourInfo> &redContoursInfo,
+                                                                   const std::vector<ContourInfo> &greenContoursInfo);
+
+    /**
+     * @brief Recorta las regiones de inters (bounding boxes) de los contornos emparejados.
+     *
+     * @param matchedContours Contornos emparejados.
+     * @param image Imagen original.
+     * @return Un recorte por pareja, en el mismo orden; vaco si el recorte enderezado se sale de la imagen.
+     */
+    std::vector<Mat> cutBoundingBox(const std::vector<pair<ContourInfo, ContourInfo>> &matchedContours, const Mat &image);
+
+    /**
+     * @brief Obtiene la imagen segmentada con los cdigos decodificados.
+     *
+     * @param imagen Imagen original.
+     * @return Imagen segmentada con cdigos decodificados.
+     */
+    Mat getSegmentedImage(const Mat &imagen);
+
+    /**
+     * @brief Genera las anotaciones (bounding boxes y textos) de los cdigos decodificados, sin dibujarlas.
+     *
+     * @param codes Cdigos devueltos por `detect`.
+     * @return Overlay en coordenadas de la imagen original.
+     */
+    FrameOverlay buildOverlay(const std::vector<DecodedCode> &codes) const;
+
+    /**
+     * @brief Genera un overlay que muestra solo los pxeles activos de una mscara.
+     *
+     * @param mask Mscara de la imagen completa (p. ej. la de `getRedMask`).
+     * @return Overlay con la mscara como regin visible.
+     */
+    FrameOverlay buildMaskOverlay(const Mat &mask) const;
+
+    /// Funciones de procesamiento de imagen
+    /**
+     * @brief Aplica un umbral a la imagen para binarizarla.
+     *
+     * @param image Imagen de entrada.
+     * @param threshold Valor del umbral.
+     * @return Imagen binarizada.
+     */
+    Mat thresholdImage(const Mat &image, int threshold = 2);
+
+    /**
+     * @brief Clasifica los contornos en categoras segn su posicin en la imagen.
+     *
+     * @param contours Contornos encontrados.
+     * @param imageShape Tamao de la imagen.
+     * @return Pareja de contornos clasificados.
+     */
+    pair<std::vector<std::vector<Point>>, std::vector<std::vector<Point>>> classifyContours(
+        const std::vector<std::vector<Point>> &contours, const Size &imageShape);
+
+    /**
+     * @brief Filtra los contornos que estn dentro de la imagen.
+     *
+     * @param contours Contornos encontrados.
+     * @return Contornos filtrados.
+     */
+    std::vector<std::vector<Point>> filterInsideContours(const std::vector<std::vector<Point>> &contours);
+
+    /**
+     * @brief Obtiene los contornos de una imagen binarizada.
+     *
+     * @param thresholdedImage Imagen binarizada.
+     * @param image Imagen original.
+     * @return Contornos encontrados.
+     */
+    std::vector<std::vector<Point>> getContours(const Mat &thresholdedImage, const Mat &image);
+
+    /**
+     * @brief Separa los contornos en segmentos segn su posicin.
+     *
+     * @param contours Contornos encontrados.
+     * @param imageWidth Ancho de la imagen.
+     * @return Contornos segmentados.
+     */
+    std::vector<std::vector<std::vector<Point>>> separateContoursBySegments(const std::vector<std::vector<Point>> &contours, int imageWidth);
+
+    /**
+     * @brief Ordena los contornos dentro de cada segmento.
+     *
+     * @param segments Segmentos de contornos.
+     * @return Segmentos con los contornos ordenados.
+     */
+    std::vector<std::vector<std::vector<Point>>> orderContours(const std::vector<std::vector<std::vector<Point>>> &segments);
+
+    /**
+     * @brief Obtiene la relacin de reas de los contornos con respecto a la imagen.
+     *
+     * @param contours Contornos encontrados.
+     * @param image Imagen original.
+     * @return Relacin de reas.
+     */
+    std::vector<double> getAreaRatio(const std::vector<std::vector<Point>> &contours, const Mat &image);
+
+    /**
+     * @brief Obtiene la informacin detallada de los segmentos de contornos ordenados.
+     *
+     * @param orderedSegments Segmentos de contornos ordenados.
+     * @param image Imagen original.
+     * @return Informacin de los segmentos.
+     */
+    std::vector<SegmentInfo> getSegmentInfo(const std::vector<std::vector<std::vector<Point>>> &orderedSegments, const Mat &image);
+
+    /**
+     * @brief Decodifica el nmero representado por los segmentos de contornos.
+     *
+     * @param segmentInfo Informacin de los segmentos.
+     * @return Nmero decodificado como cadena de caracteres.
+     */
+    std::string decodeNumber(const std::vector<SegmentInfo> &segmentInfo);
+
+    /**
+     * @brief Calcula la confianza de cada dgito decodificado por `decodeNumber`.
+     *
+     * @param segmentInfo Informacin de los segmentos.
+     * @return Confianza [0, 1] de cada uno de los 4 dgitos.
+     */
+    std::vector<double> getDigitConfidences(const std::vector<SegmentInfo> &segmentInfo);
+
+    /**
+     * @brief Obtiene la informacin de los segmentos con perfiles de proyeccin, sin buscar contornos.
+     *
+     * Alternativa a `thresholdImage` + `getContours` + `getSegmentInfo` (`DetectorParams::scanlineDecoder`).
+     *
+     * @param grayCrop Recorte en escala de grises (ya desenfocado).
+     * @return Informacin de los 4 segmentos, con el mismo significado que la de `getSegmentInfo`.
+     */
+    std::vector<SegmentInfo> getScanlineSegmentInfo(const Mat &grayCrop);
+
+private:
+    DetectorParams params; /**< Parmetros del pipeline */
+    DetectorStageMetrics stageMetrics; /**< Histogramas de duracin de las etapas */
+    DetectorBatchBuffers batchBuffers; /**< Imgenes intermedias de `detectBatch` */
+    std::shared_ptr<const CColorLut> colorLut; /**< Tabla de colores de los rangos actuales (solo con `params.colorLut`) */
+    EdgeFilter edgeFilter = nullptr; /**< Filtro de bordes especializado (nullptr: `sobelFilter` con los parmetros) */
+
+    /**
+     * @brief Construye la tabla de colores si `params.colorLut` est activado y los rangos han cambiado (o la libera).
+     */
+    void updateColorLut();
+
+    /**
+     * @brief Decodifica un cdigo recortado (etapas de decodificacin de `decodeMarkers` para un recorte).
+     *
+     * @param crop Recorte BGR enderezado del cdigo.
+     * @param code Cdigo decodificado.
+     * @param confidences Confianza de cada dgito.
+     */
+    void decodeCrop(const Mat &crop, std::string &code, std::vector<double> &confidences);
+
+    /**
+     * @brief Encuentra los marcadores de un color en una regin (la mitad de `findMarkers`).
+     *
+     * @param masked Gris de la regin con la mscara del color aplicada (se anula fuera de las ROI).
+     * @param region Regin de la imagen original.
+     * @param frameSize Tamao de la imagen original.
+     * @param scale Escala de la mscara respecto a la imagen original.
+     * @param info Marcadores encontrados, en coordenadas de la imagen original (se aaden al final).
+     */
+    void findColorMarkers(Mat &masked, const Rect &region, Size frameSize, double scale, std::vector<ContourInfo> &info);
+
+    /**
+     * @brief Anula los pxeles de una mscara que quedan fuera de las ROI.
+     *
+     * @param masked Gris de la regin con la mscara aplicada.
+     * @param region Regin de la imagen original.
+     * @param frameSize Tamao de la imagen original.
+     * @param scale Escala de la mscara respecto a la imagen original.
+     * @return rea de referencia de los umbrales de rea (la de la imagen completa a la escala de la mscara;
+     *         0 sin ROI, para usar la de la mscara).
+     */
+    double clipToRois(Mat &masked, const Rect &region, Size frameSize, double scale) const;
+
+    /**
+     * @brief Lleva unos marcadores a la resolucin y a las coordenadas de la imagen original y los aade a `info`.
+     */
+    void addMarkers(std::vector<ContourInfo> &markers, const Rect &region, double scale, std::vector<ContourInfo> &info);
+
+    /**
+     * @brief Construye los resultados de un fotograma a partir de sus parejas de marcadores y sus cdigos.
+     *
+     * @param matchedContours Parejas de marcadores.
+     * @param decodedCodes Cdigo de cada pareja (puede tener menos elementos; las que faltan son "X").
+     * @param decodedConfidences Confianzas de los dgitos de cada pareja.
+     * @return Cdigos decodificados.
+     */
+    std::vector<DecodedCode> buildDecodedCodes(const std::vector<std::pair<ContourInfo, ContourInfo>> &matchedContours,
+                                               const std::vector<std::string> &decodedCodes,
+                                               const std::vector<std::vector<double>> &decodedConfidences) const;
+
+    /**
+     * @brief Reescala y desplaza la informacin geomtrica de un contorno.
+     *
+     * Se utiliza para llevar a la resolucin y a las coordenadas de la imagen original los contornos
+     * localizados sobre la imagen reducida o sobre una regin.
+     *
+     * @param info Informacin del contorno.
+     * @param factor Factor de escala a aplicar.
+     * @param offset Desplazamiento que se suma despus de escalar.
+     * @return Informacin del contorno reescalada.
+     */
+    ContourInfo scaleContourInfo(const ContourInfo &info, double factor, Point offset = Point());
+
+    /// Variantes en aritmtica entera (punto fijo), usadas cuando `params.fixedPoint` est activo
+    /**
+     * @brief Filtro Sobel con kernels enteros y magnitud aproximada, sin imgenes en coma flotante.
+     *
+     * @param image Imagen de entrada en escala de grises (CV_8U).
+     * @param kernelSize Tamao del filtro.
+     * @return Imagen binaria con los bordes detectados.
+     */
+    Mat sobelFilterFixed(const Mat &image, uint8_t kernelSize);
+
+    /**
+     * @brief Extrae la informacin de los contornos con rea, permetro, esquinas y ngulo enteros.
+     *
+     * @param contours Contornos encontrados.
+     * @return Informacin de los contornos.
+     */
+    std::vector<ContourInfo> extractContourInfoFixed(const std::vector<std::vector<Point>> &contours);
+
+    /**
+     * @brief Empareja los contornos rojos y verdes comparando distancias al cuadrado en enteros.
+     *
+     * @param redContoursInfo Informacin de los contornos rojos.
+     * @param greenContoursInfo Informacin de los contornos verdes.
+     * @return Emparejamiento de los contornos rojos y verdes.
+     */
+    std::vector<std::pair<ContourInfo, ContourInfo>> matchContoursFixed(const std::vector<ContourInfo> &redContoursInfo,
+                                                                        const std::vector<ContourInfo> &greenContoursInfo);
+
+    /**
+     * @brief Recorta y endereza cada cdigo con una rotacin en punto fijo, sin trigonometra.
+     *
+     * @param matchedContours Contornos emparejados.
+     * @param image Imagen original.
+     * @return Imgenes recortadas.
+     */
+    std::vector<Mat> cutBoundingBoxFixed(const std::vector<pair<ContourInfo, ContourInfo>> &matchedContours, const Mat &image);
+};
@@ -0,0 +1,173 @@
+#include "CodeDetector.h"
+
+/**
+ * @file CodeDetectorBatch.cpp
+ * @brief Procesamiento por lotes de `CCodeDetector` para el reprocesado offline.
+ *
+ * `detect` ejecuta todas las etapas para un fotograma antes de pasar al siguiente. `detectBatch` ejecuta
+ * cada etapa para todo el lote (todos los desenfoques, despus todas las conversiones a HSV, etc.), de
+ * modo que el trabajo de cada etapa se reparte entre los hilos de OpenCV con `parallel_for_` y las imgenes
+ * intermedias se reutilizan entre lotes (`DetectorBatchBuffers`). Las etapas son las mismas que en
+ * `locateMarkers` y `decodeMarkers`, por lo que el resultado es idntico al de `detect`.
+ */
+
+/**
+ * @brief Redimensiona un vector de imgenes intermedias sin liberar las que ya tiene.
+ *
+ * @param buffers Vector de imgenes.
+ * @param count Nmero de imgenes necesarias.
+ */
+static void reserveBuffers(std::vector<Mat> &buffers, size_t count) {
+    if (buffers.size() < count) {
+        buffers.resize(count);
+    }
+}
+
+
+/**
+ * @brief Localiza y decodifica los cdigos de un lote de fotogramas, etapa a etapa.
+ *
+ * @param frames Fotogramas BGR.
+ *
+ * @return std::vector<std::vector<DecodedCode>> Los cdigos de cada fotograma, en el orden de `frames`.
+ */
+std::vector<std::vector<DecodedCode>> CCodeDetector::detectBatch(const std::vector<Mat> &frames) {
+    // Paso 1: Lista de trabajos de localizacin: una regin de un fotograma por trabajo (un trabajo por
+    // fotograma si no hay ROI configuradas)
+    struct LocateJob {
+        size_t frame;   /**< ndice del fotograma en el lote */
+        Rect region;    /**< Regin del fotograma */
+    };
+    std::vector<LocateJob> jobs;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        for (const Rect &region : getProcessingRegions(frames[f].size())) {
+            jobs.push_back({ f, region });
+        }
+    }
+    const int numJobs = static_cast<int>( jobs.size() );
+
+    double scale = params.pyramidScale;
+    if (scale <= 0 || scale >= 1.0) {
+        scale = 1.0;
+    }
+
+    DetectorBatchBuffers &buffers = batchBuffers;
+    for (std::vector<Mat> *buffer : { &buffers.locate, &buffers.blurred, &buffers.hsv, &buffers.gray, &buffers.redMask,
+                                      &buffers.redMask2, &buffers.greenMask, &buffers.redMasked, &buffers.greenMasked }) {
+        reserveBuffers(*buffer, jobs.size());
+    }
+
+    // Paso 2: Reducir cada regin a la escala de localizacin y desenfocarla
+    parallel_for_(Range(0, numJobs), [&](const Range &range) {
+        for (int j = range.start; j < range.end; ++j) {
+            const Mat region = frames[jobs[j].frame](jobs[j].region);
+            const Mat *source = &region;
+            if (scale != 1.0) {
+                resize(region, buffers.locate[j], Size(), scale, scale, params.fixedPoint ? INTER_LINEAR_EXACT : INTER_AREA);
+                source = &buffers.locate[j];
+            }
+            GaussianBlur(*source, buffers.blurred[j], Size(params.blurKernelSize, params.blurKernelSize), 0);
+        }
+    });
+
+    // Paso 3: Convertir a HSV (salvo con la tabla de colores, que clasifica directamente en BGR) y a gris
+    parallel_for_(Range(0, numJobs), [&](const Range &range) {
+        for (int j = range.start; j < range.end; ++j) {
+            if (!colorLut) {
+                cvtColor(buffers.blurred[j], buffers.hsv[j], COLOR_BGR2HSV);
+            }
+            cvtColor(buffers.blurred[j], buffers.gray[j], COLOR_BGR2GRAY);
+        }
+    });
+
+    if (colorLut) {
+        // Pasos 4 y 5: Mscaras de la tabla de colores aplicadas sobre el gris en una sola pasada
+        parallel_for_(Range(0, numJobs), [&](const Range &range) {
+            for (int j = range.start; j < range.end; ++j) {
+                colorLut->maskedGrayImages(buffers.blurred[j], buffers.gray[j], buffers.redMasked[j], buffers.greenMasked[j]);
+            }
+        });
+    }
+    else {
+        // Paso 4: Mscaras de color (los mismos rangos que `getRedMask` y `getGreenMask`)
+        parallel_for_(Range(0, numJobs), [&](const Range &range) {
+            for (int j = range.start; j < range.end; ++j) {
+                inRange(buffers.hsv[j], params.redLow1, params.redHigh1, buffers.redMask[j]);
+                inRange(buffers.hsv[j], params.redLow2, params.redHigh2, buffers.redMask2[j]);
+                bitwise_or(buffers.redMask[j], buffers.redMask2[j], buffers.redMask[j]);
+                inRange(buffers.hsv[j], params.greenLow, params.greenHigh, buffers.greenMask[j]);
+            }
+        });
+
+        // Paso 5: Aplicar las mscaras sobre el gris. Como las mscaras valen 0 o 255, el AND bit a bit da el
+        // mismo resultado que `applyMaskToImage` y reutiliza la imagen de salida
+        parallel_for_(Range(0, numJobs), [&](const Range &range) {
+            for (int j = range.start; j < range.end; ++j) {
+                bitwise_and(buffers.gray[j], buffers.redMask[j], buffers.redMasked[j]);
+                bitwise_and(buffers.gray[j], buffers.greenMask[j], buffers.greenMasked[j]);
+            }
+        });
+    }
+
+    // Paso 6: Marcadores de cada regin, en coordenadas de su fotograma
+    std::vector<std::vector<ContourInfo>> redInfo(jobs.size());
+    std::vector<std::vector<ContourInfo>> greenInfo(jobs.size());
+    parallel_for_(Range(0, numJobs), [&](const Range &range) {
+        for (int j = range.start; j < range.end; ++j) {
+            findMarkers(buffers.redMasked[j], buffers.greenMasked[j], jobs[j].region, frames[jobs[j].frame].size(), scale,
+                        redInfo[j], greenInfo[j]);
+        }
+    });
+
+    // Paso 7: Reunir los marcadores de las regiones de cada fotograma (en el orden de `locateMarkers`) y emparejarlos
+    std::vector<std::vector<ContourInfo>> frameRed(frames.size());
+    std::vector<std::vector<ContourInfo>> frameGreen(frames.size());
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        std::vector<ContourInfo> &red = frameRed[jobs[j].frame];
+        std::vector<ContourInfo> &green = frameGreen[jobs[j].frame];
+        red.insert(red.end(), redInfo[j].begin(), redInfo[j].end());
+        green.insert(green.end(), greenInfo[j].begin(), greenInfo[j].end());
+    }
+    std::vector<std::vector<std::pair<ContourInfo, ContourInfo>>> matches(frames.size());
+    parallel_for_(Range(0, static_cast<int>( frames.size() )), [&](const Range &range) {
+        for (int f = range.start; f < range.end; ++f) {
+            matches[f] = matchContours(frameRed[f], frameGreen[f]);
+        }
+    });
+
+    // Paso 8: Recortar los cdigos de cada fotograma
+    std::vector<std::vector<Mat>> crops(frames.size());
+    parallel_for_(Range(0, static_cast<int>( frames.size() )), [&](const Range &range) {
+        for (int f = range.start; f < range.end; ++f) {
+            crops[f] = cutBoundingBox(matches[f], frames[f]);
+        }
+    });
+
+    // Paso 9: Decodificar todos los recortes del lote, repartidos entre los hilos
+    std::vector<std::pair<size_t, size_t>> cropIndex;
+    for (size_t f = 0; f < crops.size(); ++f) {
+        for (size_t c = 0; c < crops[f].size(); ++c) {
+            cropIndex.push_back({ f, c });
+        }
+    }
+    std::vector<std::vector<std::string>> codes(frames.size());
+    std::vector<std::vector<std::vector<double>>> confidences(frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+        codes[f].resize(crops[f].size());
+        confidences[f].resize(crops[f].size());
+    }
+    parallel_for_(Range(0, static_cast<int>( cropIndex.size() )), [&](const Range &range) {
+        for (int k = range.start; k < range.end; ++k) {
+            size_t f = cropIndex[k].first;
+            size_t c = cropIndex[k].second;
+            decodeCrop(crops[f][c], codes[f][c], confidences[f][c]);
+        }
+    });
+
+    // Paso 10: Construir los resultados de cada fotograma
+    std::vector<std::vector<DecodedCode>> results(frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+        results[f] = buildDecodedCodes(matches[f], codes[f], confidences[f]);
+    }
+    return results;
+}
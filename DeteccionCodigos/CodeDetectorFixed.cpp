@@ -0,0 +1,609 @@
+#include "CodeDetector.h"
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @file CodeDetectorFixed.cpp
+ * @brief Variante en aritmtica entera (punto fijo) de la localizacin y el recorte de cdigos.
+ *
+ * Se activa con `DetectorParams::fixedPoint` y sustituye las etapas que trabajan en coma flotante (Sobel
+ * en CV_64F, `arcLength`/`minAreaRect`, distancias y ngulos en `double` y la matriz de
+ * `getRotationMatrix2D`) por equivalentes enteros. El resto de etapas ya son enteras en OpenCV para
+ * imgenes de 8 bits (conversin de color, desenfoque gaussiano, umbral adaptativo, morfologa y
+ * contornos) y no cambian. Los resultados se guardan en las mismas estructuras para mantener la API.
+ */
+
+static const int FIXED_BITS = 8;        /**< Bits fraccionarios de longitudes y ngulos (Q8) */
+static const int ROTATION_BITS = 14;    /**< Bits fraccionarios de los coeficientes de rotacin (Q14) */
+
+/**
+ * @struct FixedContour
+ * @brief Magnitudes de un contorno en enteros, para el emparejamiento.
+ */
+struct FixedContour {
+    int64_t centerX2;       /**< Centro X en Q1 (el centro del rectngulo delimitador es mltiplo de 0.5) */
+    int64_t centerY2;       /**< Centro Y en Q1 */
+    int64_t doubleArea;     /**< Doble del rea */
+    int64_t perimeter;      /**< Permetro en Q8 */
+    int64_t angle;          /**< ngulo en grados, en Q8 */
+};
+
+
+/**
+ * @brief Raz cuadrada entera (redondeada hacia abajo), calculada bit a bit.
+ *
+ * @param value Valor.
+ * @return uint64_t floor(sqrt(value)).
+ */
+static uint64_t isqrt(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = uint64_t(1) << 62;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = ( result >> 1 ) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+
+/**
+ * @brief Longitud de un vector entero en Q8.
+ *
+ * @param dx Componente X.
+ * @param dy Componente Y.
+ * @return int64_t Longitud multiplicada por 256.
+ */
+static int64_t lengthQ8(int64_t dx, int64_t dy) {
+    return static_cast<int64_t>( isqrt(static_cast<uint64_t>( dx * dx + dy * dy ) << ( 2 * FIXED_BITS )) );
+}
+
+
+/**
+ * @brief ngulo de la recta que sigue un vector, en grados (Q8) dentro de (0, 90] como el de `minAreaRect`.
+ *
+ * El vector se gira 90 grados hasta dejarlo en el primer cuadrante y se aproxima
+ * atan(z) ~ 45z + 15.66z(1 - z) con z en Q15 (error mximo de unas 0.25 grados).
+ *
+ * @param dx Componente X.
+ * @param dy Componente Y.
+ * @return int64_t ngulo en Q8.
+ */
+static int64_t lineAngleQ8(int64_t dx, int64_t dy) {
+    // Paso 1: Llevar el vector al primer cuadrante (x > 0, y >= 0)
+    for (int i = 0; i < 4 && !( dx > 0 && dy >= 0 ); ++i) {
+        int64_t previousX = dx;
+        dx = dy;
+        dy = -previousX;
+    }
+    if (dx <= 0) {
+        return 90 << FIXED_BITS;
+    }
+
+    // Paso 2: Reducir al primer octante (z <= 1) y aproximar el arcotangente
+    bool swapped = dy > dx;
+    if (swapped) {
+        std::swap(dx, dy);
+    }
+    const int64_t one = int64_t(1) << 15;
+    int64_t z = ( dy << 15 ) / dx;
+    int64_t angle = ( ( 45 << FIXED_BITS ) * z + ( ( 4009 * z ) >> 15 ) * ( one - z ) ) >> 15;
+    if (swapped) {
+        angle = ( 90 << FIXED_BITS ) - angle;
+    }
+    return angle == 0 ? ( 90 << FIXED_BITS ) : angle;
+}
+
+
+/**
+ * @brief Doble del rea de un polgono (frmula del lazo), en valor absoluto.
+ *
+ * @param points Vrtices del polgono.
+ * @return int64_t Doble del rea.
+ */
+static int64_t doublePolygonArea(const std::vector<Point> &points) {
+    int64_t area = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Point &p = points[i];
+        const Point &q = points[( i + 1 ) % points.size()];
+        area += int64_t(p.x) * q.y - int64_t(q.x) * p.y;
+    }
+    return area < 0 ? -area : area;
+}
+
+
+/**
+ * @brief Kernel entero de Sobel de una dimensin, con los mismos coeficientes que usa OpenCV.
+ *
+ * @param kernelSize Tamao del filtro.
+ * @param derivative true para el kernel de derivada, false para el de suavizado.
+ * @return std::vector<int> Coeficientes.
+ */
+static std::vector<int> sobelKernel(int kernelSize, bool derivative) {
+    // Suavizado: binomial de orden ksize - 1. Derivada: binomial de orden ksize - 3 convolucionada con [-1, 0, 1]
+    std::vector<int> kernel{ 1 };
+    int order = derivative ? std::max(kernelSize, 3) - 3 : std::max(kernelSize, 1) - 1;
+    for (int i = 0; i < order; ++i) {
+        std::vector<int> next(kernel.size() + 1, 0);
+        for (size_t k = 0; k < kernel.size(); ++k) {
+            next[k] += kernel[k];
+            next[k + 1] += kernel[k];
+        }
+        kernel = next;
+    }
+    if (derivative) {
+        std::vector<int> next(kernel.size() + 2, 0);
+        for (size_t k = 0; k < kernel.size(); ++k) {
+            next[k] -= kernel[k];
+            next[k + 2] += kernel[k];
+        }
+        kernel = next;
+    }
+    return kernel;
+}
+
+
+/**
+ * @brief Kernel de suavizado de Sobel de tamao fijo (binomial), calculado en compilacin.
+ *
+ * @return std::array<int, K> Coeficientes.
+ */
+template <int K>
+static constexpr std::array<int, K> binomialKernel() {
+    std::array<int, K> kernel{};
+    kernel[0] = 1;
+    for (int n = 1; n < K; ++n) {
+        for (int k = n; k > 0; --k) {
+            kernel[k] += kernel[k - 1];
+        }
+    }
+    return kernel;
+}
+
+
+/**
+ * @brief Kernel de derivada de Sobel de tamao fijo (K >= 3), calculado en compilacin.
+ *
+ * @return std::array<int, K> Coeficientes.
+ */
+template <int K>
+static constexpr std::array<int, K> derivativeKernel() {
+    std::array<int, K - 2> smoothing = binomialKernel<K - 2>();
+    std::array<int, K> kernel{};
+    for (int k = 0; k < K - 2; ++k) {
+        kernel[k] -= smoothing[k];
+        kernel[k + 2] += smoothing[k];
+    }
+    return kernel;
+}
+
+
+/**
+ * @brief Filtro separable entero (8 bits -> 32 bits) sobre una imagen con el borde ya aadido.
+ *
+ * Con kernels `std::array` el nmero de coeficientes es constante y el compilador desenrolla el bucle
+ * de coeficientes y vectoriza el de pxeles; con `std::vector` se usa el mismo cdigo con tamao variable.
+ *
+ * @param padded Imagen CV_8UC1 con `border` pxeles de borde por cada lado.
+ * @param border Ancho del borde.
+ * @param kernelX Kernel horizontal.
+ * @param kernelY Kernel vertical.
+ * @param shift Bits que se descartan tras el filtrado horizontal para evitar desbordamientos.
+ * @return Mat Resultado CV_32SC1 del tamao de la imagen sin borde.
+ */
+template <class KernelX, class KernelY>
+static Mat separableFilter32S(const Mat &padded, int border, const KernelX &kernelX, const KernelY &kernelY, int shift) {
+    int rows = padded.rows - 2 * border;
+    int cols = padded.cols - 2 * border;
+    int offsetX = border - static_cast<int>( kernelX.size() / 2 );
+    int offsetY = border - static_cast<int>( kernelY.size() / 2 );
+
+    // Paso 1: Filtrar por filas todas las filas, incluidas las del borde que necesita el filtrado vertical.
+    // El bucle interno recorre la fila para que el compilador lo vectorice.
+    Mat rowPass(padded.rows, cols, CV_32S, Scalar(0));
+    for (int y = 0; y < padded.rows; ++y) {
+        const uchar *src = padded.ptr<uchar>(y) + offsetX;
+        int *dst = rowPass.ptr<int>(y);
+        for (size_t k = 0; k < kernelX.size(); ++k) {
+            const int coefficient = kernelX[k];
+            if (coefficient == 0) {
+                continue;
+            }
+            for (int x = 0; x < cols; ++x) {
+                dst[x] += coefficient * src[x + k];
+            }
+        }
+        if (shift > 0) {
+            for (int x = 0; x < cols; ++x) {
+                dst[x] >>= shift;
+            }
+        }
+    }
+
+    // Paso 2: Filtrar por columnas acumulando filas completas
+    Mat result(rows, cols, CV_32S, Scalar(0));
+    for (int y = 0; y < rows; ++y) {
+        int *dst = result.ptr<int>(y);
+        for (size_t k = 0; k < kernelY.size(); ++k) {
+            const int coefficient = kernelY[k];
+            if (coefficient == 0) {
+                continue;
+            }
+            const int *src = rowPass.ptr<int>(y + offsetY + static_cast<int>( k ));
+            for (int x = 0; x < cols; ++x) {
+                dst[x] += coefficient * src[x];
+            }
+        }
+    }
+    return result;
+}
+
+
+/**
+ * @brief Pasa a enteros las magnitudes de un contorno que usa el emparejamiento.
+ *
+ * @param info Informacin del contorno.
+ * @return FixedContour Magnitudes en punto fijo.
+ */
+static FixedContour toFixedContour(const ContourInfo &info) {
+    FixedContour fixed;
+    fixed.centerX2 = cvRound(info.center.x * 2);
+    fixed.centerY2 = cvRound(info.center.y * 2);
+    fixed.doubleArea = cvRound(info.area * 2);
+    fixed.perimeter = cvRound(info.perimeter * ( 1 << FIXED_BITS ));
+    fixed.angle = cvRound(info.angle * ( 1 << FIXED_BITS ));
+    return fixed;
+}
+
+
+/**
+ * @brief Filtro Sobel entero con unos kernels dados (ver `CCodeDetector::sobelFilterFixed`).
+ *
+ * @param image Imagen en escala de grises (CV_8UC1).
+ * @param derivative Kernel de derivada.
+ * @param smoothing Kernel de suavizado.
+ * @param threshold Umbral sobre la magnitud normalizada a [0, 255].
+ * @return Mat Imagen binaria con los bordes detectados.
+ */
+template <class DerivativeKernel, class SmoothingKernel>
+static Mat fixedSobel(const Mat &image, const DerivativeKernel &derivative, const SmoothingKernel &smoothing, int threshold) {
+    // Paso 1: Con kernels grandes (ms de 11) se descartan bits tras el filtrado horizontal para que la
+    // magnitud quepa en 32 bits
+    int64_t derivativeSum = 0, smoothingSum = 0;
+    for (int c : derivative) derivativeSum += std::abs(c);
+    for (int c : smoothing) smoothingSum += std::abs(c);
+    int shift = 0;
+    while (( ( 255 * std::max(derivativeSum, smoothingSum) ) >> shift ) * std::max(derivativeSum, smoothingSum) * 11 / 8 >
+           std::numeric_limits<int32_t>::max()) {
+        shift++;
+    }
+
+    // Paso 2: Aadir el borde reflejado, el mismo que usa Sobel por defecto
+    int border = static_cast<int>( std::max(derivative.size(), smoothing.size()) / 2 );
+    Mat padded;
+    copyMakeBorder(image, padded, border, border, border, border, BORDER_REFLECT_101);
+
+    // Paso 3: Gradientes horizontal y vertical
+    Mat gradX = separableFilter32S(padded, border, derivative, smoothing, shift);
+    Mat gradY = separableFilter32S(padded, border, smoothing, derivative, shift);
+
+    // Paso 4: Magnitud aproximada, guardando su mnimo y su mximo para la normalizacin
+    Mat magnitudeImage(image.size(), CV_32S);
+    int minValue = std::numeric_limits<int>::max();
+    int maxValue = 0;
+    for (int y = 0; y < image.rows; ++y) {
+        const int *gx = gradX.ptr<int>(y);
+        const int *gy = gradY.ptr<int>(y);
+        int *mag = magnitudeImage.ptr<int>(y);
+        for (int x = 0; x < image.cols; ++x) {
+            int a = std::abs(gx[x]);
+            int b = std::abs(gy[x]);
+            mag[x] = std::max(a, b) + ( ( std::min(a, b) * 3 ) >> 3 );
+            minValue = std::min(minValue, mag[x]);
+            maxValue = std::max(maxValue, mag[x]);
+        }
+    }
+
+    // Paso 5: Normalizar y umbralizar en una sola comparacin entera:
+    // round((v - min) * 255 / (max - min)) > umbral  <=>  (v - min) * 510 >= (2 * umbral + 1) * (max - min)
+    Mat filtered_image(image.size(), CV_8U, Scalar(0));
+    int64_t range = static_cast<int64_t>( maxValue ) - minValue;
+    if (range > 0) {
+        int64_t limit = ( 2 * static_cast<int64_t>( threshold ) + 1 ) * range;
+        for (int y = 0; y < image.rows; ++y) {
+            const int *mag = magnitudeImage.ptr<int>(y);
+            uchar *dst = filtered_image.ptr<uchar>(y);
+            for (int x = 0; x < image.cols; ++x) {
+                dst[x] = ( static_cast<int64_t>( mag[x] - minValue ) * 510 >= limit ) ? 255 : 0;
+            }
+        }
+    }
+
+    return filtered_image;
+}
+
+
+/**
+ * @brief Filtro Sobel entero con los kernels de tamao K generados en compilacin.
+ *
+ * @param image Imagen en escala de grises (CV_8UC1).
+ * @param threshold Umbral sobre la magnitud normalizada a [0, 255].
+ * @return Mat Imagen binaria con los bordes detectados.
+ */
+template <int K>
+static Mat fixedSobelK(const Mat &image, int threshold) {
+    static constexpr std::array<int, K> derivative = derivativeKernel<K>();
+    static constexpr std::array<int, K> smoothing = binomialKernel<K>();
+    return fixedSobel(image, derivative, smoothing, threshold);
+}
+
+
+/**
+ * @brief Filtro Sobel en aritmtica entera.
+ *
+ * Calcula los gradientes con los kernels enteros de Sobel en CV_32S, aproxima la magnitud como
+ * max + 3/8 min (error inferior al 7% frente a la norma L2) y combina la normalizacin a [0, 255] y el
+ * umbral binario en una comparacin entera, sin divisiones por pxel. Los tamaos de kernel impares de
+ * 3 a 11 usan kernels generados en compilacin (bucles desenrollados); el resto, kernels calculados al vuelo.
+ *
+ * @param image Imagen en escala de grises (CV_8UC1), como la que recibe `findFilteredContours`.
+ * @param kernelSize Tamao del kernel de Sobel.
+ *
+ * @return Mat La imagen binaria con los bordes detectados.
+ */
+Mat CCodeDetector::sobelFilterFixed(const Mat &image, uint8_t kernelSize) {
+    switch (kernelSize) {
+        case 3: return sobelFilterFixed<3>(image);
+        case 5: return sobelFilterFixed<5>(image);
+        case 7: return sobelFilterFixed<7>(image);
+        case 9: return sobelFilterFixed<9>(image);
+        case 11: return sobelFilterFixed<11>(image);
+        default: return fixedSobel(image, sobelKernel(kernelSize, true), sobelKernel(kernelSize, false), params.sobelThreshold);
+    }
+}
+
+
+/**
+ * @brief Filtro Sobel en aritmtica entera con los kernels de tamao K generados en compilacin.
+ *
+ * Lo llaman directamente las variantes especializadas (DetectorVariants.h), que fijan K en compilacin.
+ *
+ * @param image Imagen en escala de grises (CV_8UC1).
+ *
+ * @return Mat La imagen binaria con los bordes detectados.
+ */
+template <int K>
+Mat CCodeDetector::sobelFilterFixed(const Mat &image) {
+    return fixedSobelK<K>(image, params.sobelThreshold);
+}
+
+template Mat CCodeDetector::sobelFilterFixed<3>(const Mat &image);
+template Mat CCodeDetector::sobelFilterFixed<5>(const Mat &image);
+template Mat CCodeDetector::sobelFilterFixed<7>(const Mat &image);
+template Mat CCodeDetector::sobelFilterFixed<9>(const Mat &image);
+template Mat CCodeDetector::sobelFilterFixed<11>(const Mat &image);
+
+
+/**
+ * @brief Extrae la informacin de los contornos en aritmtica entera.
+ *
+ * El rea se calcula con la frmula del lazo y el permetro con races enteras en Q8, en una sola
+ * pasada por el contorno. En lugar de `minAreaRect`, las esquinas son los puntos extremos en los ejes
+ * (cuadrado girado) o en las diagonales (cuadrado recto), quedndose con el cuadriltero de mayor rea,
+ * que para un cuadrado son sus cuatro vrtices. El ngulo es el del primer lado de ese cuadriltero.
+ *
+ * @param contours Contornos encontrados.
+ *
+ * @return std::vector<ContourInfo> La informacin de cada contorno.
+ */
+std::vector<ContourInfo> CCodeDetector::extractContourInfoFixed(const std::vector<std::vector<Point>> &contours) {
+    std::vector<ContourInfo> contour_info;
+    contour_info.reserve(contours.size());
+
+    for (const auto &contour : contours) {
+        if (contour.empty()) {
+            continue;
+        }
+        ContourInfo info;
+
+        // Paso 1: rea y permetro en una sola pasada
+        int64_t doubleArea = doublePolygonArea(contour);
+        int64_t perimeter = 0;
+        for (size_t i = 0; i < contour.size(); ++i) {
+            const Point &p = contour[i];
+            const Point &q = contour[( i + 1 ) % contour.size()];
+            perimeter += lengthQ8(q.x - p.x, q.y - p.y);
+        }
+        info.area = static_cast<float>( doubleArea ) / 2;
+        info.perimeter = static_cast<float>( perimeter ) / ( 1 << FIXED_BITS );
+
+        // Paso 2: Puntos extremos en los ejes y en las diagonales
+        Point top = contour[0], right = top, bottom = top, left = top;
+        Point topLeft = top, topRight = top, bottomRight = top, bottomLeft = top;
+        for (const Point &p : contour) {
+            if (p.y < top.y) top = p;
+            if (p.x > right.x) right = p;
+            if (p.y > bottom.y) bottom = p;
+            if (p.x < left.x) left = p;
+            if (p.x + p.y < topLeft.x + topLeft.y) topLeft = p;
+            if (p.x - p.y > topRight.x - topRight.y) topRight = p;
+            if (p.x + p.y > bottomRight.x + bottomRight.y) bottomRight = p;
+            if (p.x - p.y < bottomLeft.x - bottomLeft.y) bottomLeft = p;
+        }
+
+        // Paso 3: Quedarse con el cuadriltero de mayor rea como esquinas
+        std::vector<Point> axisCorners{ top, right, bottom, left };
+        std::vector<Point> diagonalCorners{ topLeft, topRight, bottomRight, bottomLeft };
+        info.corners = doublePolygonArea(axisCorners) >= doublePolygonArea(diagonalCorners) ? axisCorners : diagonalCorners;
+
+        // Paso 4: Centro, dimensiones y relacin de aspecto del rectngulo delimitador, como en la variante flotante
+        Rect boundingBox = boundingRect(contour);
+        info.center = Point2f(( boundingBox.x + boundingBox.width ) / 2.0f,
+                              ( boundingBox.y + boundingBox.height ) / 2.0f);
+        info.width = boundingBox.width;
+        info.height = boundingBox.height;
+        info.aspect_ratio = ( boundingBox.height != 0 ) ? boundingBox.width / static_cast<float>( boundingBox.height ) : 0;
+
+        // Paso 5: ngulo del primer lado del cuadriltero
+        info.angle = static_cast<float>( lineAngleQ8(info.corners[1].x - info.corners[0].x,
+                                                     info.corners[1].y - info.corners[0].y) ) / ( 1 << FIXED_BITS );
+
+        contour_info.push_back(info);
+    }
+
+    return contour_info;
+}
+
+
+/**
+ * @brief Empareja los contornos rojos y verdes en aritmtica entera.
+ *
+ * Aplica los mismos criterios que `matchContours` (distancia entre centros entre permetro/3.5 y
+ * permetro/2.5, menor diferencia de ngulo y desempate por rea y permetro), comparando distancias al
+ * cuadrado en enteros de 64 bits en lugar de calcular races.
+ *
+ * @param redContoursInfo Informacin de los contornos rojos.
+ * @param greenContoursInfo Informacin de los contornos verdes.
+ *
+ * @return std::vector<std::pair<ContourInfo, ContourInfo>> Los pares de contornos emparejados.
+ */
+std::vector<std::pair<ContourInfo, ContourInfo>> CCodeDetector::matchContoursFixed(
+    const std::vector<ContourInfo> &redContoursInfo,
+    const std::vector<ContourInfo> &greenContoursInfo) {
+
+    // Paso 1: Pasar los contornos a enteros una sola vez
+    std::vector<FixedContour> red, green;
+    for (const auto &info : redContoursInfo) red.push_back(toFixedContour(info));
+    for (const auto &info : greenContoursInfo) green.push_back(toFixedContour(info));
+
+    std::vector<std::pair<ContourInfo, ContourInfo>> matches;
+    std::vector<bool> usedGreen(green.size(), false);
+
+    // Paso 2: Buscar el mejor contorno verde libre para cada rojo
+    for (size_t r = 0; r < red.size(); ++r) {
+        int bestMatch = -1;
+        int64_t bestAngleMatch = std::numeric_limits<int64_t>::max();
+        int64_t bestScore = std::numeric_limits<int64_t>::max();
+        int64_t perimeter2 = red[r].perimeter * red[r].perimeter;
+
+        for (size_t g = 0; g < green.size(); ++g) {
+            if (usedGreen[g]) {
+                continue;
+            }
+
+            // Paso 3: Distancia al cuadrado en la escala del permetro: (2d)^2 * 4096 = 16384 d^2 y P^2 = 65536 p^2,
+            // as que d > p/2.5 <=> 25 * distance2 > P^2 y d < p/3.5 <=> 49 * distance2 < P^2
+            int64_t dx = green[g].centerX2 - red[r].centerX2;
+            int64_t dy = green[g].centerY2 - red[r].centerY2;
+            int64_t distance2 = ( dx * dx + dy * dy ) * 4096;
+            if (25 * distance2 > perimeter2 || 49 * distance2 < perimeter2) {
+                continue;
+            }
+
+            // Paso 4: Diferencia de ngulo y desempate por rea y permetro (ambos en Q8)
+            int64_t angleDiff = std::abs(red[r].angle - green[g].angle);
+            int64_t score = std::abs(red[r].doubleArea - green[g].doubleArea) * ( 1 << ( FIXED_BITS - 1 ) ) +
+                            std::abs(red[r].perimeter - green[g].perimeter);
+            if (angleDiff < bestAngleMatch || ( angleDiff == bestAngleMatch && score < bestScore )) {
+                bestAngleMatch = angleDiff;
+                bestScore = score;
+                bestMatch = static_cast<int>( g );
+            }
+        }
+
+        // Paso 5: Guardar la pareja y marcar el verde como usado
+        if (bestMatch >= 0) {
+            matches.emplace_back(redContoursInfo[r], greenContoursInfo[bestMatch]);
+            usedGreen[bestMatch] = true;
+        }
+    }
+
+    return matches;
+}
+
+
+/**
+ * @brief Recorta y endereza cada cdigo con una rotacin en punto fijo.
+ *
+ * El coseno y el seno del ngulo rojo -> verde se obtienen normalizando el vector entre los centros (Q14),
+ * sin `atan2` ni `getRotationMatrix2D`. Las esquinas se giran en enteros y solo se calcula la regin
+ * recortada: `warpAffine` recibe la matriz desplazada a la esquina de la bounding box y el tamao de
+ * esta, en lugar de girar la imagen completa por cada cdigo. En 8 bits, la interpolacin bilineal de
+ * `warpAffine` ya trabaja en punto fijo.
+ *
+ * @param matchedContours Pares de contornos emparejados.
+ * @param image Imagen original.
+ *
+ * @return std::vector<Mat> Un recorte por pareja, con la lnea entre marcadores en horizontal; vaco si se sale
+ *         de la imagen, como en `cutBoundingBox`.
+ */
+std::vector<Mat> CCodeDetector::cutBoundingBoxFixed(const std::vector<pair<ContourInfo, ContourInfo>> &matchedContours, const Mat &image) {
+    std::vector<Mat> extractedImages(matchedContours.size());
+    const int64_t one = int64_t(1) << ROTATION_BITS;
+
+    for (size_t i = 0; i < matchedContours.size(); ++i) {
+        const auto &match = matchedContours[i];
+        const ContourInfo &redContour = match.first;
+        const ContourInfo &greenContour = match.second;
+
+        // Paso 1: Bounding box de las esquinas de ambos marcadores y su centro
+        std::vector<Point> allPoints = redContour.corners;
+        allPoints.insert(allPoints.end(), greenContour.corners.begin(), greenContour.corners.end());
+        Rect boundingBox = boundingRect(allPoints);
+        int64_t cx = boundingBox.x + boundingBox.width / 2;
+        int64_t cy = boundingBox.y + boundingBox.height / 2;
+
+        // Paso 2: Coseno y seno en Q14 a partir del vector entre centros (en Q1)
+        int64_t dx = cvRound(( greenContour.center.x - redContour.center.x ) * 2);
+        int64_t dy = cvRound(( greenContour.center.y - redContour.center.y ) * 2);
+        int64_t length = lengthQ8(dx, dy);
+        int64_t cosine = length > 0 ? dx * ( one << FIXED_BITS ) / length : one;
+        int64_t sine = length > 0 ? dy * ( one << FIXED_BITS ) / length : 0;
+
+        // Paso 3: Traslacin de getRotationMatrix2D(centro, ngulo, 1):
+        // [cos, sin, (1 - cos) cx - sin cy; -sin, cos, sin cx + (1 - cos) cy]
+        int64_t m02 = ( one - cosine ) * cx - sine * cy;
+        int64_t m12 = sine * cx + ( one - cosine ) * cy;
+
+        // Paso 4: Girar las esquinas con redondeo y calcular la nueva bounding box
+        std::vector<Point> transformedPoints;
+        for (const Point &pt : allPoints) {
+            int64_t xNew = cosine * pt.x + sine * pt.y + m02;
+            int64_t yNew = -sine * pt.x + cosine * pt.y + m12;
+            transformedPoints.emplace_back(static_cast<int>( ( xNew + one / 2 ) >> ROTATION_BITS ),
+                                           static_cast<int>( ( yNew + one / 2 ) >> ROTATION_BITS ));
+        }
+        Rect transformedBoundingBox = boundingRect(transformedPoints);
+
+        // Paso 5: Dejar vaco el recorte si queda fuera de la imagen girada, igual que la variante flotante
+        if (transformedBoundingBox.x < 0 || transformedBoundingBox.y < 0 ||
+            transformedBoundingBox.x + transformedBoundingBox.width > image.cols ||
+            transformedBoundingBox.y + transformedBoundingBox.height > image.rows) {
+            if (stageMetrics.outOfBoundsCrops) {
+                stageMetrics.outOfBoundsCrops->inc();
+            }
+            continue;
+        }
+
+        // Paso 6: Girar solo la regin recortada
+        Mat M(2, 3, CV_64F);
+        M.at<double>(0, 0) = static_cast<double>( cosine ) / one;
+        M.at<double>(0, 1) = static_cast<double>( sine ) / one;
+        M.at<double>(0, 2) = static_cast<double>( m02 ) / one - transformedBoundingBox.x;
+        M.at<double>(1, 0) = -static_cast<double>( sine ) / one;
+        M.at<double>(1, 1) = static_cast<double>( cosine ) / one;
+        M.at<double>(1, 2) = static_cast<double>( m12 ) / one - transformedBoundingBox.y;
+        warpAffine(image, extractedImages[i], M, transformedBoundingBox.size());
+    }
+
+    return extractedImages;
+}
@@ -0,0 +1,149 @@
+#include "CodeDetector.h"
+#include "TaskScheduler.h"
+#include <atomic>
+
+/**
+ * @file CodeDetectorTasks.cpp
+ * @brief Deteccin de varios fotogramas como tareas de `CTaskScheduler`.
+ *
+ * El grafo de tareas de cada fotograma es:
+ *
+ *     mscaras (una por regin) -> contornos rojos + contornos verdes (una tarea por color y regin)
+ *         -> emparejamiento (cuando terminan todas las bsquedas del fotograma)
+ *             -> recorte y decodificacin (una tarea por candidato)
+ *
+ * Cada tarea escribe en su propia posicin de los vectores del fotograma, por lo que el orden de los
+ * resultados no depende del orden en que se ejecuten las tareas: las regiones se renen en el orden de
+ * `getProcessingRegions` y los candidatos en el de `matchContours`, igual que en `detect`.
+ */
+
+/**
+ * @brief Estado de una regin durante la deteccin con tareas.
+ */
+struct RegionTask {
+    size_t frame = 0;                 /**< ndice del fotograma */
+    Rect region;                      /**< Regin del fotograma */
+    Mat redMasked;                    /**< Gris con la mscara roja aplicada */
+    Mat greenMasked;                  /**< Gris con la mscara verde aplicada */
+    std::vector<ContourInfo> red;     /**< Marcadores rojos de la regin */
+    std::vector<ContourInfo> green;   /**< Marcadores verdes de la regin */
+};
+
+/**
+ * @brief Estado de un fotograma durante la deteccin con tareas.
+ */
+struct FrameTask {
+    std::vector<size_t> regions;                                  /**< ndices de sus regiones, en orden */
+    std::atomic<int> pendingSearches{ 0 };                        /**< Bsquedas de contornos sin terminar */
+    std::vector<std::pair<ContourInfo, ContourInfo>> matches;     /**< Parejas de marcadores */
+    std::vector<std::string> codes;                               /**< Cdigo de cada pareja */
+    std::vector<std::vector<double>> confidences;                 /**< Confianzas de los dgitos de cada pareja */
+};
+
+
+/**
+ * @brief Localiza y decodifica los cdigos de varios fotogramas con tareas de un planificador.
+ *
+ * @param frames Fotogramas BGR.
+ * @param scheduler Planificador en el que se ejecutan las tareas.
+ *
+ * @return std::vector<std::vector<DecodedCode>> Los cdigos de cada fotograma, en el orden de `frames`.
+ */
+std::vector<std::vector<DecodedCode>> CCodeDetector::detectBatch(const std::vector<Mat> &frames, CTaskScheduler &scheduler) {
+    // Paso 1: Regiones de cada fotograma
+    std::vector<RegionTask> regions;
+    std::vector<FrameTask> frameTasks(frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+        for (const Rect &region : getProcessingRegions(frames[f].size())) {
+            frameTasks[f].regions.push_back(regions.size());
+            regions.push_back(RegionTask());
+            regions.back().frame = f;
+            regions.back().region = region;
+        }
+        frameTasks[f].pendingSearches = 2 * static_cast<int>( frameTasks[f].regions.size() );
+    }
+
+    double scale = params.pyramidScale;
+    if (scale <= 0 || scale >= 1.0) {
+        scale = 1.0;
+    }
+
+    CTaskGroup group;
+
+    // Recorte y decodificacin de un candidato. Un recorte fuera de la imagen queda vaco y se decodifica como "X"
+    auto decodeTask = [&](size_t f, size_t c) {
+        FrameTask &state = frameTasks[f];
+        std::vector<Mat> crop = cutBoundingBox({ state.matches[c] }, frames[f]);
+        decodeCrop(crop.front(), state.codes[c], state.confidences[c]);
+    };
+
+    // Emparejamiento de los marcadores de todas las regiones de un fotograma y una tarea por candidato
+    auto matchTask = [&](size_t f) {
+        FrameTask &state = frameTasks[f];
+        std::vector<ContourInfo> red;
+        std::vector<ContourInfo> green;
+        for (size_t r : state.regions) {
+            red.insert(red.end(), regions[r].red.begin(), regions[r].red.end());
+            green.insert(green.end(), regions[r].green.begin(), regions[r].green.end());
+        }
+        state.matches = matchContours(red, green);
+        state.codes.resize(state.matches.size());
+        state.confidences.resize(state.matches.size());
+        for (size_t c = 0; c < state.matches.size(); ++c) {
+            scheduler.spawn(group, [&, f, c]() { decodeTask(f, c); });
+        }
+    };
+
+    // Bsqueda de los contornos de un color; la ltima bsqueda del fotograma lanza el emparejamiento
+    auto searchTask = [&](size_t r, bool isRed) {
+        RegionTask &job = regions[r];
+        findColorMarkers(isRed ? job.redMasked : job.greenMasked, job.region, frames[job.frame].size(), scale,
+                         isRed ? job.red : job.green);
+        if (frameTasks[job.frame].pendingSearches.fetch_sub(1) == 1) {
+            matchTask(job.frame);
+        }
+    };
+
+    // Mscaras de una regin (las mismas etapas que `locateMarkers`) y una bsqueda de contornos por color
+    auto maskTask = [&](size_t r) {
+        RegionTask &job = regions[r];
+        const Mat &frame = frames[job.frame];
+        Mat locateImage = frame(job.region);
+        if (scale != 1.0) {
+            resize(frame(job.region), locateImage, Size(), scale, scale, params.fixedPoint ? INTER_LINEAR_EXACT : INTER_AREA);
+        }
+        Mat blurImage = BlurImage(locateImage, params.blurKernelSize);
+        Mat grayImage = convertGrayImage(blurImage);
+        if (colorLut) {
+            colorLut->maskedGrayImages(blurImage, grayImage, job.redMasked, job.greenMasked);
+        }
+        else {
+            Mat hsvImage = convertHSVImage(blurImage);
+            job.redMasked = applyMaskToImage(grayImage, getRedMask(hsvImage));
+            job.greenMasked = applyMaskToImage(grayImage, getGreenMask(hsvImage));
+        }
+        scheduler.spawn(group, [&, r]() { searchTask(r, false); });
+        searchTask(r, true);
+    };
+
+    // Paso 2: Lanzar las mscaras de todas las regiones (y el emparejamiento de los fotogramas sin regiones)
+    for (size_t f = 0; f < frames.size(); ++f) {
+        if (frameTasks[f].regions.empty()) {
+            scheduler.spawn(group, [&, f]() { matchTask(f); });
+        }
+    }
+    for (size_t r = 0; r < regions.size(); ++r) {
+        scheduler.spawn(group, [&, r]() { maskTask(r); });
+    }
+
+    // Paso 3: Esperar a que terminen todas las tareas (las que se lanzan desde otras tareas incluidas)
+    scheduler.wait(group);
+
+    // Paso 4: Construir los resultados de cada fotograma, con el cdigo de cada pareja en su misma posicin
+    std::vector<std::vector<DecodedCode>> results(frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const FrameTask &state = frameTasks[f];
+        results[f] = buildDecodedCodes(state.matches, state.codes, state.confidences);
+    }
+    return results;
+}
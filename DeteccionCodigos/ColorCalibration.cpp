@@ -0,0 +1,409 @@
+#include "ColorCalibration.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+
+/**
+ * @brief Lee la configuracin de las claves `colorCalibration*` de un fichero de OpenCV.
+ *
+ * @param fileName Nombre del fichero (p. ej. detector.yml).
+ * @param params Configuracin leda; las claves ausentes conservan su valor.
+ *
+ * @return bool true si el fichero se ha podido abrir.
+ */
+bool ColorCalibrationParams::load(const std::string &fileName, ColorCalibrationParams &params) {
+    // Paso 1: Abrir el fichero en modo lectura
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+
+    // Paso 2: Leer cada campo solo si est presente en el fichero
+    auto readInt = [&fs](const char *key, int &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    auto readDouble = [&fs](const char *key, double &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    int enabled = params.enabled ? 1 : 0;
+    readInt("colorCalibration", enabled);
+    params.enabled = enabled != 0;
+    readDouble("colorCalibrationRate", params.learningRate);
+    readDouble("colorCalibrationMinConfidence", params.minConfidence);
+    readDouble("colorCalibrationSigmas", params.widthSigmas);
+    readInt("colorCalibrationMinSaturation", params.minSaturation);
+    readInt("colorCalibrationMinValue", params.minValue);
+    readInt("colorCalibrationUpdateEvery", params.updateEvery);
+    if (!fs["colorCalibrationDirectory"].empty()) {
+        params.directory = static_cast<std::string>( fs["colorCalibrationDirectory"] );
+    }
+    return true;
+}
+
+
+/**
+ * @brief Modelo de un color con la media en el centro de un rango y la desviacin que lo reproduce.
+ *
+ * @param hueLow Tono mnimo (desplazado en el rojo).
+ * @param hueHigh Tono mximo.
+ * @param low Lmite inferior HSV (se usan la saturacin y el brillo).
+ * @param widthSigmas Semiancho del rango en desviaciones.
+ */
+static ColorModel modelFromRange(double hueLow, double hueHigh, const Scalar &low, double widthSigmas) {
+    ColorModel model;
+    model.hue = ( hueLow + hueHigh ) / 2;
+    model.hueSigma = std::max(( hueHigh - hueLow ) / 2 / widthSigmas, 1.0);
+    model.saturation = ( low[1] + 255 ) / 2;
+    model.saturationSigma = std::max(( 255 - low[1] ) / 2 / widthSigmas, 1.0);
+    model.value = ( low[2] + 255 ) / 2;
+    model.valueSigma = std::max(( 255 - low[2] ) / 2 / widthSigmas, 1.0);
+    return model;
+}
+
+
+/**
+ * @brief Constructor de la clase CColorCalibration.
+ *
+ * El modelo inicial reproduce los rangos de `initialParams`, de modo que aplicarlo sin haber aprendido nada
+ * no cambia la segmentacin.
+ *
+ * @param initialParams Parmetros cuyos rangos se toman como punto de partida.
+ * @param params Configuracin de la calibracin.
+ * @param streamId Identificador del flujo.
+ */
+CColorCalibration::CColorCalibration(const DetectorParams &initialParams, const ColorCalibrationParams &params, const std::string &streamId)
+    : params(params)
+{
+    this->params.learningRate = std::min(std::max(this->params.learningRate, 0.0), 1.0);
+    this->params.widthSigmas = std::max(this->params.widthSigmas, 0.5);
+    this->params.updateEvery = std::max(1, this->params.updateEvery);
+
+    // Paso 1: Fichero del flujo, con los caracteres que no son letras ni dgitos sustituidos por '_'
+    std::string name = streamId;
+    for (char &c : name) {
+        if (!std::isalnum(static_cast<unsigned char>( c ))) {
+            c = '_';
+        }
+    }
+    fileName = this->params.directory + "/" + ( name.empty() ? std::string("flujo") : name ) + ".yml";
+
+    // Paso 2: Modelos iniciales; el segundo rango rojo (tonos altos) se cuenta como tonos negativos
+    bool hasSecondRed = initialParams.redLow2[0] <= initialParams.redHigh2[0];
+    double redLow = hasSecondRed ? initialParams.redLow2[0] - 180 : initialParams.redLow1[0];
+    red = modelFromRange(redLow, initialParams.redHigh1[0], initialParams.redLow1, this->params.widthSigmas);
+    green = modelFromRange(initialParams.greenLow[0], initialParams.greenHigh[0], initialParams.greenLow, this->params.widthSigmas);
+}
+
+
+/**
+ * @brief Recupera la calibracin guardada del flujo.
+ *
+ * @return bool true si exista y se ha ledo.
+ */
+bool CColorCalibration::load() {
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+    auto readModel = [&fs](const char *key, ColorModel &model) {
+        FileNode node = fs[key];
+        if (node.empty()) {
+            return false;
+        }
+        node["hue"] >> model.hue;
+        node["hueSigma"] >> model.hueSigma;
+        node["saturation"] >> model.saturation;
+        node["saturationSigma"] >> model.saturationSigma;
+        node["value"] >> model.value;
+        node["valueSigma"] >> model.valueSigma;
+        return true;
+    };
+    ColorModel loadedRed = red, loadedGreen = green;
+    if (!readModel("red", loadedRed) || !readModel("green", loadedGreen)) {
+        return false;
+    }
+    red = loadedRed;
+    green = loadedGreen;
+    if (!fs["learnedMarkers"].empty()) {
+        double learned = 0;
+        fs["learnedMarkers"] >> learned;
+        stats.learnedMarkers = static_cast<uint64_t>( learned );
+    }
+    return true;
+}
+
+
+/**
+ * @brief Guarda la calibracin del flujo.
+ *
+ * Adems del modelo, se escriben los rangos resultantes con las claves de `DetectorParams`, para poder
+ * revisarlos o copiarlos a detector.yml.
+ *
+ * @return bool true si se ha podido escribir.
+ */
+bool CColorCalibration::save() const {
+    std::error_code error;
+    std::filesystem::create_directories(params.directory, error);
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::WRITE)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+    auto writeModel = [&fs](const char *key, const ColorModel &model) {
+        fs << key << "{" << "hue" << model.hue << "hueSigma" << model.hueSigma << "saturation" << model.saturation
+           << "saturationSigma" << model.saturationSigma << "value" << model.value << "valueSigma" << model.valueSigma << "}";
+    };
+    auto toVector = [](const Scalar &s) {
+        return std::vector<double>{ s[0], s[1], s[2] };
+    };
+    fs << "learnedMarkers" << static_cast<double>( stats.learnedMarkers );
+    writeModel("red", red);
+    writeModel("green", green);
+    DetectorParams ranges;
+    apply(ranges);
+    fs << "redLow1" << toVector(ranges.redLow1);
+    fs << "redHigh1" << toVector(ranges.redHigh1);
+    fs << "redLow2" << toVector(ranges.redLow2);
+    fs << "redHigh2" << toVector(ranges.redHigh2);
+    fs << "greenLow" << toVector(ranges.greenLow);
+    fs << "greenHigh" << toVector(ranges.greenHigh);
+    return true;
+}
+
+
+/**
+ * @brief Incorpora al modelo los marcadores de los cdigos confirmados de un fotograma.
+ *
+ * Un cdigo se confirma si se han reconocido todos sus dgitos con al menos `minConfidence`: entonces sus dos
+ * marcadores son con seguridad el rojo y el verde, y su color es una muestra fiable de la iluminacin actual.
+ *
+ * @param frame Fotograma BGR en el que se han detectado.
+ * @param codes Cdigos devueltos por `detect`.
+ * @return bool true si toca actualizar los rangos.
+ */
+bool CColorCalibration::learn(const Mat &frame, const std::vector<DecodedCode> &codes) {
+    if (!params.enabled) {
+        return false;
+    }
+    for (const DecodedCode &code : codes) {
+        if (code.code.find('X') != std::string::npos || code.confidence < params.minConfidence) {
+            continue;
+        }
+        ColorModel sample;
+        if (measure(frame, code.redCorners, true, sample)) {
+            blend(red, sample);
+            stats.learnedMarkers++;
+            pendingMarkers++;
+        }
+        if (measure(frame, code.greenCorners, false, sample)) {
+            blend(green, sample);
+            stats.learnedMarkers++;
+            pendingMarkers++;
+        }
+    }
+    if (pendingMarkers < params.updateEvery) {
+        return false;
+    }
+    pendingMarkers = 0;
+    stats.updates++;
+    return true;
+}
+
+
+/**
+ * @brief Escribe los rangos del modelo en unos parmetros y activa la tabla de colores.
+ *
+ * El tono abarca la media  `widthSigmas` desviaciones (con un semiancho de 3 a 45); la saturacin y el brillo,
+ * desde la media menos `widthSigmas` desviaciones (sin bajar de `minSaturation` y `minValue`) hasta 255. En el
+ * rojo, la parte negativa del rango de tonos pasa al segundo rango (tonos altos).
+ *
+ * @param detectorParams Parmetros del detector que se modifican.
+ */
+void CColorCalibration::apply(DetectorParams &detectorParams) const {
+    const double k = params.widthSigmas;
+    auto lowerBound = [](double mean, double sigma, double k, int minimum) {
+        return std::min(std::max(cvRound(mean - k * sigma), minimum), 254);
+    };
+    const Scalar emptyLow(255, 255, 255), emptyHigh(0, 0, 0);   // inRange no acepta ningn pxel
+
+    // Paso 1: Rojo. Rango de tonos desplazados [low, high] dentro de [-89, 89]
+    double redHalf = std::min(std::max(k * red.hueSigma, 3.0), 45.0);
+    int low = std::max(cvRound(red.hue - redHalf), -89);
+    int high = std::min(cvRound(red.hue + redHalf), 89);
+    int redS = lowerBound(red.saturation, red.saturationSigma, k, params.minSaturation);
+    int redV = lowerBound(red.value, red.valueSigma, k, params.minValue);
+    if (high >= 0) {
+        detectorParams.redLow1 = Scalar(std::max(low, 0), redS, redV);
+        detectorParams.redHigh1 = Scalar(high, 255, 255);
+    }
+    else {
+        detectorParams.redLow1 = emptyLow;
+        detectorParams.redHigh1 = emptyHigh;
+    }
+    if (low < 0) {
+        detectorParams.redLow2 = Scalar(180 + low, redS, redV);
+        detectorParams.redHigh2 = Scalar(180 + std::min(high, -1), 255, 255);
+    }
+    else {
+        detectorParams.redLow2 = emptyLow;
+        detectorParams.redHigh2 = emptyHigh;
+    }
+
+    // Paso 2: Verde
+    double greenHalf = std::min(std::max(k * green.hueSigma, 3.0), 45.0);
+    detectorParams.greenLow = Scalar(std::max(cvRound(green.hue - greenHalf), 0),
+                                     lowerBound(green.saturation, green.saturationSigma, k, params.minSaturation),
+                                     lowerBound(green.value, green.valueSigma, k, params.minValue));
+    detectorParams.greenHigh = Scalar(std::min(cvRound(green.hue + greenHalf), 179), 255, 255);
+
+    // Paso 3: Los rangos calibrados se clasifican con la tabla BGR
+    detectorParams.colorLut = true;
+}
+
+
+/**
+ * @brief Devuelve el modelo del rojo.
+ */
+const ColorModel &CColorCalibration::getRedModel() const {
+    return red;
+}
+
+
+/**
+ * @brief Devuelve el modelo del verde.
+ */
+const ColorModel &CColorCalibration::getGreenModel() const {
+    return green;
+}
+
+
+/**
+ * @brief Devuelve las estadsticas acumuladas.
+ */
+const ColorCalibrationStats &CColorCalibration::getStats() const {
+    return stats;
+}
+
+
+/**
+ * @brief Devuelve el fichero en el que se guarda la calibracin del flujo.
+ */
+const std::string &CColorCalibration::getFileName() const {
+    return fileName;
+}
+
+
+/**
+ * @brief Mide el color del interior de un marcador.
+ *
+ * Solo se usa la mitad central del marcador (las esquinas se acercan al centro a la mitad de distancia), para no
+ * mezclar el color del borde desenfocado ni el del fondo.
+ *
+ * @param frame Fotograma BGR.
+ * @param corners Esquinas del marcador.
+ * @param wrapHue Desplazar el tono a [-90, 90).
+ * @param sample Media y desviacin medidas.
+ * @return bool true si el marcador tiene pxeles suficientes.
+ */
+bool CColorCalibration::measure(const Mat &frame, const std::vector<Point> &corners, bool wrapHue, ColorModel &sample) {
+    if (corners.size() < 3) {
+        return false;
+    }
+
+    // Paso 1: Polgono interior y su rectngulo dentro del fotograma
+    Point2f center(0, 0);
+    for (const Point &p : corners) {
+        center.x += static_cast<float>( p.x ) / corners.size();
+        center.y += static_cast<float>( p.y ) / corners.size();
+    }
+    std::vector<Point> inner;
+    for (const Point &p : corners) {
+        inner.push_back(Point(cvRound(center.x + 0.5f * ( p.x - center.x )), cvRound(center.y + 0.5f * ( p.y - center.y ))));
+    }
+    Rect box = boundingRect(inner) & Rect(0, 0, frame.cols, frame.rows);
+    if (box.area() < 4) {
+        return false;
+    }
+    for (Point &p : inner) {
+        p = Point(p.x - box.x, p.y - box.y);
+    }
+
+    // Paso 2: HSV del rectngulo y mscara del polgono
+    Mat hsv;
+    cvtColor(frame(box), hsv, COLOR_BGR2HSV);
+    Mat mask = Mat::zeros(box.size(), CV_8UC1);
+    fillConvexPoly(mask, inner, Scalar(255));
+
+    // Paso 3: Media y desviacin de cada canal
+    double sum[3] = { 0, 0, 0 }, sumSquares[3] = { 0, 0, 0 };
+    int count = 0;
+    for (int y = 0; y < hsv.rows; ++y) {
+        const uchar *hsvRow = hsv.ptr<uchar>(y);
+        const uchar *maskRow = mask.ptr<uchar>(y);
+        for (int x = 0; x < hsv.cols; ++x) {
+            if (!maskRow[x]) {
+                continue;
+            }
+            double h = hsvRow[3 * x];
+            if (wrapHue && h >= 90) {
+                h -= 180;
+            }
+            const double values[3] = { h, static_cast<double>( hsvRow[3 * x + 1] ), static_cast<double>( hsvRow[3 * x + 2] ) };
+            for (int c = 0; c < 3; ++c) {
+                sum[c] += values[c];
+                sumSquares[c] += values[c] * values[c];
+            }
+            count++;
+        }
+    }
+    if (count < 4) {
+        return false;
+    }
+    double mean[3], sigma[3];
+    for (int c = 0; c < 3; ++c) {
+        mean[c] = sum[c] / count;
+        sigma[c] = std::sqrt(std::max(sumSquares[c] / count - mean[c] * mean[c], 0.0));
+    }
+    sample.hue = mean[0];
+    sample.hueSigma = sigma[0];
+    sample.saturation = mean[1];
+    sample.saturationSigma = sigma[1];
+    sample.value = mean[2];
+    sample.valueSigma = sigma[2];
+    return true;
+}
+
+
+/**
+ * @brief Acerca un modelo a una medida con el peso `learningRate`.
+ *
+ * Las desviaciones no bajan de 1 (tono) ni de 2 (saturacin y brillo), para que unos marcadores muy uniformes no
+ * estrechen los rangos hasta perder los de los bordes de la cinta.
+ *
+ * @param model Modelo que se actualiza.
+ * @param sample Medida de un marcador.
+ */
+void CColorCalibration::blend(ColorModel &model, const ColorModel &sample) const {
+    const double rate = params.learningRate;
+    model.hue += rate * ( sample.hue - model.hue );
+    model.hueSigma = std::max(model.hueSigma + rate * ( sample.hueSigma - model.hueSigma ), 1.0);
+    model.saturation += rate * ( sample.saturation - model.saturation );
+    model.saturationSigma = std::max(model.saturationSigma + rate * ( sample.saturationSigma - model.saturationSigma ), 2.0);
+    model.value += rate * ( sample.value - model.value );
+    model.valueSigma = std::max(model.valueSigma + rate * ( sample.valueSigma - model.valueSigma ), 2.0);
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "CodeDetector.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct ColorCalibrationParams
+ * @brief Configuracin de la calibracin automtica de los colores de los marcadores.
+ */
+struct ColorCalibrationParams {
+    bool enabled = false;              /**< Aprender los colores de las detecciones confirmadas */
+    double learningRate = 0.02;        /**< Peso de cada marcador confirmado en el modelo (adaptacin lenta) */
+    double minConfidence = 0.8;        /**< Confianza mnima de un cdigo para confirmar sus marcadores */
+    double widthSigmas = 3.0;          /**< Semiancho de los rangos, en desviaciones tpicas del modelo */
+    int minSaturation = 30;            /**< Lmite inferior mnimo de saturacin (evita aceptar grises) */
+    int minValue = 30;                 /**< Lmite inferior mnimo de brillo */
+    int updateEvery = 50;              /**< Marcadores confirmados entre dos actualizaciones de los rangos */
+    std::string directory = "calibracion"; /**< Directorio con la calibracin de cada flujo */
+
+    /**
+     * @brief Lee la configuracin de las claves `colorCalibration*` de un fichero YAML/XML de OpenCV (p. ej. detector.yml).
+     *
+     * Claves: `colorCalibration` (0 o 1), `colorCalibrationRate`, `colorCalibrationMinConfidence`,
+     * `colorCalibrationSigmas`, `colorCalibrationMinSaturation`, `colorCalibrationMinValue`,
+     * `colorCalibrationUpdateEvery` y `colorCalibrationDirectory`. Las claves ausentes conservan su valor.
+     *
+     * @param fileName Nombre del fichero.
+     * @param params Configuracin leda.
+     * @return bool true si el fichero se ha podido abrir.
+     */
+    static bool load(const std::string &fileName, ColorCalibrationParams &params);
+};
+
+/**
+ * @struct ColorModel
+ * @brief Distribucin de un color en HSV: media y desviacin tpica de cada canal.
+ *
+ * En el rojo, el tono se guarda desplazado a [-90, 90) (los tonos de 90 a 179 se cuentan como negativos) para
+ * que la media no salte al cruzar el 0.
+ */
+struct ColorModel {
+    double hue = 0;            /**< Tono medio */
+    double hueSigma = 1;       /**< Desviacin tpica del tono */
+    double saturation = 0;     /**< Saturacin media */
+    double saturationSigma = 1; /**< Desviacin tpica de la saturacin */
+    double value = 0;          /**< Brillo medio */
+    double valueSigma = 1;     /**< Desviacin tpica del brillo */
+};
+
+/**
+ * @struct ColorCalibrationStats
+ * @brief Estadsticas acumuladas de la calibracin.
+ */
+struct ColorCalibrationStats {
+    uint64_t learnedMarkers = 0;   /**< Marcadores confirmados incorporados al modelo (incluidos los de sesiones anteriores) */
+    uint64_t updates = 0;          /**< Actualizaciones de los rangos en esta sesin */
+};
+
+/**
+ * @class CColorCalibration
+ * @brief Calibracin automtica y persistente, por flujo, de los rangos de color de los marcadores.
+ *
+ * Los rangos HSV fijos dejan de servir cuando cambia la iluminacin de la fbrica, y entonces el pipeline
+ * completo se ejecuta sin encontrar nada. La calibracin mide el color de los marcadores de los cdigos
+ * decodificados con confianza (el interior de cada marcador, lejos del borde) y actualiza lentamente (media
+ * exponencial) un modelo de cada color. Cada `updateEvery` marcadores, los rangos se recalculan como la media
+ *  `widthSigmas` desviaciones, sin bajar de `minSaturation` ni de `minValue`, y el llamador los aplica al
+ * detector (`apply`), que los compila en una tabla BGR (`CColorLut`): la clasificacin sigue siendo una consulta
+ * por pxel. El modelo se guarda en `<directory>/<flujo>.yml` y se recupera al arrancar.
+ *
+ * Solo aprende de cdigos ya encontrados con los rangos vigentes, as que sigue derivas lentas de la
+ * iluminacin, no saltos que hagan desaparecer todos los marcadores.
+ */
+class CColorCalibration
+{
+public:
+    /**
+     * @brief Constructor de la clase CColorCalibration. Inicia el modelo con los rangos de unos parmetros.
+     *
+     * @param initialParams Parmetros cuyos rangos se toman como punto de partida.
+     * @param params Configuracin de la calibracin.
+     * @param streamId Identificador del flujo (da nombre al fichero de la calibracin).
+     */
+    CColorCalibration(const DetectorParams &initialParams, const ColorCalibrationParams &params, const std::string &streamId);
+
+    /**
+     * @brief Recupera la calibracin guardada del flujo.
+     *
+     * @return true si exista y se ha ledo.
+     */
+    bool load();
+
+    /**
+     * @brief Guarda la calibracin del flujo (modelo y rangos resultantes), creando el directorio si hace falta.
+     *
+     * @return true si se ha podido escribir.
+     */
+    bool save() const;
+
+    /**
+     * @brief Incorpora al modelo los marcadores de los cdigos confirmados de un fotograma.
+     *
+     * @param frame Fotograma BGR en el que se han detectado.
+     * @param codes Cdigos devueltos por `detect`.
+     * @return true si toca actualizar los rangos (llamar a `apply` y aplicar los parmetros al detector).
+     */
+    bool learn(const Mat &frame, const std::vector<DecodedCode> &codes);
+
+    /**
+     * @brief Escribe los rangos del modelo en unos parmetros y activa la tabla de colores.
+     *
+     * @param params Parmetros del detector que se modifican.
+     */
+    void apply(DetectorParams &params) const;
+
+    /**
+     * @brief Devuelve el modelo del rojo.
+     */
+    const ColorModel &getRedModel() const;
+
+    /**
+     * @brief Devuelve el modelo del verde.
+     */
+    const ColorModel &getGreenModel() const;
+
+    /**
+     * @brief Devuelve las estadsticas acumuladas.
+     */
+    const ColorCalibrationStats &getStats() const;
+
+    /**
+     * @brief Devuelve el fichero en el que se guarda la calibracin del flujo.
+     */
+    const std::string &getFileName() const;
+
+private:
+    /**
+     * @brief Mide el color del interior de un marcador.
+     *
+     * @param frame Fotograma BGR.
+     * @param corners Esquinas del marcador.
+     * @param wrapHue Desplazar el tono a [-90, 90) (rojo).
+     * @param sample Media y desviacin medidas.
+     * @return true si el marcador tiene pxeles suficientes.
+     */
+    static bool measure(const Mat &frame, const std::vector<Point> &corners, bool wrapHue, ColorModel &sample);
+
+    /**
+     * @brief Acerca un modelo a una medida con el peso `learningRate`.
+     */
+    void blend(ColorModel &model, const ColorModel &sample) const;
+
+    ColorCalibrationParams params;   /**< Configuracin */
+    std::string fileName;            /**< Fichero de la calibracin del flujo */
+    ColorModel red;                  /**< Modelo del rojo (tono desplazado) */
+    ColorModel green;                /**< Modelo del verde */
+    ColorCalibrationStats stats;     /**< Estadsticas acumuladas */
+    int pendingMarkers = 0;          /**< Marcadores aprendidos desde la ltima actualizacin de los rangos */
+};
@@ -0,0 +1,105 @@
+#include "ColorLut.h"
+#include "CodeDetector.h"
+#include <mutex>
+
+/**
+ * @brief Construye la tabla para los rangos HSV de unos parmetros.
+ *
+ * Los centros de todas las celdas BGR se colocan en una imagen de 512x512 (2^18 pxeles con 6 bits por canal),
+ * que se convierte a HSV y se compara con los rangos con las mismas funciones que `getRedMask` y `getGreenMask`.
+ *
+ * @param params Parmetros con los rangos rojos y verde.
+ */
+CColorLut::CColorLut(const DetectorParams &params)
+    : ranges{ params.redLow1, params.redHigh1, params.redLow2, params.redHigh2, params.greenLow, params.greenHigh }
+{
+    // Paso 1: Imagen con el centro de cada celda, en el orden de los ndices de la tabla
+    constexpr int levels = 1 << bits;
+    constexpr int shift = 8 - bits;
+    constexpr int half = ( 1 << shift ) / 2;
+    const int cells = levels * levels * levels;
+    Mat centers(cells / 512, 512, CV_8UC3);
+    Vec3b *center = centers.ptr<Vec3b>(0);
+    for (int b = 0; b < levels; ++b) {
+        for (int g = 0; g < levels; ++g) {
+            for (int r = 0; r < levels; ++r) {
+                *center++ = Vec3b(static_cast<uchar>( ( b << shift ) + half ), static_cast<uchar>( ( g << shift ) + half ),
+                                  static_cast<uchar>( ( r << shift ) + half ));
+            }
+        }
+    }
+
+    // Paso 2: Clasificar los centros con los rangos HSV
+    Mat hsv, redMask, redMask2, greenMask;
+    cvtColor(centers, hsv, COLOR_BGR2HSV);
+    inRange(hsv, params.redLow1, params.redHigh1, redMask);
+    inRange(hsv, params.redLow2, params.redHigh2, redMask2);
+    inRange(hsv, params.greenLow, params.greenHigh, greenMask);
+
+    // Paso 3: Guardar la clasificacin de cada celda
+    table.resize(static_cast<size_t>( cells ));
+    const uchar *red = redMask.ptr<uchar>(0);
+    const uchar *red2 = redMask2.ptr<uchar>(0);
+    const uchar *green = greenMask.ptr<uchar>(0);
+    for (int i = 0; i < cells; ++i) {
+        table[i] = static_cast<uint8_t>( ( red[i] || red2[i] ? Red : 0 ) | ( green[i] ? Green : 0 ) );
+    }
+}
+
+
+/**
+ * @brief Devuelve la tabla de unos rangos, reutilizando la ltima construida si son los mismos.
+ *
+ * Se conserva solo la ltima tabla (256 KB). La construccin se hace con el mutex tomado, de modo que dos hilos
+ * que piden los mismos rangos a la vez no la construyen dos veces.
+ *
+ * @param params Parmetros con los rangos rojos y verde.
+ *
+ * @return std::shared_ptr<const CColorLut> Tabla de los rangos de `params`.
+ */
+std::shared_ptr<const CColorLut> CColorLut::get(const DetectorParams &params) {
+    static std::mutex cacheMutex;
+    static std::shared_ptr<const CColorLut> last;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!last || !last->matches(params)) {
+        last = std::make_shared<CColorLut>(params);
+    }
+    return last;
+}
+
+
+/**
+ * @brief Indica si la tabla se ha construido con los mismos rangos que unos parmetros.
+ *
+ * @param params Parmetros del detector.
+ * @return bool true si los seis lmites coinciden.
+ */
+bool CColorLut::matches(const DetectorParams &params) const {
+    return ranges[0] == params.redLow1 && ranges[1] == params.redHigh1 && ranges[2] == params.redLow2 &&
+           ranges[3] == params.redHigh2 && ranges[4] == params.greenLow && ranges[5] == params.greenHigh;
+}
+
+
+/**
+ * @brief Calcula las mscaras roja y verde de una imagen BGR y las aplica sobre el gris en una sola pasada.
+ *
+ * @param bgr Imagen BGR (CV_8UC3).
+ * @param gray Imagen en gris (CV_8UC1) del mismo tamao.
+ * @param redMasked Gris con la mscara roja aplicada.
+ * @param greenMasked Gris con la mscara verde aplicada.
+ */
+void CColorLut::maskedGrayImages(const Mat &bgr, const Mat &gray, Mat &redMasked, Mat &greenMasked) const {
+    redMasked.create(gray.size(), CV_8UC1);
+    greenMasked.create(gray.size(), CV_8UC1);
+    for (int y = 0; y < gray.rows; ++y) {
+        const uchar *bgrRow = bgr.ptr<uchar>(y);
+        const uchar *grayRow = gray.ptr<uchar>(y);
+        uchar *redRow = redMasked.ptr<uchar>(y);
+        uchar *greenRow = greenMasked.ptr<uchar>(y);
+        for (int x = 0; x < gray.cols; ++x) {
+            const uint8_t colorClass = classify(bgrRow[3 * x], bgrRow[3 * x + 1], bgrRow[3 * x + 2]);
+            redRow[x] = ( colorClass & Red ) ? grayRow[x] : 0;
+            greenRow[x] = ( colorClass & Green ) ? grayRow[x] : 0;
+        }
+    }
+}
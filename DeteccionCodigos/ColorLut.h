@@ -0,0 +1,87 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace cv;
+
+struct DetectorParams;
+
+/**
+ * @class CColorLut
+ * @brief Tabla BGR precalculada que clasifica cada pxel como rojo, verde o ninguno con una sola consulta.
+ *
+ * Equivale a convertir la imagen a HSV y comparar cada pxel con los rangos de `DetectorParams` (como
+ * `getRedMask` y `getGreenMask`), pero sin la conversin: la clasificacin de cada color BGR, cuantizado a
+ * `bits` bits por canal, se calcula una vez al construir la tabla (2^18 entradas de un byte con 6 bits, que
+ * caben en la cach L2). Los pxeles se clasifican por el centro de su celda, de modo que los que estn a menos
+ * de media celda del borde de un rango pueden clasificarse distinto que con `inRange`.
+ */
+class CColorLut
+{
+public:
+    static constexpr int bits = 6;   /**< Bits por canal de la tabla */
+
+    /**
+     * @enum ColorClass
+     * @brief Bits de la clasificacin de un color.
+     */
+    enum ColorClass : uint8_t {
+        Red = 1,     /**< Dentro de alguno de los dos rangos rojos */
+        Green = 2    /**< Dentro del rango verde */
+    };
+
+    /**
+     * @brief Construye la tabla para los rangos HSV de unos parmetros.
+     *
+     * @param params Parmetros con los rangos rojos y verde.
+     */
+    explicit CColorLut(const DetectorParams &params);
+
+    /**
+     * @brief Devuelve la tabla de unos rangos, reutilizando la ltima construida si son los mismos.
+     *
+     * Construir una tabla cuesta unos milisegundos, y todos los detectores de un proceso (las variantes que se
+     * crean al cambiar de nivel de calidad, las vistas de mscara) suelen usar los mismos rangos. Se puede llamar
+     * desde cualquier hilo, p. ej. para construir la tabla de unos rangos recalibrados fuera del de la interfaz.
+     *
+     * @param params Parmetros con los rangos rojos y verde.
+     * @return std::shared_ptr<const CColorLut> Tabla de los rangos de `params`.
+     */
+    static std::shared_ptr<const CColorLut> get(const DetectorParams &params);
+
+    /**
+     * @brief Indica si la tabla se ha construido con los mismos rangos que unos parmetros.
+     *
+     * @param params Parmetros del detector.
+     */
+    bool matches(const DetectorParams &params) const;
+
+    /**
+     * @brief Clasifica un color BGR.
+     *
+     * @return uint8_t Combinacin de `ColorClass`.
+     */
+    uint8_t classify(uchar b, uchar g, uchar r) const {
+        constexpr int shift = 8 - bits;
+        return table[( static_cast<size_t>( b >> shift ) << ( 2 * bits ) ) | ( static_cast<size_t>( g >> shift ) << bits ) | ( r >> shift )];
+    }
+
+    /**
+     * @brief Calcula las mscaras roja y verde de una imagen BGR y las aplica sobre el gris en una sola pasada.
+     *
+     * Equivale a `convertHSVImage` + `getRedMask` + `getGreenMask` + dos `applyMaskToImage`.
+     *
+     * @param bgr Imagen BGR (CV_8UC3), normalmente ya desenfocada.
+     * @param gray Imagen en gris (CV_8UC1) del mismo tamao.
+     * @param redMasked Gris con la mscara roja aplicada.
+     * @param greenMasked Gris con la mscara verde aplicada.
+     */
+    void maskedGrayImages(const Mat &bgr, const Mat &gray, Mat &redMasked, Mat &greenMasked) const;
+
+private:
+    std::vector<uint8_t> table;   /**< Clasificacin de cada color cuantizado (ndice B, G, R) */
+    Scalar ranges[6];             /**< Rangos con los que se ha construido: redLow1, redHigh1, redLow2, redHigh2, greenLow, greenHigh */
+};
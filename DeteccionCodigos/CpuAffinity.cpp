@@ -0,0 +1,314 @@
+#include "CpuAffinity.h"
+#include "opencv2/opencv.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Indica si no hay ninguna ubicacin configurada.
+ *
+ * @return bool true si no hay ncleos ni nodo NUMA.
+ */
+bool CpuPlacement::empty() const {
+    return cores.empty() && numaNode < 0;
+}
+
+
+/**
+ * @brief Devuelve los ncleos de la ubicacin.
+ *
+ * @return std::vector<int> `cores` o, si est vaco, los ncleos del nodo `numaNode` (vaco si no hay ubicacin).
+ */
+std::vector<int> CpuPlacement::resolveCores() const {
+    if (!cores.empty()) {
+        return cores;
+    }
+    return numaNode >= 0 ? getNumaNodeCores(numaNode) : std::vector<int>();
+}
+
+
+/**
+ * @brief Describe la ubicacin.
+ *
+ * @return std::string "node:N", la lista de ncleos separados por comas, o vaco.
+ */
+std::string CpuPlacement::toString() const {
+    if (cores.empty()) {
+        return numaNode >= 0 ? "node:" + std::to_string(numaNode) : std::string();
+    }
+    std::string text;
+    for (size_t i = 0; i < cores.size(); ++i) {
+        text += ( i ? "," : "" ) + std::to_string(cores[i]);
+    }
+    return text;
+}
+
+
+/**
+ * @brief Interpreta una ubicacin.
+ *
+ * @param text "node:N" para los ncleos del nodo NUMA N, o una lista de ncleos como "0-3,6".
+ * @param placement Ubicacin interpretada (no se modifica si el texto no es vlido).
+ *
+ * @return bool true si el texto es vlido.
+ */
+bool CpuPlacement::parse(const std::string &text, CpuPlacement &placement) {
+    CpuPlacement parsed;
+    if (text.compare(0, 5, "node:") == 0) {
+        char *end = nullptr;
+        long node = std::strtol(text.c_str() + 5, &end, 10);
+        if (end == text.c_str() + 5 || *end != '\0' || node < 0) {
+            return false;
+        }
+        parsed.numaNode = static_cast<int>( node );
+    }
+    else {
+        parsed.cores = parseCpuList(text);
+        if (parsed.cores.empty()) {
+            return false;
+        }
+    }
+    placement = parsed;
+    return true;
+}
+
+
+/**
+ * @brief Lee la ubicacin de la clave `cpuPlacement` de un fichero de OpenCV.
+ *
+ * @param fileName Nombre del fichero (p. ej. el detector.yml del flujo).
+ * @param placement Ubicacin leda.
+ *
+ * @return bool true si la clave existe y es vlida.
+ */
+bool CpuPlacement::load(const std::string &fileName, CpuPlacement &placement) {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(fileName, cv::FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+    cv::FileNode node = fs["cpuPlacement"];
+    if (node.empty()) {
+        return false;
+    }
+    return parse(static_cast<std::string>( node ), placement);
+}
+
+
+/**
+ * @brief Interpreta una lista de ncleos.
+ *
+ * @param list Ncleos y rangos separados por comas, p. ej. "0-3,6".
+ *
+ * @return std::vector<int> Ncleos; vaco si algn elemento no es vlido.
+ */
+std::vector<int> parseCpuList(const std::string &list) {
+    std::vector<int> cores;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int first = -1, last = -1;
+        char dash = 0;
+        std::stringstream itemStream(item);
+        itemStream >> first;
+        if (itemStream >> dash) {
+            if (dash != '-' || !( itemStream >> last )) {
+                return {};
+            }
+        }
+        else {
+            last = first;
+        }
+        if (first < 0 || last < first) {
+            return {};
+        }
+        for (int core = first; core <= last; ++core) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+
+/**
+ * @brief Devuelve los ncleos de un nodo NUMA.
+ *
+ * En Linux se leen de `/sys/devices/system/node/nodeN/cpulist`; en Windows, de la mscara de procesadores
+ * del nodo (solo el grupo de procesadores del nodo, hasta 64 ncleos).
+ *
+ * @param node ndice del nodo.
+ *
+ * @return std::vector<int> Ncleos del nodo.
+ */
+std::vector<int> getNumaNodeCores(int node) {
+    std::vector<int> cores;
+    if (node < 0) {
+        return cores;
+    }
+#ifdef _WIN32
+    GROUP_AFFINITY affinity{};
+    if (GetNumaNodeProcessorMaskEx(static_cast<USHORT>( node ), &affinity)) {
+        for (int bit = 0; bit < static_cast<int>( sizeof(KAFFINITY) * 8 ); ++bit) {
+            if (affinity.Mask & ( static_cast<KAFFINITY>( 1 ) << bit )) {
+                cores.push_back(affinity.Group * 64 + bit);
+            }
+        }
+    }
+#elif defined(__linux__)
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (std::getline(file, list)) {
+        cores = parseCpuList(list);
+    }
+#endif
+    return cores;
+}
+
+
+/**
+ * @brief Fija el hilo actual en un conjunto de ncleos.
+ *
+ * @param cores Ncleos en los que puede ejecutarse el hilo.
+ *
+ * @return bool true si se ha podido fijar. En Windows solo se admiten los ncleos del primer grupo de
+ *         procesadores (0-63); en otros sistemas no se fija.
+ */
+bool pinCurrentThread(const std::vector<int> &cores) {
+    if (cores.empty()) {
+        return false;
+    }
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int core : cores) {
+        if (core < 0 || core >= static_cast<int>( sizeof(DWORD_PTR) * 8 )) {
+            return false;
+        }
+        mask |= static_cast<DWORD_PTR>( 1 ) << core;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores) {
+        if (core < 0 || core >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(core, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * @brief Constructor de la clase CCpuUsageMonitor.
+ */
+CCpuUsageMonitor::CCpuUsageMonitor()
+    : previous(readCoreTimes())
+{
+}
+
+
+/**
+ * @brief Toma una muestra y devuelve la utilizacin de cada ncleo desde la anterior.
+ *
+ * @return std::vector<double> Fraccin de tiempo ocupado de cada ncleo (0 si no ha pasado tiempo).
+ */
+std::vector<double> CCpuUsageMonitor::sample() {
+    std::vector<CoreTimes> current = readCoreTimes();
+    std::vector<double> usage(current.size(), 0.0);
+    for (size_t core = 0; core < current.size() && core < previous.size(); ++core) {
+        uint64_t total = current[core].total - previous[core].total;
+        uint64_t busy = current[core].busy - previous[core].busy;
+        if (total > 0) {
+            usage[core] = std::min(1.0, static_cast<double>( busy ) / total);
+        }
+    }
+    previous = current;
+    return usage;
+}
+
+
+#ifdef _WIN32
+/**
+ * @brief Tiempos de un procesador tal como los devuelve `NtQuerySystemInformation`
+ * (SystemProcessorPerformanceInformation), en unidades de 100 ns. `KernelTime` incluye `IdleTime`.
+ */
+struct ProcessorPerformanceInformation {
+    LARGE_INTEGER IdleTime;
+    LARGE_INTEGER KernelTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER Reserved1[2];
+    ULONG Reserved2;
+};
+#endif
+
+/**
+ * @brief Lee los tiempos acumulados de cada ncleo.
+ *
+ * @return Tiempos de cada ncleo, por ndice de ncleo (vaco si el sistema no permite leerlos).
+ */
+std::vector<CCpuUsageMonitor::CoreTimes> CCpuUsageMonitor::readCoreTimes() {
+    std::vector<CoreTimes> times;
+#ifdef _WIN32
+    // Paso 1: NtQuerySystemInformation no est en las bibliotecas de importacin habituales; se obtiene de ntdll
+    typedef LONG (WINAPI *QueryFunction)(ULONG, PVOID, ULONG, PULONG);
+    static QueryFunction query = reinterpret_cast<QueryFunction>(
+        reinterpret_cast<void *>( GetProcAddress(GetModuleHandleA("ntdll.dll"), "NtQuerySystemInformation") ) );
+    if (query == nullptr) {
+        return times;
+    }
+
+    // Paso 2: Tiempos de todos los procesadores (SystemProcessorPerformanceInformation = 8)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    std::vector<ProcessorPerformanceInformation> processors(info.dwNumberOfProcessors);
+    ULONG size = static_cast<ULONG>( processors.size() * sizeof(ProcessorPerformanceInformation) );
+    if (query(8, processors.data(), size, nullptr) != 0) {
+        return times;
+    }
+    for (const ProcessorPerformanceInformation &p : processors) {
+        CoreTimes core;
+        core.total = static_cast<uint64_t>( p.KernelTime.QuadPart + p.UserTime.QuadPart );
+        core.busy = core.total - static_cast<uint64_t>( p.IdleTime.QuadPart );
+        times.push_back(core);
+    }
+#elif defined(__linux__)
+    // Lneas "cpuN user nice system idle iowait irq softirq steal ..." de /proc/stat (en ticks del reloj)
+    std::ifstream file("/proc/stat");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 3, "cpu") != 0 || line.size() < 4 || !std::isdigit(static_cast<unsigned char>( line[3] ))) {
+            continue;
+        }
+        std::istringstream stream(line.substr(3));
+        size_t index = 0;
+        uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+        stream >> index >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+        if (index >= times.size()) {
+            times.resize(index + 1);
+        }
+        times[index].busy = user + nice + system + irq + softirq + steal;
+        times[index].total = times[index].busy + idle + iowait;
+    }
+#endif
+    return times;
+}
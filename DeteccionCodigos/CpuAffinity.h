@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file CpuAffinity.h
+ * @brief Ubicacin de los hilos en ncleos o nodos NUMA y utilizacin de cada ncleo.
+ *
+ * En servidores con varios zcalos, un hilo de captura que migra a otro zcalo procesa fotogramas cuya
+ * memoria est en el nodo del primero. Fijando la captura y la decodificacin de un flujo en los ncleos
+ * de un mismo nodo, y reservando las imgenes desde esos hilos (la memoria se asigna en el nodo del hilo
+ * que la escribe por primera vez), los datos de cada flujo se quedan en su nodo.
+ */
+
+/**
+ * @struct CpuPlacement
+ * @brief Conjunto de ncleos en el que se ejecutan los hilos de un flujo: una lista de ncleos o un nodo NUMA.
+ */
+struct CpuPlacement {
+    std::vector<int> cores;   /**< Ncleos (si no est vaco, tiene prioridad sobre `numaNode`) */
+    int numaNode = -1;        /**< Nodo NUMA cuyos ncleos se usan (-1 = ninguno) */
+
+    /**
+     * @brief Indica si no hay ninguna ubicacin configurada (los hilos pueden ejecutarse en cualquier ncleo).
+     */
+    bool empty() const;
+
+    /**
+     * @brief Devuelve los ncleos de la ubicacin: `cores` o, si est vaco, los del nodo `numaNode`.
+     */
+    std::vector<int> resolveCores() const;
+
+    /**
+     * @brief Describe la ubicacin como en `parse` ("0-3,6" o "node:1"; vaco si no hay ninguna).
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Interpreta una ubicacin: una lista de ncleos ("0-3,6") o un nodo NUMA ("node:1").
+     *
+     * @param text Texto de la ubicacin.
+     * @param placement Ubicacin interpretada.
+     * @return bool true si el texto es vlido.
+     */
+    static bool parse(const std::string &text, CpuPlacement &placement);
+
+    /**
+     * @brief Lee la ubicacin de la clave `cpuPlacement` de un fichero YAML/XML de OpenCV (p. ej. detector.yml).
+     *
+     * @param fileName Nombre del fichero.
+     * @param placement Ubicacin leda.
+     * @return bool true si el fichero tiene una ubicacin vlida.
+     */
+    static bool load(const std::string &fileName, CpuPlacement &placement);
+};
+
+/**
+ * @brief Interpreta una lista de ncleos como "0-3,6,8-9".
+ *
+ * @param list Lista de ncleos y rangos separados por comas.
+ * @return std::vector<int> Ncleos, en el orden de la lista (vaco si la lista no es vlida).
+ */
+std::vector<int> parseCpuList(const std::string &list);
+
+/**
+ * @brief Devuelve los ncleos de un nodo NUMA.
+ *
+ * @param node ndice del nodo.
+ * @return std::vector<int> Ncleos del nodo (vaco si no existe o el sistema no lo indica).
+ */
+std::vector<int> getNumaNodeCores(int node);
+
+/**
+ * @brief Fija el hilo actual en un conjunto de ncleos.
+ *
+ * @param cores Ncleos en los que puede ejecutarse el hilo.
+ * @return bool true si se ha podido fijar (solo en Windows y Linux).
+ */
+bool pinCurrentThread(const std::vector<int> &cores);
+
+/**
+ * @class CCpuUsageMonitor
+ * @brief Utilizacin de cada ncleo del sistema entre dos muestras (tiempo ocupado / tiempo transcurrido).
+ *
+ * Mide todos los procesos, no solo este, que es lo que hace falta para saber cuntas cmaras caben en un
+ * servidor. En Linux lee `/proc/stat`; en Windows, los tiempos de cada procesador del sistema.
+ */
+class CCpuUsageMonitor
+{
+public:
+    /**
+     * @brief Constructor de la clase CCpuUsageMonitor. Toma la primera muestra.
+     */
+    CCpuUsageMonitor();
+
+    /**
+     * @brief Toma una muestra y devuelve la utilizacin de cada ncleo desde la anterior.
+     *
+     * @return std::vector<double> Fraccin [0, 1] de tiempo ocupado de cada ncleo, por ndice de ncleo
+     *         (vaco si el sistema no permite medirla).
+     */
+    std::vector<double> sample();
+
+private:
+    /**
+     * @struct CoreTimes
+     * @brief Tiempos acumulados de un ncleo, en las unidades del sistema.
+     */
+    struct CoreTimes {
+        uint64_t busy = 0;    /**< Tiempo ocupado */
+        uint64_t total = 0;   /**< Tiempo total (ocupado + inactivo) */
+    };
+
+    /**
+     * @brief Lee los tiempos acumulados de cada ncleo.
+     */
+    static std::vector<CoreTimes> readCoreTimes();
+
+    std::vector<CoreTimes> previous;   /**< Tiempos de la muestra anterior */
+};
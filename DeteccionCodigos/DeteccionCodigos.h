@@ -3,13 +3,29 @@
 #include <QtWidgets/QMainWindow>
 #include "ui_DeteccionCodigos.h"
 #include "VideoAcquisition.h"
+#include "CodeDetector.h"
+#include "DetectorVariants.h"
+#include "MotionGate.h"
+#include "QualityController.h"
+#include "ColorCalibration.h"
+#include "CpuAffinity.h"
+#include "ResultAggregator.h"
+#include "ResultWriter.h"
+#include "FrameArchiver.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "ResultServer.h"
 #include "opencv2/opencv.hpp"
 #include <QMessageBox>
 #include <QTimer>
+#include <QStatusBar>
 #include <QDebug>
 #include <QFileDialog>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
 
 /**
  * @enum ViewMode
@@ -23,35 +39,15 @@ enum ViewMode {
 };
 
 /**
- * @struct ContourInfo
- * @brief Estructura para almacenar la informacin de un contorno.
- *
- * Esta estructura almacena datos relacionados con un contorno detectado en una imagen, como sus esquinas,
- * el centro, las dimensiones (ancho, alto), rea, relacin de aspecto, permetro y ngulo de rotacin.
- */
-struct ContourInfo {
-    std::vector<Point> corners;   /**< Esquinas del contorno */
-    Point2f center;               /**< Centro del contorno */
-    float width;                  /**< Ancho del contorno */
-    float height;                 /**< Alto del contorno */
-    float area;                   /**< rea del contorno */
-    float aspect_ratio;           /**< Relacin de aspecto del contorno */
-    float perimeter;              /**< Permetro del contorno */
-    float angle;                  /**< ngulo de rotacin del contorno */
-};
-
-/**
- * @struct SegmentInfo
- * @brief Estructura para almacenar la informacin de un segmento de contornos.
- *
- * Esta estructura almacena datos sobre los segmentos de contornos, como el nmero de contornos, sus orientaciones,
- * las relaciones de rea y la relacin entre reas si el segmento tiene exactamente dos contornos.
+ * @struct StreamMetrics
+ * @brief Mtricas del procesamiento de un flujo en la aplicacin grfica.
  */
-struct SegmentInfo {
-    size_t numContours;                         /**< Nmero de contornos en el segmento */
-    std::vector<std::string> orientations;      /**< Orientacin de cada contorno (horizontal o vertical) */
-    std::vector<double> areaRatios;             /**< Relacin de reas de cada contorno respecto a la imagen */
-    double areaRatioRelation;                   /**< Relacin entre las reas de los contornos (solo si hay 2) */
+struct StreamMetrics {
+    CMetricCounter *processedFrames = nullptr;      /**< Fotogramas en los que se ha ejecutado el detector */
+    CMetricCounter *skippedFrames = nullptr;        /**< Fotogramas omitidos por no tener cambios */
+    CMetricCounter *decodedCodes = nullptr;         /**< Cdigos reconocidos completos */
+    CMetricCounter *failedCodes = nullptr;          /**< Cdigos con algn dgito no reconocido */
+    CMetricHistogram *motionGateSeconds = nullptr;  /**< Duracin de la comprobacin de movimiento */
 };
 
 /**
@@ -124,199 +120,60 @@ private slots:
     void ViewGreenMask(bool state);
 
     /**
-     * @brief Guarda el cdigo decodificado en un archivo.
+     * @brief Guarda la imagen decodificada en un archivo elegido por el usuario (la escritura es asncrona).
      */
     void SaveDecodedCode();
 
-private:
-    Ui::DeteccionCodigosClass ui; /**< Interfaz grfica de usuario */
-    CVideoAcquisition *camera;    /**< Objeto para la adquisicin de video */
-    QTimer *timer;                /**< Temporizador para actualizar la imagen */
-    Mat imgcapturada;             /**< Imagen capturada */
-    Mat imagenFinal;              /**< Imagen final procesada */
-
-    ViewMode currentMode = Normal; /**< Modo de visualizacin actual */
-
-    /// Funciones de segmentacin de imagen
-    /**
-     * @brief Aplica un filtro de desenfoque a la imagen.
-     *
-     * @param image Imagen de entrada.
-     * @param kernelSize Tamao del ncleo del filtro de desenfoque.
-     * @return Imagen desenfocada.
-     */
-    Mat BlurImage(const Mat &image, uint8_t kernelSize);
-
     /**
-     * @brief Convierte una imagen a escala de grises.
+     * @brief Muestra en la barra de estado los cambios de estado del flujo de vdeo (cadas y reconexiones).
      *
-     * @param image Imagen de entrada.
-     * @return Imagen convertida a escala de grises.
+     * @param state Nuevo estado (`CStreamCapture::State`).
+     * @param message Descripcin del cambio.
      */
-    Mat convertGrayImage(const Mat &image);
-
-    /**
-     * @brief Convierte una imagen a espacio de color HSV.
-     *
-     * @param image Imagen de entrada.
-     * @return Imagen convertida a HSV.
-     */
-    Mat convertHSVImage(const Mat &image);
-
-    /**
-     * @brief Obtiene la mscara de color rojo de una imagen en HSV.
-     *
-     * @param image Imagen en HSV.
-     * @return Mscara de color rojo.
-     */
-    Mat getRedMask(const Mat &image);
-
-    /**
-     * @brief Obtiene la mscara de color verde de una imagen en HSV.
-     *
-     * @param image Imagen en HSV.
-     * @return Mscara de color verde.
-     */
-    Mat getGreenMask(const Mat &image);
-
-    /**
-     * @brief Aplica una mscara a la imagen.
-     *
-     * @param image Imagen de entrada.
-     * @param mask Mscara a aplicar.
-     * @return Imagen con la mscara aplicada.
-     */
-    Mat applyMaskToImage(const Mat &image, Mat mask);
-
-    /**
-     * @brief Aplica un filtro de Sobel a la imagen.
-     *
-     * @param image Imagen de entrada.
-     * @param kernelSize Tamao del filtro.
-     * @return Imagen filtrada.
-     */
-    Mat sobelFilter(const Mat &image, uint8_t kernelSize);
-
-    /**
-     * @brief Encuentra los contornos filtrados en una imagen.
-     *
-     * @param image Imagen filtrada.
-     * @return Contornos encontrados.
-     */
-    std::vector<std::vector<Point>> findFilteredContours(const Mat &image);
-
-    /**
-     * @brief Extrae informacin relevante de los contornos.
-     *
-     * @param contours Contornos encontrados.
-     * @return Informacin de los contornos.
-     */
-    std::vector<ContourInfo> extractContourInfo(const vector<vector<Point>> &contours);
-
-    /**
-     * @brief Empareja los contornos rojos y verdes.
-     *
-     * @param redContoursInfo Informacin de los contornos rojos.
-     * @param greenContoursInfo Informacin de los contornos verdes.
-     * @return Emparejamiento de los contornos rojos y verdes.
-     */
-    std::vector<std::pair<ContourInfo, ContourInfo>> matchContours(const std::vector<ContourInfo> &redContoursInfo,
-                                                                   const std::vector<ContourInfo> &greenContoursInfo);
-
-    /**
-     * @brief Recorta las regiones de inters (bounding boxes) de los contornos emparejados.
-     *
-     * @param matchedContours Contornos emparejados.
-     * @param image Imagen original.
-     * @return Imgenes recortadas.
-     */
-    std::vector<Mat> cutBoundingBox(const std::vector<pair<ContourInfo, ContourInfo>> &matchedContours, const Mat &image);
-
-    /**
-     * @brief Obtiene la imagen segmentada con los cdigos decodificados.
-     *
-     * @param imagen Imagen original.
-     * @return Imagen segmentada con cdigos decodificados.
-     */
-    Mat getSegmentedImage(const Mat &imagen);
-
-    /// Funciones de procesamiento de imagen
-    /**
-     * @brief Aplica un umbral a la imagen para binarizarla.
-     *
-     * @param image Imagen de entrada.
-     * @param threshold Valor del umbral.
-     * @return Imagen binarizada.
-     */
-    Mat thresholdImage(const Mat &image, int threshold = 2);
-
-    /**
-     * @brief Clasifica los contornos en categoras segn su posicin en la imagen.
-     *
-     * @param contours Contornos encontrados.
-     * @param imageShape Tamao de la imagen.
-     * @return Pareja de contornos clasificados.
-     */
-    pair<std::vector<std::vector<Point>>, std::vector<std::vector<Point>>> classifyContours(
-        const std::vector<std::vector<Point>> &contours, const Size &imageShape);
-
-    /**
-     * @brief Filtra los contornos que estn dentro de la imagen.
-     *
-     * @param contours Contornos encontrados.
-     * @return Contornos filtrados.
-     */
-    std::vector<std::vector<Point>> filterInsideContours(const std::vector<std::vector<Point>> &contours);
-
-    /**
-     * @brief Obtiene los contornos de una imagen binarizada.
-     *
-     * @param thresholdedImage Imagen binarizada.
-     * @param image Imagen original.
-     * @return Contornos encontrados.
-     */
-    std::vector<std::vector<Point>> getContours(const Mat &thresholdedImage, const Mat &image);
+    void CaptureStateChanged(int state, QString message);
 
+private:
     /**
-     * @brief Separa los contornos en segmentos segn su posicin.
-     *
-     * @param contours Contornos encontrados.
-     * @param imageWidth Ancho de la imagen.
-     * @return Contornos segmentados.
+     * @brief Empieza a construir en segundo plano la tabla de colores de los rangos recalibrados.
      */
-    std::vector<std::vector<std::vector<Point>>> separateContoursBySegments(const std::vector<std::vector<Point>> &contours, int imageWidth);
+    void UpdateColorCalibration();
 
     /**
-     * @brief Ordena los contornos dentro de cada segmento.
-     *
-     * @param segments Segmentos de contornos.
-     * @return Segmentos con los contornos ordenados.
+     * @brief Aplica los rangos recalibrados al detector y a su variante si su tabla de colores ya est construida.
      */
-    std::vector<std::vector<std::vector<Point>>> orderContours(const std::vector<std::vector<std::vector<Point>>> &segments);
+    void ApplyColorCalibration();
 
     /**
-     * @brief Obtiene la relacin de reas de los contornos con respecto a la imagen.
-     *
-     * @param contours Contornos encontrados.
-     * @param image Imagen original.
-     * @return Relacin de reas.
+     * @brief Enva al escritor de resultados y al servidor local los cdigos fsicos terminados del agregador.
      */
-    std::vector<double> getAreaRatio(const std::vector<std::vector<Point>> &contours, const Mat &image);
+    void PublishAggregatedCodes();
 
-    /**
-     * @brief Obtiene la informacin detallada de los segmentos de contornos ordenados.
-     *
-     * @param orderedSegments Segmentos de contornos ordenados.
-     * @param image Imagen original.
-     * @return Informacin de los segmentos.
-     */
-    std::vector<SegmentInfo> getSegmentInfo(const std::vector<std::vector<std::vector<Point>>> &orderedSegments, const Mat &image);
+    Ui::DeteccionCodigosClass ui; /**< Interfaz grfica de usuario */
+    CVideoAcquisition *camera;    /**< Objeto para la adquisicin de video */
+    QTimer *timer;                /**< Temporizador para actualizar la imagen */
+    Mat imgcapturada;             /**< Imagen capturada */
+    Mat imagenFinal;              /**< Imagen final procesada (sin anotaciones) */
+    FrameOverlay overlayFinal;    /**< Anotaciones que se componen sobre imagenFinal al mostrarla o guardarla */
+
+    CCodeDetector detector;       /**< Etapas del detector para las vistas de mscara */
+    std::unique_ptr<CDetectorPipeline> pipeline; /**< Variante del detector (especializada si hay una para los parmetros) */
+    CMotionGate motionGate;                      /**< Omite la deteccin en los fotogramas sin cambios */
+    std::unique_ptr<CQualityController> qualityController; /**< Baja la calidad del detector si no da tiempo a procesar cada fotograma */
+    std::unique_ptr<CColorCalibration> colorCalibration;   /**< Ajusta los rangos de color a la iluminacin (nullptr si est desactivada) */
+    std::future<DetectorParams> pendingCalibration;        /**< Parmetros recalibrados cuya tabla de colores se est construyendo */
+    bool calibrationOutdated = false;                      /**< El modelo ha cambiado mientras se construa `pendingCalibration` */
+    std::unique_ptr<CResultAggregator> resultAggregator;   /**< Vota los resultados de cada cdigo fsico entre fotogramas (nullptr si est desactivado) */
+    std::vector<DecodedCode> lastCodes;          /**< Cdigos del ltimo fotograma procesado, reutilizados si no hay cambios */
+    FrameOverlay lastOverlay;                    /**< Anotaciones del ltimo fotograma procesado */
+    quint64 lastFrameIndex = 0;                  /**< Nmero de la ltima imagen mostrada; las repetidas no se vuelven a procesar */
+    CResultWriter *resultWriter;  /**< Escritor asncrono de los cdigos decodificados */
+    CFrameArchiver *frameArchiver; /**< Archivo asncrono de los fotogramas con cdigos, para auditora */
+    CResultServer *resultServer;  /**< Servidor local que publica los cdigos decodificados */
+    CpuPlacement placement;       /**< Ncleos o nodo NUMA de la captura y la decodificacin (`cpuPlacement` de detector.yml) */
+    CCpuUsageMonitor cpuUsage;    /**< Utilizacin de cada ncleo mientras se decodifica */
+    CMetricsRegistry metrics;     /**< Mtricas del proceso, servidas por el servidor local en GET /metrics */
+    StreamMetrics streamMetrics;  /**< Mtricas del procesamiento del flujo */
+    std::string traceFile;        /**< Fichero en el que se escribe la traza al cerrar (`traceFile` de detector.yml; vaco = sin trazas) */
 
-    /**
-     * @brief Decodifica el nmero representado por los segmentos de contornos.
-     *
-     * @param segmentInfo Informacin de los segmentos.
-     * @return Nmero decodificado como cadena de caracteres.
-     */
-    std::string decodeNumber(const std::vector<SegmentInfo> &segmentInfo);
+    ViewMode currentMode = Normal; /**< Modo de visualizacin actual */
 };
@@ -0,0 +1,79 @@
+#include "DetectorVariants.h"
+#include <tuple>
+
+/**
+ * @file DetectorVariants.cpp
+ * @brief Variantes precompiladas del detector y factora.
+ */
+
+/**
+ * @class CGenericDetector
+ * @brief Variante sin especializar: `CCodeDetector` con todos los parmetros en tiempo de ejecucin.
+ *
+ * Se usa cuando ninguna variante precompilada coincide con los parmetros cargados (p. ej. rangos de color
+ * calibrados o kernels que no estn en la lista).
+ */
+class CGenericDetector : public CDetectorPipeline
+{
+public:
+    CGenericDetector(const DetectorParams &params, bool annotate)
+        : detector(params), annotate(annotate)
+    {
+    }
+
+    std::vector<DecodedCode> detect(const Mat &imagen, FrameOverlay *overlay) override {
+        std::vector<DecodedCode> codes = detector.detect(imagen);
+        if (annotate && overlay != nullptr) {
+            *overlay = detector.buildOverlay(codes);
+        }
+        return codes;
+    }
+
+    std::string getName() const override {
+        return "generic";
+    }
+
+    CCodeDetector &getDetector() override {
+        return detector;
+    }
+
+private:
+    CCodeDetector detector;
+    bool annotate;
+};
+
+/**
+ * @brief Las cuatro variantes (flotante/entera, con/sin anotaciones) de una pareja de kernels.
+ */
+template <int Blur, int Sobel>
+using VariantsFor = std::tuple<DetectorConfig<Blur, Sobel, false, false>, DetectorConfig<Blur, Sobel, false, true>,
+                               DetectorConfig<Blur, Sobel, true, false>, DetectorConfig<Blur, Sobel, true, true>>;
+
+/**
+ * @brief Configuraciones precompiladas: la de `DetectorParams` por defecto (7, 11) y las que suele proponer
+ * ParameterTuner. Cada configuracin aade una instancia de `CSpecializedDetector` al ejecutable.
+ */
+using PrebuiltConfigs = decltype( std::tuple_cat(std::declval<VariantsFor<7, 11>>(), std::declval<VariantsFor<5, 11>>(),
+                                                 std::declval<VariantsFor<7, 7>>(), std::declval<VariantsFor<5, 7>>(),
+                                                 std::declval<VariantsFor<3, 5>>()) );
+
+/**
+ * @brief Crea la primera variante de la lista que coincide con los parmetros.
+ */
+template <class... Configs>
+static std::unique_ptr<CDetectorPipeline> createFirstMatching(const DetectorParams &params, bool annotate, std::tuple<Configs...> *) {
+    std::unique_ptr<CDetectorPipeline> pipeline;
+    ( void ) ( ( Configs::matches(params, annotate) && ( pipeline = std::make_unique<CSpecializedDetector<Configs>>(params), true ) ) || ... );
+    return pipeline;
+}
+
+std::unique_ptr<CDetectorPipeline> createDetectorPipeline(const DetectorParams &params, bool annotate) {
+    // Paso 1: Buscar una variante precompilada con los mismos kernels, modo y rangos de color
+    std::unique_ptr<CDetectorPipeline> pipeline = createFirstMatching(params, annotate, static_cast<PrebuiltConfigs *>( nullptr ));
+
+    // Paso 2: Si no hay ninguna, usar el detector genrico
+    if (!pipeline) {
+        pipeline = std::make_unique<CGenericDetector>(params, annotate);
+    }
+    return pipeline;
+}
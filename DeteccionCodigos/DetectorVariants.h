@@ -0,0 +1,262 @@
+#pragma once
+
+#include "CodeDetector.h"
+#include <memory>
+#include <string>
+
+/**
+ * @file DetectorVariants.h
+ * @brief Variantes del detector especializadas en compilacin y factora que elige entre ellas.
+ *
+ * Los parmetros que no cambian durante un despliegue (tamaos de kernel, rangos de color, modo entero y
+ * si se generan anotaciones) se fijan como parmetros de plantilla. Cada variante fusiona el clculo de las
+ * mscaras roja y verde y su aplicacin sobre el gris en una sola pasada con los rangos como constantes, y
+ * en punto fijo usa el Sobel entero con los kernels generados en compilacin. `createDetectorPipeline`
+ * elige en tiempo de ejecucin la variante precompilada que coincide con los parmetros cargados, o la
+ * genrica (`CCodeDetector` con parmetros en tiempo de ejecucin) si no hay ninguna.
+ */
+
+/**
+ * @struct DefaultColorRanges
+ * @brief Rangos HSV por defecto de `DetectorParams`, como constantes de compilacin.
+ */
+struct DefaultColorRanges {
+    static constexpr int redLow1[3] = { 0, 50, 50 };        /**< Lmite inferior del primer rango de rojo */
+    static constexpr int redHigh1[3] = { 10, 255, 255 };    /**< Lmite superior del primer rango de rojo */
+    static constexpr int redLow2[3] = { 150, 50, 50 };      /**< Lmite inferior del segundo rango de rojo */
+    static constexpr int redHigh2[3] = { 179, 255, 255 };   /**< Lmite superior del segundo rango de rojo */
+    static constexpr int greenLow[3] = { 30, 55, 55 };      /**< Lmite inferior del verde */
+    static constexpr int greenHigh[3] = { 90, 255, 255 };   /**< Lmite superior del verde */
+};
+
+/**
+ * @struct DetectorConfig
+ * @brief Configuracin de compilacin de una variante del detector.
+ *
+ * @tparam BlurKernelSize Kernel del desenfoque previo a la segmentacin.
+ * @tparam SobelKernelSize Kernel del filtro Sobel.
+ * @tparam FixedPoint Variante en aritmtica entera.
+ * @tparam Annotate Genera el overlay de los cdigos (aplicacin grfica) o no (consola).
+ * @tparam Colors Rangos HSV (una estructura como `DefaultColorRanges`).
+ */
+template <int BlurKernelSize, int SobelKernelSize, bool FixedPoint, bool Annotate, class Colors = DefaultColorRanges>
+struct DetectorConfig {
+    static constexpr int blurKernelSize = BlurKernelSize;
+    static constexpr int sobelKernelSize = SobelKernelSize;
+    static constexpr bool fixedPoint = FixedPoint;
+    static constexpr bool annotate = Annotate;
+    using ColorRanges = Colors;
+
+    /**
+     * @brief Indica si la configuracin coincide con unos parmetros de tiempo de ejecucin.
+     *
+     * @param params Parmetros cargados.
+     * @param annotateOutput Si se necesitan anotaciones.
+     * @return bool true si la variante produce exactamente el mismo resultado que `CCodeDetector` con `params`.
+     */
+    static bool matches(const DetectorParams &params, bool annotateOutput) {
+        auto same = [](const Scalar &value, const int (&expected)[3]) {
+            return value[0] == expected[0] && value[1] == expected[1] && value[2] == expected[2];
+        };
+        return params.blurKernelSize == BlurKernelSize && params.sobelKernelSize == SobelKernelSize &&
+               params.fixedPoint == FixedPoint && annotateOutput == Annotate && !params.colorLut &&
+               same(params.redLow1, Colors::redLow1) && same(params.redHigh1, Colors::redHigh1) &&
+               same(params.redLow2, Colors::redLow2) && same(params.redHigh2, Colors::redHigh2) &&
+               same(params.greenLow, Colors::greenLow) && same(params.greenHigh, Colors::greenHigh);
+    }
+
+    /**
+     * @brief Nombre de la variante, p. ej. "blur7-sobel11-float-overlay".
+     */
+    static std::string name() {
+        return "blur" + std::to_string(BlurKernelSize) + "-sobel" + std::to_string(SobelKernelSize) +
+               ( FixedPoint ? "-fixed" : "-float" ) + ( Annotate ? "-overlay" : "" );
+    }
+};
+
+/**
+ * @brief Indica si un pxel HSV est dentro de un rango (lmites incluidos, como `inRange`).
+ */
+inline bool inHsvRange(int h, int s, int v, const int (&low)[3], const int (&high)[3]) {
+    return h >= low[0] && h <= high[0] && s >= low[1] && s <= high[1] && v >= low[2] && v <= high[2];
+}
+
+/**
+ * @brief Calcula las mscaras roja y verde y las aplica sobre el gris en una sola pasada.
+ *
+ * Equivale a `getRedMask` + `getGreenMask` + dos `applyMaskToImage`, pero recorre la imagen una vez y,
+ * con los rangos como constantes de compilacin, el compilador reduce las comparaciones y vectoriza el bucle.
+ *
+ * @tparam Colors Rangos HSV.
+ * @param hsv Imagen HSV (CV_8UC3).
+ * @param gray Imagen en gris (CV_8UC1) del mismo tamao.
+ * @param redMasked Gris con la mscara roja aplicada.
+ * @param greenMasked Gris con la mscara verde aplicada.
+ */
+template <class Colors>
+void maskedGrayImages(const Mat &hsv, const Mat &gray, Mat &redMasked, Mat &greenMasked) {
+    redMasked.create(gray.size(), CV_8UC1);
+    greenMasked.create(gray.size(), CV_8UC1);
+    for (int y = 0; y < gray.rows; ++y) {
+        const uchar *hsvRow = hsv.ptr<uchar>(y);
+        const uchar *grayRow = gray.ptr<uchar>(y);
+        uchar *redRow = redMasked.ptr<uchar>(y);
+        uchar *greenRow = greenMasked.ptr<uchar>(y);
+        for (int x = 0; x < gray.cols; ++x) {
+            const int h = hsvRow[3 * x], s = hsvRow[3 * x + 1], v = hsvRow[3 * x + 2];
+            const bool red = inHsvRange(h, s, v, Colors::redLow1, Colors::redHigh1) ||
+                             inHsvRange(h, s, v, Colors::redLow2, Colors::redHigh2);
+            const bool green = inHsvRange(h, s, v, Colors::greenLow, Colors::greenHigh);
+            redRow[x] = red ? grayRow[x] : 0;
+            greenRow[x] = green ? grayRow[x] : 0;
+        }
+    }
+}
+
+/**
+ * @brief Bordes de una mscara con el kernel y el modo de una configuracin (filtro de `findFilteredContours`).
+ *
+ * En punto fijo llama directamente al Sobel entero con los kernels de tamao `Config::sobelKernelSize`
+ * generados en compilacin, sin pasar por la seleccin del kernel en tiempo de ejecucin; en coma flotante,
+ * al Sobel de OpenCV con el tamao de la configuracin.
+ *
+ * @tparam Config Una instancia de `DetectorConfig`.
+ */
+template <class Config>
+Mat configEdgeFilter(CCodeDetector &detector, const Mat &image) {
+    if constexpr (Config::fixedPoint) {
+        return detector.sobelFilterFixed<Config::sobelKernelSize>(image);
+    }
+    else {
+        return detector.sobelFilter(image, Config::sobelKernelSize);
+    }
+}
+
+/**
+ * @class CDetectorPipeline
+ * @brief Interfaz comn de las variantes del detector.
+ */
+class CDetectorPipeline
+{
+public:
+    virtual ~CDetectorPipeline() = default;
+
+    /**
+     * @brief Localiza y decodifica los cdigos de un fotograma.
+     *
+     * @param imagen Imagen BGR.
+     * @param overlay Si no es nullptr y la variante genera anotaciones, recibe el overlay de los cdigos.
+     * @return Cdigos decodificados.
+     */
+    virtual std::vector<DecodedCode> detect(const Mat &imagen, FrameOverlay *overlay) = 0;
+
+    /**
+     * @brief Nombre de la variante ("generic" si no est especializada).
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Detector con los parmetros de la variante, para las etapas sueltas (p. ej. las vistas de mscara).
+     */
+    virtual CCodeDetector &getDetector() = 0;
+};
+
+/**
+ * @class CSpecializedDetector
+ * @brief Variante del detector con la configuracin fijada en compilacin.
+ *
+ * @tparam Config Una instancia de `DetectorConfig`.
+ */
+template <class Config>
+class CSpecializedDetector : public CDetectorPipeline
+{
+public:
+    /**
+     * @brief Constructor de la clase CSpecializedDetector.
+     *
+     * @param params Parmetros del detector; los fijados por `Config` deben coincidir (`Config::matches`).
+     */
+    explicit CSpecializedDetector(const DetectorParams &params)
+        : detector(params)
+    {
+        detector.setEdgeFilter(&configEdgeFilter<Config>);
+    }
+
+    std::vector<DecodedCode> detect(const Mat &imagen, FrameOverlay *overlay) override {
+        // Paso 1: Escala de localizacin (1 si no se ha configurado una escala menor que 1)
+        double scale = detector.getParams().pyramidScale;
+        if (scale <= 0 || scale >= 1.0) {
+            scale = 1.0;
+        }
+
+        // Paso 2: Localizar los marcadores de cada regin (la imagen completa si no hay ROI configuradas) y emparejarlos
+        std::vector<std::pair<ContourInfo, ContourInfo>> pairs;
+        {
+            CMetricTimer timer(detector.getStageMetrics().locateSeconds);
+            CTraceScope trace("locate");
+            std::vector<ContourInfo> redInfo, greenInfo;
+            for (const Rect &region : detector.getProcessingRegions(imagen.size())) {
+                // Paso 2.1: Reducir la regin y aplicar el desenfoque con el kernel de la configuracin
+                Mat locateImage = imagen(region);
+                if (scale != 1.0) {
+                    CTraceScope resizeTrace("resize");
+                    resize(imagen(region), locateImage, Size(), scale, scale, Config::fixedPoint ? INTER_LINEAR_EXACT : INTER_AREA);
+                }
+                Mat blurImage;
+                {
+                    CTraceScope blurTrace("blur");
+                    GaussianBlur(locateImage, blurImage, Size(Config::blurKernelSize, Config::blurKernelSize), 0);
+                }
+                Mat hsvImage = detector.convertHSVImage(blurImage);
+                Mat grayImage = detector.convertGrayImage(blurImage);
+
+                // Paso 2.2: Mscaras roja y verde aplicadas sobre el gris en una sola pasada
+                Mat redMasked, greenMasked;
+                {
+                    CTraceScope masksTrace("masks");
+                    maskedGrayImages<typename Config::ColorRanges>(hsvImage, grayImage, redMasked, greenMasked);
+                }
+
+                // Paso 2.3: Marcadores de la regin, con los bordes de `configEdgeFilter<Config>`
+                detector.findMarkers(redMasked, greenMasked, region, imagen.size(), scale, redInfo, greenInfo);
+            }
+            pairs = detector.matchContours(redInfo, greenInfo);
+        }
+
+        // Paso 3: Decodificacin, comn con CCodeDetector
+        std::vector<DecodedCode> codes;
+        {
+            CMetricTimer timer(detector.getStageMetrics().decodeSeconds);
+            CTraceScope trace("decode");
+            codes = detector.decodeMarkers(pairs, imagen);
+        }
+
+        // Paso 4: Anotaciones, solo en las variantes que las generan
+        if constexpr (Config::annotate) {
+            if (overlay != nullptr) {
+                *overlay = detector.buildOverlay(codes);
+            }
+        }
+        return codes;
+    }
+
+    std::string getName() const override {
+        return Config::name();
+    }
+
+    CCodeDetector &getDetector() override {
+        return detector;
+    }
+
+private:
+    CCodeDetector detector; /**< Etapas comunes y parmetros no especializados (escala, decodificacin) */
+};
+
+/**
+ * @brief Crea la variante del detector que corresponde a unos parmetros.
+ *
+ * @param params Parmetros del detector (p. ej. los de `detector.yml`).
+ * @param annotate Si el llamador necesita el overlay de los cdigos.
+ * @return std::unique_ptr<CDetectorPipeline> Una variante precompilada si alguna coincide; si no, la genrica.
+ */
+std::unique_ptr<CDetectorPipeline> createDetectorPipeline(const DetectorParams &params, bool annotate);
@@ -0,0 +1,401 @@
+#include "FrameArchiver.h"
+#include "ResultWriter.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+/**
+ * @brief Lee la configuracin de las claves `archive*` de un fichero de OpenCV.
+ *
+ * @param fileName Nombre del fichero (p. ej. detector.yml).
+ * @param params Configuracin leda; las claves ausentes o no vlidas conservan su valor.
+ *
+ * @return bool true si el fichero se ha podido abrir.
+ */
+bool FrameArchiverParams::load(const std::string &fileName, FrameArchiverParams &params) {
+    // Paso 1: Abrir el fichero en modo lectura
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+
+    // Paso 2: Leer cada campo solo si est presente en el fichero
+    auto readInt = [&fs](const char *key, int &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    if (!fs["archiveDirectory"].empty()) {
+        params.directory = static_cast<std::string>( fs["archiveDirectory"] );
+    }
+    if (!fs["archiveSampling"].empty()) {
+        std::string sampling = static_cast<std::string>( fs["archiveSampling"] );
+        if (sampling == "off") params.sampling = Off;
+        else if (sampling == "all") params.sampling = All;
+        else if (sampling == "failures") params.sampling = FailuresOnly;
+        else if (sampling == "every") params.sampling = OneInN;
+    }
+    readInt("archiveSampleEvery", params.sampleEvery);
+    readInt("archiveJpegQuality", params.jpegQuality);
+    readInt("archiveWorkers", params.numWorkers);
+    readInt("archiveMaxFramesPerDirectory", params.maxFramesPerDirectory);
+    readInt("archiveMaxDirectories", params.maxDirectories);
+    return true;
+}
+
+
+/**
+ * @brief Constructor de la clase CFrameArchiver.
+ *
+ * Crea el directorio base y lanza los hilos de codificacin. El primer directorio rotativo se crea con la
+ * primera imagen, de modo que una ejecucin sin cdigos no deja directorios vacos.
+ *
+ * @param params Configuracin del archivo.
+ */
+CFrameArchiver::CFrameArchiver(const FrameArchiverParams &params)
+    : params(params)
+{
+    if (params.sampling != FrameArchiverParams::Off) {
+        std::error_code error;
+        std::filesystem::create_directories(params.directory, error);
+    }
+    for (int w = 0; w < std::max(1, params.numWorkers); ++w) {
+        workers.emplace_back(&CFrameArchiver::run, this);
+    }
+}
+
+
+/**
+ * @brief Destructor de la clase CFrameArchiver.
+ *
+ * Indica a los hilos que terminen y espera a que escriban las imgenes pendientes.
+ */
+CFrameArchiver::~CFrameArchiver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+
+/**
+ * @brief Ofrece un fotograma procesado para archivarlo.
+ *
+ * La decisin del muestreo y la insercin se hacen bajo el mutex, que solo protege la cola; la
+ * codificacin y la escritura se hacen en los hilos propios.
+ *
+ * @param frame Fotograma BGR (no se copia).
+ * @param streamId Identificador del flujo.
+ * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+ * @param frameIndex Nmero de fotograma.
+ * @param codes Cdigos del fotograma.
+ *
+ * @return bool true si se ha encolado.
+ */
+bool CFrameArchiver::push(const Mat &frame, const std::string &streamId, int64_t timestampMs, uint64_t frameIndex,
+                          const std::vector<DecodedCode> &codes) {
+    if (params.sampling == FrameArchiverParams::Off || codes.empty() || frame.empty()) {
+        return false;
+    }
+    offered++;
+
+    // Paso 1: Muestreo. Los fallos se archivan siempre (salvo con `Off`); los aciertos segn el modo
+    bool failed = hasFailures(codes);
+    if (!failed) {
+        bool keep = params.sampling == FrameArchiverParams::All;
+        if (params.sampling == FrameArchiverParams::OneInN) {
+            std::lock_guard<std::mutex> lock(mutex);
+            keep = sampleCounter++ % static_cast<uint64_t>( std::max(1, params.sampleEvery) ) == 0;
+        }
+        if (!keep) {
+            sampledOut++;
+            return false;
+        }
+    }
+
+    // Paso 2: Encolar el fotograma sin copiarlo
+    Job job;
+    job.image = frame;
+    job.streamId = streamId;
+    job.timestampMs = timestampMs;
+    job.frameIndex = frameIndex;
+    job.codes = codes;
+    job.failed = failed;
+    return enqueue(std::move(job));
+}
+
+
+/**
+ * @brief Encola la escritura de una imagen en un fichero concreto.
+ *
+ * @param image Imagen BGR (no se copia).
+ * @param fileName Nombre del fichero.
+ *
+ * @return bool true si se ha encolado.
+ */
+bool CFrameArchiver::save(const Mat &image, const std::string &fileName) {
+    if (image.empty() || fileName.empty()) {
+        return false;
+    }
+    Job job;
+    job.image = image;
+    job.fileName = fileName;
+    return enqueue(std::move(job));
+}
+
+
+/**
+ * @brief Indica si algn cdigo de un fotograma no se ha reconocido.
+ *
+ * @param codes Cdigos del fotograma.
+ *
+ * @return bool true si algn cdigo tiene algn dgito 'X'.
+ */
+bool CFrameArchiver::hasFailures(const std::vector<DecodedCode> &codes) {
+    for (const DecodedCode &code : codes) {
+        if (code.code.find('X') != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Devuelve las estadsticas acumuladas.
+ *
+ * @return FrameArchiverStats Contadores y tiempo medio de codificacin.
+ */
+FrameArchiverStats CFrameArchiver::getStats() const {
+    FrameArchiverStats stats;
+    stats.offeredFrames = offered.load();
+    stats.sampledOutFrames = sampledOut.load();
+    stats.droppedFrames = dropped.load();
+    stats.archivedFrames = archived.load();
+    stats.errors = errors.load();
+    uint64_t encoded = stats.archivedFrames + stats.errors;
+    stats.meanEncodeMs = encoded ? encodeUs.load() / 1000.0 / encoded : 0.0;
+    return stats;
+}
+
+
+/**
+ * @brief Devuelve el nmero de imgenes pendientes de codificar.
+ */
+size_t CFrameArchiver::getQueueSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+
+/**
+ * @brief Inserta un trabajo en la cola si cabe.
+ *
+ * @param job Trabajo a insertar.
+ *
+ * @return bool true si se ha encolado, false si la cola estaba llena y se ha descartado.
+ */
+bool CFrameArchiver::enqueue(Job &&job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= params.queueCapacity) {
+            dropped++;
+            return false;
+        }
+        queue.push_back(std::move(job));
+    }
+    condition.notify_one();
+    return true;
+}
+
+
+/**
+ * @brief Bucle de los hilos de codificacin.
+ *
+ * Cada hilo extrae una imagen, le asigna un nombre en el directorio rotativo, la codifica en JPEG y la
+ * escribe fuera de cualquier mutex, y despus aade su lnea al ndice del directorio y libera su reserva
+ * (el directorio no se puede eliminar mientras tenga reservas). Al parar, los hilos terminan de vaciar la
+ * cola antes de salir.
+ */
+void CFrameArchiver::run() {
+    const std::vector<int> jpegParams = { IMWRITE_JPEG_QUALITY, params.jpegQuality };
+    CTracer::instance().setThreadName("archivo");
+
+    while (true) {
+        // Paso 1: Esperar a que haya una imagen o a la parada
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                break;
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        // Paso 2: Asignar el fichero de destino
+        auto start = std::chrono::steady_clock::now();
+        std::string directory;
+        if (job.fileName.empty()) {
+            directory = reserveFileName(job);
+        }
+
+        // Paso 3: Codificar y escribir la imagen
+        bool ok = false;
+        try {
+            CTraceScope trace("encode", "archive", job.fileName.empty() ? static_cast<int64_t>( job.frameIndex ) : -1);
+            std::vector<uchar> bytes;
+            std::string extension = std::filesystem::path(job.fileName).extension().string();
+            if (imencode(extension.empty() ? ".jpg" : extension, job.image, bytes, jpegParams)) {
+                std::ofstream file(job.fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char *>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ));
+                ok = static_cast<bool>( file );
+            }
+        }
+        catch (const cv::Exception &) {
+            ok = false;
+        }
+        encodeUs += static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count() );
+        if (!ok) {
+            errors++;
+            if (!directory.empty()) {
+                releaseDirectory(directory);
+            }
+            continue;
+        }
+        archived++;
+
+        // Paso 4: Aadir la imagen al ndice de su directorio (los cdigos en el formato de CResultWriter)
+        if (!directory.empty()) {
+            std::ostringstream line;
+            line << "{\"file\":\"" << std::filesystem::path(job.fileName).filename().string() << '"'
+                 << ",\"failed\":" << ( job.failed ? "true" : "false" ) << ",\"codes\":[";
+            for (size_t i = 0; i < job.codes.size(); ++i) {
+                ResultRecord record;
+                record.streamId = job.streamId;
+                record.timestampMs = job.timestampMs;
+                record.frameIndex = job.frameIndex;
+                record.code = job.codes[i];
+                line << ( i ? "," : "" ) << CResultWriter::toJson(record);
+            }
+            line << "]}\n";
+            {
+                std::lock_guard<std::mutex> lock(directoryMutex);
+                std::ofstream index(( std::filesystem::path(directory) / "indice.jsonl" ).string(), std::ios::out | std::ios::app);
+                index << line.str();
+            }
+
+            // Paso 5: Liberar la reserva del directorio
+            releaseDirectory(directory);
+        }
+    }
+}
+
+
+/**
+ * @brief Reserva el nombre de la siguiente imagen del directorio rotativo actual.
+ *
+ * El nombre incluye el instante de captura, el nmero de fotograma y si ha fallado algn cdigo, p. ej.
+ * `1731924900123_000042_ok.jpg`, de modo que el orden alfabtico es el temporal.
+ *
+ * @param job Trabajo al que se asigna el nombre (`fileName`).
+ *
+ * @return std::string Directorio en el que se ha reservado; hay que liberarlo con `releaseDirectory`.
+ */
+std::string CFrameArchiver::reserveFileName(Job &job) {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    if (currentDirectory.empty() || framesInDirectory >= params.maxFramesPerDirectory) {
+        rotate();
+    }
+    framesInDirectory++;
+    directories.back().pendingWrites++;
+    char name[64];
+    std::snprintf(name, sizeof(name), "%013" PRId64 "_%06" PRIu64 "_%s.jpg", job.timestampMs, job.frameIndex,
+                  job.failed ? "fallo" : "ok");
+    job.fileName = ( std::filesystem::path(currentDirectory) / name ).string();
+    return currentDirectory;
+}
+
+
+/**
+ * @brief Crea el siguiente directorio rotativo.
+ *
+ * El nombre incluye la fecha y hora de creacin y un ndice, p. ej. `archivo/20241118_101500_0`. Si se
+ * supera `maxDirectories`, se eliminan los directorios ms antiguos creados por este archivo (ver
+ * `removeExpiredDirectories`).
+ */
+void CFrameArchiver::rotate() {
+    // Paso 1: Componer el nombre del nuevo directorio
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    std::ostringstream name;
+    name << std::put_time(&local, "%Y%m%d_%H%M%S") << '_' << directoryIndex++;
+
+    // Paso 2: Crearlo
+    currentDirectory = ( std::filesystem::path(params.directory) / name.str() ).string();
+    std::error_code error;
+    std::filesystem::create_directories(currentDirectory, error);
+    framesInDirectory = 0;
+    directories.push_back({ currentDirectory, 0 });
+
+    // Paso 3: Eliminar los directorios ms antiguos si se supera el mximo
+    removeExpiredDirectories();
+}
+
+
+/**
+ * @brief Indica que ha terminado la escritura de una imagen reservada en un directorio rotativo.
+ *
+ * Si era la ltima escritura pendiente de un directorio que ya sobraba, se elimina ahora.
+ *
+ * @param directory Directorio devuelto por `reserveFileName`.
+ */
+void CFrameArchiver::releaseDirectory(const std::string &directory) {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    for (ArchiveDirectory &entry : directories) {
+        if (entry.path == directory) {
+            entry.pendingWrites--;
+            break;
+        }
+    }
+    removeExpiredDirectories();
+}
+
+
+/**
+ * @brief Elimina los directorios ms antiguos que sobran.
+ *
+ * Otro hilo puede estar todava codificando una imagen reservada en un directorio que ha dejado de ser el
+ * actual; en ese caso su eliminacin (y la de los posteriores) se aplaza hasta que `releaseDirectory` libere
+ * la ltima reserva, de modo que nunca se borra un directorio mientras se escribe en l.
+ */
+void CFrameArchiver::removeExpiredDirectories() {
+    std::error_code error;
+    while (params.maxDirectories > 0 && static_cast<int>( directories.size() ) > params.maxDirectories &&
+           directories.front().pendingWrites == 0) {
+        std::filesystem::remove_all(directories.front().path, error);
+        directories.pop_front();
+    }
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "CodeDetector.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct FrameArchiverParams
+ * @brief Configuracin del archivo de fotogramas.
+ */
+struct FrameArchiverParams {
+    /**
+     * @enum Sampling
+     * @brief Qu fotogramas con cdigos se archivan.
+     */
+    enum Sampling {
+        Off,            /**< No se archiva ningn fotograma */
+        All,            /**< Todos los fotogramas en los que se ha decodificado o intentado decodificar un cdigo */
+        FailuresOnly,   /**< Solo los fotogramas con algn cdigo no reconocido (algn dgito 'X') */
+        OneInN          /**< Todos los fallos y uno de cada `sampleEvery` fotogramas decodificados correctamente */
+    };
+
+    std::string directory = "archivo";     /**< Directorio base; cada directorio rotativo se crea dentro */
+    Sampling sampling = All;               /**< Fotogramas que se archivan */
+    int sampleEvery = 10;                  /**< N de `OneInN` */
+    int jpegQuality = 90;                  /**< Calidad JPEG de las imgenes archivadas */
+    int numWorkers = 2;                    /**< Hilos que codifican y escriben las imgenes */
+    size_t queueCapacity = 16;             /**< Fotogramas pendientes como mximo; los que no caben se descartan */
+    int maxFramesPerDirectory = 1000;      /**< Fotogramas a partir de los cuales se rota a un directorio nuevo */
+    int maxDirectories = 50;               /**< Nmero mximo de directorios conservados (0 = sin lmite) */
+
+    /**
+     * @brief Lee la configuracin de las claves `archive*` de un fichero YAML/XML de OpenCV (p. ej. detector.yml).
+     *
+     * Claves: `archiveDirectory`, `archiveSampling` ("off", "all", "failures" o "every"), `archiveSampleEvery`,
+     * `archiveJpegQuality`, `archiveWorkers`, `archiveMaxFramesPerDirectory` y `archiveMaxDirectories`. Las claves
+     * ausentes conservan su valor.
+     *
+     * @param fileName Nombre del fichero.
+     * @param params Configuracin leda.
+     * @return bool true si el fichero se ha podido abrir.
+     */
+    static bool load(const std::string &fileName, FrameArchiverParams &params);
+};
+
+/**
+ * @struct FrameArchiverStats
+ * @brief Estadsticas acumuladas del archivo de fotogramas.
+ */
+struct FrameArchiverStats {
+    uint64_t offeredFrames = 0;     /**< Fotogramas con cdigos recibidos */
+    uint64_t sampledOutFrames = 0;  /**< Fotogramas no archivados por el muestreo */
+    uint64_t droppedFrames = 0;     /**< Fotogramas descartados por tener la cola llena */
+    uint64_t archivedFrames = 0;    /**< Imgenes escritas en disco (incluidas las de `save`) */
+    uint64_t errors = 0;            /**< Imgenes que no se han podido codificar o escribir */
+    double meanEncodeMs = 0;        /**< Tiempo medio de codificacin y escritura de una imagen, en milisegundos */
+};
+
+/**
+ * @class CFrameArchiver
+ * @brief Archivo asncrono, para auditora, de los fotogramas en los que se ha decodificado (o no) un cdigo.
+ *
+ * El hilo de procesamiento solo decide si el fotograma entra en el muestreo y lo encola, sin copiarlo,
+ * codificarlo ni tocar el disco. Varios hilos propios codifican los fotogramas en JPEG y los escriben en
+ * directorios rotativos (`<directorio>/<fecha>_<hora>_<ndice>/`), junto con un `indice.jsonl` con los cdigos
+ * de cada imagen. Si la cola est llena, el fotograma se descarta y se contabiliza en `getStats`, de forma que
+ * el archivo nunca detiene el procesamiento.
+ */
+class CFrameArchiver
+{
+public:
+    /**
+     * @brief Constructor de la clase CFrameArchiver. Lanza los hilos de codificacin.
+     *
+     * @param params Configuracin del archivo.
+     */
+    CFrameArchiver(const FrameArchiverParams &params = FrameArchiverParams());
+
+    /**
+     * @brief Destructor. Escribe los fotogramas pendientes y detiene los hilos.
+     */
+    ~CFrameArchiver();
+
+    /**
+     * @brief Ofrece un fotograma procesado para archivarlo. No bloquea ms all de la insercin en la cola.
+     *
+     * Los fotogramas sin cdigos no se archivan. El fotograma no se copia: el llamador no debe escribir en l
+     * despus (basta con que cada fotograma sea un `Mat` nuevo, como los de `CVideoAcquisition::getImage`).
+     *
+     * @param frame Fotograma BGR sin anotaciones.
+     * @param streamId Identificador del flujo.
+     * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+     * @param frameIndex Nmero de fotograma.
+     * @param codes Cdigos devueltos por `CCodeDetector::detect`.
+     * @return true si se ha encolado; false si no hay cdigos, el muestreo lo excluye o la cola est llena.
+     */
+    bool push(const Mat &frame, const std::string &streamId, int64_t timestampMs, uint64_t frameIndex,
+              const std::vector<DecodedCode> &codes);
+
+    /**
+     * @brief Encola la escritura de una imagen en un fichero concreto, fuera del muestreo y de los directorios rotativos.
+     *
+     * @param image Imagen BGR (no se copia).
+     * @param fileName Nombre del fichero; el formato se deduce de la extensin, como en `imwrite`.
+     * @return true si se ha encolado, false si la cola estaba llena.
+     */
+    bool save(const Mat &image, const std::string &fileName);
+
+    /**
+     * @brief Indica si algn cdigo de un fotograma no se ha reconocido (tiene algn dgito 'X').
+     *
+     * @param codes Cdigos del fotograma.
+     */
+    static bool hasFailures(const std::vector<DecodedCode> &codes);
+
+    /**
+     * @brief Devuelve las estadsticas acumuladas.
+     */
+    FrameArchiverStats getStats() const;
+
+    /**
+     * @brief Devuelve el nmero de imgenes pendientes de codificar.
+     */
+    size_t getQueueSize() const;
+
+private:
+    /**
+     * @struct Job
+     * @brief Imagen pendiente de codificar y escribir.
+     */
+    struct Job {
+        Mat image;                         /**< Imagen BGR */
+        std::string fileName;              /**< Fichero de destino (vaco = directorio rotativo) */
+        std::string streamId;              /**< Identificador del flujo */
+        int64_t timestampMs = 0;           /**< Instante de captura */
+        uint64_t frameIndex = 0;           /**< Nmero de fotograma */
+        std::vector<DecodedCode> codes;    /**< Cdigos del fotograma */
+        bool failed = false;               /**< Algn cdigo no se ha reconocido */
+    };
+
+    /**
+     * @struct ArchiveDirectory
+     * @brief Directorio rotativo creado por este archivo.
+     */
+    struct ArchiveDirectory {
+        std::string path;                  /**< Ruta del directorio */
+        int pendingWrites = 0;             /**< Imgenes reservadas en l que todava se estn escribiendo */
+    };
+
+    /**
+     * @brief Inserta un trabajo en la cola si cabe.
+     */
+    bool enqueue(Job &&job);
+
+    /**
+     * @brief Bucle de los hilos de codificacin.
+     */
+    void run();
+
+    /**
+     * @brief Reserva el nombre de la siguiente imagen del directorio rotativo actual, rotando si est lleno.
+     *
+     * @param job Trabajo al que se asigna el nombre.
+     * @return std::string Directorio en el que se ha reservado.
+     */
+    std::string reserveFileName(Job &job);
+
+    /**
+     * @brief Crea el siguiente directorio rotativo, eliminando los ms antiguos.
+     */
+    void rotate();
+
+    /**
+     * @brief Indica que ha terminado la escritura de una imagen reservada en un directorio rotativo.
+     *
+     * @param directory Directorio devuelto por `reserveFileName`.
+     */
+    void releaseDirectory(const std::string &directory);
+
+    /**
+     * @brief Elimina los directorios ms antiguos que sobran, mientras ninguno tenga escrituras pendientes.
+     *
+     * Se llama con `directoryMutex` tomado.
+     */
+    void removeExpiredDirectories();
+
+    FrameArchiverParams params;              /**< Configuracin del archivo */
+    std::deque<Job> queue;                   /**< Imgenes pendientes */
+    mutable std::mutex mutex;                /**< Protege la cola y el contador del muestreo */
+    std::condition_variable condition;       /**< Despierta a los hilos de codificacin */
+    std::vector<std::thread> workers;        /**< Hilos de codificacin */
+    bool stopping = false;                   /**< Indica a los hilos que deben terminar */
+    uint64_t sampleCounter = 0;              /**< Fotogramas correctos vistos por `OneInN` */
+
+    std::mutex directoryMutex;               /**< Protege el directorio actual y los ndices */
+    std::string currentDirectory;            /**< Directorio rotativo actual (vaco hasta la primera imagen) */
+    int framesInDirectory = 0;               /**< Imgenes reservadas en el directorio actual */
+    int directoryIndex = 0;                  /**< ndice del directorio actual dentro de la ejecucin */
+    std::deque<ArchiveDirectory> directories; /**< Directorios creados, del ms antiguo al ms reciente */
+
+    std::atomic<uint64_t> offered{ 0 };      /**< Fotogramas con cdigos recibidos */
+    std::atomic<uint64_t> sampledOut{ 0 };   /**< Fotogramas excluidos por el muestreo */
+    std::atomic<uint64_t> dropped{ 0 };      /**< Fotogramas descartados */
+    std::atomic<uint64_t> archived{ 0 };     /**< Imgenes escritas */
+    std::atomic<uint64_t> errors{ 0 };       /**< Imgenes con error */
+    std::atomic<uint64_t> encodeUs{ 0 };     /**< Tiempo total de codificacin y escritura, en microsegundos */
+};
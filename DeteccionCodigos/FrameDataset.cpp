@@ -0,0 +1,435 @@
+#include "FrameDataset.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(FrameDatasetHeader) == 64, "La cabecera del conjunto debe ocupar 64 bytes");
+static_assert(sizeof(FrameDatasetEntry) == 56, "Las entradas del ndice deben ocupar 56 bytes");
+
+/**
+ * @brief Identificador de los ficheros de conjuntos de fotogramas.
+ */
+static const char datasetMagic[8] = { 'D', 'C', 'F', 'R', 'A', 'M', 'E', '1' };
+
+/**
+ * @brief Alineacin de los datos de cada fotograma dentro del fichero.
+ */
+static const uint64_t datasetAlignment = 64;
+
+
+/**
+ * @brief Constructor de la clase CFrameDatasetWriter.
+ *
+ * @param params Representacin de los fotogramas.
+ */
+CFrameDatasetWriter::CFrameDatasetWriter(const FrameDatasetParams &params)
+    : params(params)
+{
+}
+
+
+/**
+ * @brief Destructor de la clase CFrameDatasetWriter.
+ */
+CFrameDatasetWriter::~CFrameDatasetWriter() {
+    if (file.is_open()) {
+        close();
+    }
+}
+
+
+/**
+ * @brief Crea el fichero de salida y reserva el espacio de la cabecera.
+ *
+ * @param fileName Nombre del fichero.
+ *
+ * @return bool true si se ha podido crear.
+ */
+bool CFrameDatasetWriter::open(const std::string &fileName) {
+    file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    FrameDatasetHeader header{};
+    file.write(reinterpret_cast<const char *>( &header ), sizeof(header));
+    position = sizeof(header);
+    entries.clear();
+    labels.clear();
+    return file.good();
+}
+
+
+/**
+ * @brief Aade un fotograma BGR.
+ *
+ * @param frame Fotograma BGR.
+ * @param label Etiqueta del fotograma.
+ * @param timestampMs Instante de captura.
+ *
+ * @return bool true si se ha podido escribir.
+ */
+bool CFrameDatasetWriter::addFrame(const Mat &frame, const std::string &label, int64_t timestampMs) {
+    if (!file.is_open() || frame.empty() || frame.type() != CV_8UC3) {
+        return false;
+    }
+
+    // Paso 1: Reducir el fotograma si se ha pedido
+    Mat stored = frame;
+    if (params.scale > 0 && params.scale < 1.0) {
+        resize(frame, stored, Size(), params.scale, params.scale, INTER_AREA);
+    }
+
+    FrameDatasetEntry entry{};
+    entry.timestampMs = timestampMs;
+    entry.width = stored.cols;
+    entry.height = stored.rows;
+    entry.type = stored.type();
+    entry.encoding = params.encoding;
+
+    // Paso 2: Escribir los pxeles (filas contiguas) o el JPEG
+    if (params.encoding == FrameDatasetParams::Raw) {
+        if (!stored.isContinuous()) {
+            stored = stored.clone();
+        }
+        entry.step = static_cast<uint32_t>( stored.step[0] );
+        entry.size = static_cast<uint64_t>( stored.total() * stored.elemSize() );
+        return writeEntry(entry, stored.data, label);
+    }
+    std::vector<uchar> jpeg;
+    if (!imencode(".jpg", stored, jpeg, { IMWRITE_JPEG_QUALITY, params.jpegQuality })) {
+        return false;
+    }
+    entry.size = jpeg.size();
+    return writeEntry(entry, jpeg.data(), label);
+}
+
+
+/**
+ * @brief Aade un fotograma ya codificado en JPEG, copiando sus bytes tal cual.
+ *
+ * @param jpeg Bytes del fichero JPEG.
+ * @param size Tamao del fotograma.
+ * @param label Etiqueta del fotograma.
+ * @param timestampMs Instante de captura.
+ *
+ * @return bool true si se ha podido escribir (false si los parmetros piden otra representacin o escala).
+ */
+bool CFrameDatasetWriter::addJpeg(const std::vector<uchar> &jpeg, Size size, const std::string &label, int64_t timestampMs) {
+    if (!file.is_open() || jpeg.empty() || params.encoding != FrameDatasetParams::Jpeg || ( params.scale > 0 && params.scale < 1.0 )) {
+        return false;
+    }
+    FrameDatasetEntry entry{};
+    entry.timestampMs = timestampMs;
+    entry.width = size.width;
+    entry.height = size.height;
+    entry.type = CV_8UC3;
+    entry.encoding = FrameDatasetParams::Jpeg;
+    entry.size = jpeg.size();
+    return writeEntry(entry, jpeg.data(), label);
+}
+
+
+/**
+ * @brief Escribe los datos de un fotograma alineados a 64 bytes y aade su entrada al ndice.
+ *
+ * @param entry Entrada del fotograma (sin posicin ni etiqueta).
+ * @param data Datos del fotograma (`entry.size` bytes).
+ * @param label Etiqueta del fotograma.
+ *
+ * @return bool true si se ha podido escribir.
+ */
+bool CFrameDatasetWriter::writeEntry(FrameDatasetEntry entry, const uchar *data, const std::string &label) {
+    // Paso 1: Relleno hasta la siguiente posicin alineada
+    static const char padding[datasetAlignment] = {};
+    uint64_t aligned = ( position + datasetAlignment - 1 ) / datasetAlignment * datasetAlignment;
+    file.write(padding, static_cast<std::streamsize>( aligned - position ));
+
+    // Paso 2: Datos del fotograma
+    file.write(reinterpret_cast<const char *>( data ), static_cast<std::streamsize>( entry.size ));
+    if (!file.good()) {
+        return false;
+    }
+    entry.offset = aligned;
+    position = aligned + entry.size;
+
+    // Paso 3: Entrada del ndice y etiqueta
+    entry.labelOffset = static_cast<uint32_t>( labels.size() );
+    entry.labelLength = static_cast<uint32_t>( label.size() );
+    labels += label;
+    entries.push_back(entry);
+    return true;
+}
+
+
+/**
+ * @brief Escribe el ndice, las etiquetas y la cabecera definitiva, y cierra el fichero.
+ *
+ * @return bool true si el fichero se ha completado correctamente.
+ */
+bool CFrameDatasetWriter::close() {
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Paso 1: ndice y etiquetas al final del fichero
+    FrameDatasetHeader header{};
+    std::memcpy(header.magic, datasetMagic, sizeof(header.magic));
+    header.version = 1;
+    header.frameCount = static_cast<uint32_t>( entries.size() );
+    header.indexOffset = position;
+    header.labelsOffset = position + entries.size() * sizeof(FrameDatasetEntry);
+    header.labelsSize = labels.size();
+    file.write(reinterpret_cast<const char *>( entries.data() ), static_cast<std::streamsize>( entries.size() * sizeof(FrameDatasetEntry) ));
+    file.write(labels.data(), static_cast<std::streamsize>( labels.size() ));
+
+    // Paso 2: Cabecera con las posiciones del ndice (el fichero no es vlido hasta este momento)
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>( &header ), sizeof(header));
+    bool ok = file.good();
+    file.close();
+    return ok;
+}
+
+
+/**
+ * @brief Devuelve el nmero de fotogramas aadidos.
+ *
+ * @return size_t Fotogramas.
+ */
+size_t CFrameDatasetWriter::getFrameCount() const {
+    return entries.size();
+}
+
+
+/**
+ * @brief Destructor de la clase CFrameDatasetReader.
+ */
+CFrameDatasetReader::~CFrameDatasetReader() {
+    close();
+}
+
+
+/**
+ * @brief Abre y mapea un fichero .dcf.
+ *
+ * @param fileName Nombre del fichero.
+ *
+ * @return bool true si la cabecera y todas las entradas del ndice son vlidas.
+ */
+bool CFrameDatasetReader::open(const std::string &fileName) {
+    close();
+
+    // Paso 1: Mapear el fichero completo en modo copia en escritura
+#ifdef _WIN32
+    HANDLE fileH = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileH == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mappingH = GetFileSizeEx(fileH, &fileSize) && fileSize.QuadPart > 0
+        ? CreateFileMappingA(fileH, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+    void *view = mappingH ? MapViewOfFile(mappingH, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+    if (view == nullptr) {
+        if (mappingH) CloseHandle(mappingH);
+        CloseHandle(fileH);
+        return false;
+    }
+    fileHandle = fileH;
+    mappingHandle = mappingH;
+    mapping = static_cast<uchar *>( view );
+    mappingSize = static_cast<uint64_t>( fileSize.QuadPart );
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void *view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, static_cast<size_t>( info.st_size ), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    mapping = static_cast<uchar *>( view );
+    mappingSize = static_cast<uint64_t>( info.st_size );
+#endif
+
+    // Paso 2: Comprobar la cabecera y que el ndice y las etiquetas estn dentro del fichero
+    FrameDatasetHeader header;
+    if (mappingSize < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, datasetMagic, sizeof(header.magic)) != 0 || header.version != 1 ||
+        header.indexOffset > mappingSize || header.frameCount > ( mappingSize - header.indexOffset ) / sizeof(FrameDatasetEntry) ||
+        header.labelsOffset > mappingSize || header.labelsSize > mappingSize - header.labelsOffset) {
+        close();
+        return false;
+    }
+
+    // Paso 3: Leer el ndice y comprobar cada entrada
+    entries.resize(header.frameCount);
+    std::memcpy(entries.data(), mapping + header.indexOffset, entries.size() * sizeof(FrameDatasetEntry));
+    records.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const FrameDatasetEntry &entry = entries[i];
+        bool valid = entry.offset <= mappingSize && entry.size <= mappingSize - entry.offset &&
+                     static_cast<uint64_t>( entry.labelOffset ) + entry.labelLength <= header.labelsSize &&
+                     entry.width >= 0 && entry.height >= 0;
+        if (valid && entry.encoding == FrameDatasetParams::Raw) {
+            valid = entry.type == CV_8UC3 && entry.step >= static_cast<uint64_t>( entry.width ) * 3 &&
+                    static_cast<uint64_t>( entry.step ) * entry.height <= entry.size;
+        }
+        else if (valid) {
+            // Un JPEG vaco hara fallar `imdecode` al leerlo; el fichero se rechaza ya al abrirlo
+            valid = entry.encoding == FrameDatasetParams::Jpeg && entry.size > 0;
+        }
+        if (!valid) {
+            close();
+            return false;
+        }
+        records[i].label.assign(reinterpret_cast<const char *>( mapping + header.labelsOffset + entry.labelOffset ), entry.labelLength);
+        records[i].timestampMs = entry.timestampMs;
+        records[i].size = Size(entry.width, entry.height);
+        records[i].encoding = static_cast<FrameDatasetParams::Encoding>( entry.encoding );
+    }
+    return true;
+}
+
+
+/**
+ * @brief Deshace el mapeo y cierra el fichero.
+ */
+void CFrameDatasetReader::close() {
+    if (mapping != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+        CloseHandle(static_cast<HANDLE>( mappingHandle ));
+        CloseHandle(static_cast<HANDLE>( fileHandle ));
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(mapping, static_cast<size_t>( mappingSize ));
+#endif
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    entries.clear();
+    records.clear();
+}
+
+
+/**
+ * @brief Devuelve el nmero de fotogramas.
+ *
+ * @return size_t Fotogramas del conjunto (0 si no est abierto).
+ */
+size_t CFrameDatasetReader::size() const {
+    return entries.size();
+}
+
+
+/**
+ * @brief Devuelve la descripcin de un fotograma.
+ *
+ * @param index ndice del fotograma (menor que `size()`).
+ *
+ * @return const FrameRecord& Etiqueta, instante, tamao y representacin.
+ */
+const FrameRecord &CFrameDatasetReader::getRecord(size_t index) const {
+    return records[index];
+}
+
+
+/**
+ * @brief Direccin de los datos de un fotograma.
+ *
+ * @param index ndice del fotograma.
+ *
+ * @return uchar* Inicio de sus datos en el mapeo.
+ */
+uchar *CFrameDatasetReader::frameData(size_t index) const {
+    return mapping + entries[index].offset;
+}
+
+
+/**
+ * @brief Devuelve un fotograma BGR.
+ *
+ * Los fotogramas decodificados no se copian: el `Mat` apunta al mapeo. Los JPEG se decodifican desde el
+ * mapeo, tambin sin copiarlos antes.
+ *
+ * @param index ndice del fotograma.
+ *
+ * @return Mat Fotograma BGR (vaco si el ndice no es vlido o el JPEG no se puede decodificar).
+ */
+Mat CFrameDatasetReader::getFrame(size_t index) const {
+    if (index >= entries.size()) {
+        return Mat();
+    }
+    const FrameDatasetEntry &entry = entries[index];
+    if (entry.encoding == FrameDatasetParams::Raw) {
+        return Mat(entry.height, entry.width, entry.type, frameData(index), entry.step);
+    }
+    Mat blob(1, static_cast<int>( entry.size ), CV_8UC1, frameData(index));
+    return imdecode(blob, IMREAD_COLOR);
+}
+
+
+/**
+ * @brief Pide al sistema la lectura anticipada de unos fotogramas.
+ *
+ * @param first Primer fotograma.
+ * @param count Nmero de fotogramas (se recorta al final del conjunto).
+ */
+void CFrameDatasetReader::prefetch(size_t first, size_t count) const {
+    if (first >= entries.size() || count == 0) {
+        return;
+    }
+    size_t last = std::min(entries.size(), first + count) - 1;
+    uint64_t begin = entries[first].offset;
+    uint64_t end = entries[last].offset + entries[last].size;
+    if (end <= begin) {
+        return;
+    }
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = mapping + begin;
+    range.NumberOfBytes = static_cast<SIZE_T>( end - begin );
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // posix_madvise exige una direccin alineada a pgina
+    const uint64_t page = static_cast<uint64_t>( sysconf(_SC_PAGESIZE) );
+    uint64_t alignedBegin = begin / page * page;
+    posix_madvise(mapping + alignedBegin, static_cast<size_t>( end - alignedBegin ), POSIX_MADV_WILLNEED);
+#endif
+}
+
+
+/**
+ * @brief Indica si un fichero es un conjunto de fotogramas.
+ *
+ * @param fileName Nombre del fichero.
+ *
+ * @return bool true si empieza por la cabecera de un conjunto.
+ */
+bool CFrameDatasetReader::isDataset(const std::string &fileName) {
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    char magic[sizeof(datasetMagic)] = {};
+    file.read(magic, sizeof(magic));
+    return file.good() && std::memcmp(magic, datasetMagic, sizeof(magic)) == 0;
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cv;
+
+/**
+ * @file FrameDataset.h
+ * @brief Conjunto de fotogramas empaquetado en un nico fichero (.dcf) que se lee mapeado en memoria.
+ *
+ * Reprocesar el archivo de imgenes con una nueva versin del pipeline consiste sobre todo en abrir y
+ * decodificar miles de JPEG pequeos. Un conjunto empaquetado guarda los fotogramas ya decodificados (BGR,
+ * opcionalmente reducidos) o los JPEG originales, uno detrs de otro y alineados a 64 bytes, seguidos de un
+ * ndice con la etiqueta y el instante de cada fotograma. Al leerlo, el fichero se mapea en memoria y cada
+ * fotograma decodificado es una cabecera `Mat` sobre el mapeo, sin copias ni llamadas de lectura.
+ *
+ * Formato (little-endian):
+ *
+ *     FrameDatasetHeader (64 bytes)
+ *     datos de cada fotograma (alineados a 64 bytes)
+ *     FrameDatasetEntry x frameCount
+ *     etiquetas (UTF-8, sin terminador)
+ */
+
+/**
+ * @struct FrameDatasetHeader
+ * @brief Cabecera del fichero.
+ */
+struct FrameDatasetHeader {
+    char magic[8];            /**< "DCFRAME1" */
+    uint32_t version;         /**< Versin del formato (1) */
+    uint32_t frameCount;      /**< Nmero de fotogramas */
+    uint64_t indexOffset;     /**< Posicin del ndice (`FrameDatasetEntry` x frameCount) */
+    uint64_t labelsOffset;    /**< Posicin de las etiquetas */
+    uint64_t labelsSize;      /**< Tamao de las etiquetas, en bytes */
+    uint8_t reserved[24];     /**< Reservado (ceros) */
+};
+
+/**
+ * @struct FrameDatasetEntry
+ * @brief Entrada del ndice: dnde est un fotograma y cmo interpretarlo.
+ */
+struct FrameDatasetEntry {
+    uint64_t offset;          /**< Posicin de los datos del fotograma */
+    uint64_t size;            /**< Tamao de los datos, en bytes */
+    int64_t timestampMs;      /**< Instante de captura, en ms desde epoch (0 si no se conoce) */
+    int32_t width;            /**< Ancho del fotograma */
+    int32_t height;           /**< Alto del fotograma */
+    int32_t type;             /**< Tipo de OpenCV de los pxeles (CV_8UC3) */
+    int32_t encoding;         /**< `FrameDatasetParams::Encoding` */
+    uint32_t step;            /**< Bytes por fila (fotogramas decodificados) */
+    uint32_t labelOffset;     /**< Posicin de la etiqueta dentro de las etiquetas */
+    uint32_t labelLength;     /**< Longitud de la etiqueta */
+    uint32_t reserved;        /**< Reservado (cero) */
+};
+
+/**
+ * @struct FrameDatasetParams
+ * @brief Cmo se guardan los fotogramas al empaquetar.
+ */
+struct FrameDatasetParams {
+    /**
+     * @enum Encoding
+     * @brief Representacin de los fotogramas en el fichero.
+     */
+    enum Encoding {
+        Raw = 0,    /**< Pxeles BGR decodificados: lectura sin decodificar ni copiar (fichero ms grande) */
+        Jpeg = 1    /**< JPEG: fichero pequeo, pero hay que decodificar cada fotograma al leerlo */
+    };
+
+    Encoding encoding = Raw;   /**< Representacin de los fotogramas */
+    double scale = 1.0;        /**< Factor de reduccin de los fotogramas (1 = resolucin original) */
+    int jpegQuality = 95;      /**< Calidad al recodificar en JPEG (si se reduce o el original no es JPEG) */
+};
+
+/**
+ * @struct FrameRecord
+ * @brief Descripcin de un fotograma del conjunto.
+ */
+struct FrameRecord {
+    std::string label;          /**< Etiqueta (p. ej. el nombre del fichero original, "1103_G1_12.jpg") */
+    int64_t timestampMs = 0;    /**< Instante de captura, en ms desde epoch (0 si no se conoce) */
+    Size size;                  /**< Tamao del fotograma */
+    FrameDatasetParams::Encoding encoding = FrameDatasetParams::Raw;  /**< Representacin en el fichero */
+};
+
+/**
+ * @class CFrameDatasetWriter
+ * @brief Empaqueta fotogramas en un fichero .dcf.
+ */
+class CFrameDatasetWriter
+{
+public:
+    /**
+     * @brief Constructor de la clase CFrameDatasetWriter.
+     *
+     * @param params Representacin de los fotogramas.
+     */
+    CFrameDatasetWriter(const FrameDatasetParams &params = FrameDatasetParams());
+
+    /**
+     * @brief Destructor de la clase CFrameDatasetWriter. Cierra el fichero si sigue abierto.
+     */
+    ~CFrameDatasetWriter();
+
+    /**
+     * @brief Crea el fichero de salida.
+     *
+     * @param fileName Nombre del fichero.
+     * @return bool true si se ha podido crear.
+     */
+    bool open(const std::string &fileName);
+
+    /**
+     * @brief Aade un fotograma BGR, reducido y codificado segn los parmetros.
+     *
+     * @param frame Fotograma BGR (CV_8UC3).
+     * @param label Etiqueta del fotograma.
+     * @param timestampMs Instante de captura, en ms desde epoch.
+     * @return bool true si se ha podido escribir.
+     */
+    bool addFrame(const Mat &frame, const std::string &label, int64_t timestampMs);
+
+    /**
+     * @brief Aade un fotograma ya codificado en JPEG, sin recodificarlo (solo con `encoding` = Jpeg y `scale` = 1).
+     *
+     * @param jpeg Bytes del fichero JPEG.
+     * @param size Tamao del fotograma.
+     * @param label Etiqueta del fotograma.
+     * @param timestampMs Instante de captura, en ms desde epoch.
+     * @return bool true si se ha podido escribir.
+     */
+    bool addJpeg(const std::vector<uchar> &jpeg, Size size, const std::string &label, int64_t timestampMs);
+
+    /**
+     * @brief Escribe el ndice y las etiquetas y cierra el fichero.
+     *
+     * @return bool true si el fichero se ha completado correctamente.
+     */
+    bool close();
+
+    /**
+     * @brief Devuelve el nmero de fotogramas aadidos.
+     */
+    size_t getFrameCount() const;
+
+private:
+    /**
+     * @brief Escribe los datos de un fotograma alineados a 64 bytes y aade su entrada al ndice.
+     */
+    bool writeEntry(FrameDatasetEntry entry, const uchar *data, const std::string &label);
+
+    FrameDatasetParams params;                /**< Representacin de los fotogramas */
+    std::ofstream file;                       /**< Fichero de salida */
+    uint64_t position = 0;                    /**< Posicin de escritura */
+    std::vector<FrameDatasetEntry> entries;   /**< ndice */
+    std::string labels;                       /**< Etiquetas concatenadas */
+};
+
+/**
+ * @class CFrameDatasetReader
+ * @brief Lee un fichero .dcf mapeado en memoria.
+ *
+ * El mapeo es privado (copia en escritura): los `Mat` de `getFrame` apuntan directamente al fichero y, si
+ * alguien escribe en ellos, el sistema copia solo las pginas modificadas sin tocar el fichero. Los `Mat`
+ * devueltos son vlidos mientras el lector est abierto.
+ */
+class CFrameDatasetReader
+{
+public:
+    CFrameDatasetReader() = default;
+
+    /**
+     * @brief Destructor de la clase CFrameDatasetReader. Deshace el mapeo.
+     */
+    ~CFrameDatasetReader();
+
+    CFrameDatasetReader(const CFrameDatasetReader &) = delete;
+    CFrameDatasetReader &operator=(const CFrameDatasetReader &) = delete;
+
+    /**
+     * @brief Abre y mapea un fichero .dcf y comprueba su ndice.
+     *
+     * @param fileName Nombre del fichero.
+     * @return bool true si el fichero es un conjunto vlido.
+     */
+    bool open(const std::string &fileName);
+
+    /**
+     * @brief Deshace el mapeo y cierra el fichero.
+     */
+    void close();
+
+    /**
+     * @brief Devuelve el nmero de fotogramas.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Devuelve la etiqueta, el instante, el tamao y la representacin de un fotograma.
+     *
+     * @param index ndice del fotograma.
+     */
+    const FrameRecord &getRecord(size_t index) const;
+
+    /**
+     * @brief Devuelve un fotograma BGR.
+     *
+     * @param index ndice del fotograma.
+     * @return Mat Cabecera sobre el mapeo (fotogramas decodificados) o fotograma decodificado (JPEG);
+     *         vaco si no se puede decodificar.
+     */
+    Mat getFrame(size_t index) const;
+
+    /**
+     * @brief Pide al sistema que empiece a leer del disco los fotogramas indicados (lectura anticipada).
+     *
+     * No bloquea: se llama con el lote siguiente mientras se procesa el actual.
+     *
+     * @param first Primer fotograma.
+     * @param count Nmero de fotogramas.
+     */
+    void prefetch(size_t first, size_t count) const;
+
+    /**
+     * @brief Indica si un fichero es un conjunto de fotogramas (por su cabecera).
+     *
+     * @param fileName Nombre del fichero.
+     */
+    static bool isDataset(const std::string &fileName);
+
+private:
+    /**
+     * @brief Direccin de los datos de un fotograma dentro del mapeo.
+     */
+    uchar *frameData(size_t index) const;
+
+    uchar *mapping = nullptr;                    /**< Inicio del mapeo */
+    uint64_t mappingSize = 0;                    /**< Tamao del mapeo (el del fichero) */
+    std::vector<FrameDatasetEntry> entries;      /**< ndice */
+    std::vector<FrameRecord> records;            /**< Descripcin de cada fotograma */
+#ifdef _WIN32
+    void *fileHandle = nullptr;                  /**< Fichero (HANDLE) */
+    void *mappingHandle = nullptr;               /**< Objeto de mapeo (HANDLE) */
+#endif
+};
@@ -0,0 +1,170 @@
+#include "FrameView.h"
+#include <algorithm>
+
+/**
+ * @brief Libera el `Mat` que mantiene vivos los datos de un `QImage`.
+ *
+ * Se registra como funcin de limpieza del `QImage`, que la llama cuando se destruye la ltima copia.
+ *
+ * @param info Puntero al `Mat` reservado en `setFrame`.
+ */
+static void releaseMat(void *info) {
+    delete static_cast<Mat *>(info);
+}
+
+
+/**
+ * @brief Constructor de la clase CFrameView.
+ *
+ * Permite que el widget se reduzca por debajo del tamao del fotograma, de modo que el diseo no crezca
+ * hasta la resolucin de la cmara.
+ *
+ * @param parent Widget padre (opcional).
+ */
+CFrameView::CFrameView(QWidget *parent)
+    : QLabel(parent)
+{
+    setMinimumSize(1, 1);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+
+/**
+ * @brief Convierte un color BGR de OpenCV en un `QColor`.
+ *
+ * @param color Color BGR.
+ *
+ * @return QColor El color equivalente.
+ */
+static QColor toQColor(const Scalar &color) {
+    return QColor(saturate_cast<int>( color[2] ), saturate_cast<int>( color[1] ), saturate_cast<int>( color[0] ));
+}
+
+
+/**
+ * @brief Muestra un fotograma reducindolo una sola vez al tamao del widget.
+ *
+ * Esta funcin calcula el tamao que ocupa el fotograma dentro del widget conservando su relacin de aspecto
+ * y, si es necesario, lo reduce con `INTER_AREA`. El `QImage` se construye sobre los datos del `Mat`
+ * (reducido o el original compartido por recuento de referencias), sin copiarlos.
+ * Las mscaras del overlay se aplican sobre la imagen reducida; solo si el fotograma se muestra a tamao
+ * completo y hay mscaras se hace una copia, para no modificar el original.
+ *
+ * @param frame Fotograma BGR (CV_8UC3) o en escala de grises (CV_8UC1).
+ * @param overlay Anotaciones en coordenadas del fotograma original.
+ */
+void CFrameView::setFrame(const Mat &frame, const FrameOverlay &overlay) {
+    if (frame.empty()) {
+        return;
+    }
+
+    // Paso 1: Calcular el tamao visible conservando la relacin de aspecto (nunca se ampla)
+    scale = std::min({ 1.0,
+                       static_cast<double>( width() ) / frame.cols,
+                       static_cast<double>( height() ) / frame.rows });
+    Size target(std::max(1, cvRound(frame.cols * scale)), std::max(1, cvRound(frame.rows * scale)));
+
+    // Paso 2: Reducir el fotograma una nica vez sobre un Mat propio que vivir tanto como el QImage.
+    // Si no hace falta reducirlo, el Mat comparte los datos del fotograma original.
+    Mat *display = new Mat();
+    if (target.width != frame.cols || target.height != frame.rows) {
+        resize(frame, *display, target, 0, 0, INTER_AREA);
+    }
+    else if (!overlay.masks.empty()) {
+        *display = frame.clone();
+    }
+    else {
+        *display = frame;
+    }
+
+    // Paso 3: Aplicar las mscaras a la resolucin de salida y guardar el resto de primitivas para paintEvent
+    applyOverlayMasks(*display, overlay, scale);
+    this->overlay.boxes = overlay.boxes;
+    this->overlay.labels = overlay.labels;
+
+    // Paso 4: Envolver los datos sin copiarlos; releaseMat libera el Mat cuando el QImage deja de usarse
+    image = QImage(display->data, display->cols, display->rows, static_cast<qsizetype>( display->step ),
+                   display->channels() == 1 ? QImage::Format_Grayscale8 : QImage::Format_BGR888,
+                   releaseMat, display);
+
+    // Paso 5: Solicitar el repintado
+    update();
+}
+
+
+/**
+ * @brief Devuelve el rectngulo en el que se dibuja el fotograma, centrado en el widget.
+ *
+ * @return QRect El rectngulo ocupado por el fotograma, o un rectngulo vaco si no hay fotograma.
+ */
+QRect CFrameView::getFrameRect() const {
+    if (image.isNull()) {
+        return QRect();
+    }
+    return QRect(( width() - image.width() ) / 2, ( height() - image.height() ) / 2, image.width(), image.height());
+}
+
+
+/**
+ * @brief Devuelve el factor de escala aplicado al ltimo fotograma.
+ *
+ * @return double Tamao mostrado / tamao original (1 si no se ha reducido).
+ */
+double CFrameView::getScale() const {
+    return scale;
+}
+
+
+/**
+ * @brief Elimina el fotograma y muestra de nuevo el texto de la etiqueta.
+ */
+void CFrameView::clear() {
+    image = QImage();
+    overlay.clear();
+    QLabel::clear();
+    update();
+}
+
+
+/**
+ * @brief Pinta el fotograma actual centrado en el widget.
+ *
+ * Si no hay fotograma, delega en `QLabel` para que se muestre el texto. Los rectngulos y textos del
+ * overlay se escalan al tamao mostrado; los textos usan un tamao de fuente fijo para que sigan siendo
+ * legibles aunque el fotograma est muy reducido.
+ *
+ * @param event Evento de pintado.
+ */
+void CFrameView::paintEvent(QPaintEvent *event) {
+    if (image.isNull()) {
+        QLabel::paintEvent(event);
+        return;
+    }
+
+    CTraceScope trace("paint", "gui");
+    QPainter painter(this);
+    QRect frameRect = getFrameRect();
+    painter.drawImage(frameRect.topLeft(), image);
+
+    // Anotaciones en coordenadas del widget
+    if (overlay.boxes.empty() && overlay.labels.empty()) {
+        return;
+    }
+    painter.translate(frameRect.topLeft());
+    painter.setClipRect(QRect(QPoint(0, 0), frameRect.size()));
+    painter.setBrush(Qt::NoBrush);
+
+    for (const OverlayBox &box : overlay.boxes) {
+        painter.setPen(QPen(toQColor(box.color), std::max(1.0, box.thickness * scale)));
+        painter.drawRect(QRectF(box.rect.x * scale, box.rect.y * scale, box.rect.width * scale, box.rect.height * scale));
+    }
+
+    QFont font = painter.font();
+    font.setBold(true);
+    for (const OverlayLabel &label : overlay.labels) {
+        font.setPixelSize(std::max(12, cvRound(22 * label.fontScale * scale)));
+        painter.setFont(font);
+        painter.setPen(toQColor(label.color));
+        painter.drawText(QPointF(label.origin.x * scale, label.origin.y * scale), QString::fromStdString(label.text));
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QLabel>
+#include <QImage>
+#include <QPainter>
+#include "opencv2/opencv.hpp"
+#include "Overlay.h"
+#include "Tracer.h"
+
+using namespace cv;
+
+/**
+ * @class CFrameView
+ * @brief Etiqueta que muestra fotogramas de OpenCV reducidos una sola vez al tamao del widget.
+ *
+ * Sustituye al camino `QImage` -> `QPixmap::fromImage` -> `setPixmap` a resolucin completa: cada fotograma
+ * se reduce directamente al tamao visible (conservando la relacin de aspecto). El `QImage` resultante
+ * apunta a los datos del `Mat`, que se mantiene vivo mediante la funcin de limpieza del `QImage`, y se
+ * pinta en `paintEvent` sin convertirlo a `QPixmap`.
+ * Las anotaciones (`FrameOverlay`) se componen en la propia vista: las mscaras se aplican sobre el fotograma
+ * ya reducido y los rectngulos y textos se pintan con `QPainter`, sin modificar el fotograma original.
+ * Si no hay fotograma, se comporta como un `QLabel` normal (muestra su texto).
+ */
+class CFrameView : public QLabel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor de la clase CFrameView.
+     *
+     * @param parent Widget padre (opcional).
+     */
+    CFrameView(QWidget *parent = nullptr);
+
+    /**
+     * @brief Muestra un fotograma BGR (CV_8UC3) o en escala de grises (CV_8UC1) con sus anotaciones.
+     *
+     * @param frame Fotograma a mostrar. No se copia a resolucin completa ni se modifica.
+     * @param overlay Anotaciones en coordenadas del fotograma original (opcional).
+     */
+    void setFrame(const Mat &frame, const FrameOverlay &overlay = FrameOverlay());
+
+    /**
+     * @brief Devuelve el rectngulo (en coordenadas del widget) en el que se dibuja el fotograma.
+     */
+    QRect getFrameRect() const;
+
+    /**
+     * @brief Devuelve el factor de escala aplicado al ltimo fotograma (tamao mostrado / tamao original).
+     */
+    double getScale() const;
+
+public slots:
+    /**
+     * @brief Elimina el fotograma y muestra de nuevo el texto de la etiqueta.
+     */
+    void clear();
+
+protected:
+    /**
+     * @brief Pinta el fotograma actual centrado en el widget.
+     *
+     * @param event Evento de pintado.
+     */
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QImage image;         /**< Fotograma a mostrar, ya reducido al tamao del widget */
+    double scale = 1;     /**< Factor de escala del ltimo fotograma */
+    FrameOverlay overlay; /**< Rectngulos y textos a pintar sobre el fotograma (las mscaras ya estn aplicadas) */
+};
@@ -0,0 +1,369 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Convierte un `double` a su representacin binaria, para guardarlo en un atmico entero.
+ */
+static uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Convierte una representacin binaria de nuevo a `double`.
+ */
+static double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Suma un valor a un `double` guardado en un atmico entero (bucle de comparacin e intercambio).
+ */
+static void addBits(std::atomic<uint64_t> &bits, double value) {
+    uint64_t expected = bits.load(std::memory_order_relaxed);
+    while (!bits.compare_exchange_weak(expected, toBits(fromBits(expected) + value), std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Escribe un valor como lo espera Prometheus ("+Inf", "NaN" o el nmero).
+ */
+static std::string formatValue(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    std::ostringstream text;
+    text.precision(15);
+    text << value;
+    return text.str();
+}
+
+
+/**
+ * @brief Fija el valor del indicador.
+ *
+ * @param v Valor.
+ */
+void CMetricGauge::set(double v) {
+    bits.store(toBits(v), std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief Suma un valor al indicador.
+ *
+ * @param v Valor a sumar (negativo para restar).
+ */
+void CMetricGauge::add(double v) {
+    addBits(bits, v);
+}
+
+
+/**
+ * @brief Devuelve el valor del indicador.
+ */
+double CMetricGauge::get() const {
+    return fromBits(bits.load(std::memory_order_relaxed));
+}
+
+
+/**
+ * @brief Constructor de la clase CMetricHistogram.
+ *
+ * @param bounds Lmites superiores de los intervalos; se ordenan por si acaso.
+ */
+CMetricHistogram::CMetricHistogram(const std::vector<double> &bounds)
+    : bounds(bounds), buckets(new std::atomic<uint64_t>[bounds.size() + 1])
+{
+    std::sort(this->bounds.begin(), this->bounds.end());
+    for (size_t i = 0; i <= this->bounds.size(); ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+/**
+ * @brief Aade una observacin.
+ *
+ * Solo se incrementa el intervalo que le corresponde (los acumulados se calculan al exponer) y la suma.
+ *
+ * @param value Valor observado.
+ */
+void CMetricHistogram::observe(double value) {
+    size_t index = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    addBits(sumBits, value);
+}
+
+
+/**
+ * @brief Devuelve las observaciones acumuladas hasta cada lmite.
+ *
+ * @return std::vector<uint64_t> Un valor por lmite ms el total (+Inf).
+ */
+std::vector<uint64_t> CMetricHistogram::getCumulativeCounts() const {
+    std::vector<uint64_t> counts(bounds.size() + 1);
+    uint64_t total = 0;
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+        total += buckets[i].load(std::memory_order_relaxed);
+        counts[i] = total;
+    }
+    return counts;
+}
+
+
+/**
+ * @brief Devuelve la suma de los valores observados.
+ */
+double CMetricHistogram::getSum() const {
+    return fromBits(sumBits.load(std::memory_order_relaxed));
+}
+
+
+/**
+ * @brief Lmites de intervalo por defecto para duraciones de etapas.
+ *
+ * @return std::vector<double> De 0,5 ms a 1 s, en segundos.
+ */
+std::vector<double> CMetricHistogram::latencyBounds() {
+    return { 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0 };
+}
+
+
+/**
+ * @brief Empieza a medir (solo si hay histograma de destino).
+ *
+ * @param histogram Histograma de destino (puede ser nullptr).
+ */
+CMetricTimer::CMetricTimer(CMetricHistogram *histogram)
+    : histogram(histogram)
+{
+    if (histogram) {
+        startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+
+/**
+ * @brief Aade la duracin medida al histograma, en segundos.
+ */
+CMetricTimer::~CMetricTimer()
+{
+    if (histogram) {
+        int64_t endNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        histogram->observe(( endNs - startNs ) * 1e-9);
+    }
+}
+
+
+/**
+ * @brief Registra (o devuelve) un contador.
+ *
+ * @param name Nombre de la mtrica.
+ * @param help Descripcin.
+ * @param labels Etiquetas de la serie.
+ *
+ * @return CMetricCounter& El contador de la serie.
+ */
+CMetricCounter &CMetricsRegistry::counter(const std::string &name, const std::string &help, const MetricLabels &labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &series = findSeries(name, help, "counter", labels);
+    if (!series.counter) {
+        series.counter.reset(new CMetricCounter());
+    }
+    return *series.counter;
+}
+
+
+/**
+ * @brief Registra (o devuelve) un indicador.
+ *
+ * @param name Nombre de la mtrica.
+ * @param help Descripcin.
+ * @param labels Etiquetas de la serie.
+ *
+ * @return CMetricGauge& El indicador de la serie.
+ */
+CMetricGauge &CMetricsRegistry::gauge(const std::string &name, const std::string &help, const MetricLabels &labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &series = findSeries(name, help, "gauge", labels);
+    if (!series.gauge) {
+        series.gauge.reset(new CMetricGauge());
+    }
+    return *series.gauge;
+}
+
+
+/**
+ * @brief Registra (o devuelve) un histograma.
+ *
+ * @param name Nombre de la mtrica.
+ * @param help Descripcin.
+ * @param labels Etiquetas de la serie.
+ * @param bounds Lmites de los intervalos.
+ *
+ * @return CMetricHistogram& El histograma de la serie.
+ */
+CMetricHistogram &CMetricsRegistry::histogram(const std::string &name, const std::string &help, const MetricLabels &labels,
+                                              const std::vector<double> &bounds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series &series = findSeries(name, help, "histogram", labels);
+    if (!series.histogram) {
+        series.histogram.reset(new CMetricHistogram(bounds));
+    }
+    return *series.histogram;
+}
+
+
+/**
+ * @brief Aade una funcin que actualiza mtricas antes de cada exposicin.
+ *
+ * @param collector Funcin a llamar.
+ */
+void CMetricsRegistry::addCollector(std::function<void()> collector) {
+    std::lock_guard<std::mutex> lock(mutex);
+    collectors.push_back(collector);
+}
+
+
+/**
+ * @brief Genera todas las mtricas en el formato de texto de Prometheus.
+ *
+ * Los recolectores se llaman fuera del mutex, de modo que pueden registrar mtricas nuevas.
+ *
+ * @return std::string Una lnea `# HELP` y otra `# TYPE` por mtrica y una lnea por valor.
+ */
+std::string CMetricsRegistry::exposition() {
+    // Paso 1: Actualizar las mtricas que se leen de otros componentes
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = collectors;
+    }
+    for (const std::function<void()> &collector : pending) {
+        collector();
+    }
+
+    // Paso 2: Escribir cada mtrica con todas sus series
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream text;
+    for (const auto &entry : families) {
+        const std::string &name = entry.first;
+        const Family &family = entry.second;
+        text << "# HELP " << name << ' ' << family.help << '\n'
+             << "# TYPE " << name << ' ' << family.type << '\n';
+        for (const std::unique_ptr<Series> &series : family.series) {
+            std::string braces = series->labels.empty() ? std::string() : '{' + series->labels + '}';
+            if (series->counter) {
+                text << name << braces << ' ' << series->counter->get() << '\n';
+            }
+            else if (series->gauge) {
+                text << name << braces << ' ' << formatValue(series->gauge->get()) << '\n';
+            }
+            else if (series->histogram) {
+                const std::vector<double> &bounds = series->histogram->getBounds();
+                std::vector<uint64_t> counts = series->histogram->getCumulativeCounts();
+                std::string prefix = series->labels.empty() ? std::string() : series->labels + ',';
+                for (size_t i = 0; i < counts.size(); ++i) {
+                    std::string le = i < bounds.size() ? formatValue(bounds[i]) : "+Inf";
+                    text << name << "_bucket{" << prefix << "le=\"" << le << "\"} " << counts[i] << '\n';
+                }
+                text << name << "_sum" << braces << ' ' << formatValue(series->histogram->getSum()) << '\n'
+                     << name << "_count" << braces << ' ' << counts.back() << '\n';
+            }
+        }
+    }
+    return text.str();
+}
+
+
+/**
+ * @brief Busca o crea la serie de una mtrica.
+ *
+ * @param name Nombre de la mtrica.
+ * @param help Descripcin (solo se usa al crear la mtrica).
+ * @param type Tipo de la mtrica.
+ * @param labels Etiquetas de la serie.
+ *
+ * @return Series& La serie.
+ */
+CMetricsRegistry::Series &CMetricsRegistry::findSeries(const std::string &name, const std::string &help, const std::string &type,
+                                                       const MetricLabels &labels) {
+    // Paso 1: Formatear las etiquetas escapando las barras, las comillas y los saltos de lnea
+    std::string formatted;
+    for (const auto &label : labels) {
+        std::string value;
+        for (char c : label.second) {
+            if (c == '\\') value += "\\\\";
+            else if (c == '"') value += "\\\"";
+            else if (c == '\n') value += "\\n";
+            else value += c;
+        }
+        formatted += ( formatted.empty() ? "" : "," ) + label.first + "=\"" + value + '"';
+    }
+
+    // Paso 2: Buscar la serie en la mtrica, creando las que no existan
+    Family &family = families[name];
+    if (family.type.empty()) {
+        family.help = help;
+        family.type = type;
+    }
+    for (std::unique_ptr<Series> &series : family.series) {
+        if (series->labels == formatted) {
+            return *series;
+        }
+    }
+    family.series.emplace_back(new Series());
+    family.series.back()->labels = formatted;
+    return *family.series.back();
+}
+
+
+/**
+ * @brief Devuelve la memoria residente del proceso.
+ *
+ * En Linux se lee de `/proc/self/statm`; en Windows es el conjunto de trabajo del proceso.
+ *
+ * @return uint64_t Memoria residente, en bytes (0 si no se puede leer).
+ */
+uint64_t getResidentMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<uint64_t>( counters.WorkingSetSize );
+    }
+    return 0;
+#elif defined(__linux__)
+    std::ifstream file("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (file >> size >> resident) {
+        return resident * static_cast<uint64_t>( sysconf(_SC_PAGESIZE) );
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
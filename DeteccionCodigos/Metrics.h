@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file Metrics.h
+ * @brief Registro de mtricas del proceso (contadores, indicadores e histogramas) en formato de texto de Prometheus.
+ *
+ * Las mtricas se registran una vez (con un mutex) y el registro devuelve referencias estables que los
+ * componentes guardan; a partir de ah, actualizarlas son solo operaciones atmicas relajadas, sin bloqueos,
+ * de modo que el coste en el camino crtico es de unos pocos nanosegundos. `exposition` genera el texto que
+ * se sirve en `GET /metrics`.
+ */
+
+/**
+ * @brief Etiquetas de una serie, p. ej. `{ { "stream", "rtsp://..." }, { "stage", "locate" } }`.
+ */
+typedef std::vector<std::pair<std::string, std::string>> MetricLabels;
+
+/**
+ * @class CMetricCounter
+ * @brief Contador montono.
+ */
+class CMetricCounter
+{
+public:
+    /**
+     * @brief Incrementa el contador.
+     *
+     * @param n Incremento.
+     */
+    void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+
+    /**
+     * @brief Fija el valor, para reflejar un contador montono que mantiene otro componente (p. ej. `getDropped`).
+     *
+     * @param n Valor del contador.
+     */
+    void set(uint64_t n) { value.store(n, std::memory_order_relaxed); }
+
+    /**
+     * @brief Devuelve el valor del contador.
+     */
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{ 0 };   /**< Valor del contador */
+};
+
+/**
+ * @class CMetricGauge
+ * @brief Indicador: un valor que puede subir y bajar (profundidad de una cola, memoria en uso).
+ */
+class CMetricGauge
+{
+public:
+    /**
+     * @brief Fija el valor del indicador.
+     */
+    void set(double v);
+
+    /**
+     * @brief Suma un valor (negativo para restar) al indicador.
+     */
+    void add(double v);
+
+    /**
+     * @brief Devuelve el valor del indicador.
+     */
+    double get() const;
+
+private:
+    std::atomic<uint64_t> bits{ 0 };    /**< Representacin binaria del valor `double` (0.0) */
+};
+
+/**
+ * @class CMetricHistogram
+ * @brief Histograma de valores (normalmente duraciones en segundos) con lmites de intervalo fijos.
+ *
+ * Prometheus calcula los percentiles a partir de los intervalos (`histogram_quantile`).
+ */
+class CMetricHistogram
+{
+public:
+    /**
+     * @brief Constructor de la clase CMetricHistogram.
+     *
+     * @param bounds Lmites superiores de los intervalos, en orden creciente (el intervalo +Inf se aade solo).
+     */
+    explicit CMetricHistogram(const std::vector<double> &bounds);
+
+    /**
+     * @brief Aade una observacin.
+     *
+     * @param value Valor observado.
+     */
+    void observe(double value);
+
+    /**
+     * @brief Devuelve los lmites de los intervalos.
+     */
+    const std::vector<double> &getBounds() const { return bounds; }
+
+    /**
+     * @brief Devuelve las observaciones acumuladas hasta cada lmite (la ltima es el total, +Inf).
+     */
+    std::vector<uint64_t> getCumulativeCounts() const;
+
+    /**
+     * @brief Devuelve la suma de los valores observados.
+     */
+    double getSum() const;
+
+    /**
+     * @brief Lmites de intervalo por defecto para duraciones de etapas, de 0,5 ms a 1 s.
+     */
+    static std::vector<double> latencyBounds();
+
+private:
+    std::vector<double> bounds;                          /**< Lmites superiores de los intervalos */
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;    /**< Observaciones de cada intervalo (bounds.size() + 1) */
+    std::atomic<uint64_t> sumBits{ 0 };                  /**< Representacin binaria de la suma (`double`) */
+};
+
+/**
+ * @class CMetricTimer
+ * @brief Mide la duracin de un mbito y la aade a un histograma en segundos. Si el histograma es nullptr, no mide nada.
+ */
+class CMetricTimer
+{
+public:
+    /**
+     * @brief Empieza a medir.
+     *
+     * @param histogram Histograma de destino (puede ser nullptr).
+     */
+    explicit CMetricTimer(CMetricHistogram *histogram);
+
+    /**
+     * @brief Aade la duracin medida al histograma.
+     */
+    ~CMetricTimer();
+
+    CMetricTimer(const CMetricTimer &) = delete;
+    CMetricTimer &operator=(const CMetricTimer &) = delete;
+
+private:
+    CMetricHistogram *histogram;   /**< Histograma de destino */
+    int64_t startNs = 0;           /**< Instante de inicio, en ns del reloj montono */
+};
+
+/**
+ * @class CMetricsRegistry
+ * @brief Registro de las mtricas del proceso.
+ *
+ * Registrar dos veces la misma mtrica con las mismas etiquetas devuelve la misma serie. Las referencias
+ * devueltas son vlidas mientras exista el registro.
+ */
+class CMetricsRegistry
+{
+public:
+    /**
+     * @brief Registra (o devuelve) un contador.
+     *
+     * @param name Nombre de la mtrica (p. ej. "dc_capture_frames_total").
+     * @param help Descripcin.
+     * @param labels Etiquetas de la serie.
+     */
+    CMetricCounter &counter(const std::string &name, const std::string &help, const MetricLabels &labels = MetricLabels());
+
+    /**
+     * @brief Registra (o devuelve) un indicador.
+     *
+     * @param name Nombre de la mtrica.
+     * @param help Descripcin.
+     * @param labels Etiquetas de la serie.
+     */
+    CMetricGauge &gauge(const std::string &name, const std::string &help, const MetricLabels &labels = MetricLabels());
+
+    /**
+     * @brief Registra (o devuelve) un histograma.
+     *
+     * @param name Nombre de la mtrica (p. ej. "dc_stage_seconds").
+     * @param help Descripcin.
+     * @param labels Etiquetas de la serie.
+     * @param bounds Lmites de los intervalos (solo se usan al crear la serie).
+     */
+    CMetricHistogram &histogram(const std::string &name, const std::string &help, const MetricLabels &labels = MetricLabels(),
+                                const std::vector<double> &bounds = CMetricHistogram::latencyBounds());
+
+    /**
+     * @brief Aade una funcin que actualiza mtricas justo antes de cada `exposition` (p. ej. profundidades de colas).
+     *
+     * @param collector Funcin a llamar; se ejecuta en el hilo que llama a `exposition`.
+     */
+    void addCollector(std::function<void()> collector);
+
+    /**
+     * @brief Genera todas las mtricas en el formato de texto de Prometheus (versin 0.0.4).
+     */
+    std::string exposition();
+
+private:
+    /**
+     * @struct Series
+     * @brief Una serie (una combinacin de etiquetas) de una mtrica.
+     */
+    struct Series {
+        std::string labels;                             /**< Etiquetas ya formateadas, sin llaves ('stream="a"') */
+        std::unique_ptr<CMetricCounter> counter;        /**< Contador (si la mtrica es un contador) */
+        std::unique_ptr<CMetricGauge> gauge;            /**< Indicador (si la mtrica es un indicador) */
+        std::unique_ptr<CMetricHistogram> histogram;    /**< Histograma (si la mtrica es un histograma) */
+    };
+
+    /**
+     * @struct Family
+     * @brief Una mtrica con todas sus series.
+     */
+    struct Family {
+        std::string help;                               /**< Descripcin */
+        std::string type;                               /**< "counter", "gauge" o "histogram" */
+        std::vector<std::unique_ptr<Series>> series;    /**< Series de la mtrica */
+    };
+
+    /**
+     * @brief Busca o crea la serie de una mtrica.
+     */
+    Series &findSeries(const std::string &name, const std::string &help, const std::string &type, const MetricLabels &labels);
+
+    std::mutex mutex;                                   /**< Protege las familias y los recolectores */
+    std::map<std::string, Family> families;             /**< Mtricas, por nombre */
+    std::vector<std::function<void()>> collectors;      /**< Funciones llamadas antes de cada exposicin */
+};
+
+/**
+ * @brief Devuelve la memoria residente del proceso, en bytes (0 si el sistema no permite leerla).
+ */
+uint64_t getResidentMemoryBytes();
@@ -0,0 +1,119 @@
+#include "MotionGate.h"
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @brief Constructor de la clase CMotionGate.
+ *
+ * @param params Configuracin del detector de movimiento.
+ */
+CMotionGate::CMotionGate(const MotionGateParams &params)
+    : params(params)
+{
+}
+
+
+/**
+ * @brief Reduce un fotograma a su plano de luminancia.
+ *
+ * Primero se reduce el fotograma en color y despus se convierte a gris, de modo que la conversin se
+ * aplica solo a los pxeles reducidos.
+ *
+ * @param frame Fotograma BGR.
+ *
+ * @return Mat Plano de luminancia de `params.width` pxeles de ancho (o el original si es ms estrecho).
+ */
+Mat CMotionGate::lumaPlane(const Mat &frame) const {
+    Mat small = frame;
+    if (params.width > 0 && frame.cols > params.width) {
+        int height = std::max(1, cvRound(static_cast<double>( frame.rows ) * params.width / frame.cols));
+        resize(frame, small, Size(params.width, height), 0, 0, INTER_AREA);
+    }
+    Mat luma;
+    if (small.channels() == 3) {
+        cvtColor(small, luma, COLOR_BGR2GRAY);
+    }
+    else {
+        luma = small.clone();
+    }
+    return luma;
+}
+
+
+/**
+ * @brief Comprueba si un fotograma ha cambiado lo suficiente respecto al ltimo procesado.
+ *
+ * @param frame Fotograma BGR.
+ *
+ * @return bool true si hay que procesar el fotograma, false si se puede reutilizar el resultado anterior.
+ */
+bool CMotionGate::check(const Mat &frame) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Paso 1: Plano de luminancia reducido del fotograma
+    Mat luma = lumaPlane(frame);
+
+    // Paso 2: Fraccin de pxeles que han cambiado respecto a la referencia. Sin referencia (primer
+    // fotograma o tras `reset`) o si cambia la resolucin, el fotograma se procesa siempre
+    bool process = true;
+    if (!reference.empty() && reference.size() == luma.size()) {
+        Mat diff;
+        absdiff(luma, reference, diff);
+        int changed = countNonZero(diff > params.pixelThreshold);
+        stats.lastChangedFraction = static_cast<double>( changed ) / diff.total();
+        process = stats.lastChangedFraction >= params.changedFraction;
+    }
+    else {
+        stats.lastChangedFraction = 1.0;
+    }
+
+    // Paso 3: Forzar el procesamiento si se ha alcanzado el mximo de fotogramas omitidos seguidos
+    if (!process && params.maxSkippedFrames > 0 && skippedInARow >= params.maxSkippedFrames) {
+        process = true;
+    }
+
+    // Paso 4: Actualizar la referencia y las estadsticas
+    if (process) {
+        reference = luma;
+        skippedInARow = 0;
+        stats.processedFrames++;
+    }
+    else {
+        skippedInARow++;
+        stats.skippedFrames++;
+    }
+    stats.checkedFrames++;
+    stats.lastCheckUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    stats.meanCheckUs += ( stats.lastCheckUs - stats.meanCheckUs ) / stats.checkedFrames;
+    stats.maxCheckUs = std::max(stats.maxCheckUs, stats.lastCheckUs);
+    return process;
+}
+
+
+/**
+ * @brief Olvida el fotograma de referencia; el siguiente fotograma se procesa siempre.
+ */
+void CMotionGate::reset() {
+    reference.release();
+    skippedInARow = 0;
+}
+
+
+/**
+ * @brief Devuelve las estadsticas acumuladas.
+ *
+ * @return const MotionGateStats& Fotogramas comprobados, procesados y omitidos, y duracin de las comprobaciones.
+ */
+const MotionGateStats &CMotionGate::getStats() const {
+    return stats;
+}
+
+
+/**
+ * @brief Devuelve la configuracin actual.
+ *
+ * @return const MotionGateParams& Configuracin del detector de movimiento.
+ */
+const MotionGateParams &CMotionGate::getParams() const {
+    return params;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include <cstdint>
+
+using namespace cv;
+
+/**
+ * @struct MotionGateParams
+ * @brief Configuracin del detector de movimiento que decide si un fotograma se procesa.
+ */
+struct MotionGateParams {
+    int width = 160;                 /**< Ancho del plano de luminancia reducido sobre el que se compara (el alto, proporcional) */
+    int pixelThreshold = 20;         /**< Diferencia de luminancia a partir de la cual un pxel cuenta como cambiado */
+    double changedFraction = 0.005;  /**< Fraccin de pxeles cambiados a partir de la cual se procesa el fotograma */
+    int maxSkippedFrames = 0;        /**< Fotogramas seguidos que se pueden omitir como mximo (0 = sin lmite) */
+};
+
+/**
+ * @struct MotionGateStats
+ * @brief Estadsticas acumuladas del detector de movimiento.
+ */
+struct MotionGateStats {
+    uint64_t checkedFrames = 0;       /**< Fotogramas comprobados */
+    uint64_t processedFrames = 0;     /**< Fotogramas en los que se ha indicado que hay que procesar */
+    uint64_t skippedFrames = 0;       /**< Fotogramas omitidos (se reutiliza el resultado anterior) */
+    double lastChangedFraction = 0;   /**< Fraccin de pxeles cambiados en la ltima comprobacin */
+    double lastCheckUs = 0;           /**< Duracin de la ltima comprobacin, en microsegundos */
+    double meanCheckUs = 0;           /**< Duracin media de las comprobaciones, en microsegundos */
+    double maxCheckUs = 0;            /**< Duracin mxima de una comprobacin, en microsegundos */
+};
+
+/**
+ * @class CMotionGate
+ * @brief Detector de movimiento por diferencia de imgenes que evita procesar fotogramas sin cambios.
+ *
+ * Entre dos piezas de la cinta la escena est quieta. Cada fotograma se reduce a un plano de luminancia
+ * pequeo y se compara con el del ltimo fotograma procesado; solo si la fraccin de pxeles cambiados
+ * supera `changedFraction` se indica que hay que ejecutar el detector. En caso contrario, el llamador
+ * reutiliza el resultado anterior. La comparacin es con el ltimo fotograma procesado (no con el
+ * anterior), de modo que un cambio lento tambin acaba disparando el procesamiento.
+ */
+class CMotionGate
+{
+public:
+    /**
+     * @brief Constructor de la clase CMotionGate.
+     *
+     * @param params Configuracin del detector de movimiento.
+     */
+    CMotionGate(const MotionGateParams &params = MotionGateParams());
+
+    /**
+     * @brief Comprueba si un fotograma ha cambiado lo suficiente para procesarlo.
+     *
+     * Si devuelve true, el fotograma pasa a ser la referencia de las comprobaciones siguientes.
+     *
+     * @param frame Fotograma BGR.
+     * @return true si hay que procesar el fotograma; false si se puede reutilizar el resultado anterior.
+     */
+    bool check(const Mat &frame);
+
+    /**
+     * @brief Olvida el fotograma de referencia, de modo que el siguiente se procesa siempre.
+     *
+     * Se usa cuando el resultado anterior deja de ser vlido (p. ej. al cambiar de modo o de parmetros).
+     */
+    void reset();
+
+    /**
+     * @brief Devuelve las estadsticas acumuladas.
+     */
+    const MotionGateStats &getStats() const;
+
+    /**
+     * @brief Devuelve la configuracin actual.
+     */
+    const MotionGateParams &getParams() const;
+
+private:
+    /**
+     * @brief Reduce un fotograma BGR a su plano de luminancia de `params.width` pxeles de ancho.
+     *
+     * @param frame Fotograma BGR.
+     * @return Mat Plano de luminancia reducido (CV_8UC1).
+     */
+    Mat lumaPlane(const Mat &frame) const;
+
+    MotionGateParams params;   /**< Configuracin */
+    MotionGateStats stats;     /**< Estadsticas acumuladas */
+    Mat reference;             /**< Luminancia reducida del ltimo fotograma procesado */
+    int skippedInARow = 0;     /**< Fotogramas omitidos desde el ltimo procesado */
+};
@@ -0,0 +1,85 @@
+#include "Overlay.h"
+
+/**
+ * @brief Escala un rectngulo de coordenadas de la imagen original a las de una imagen reducida.
+ *
+ * @param rect Rectngulo original.
+ * @param scale Factor de escala.
+ *
+ * @return Rect El rectngulo escalado.
+ */
+static Rect scaleRect(const Rect &rect, double scale) {
+    if (scale == 1.0) {
+        return rect;
+    }
+    int x0 = cvRound(rect.x * scale);
+    int y0 = cvRound(rect.y * scale);
+    int x1 = cvRound(( rect.x + rect.width ) * scale);
+    int y1 = cvRound(( rect.y + rect.height ) * scale);
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+
+/**
+ * @brief Aplica las mscaras de visibilidad del overlay sobre una imagen.
+ *
+ * Esta funcin combina todas las mscaras del overlay (reducidas con vecino ms prximo si `scale` es
+ * distinto de 1) y pone a negro los pxeles de la imagen que no estn activos en ninguna de ellas.
+ * Si el overlay no contiene mscaras, la imagen no se modifica.
+ *
+ * @param image Imagen de destino, que se modifica en el sitio.
+ * @param overlay Overlay con las mscaras.
+ * @param scale Escala de `image` respecto a la imagen original.
+ */
+void applyOverlayMasks(Mat &image, const FrameOverlay &overlay, double scale) {
+    if (overlay.masks.empty()) {
+        return;
+    }
+
+    // Paso 1: Combinar las mscaras a la resolucin de la imagen de destino
+    Mat visible = Mat::zeros(image.size(), CV_8UC1);
+    Rect bounds(0, 0, image.cols, image.rows);
+    for (const OverlayMask &m : overlay.masks) {
+        Rect roi = scaleRect(m.roi, scale) & bounds;
+        if (roi.empty() || m.mask.empty()) {
+            continue;
+        }
+        Mat scaledMask;
+        resize(m.mask, scaledMask, roi.size(), 0, 0, INTER_NEAREST);
+        Mat target = visible(roi);
+        bitwise_or(target, scaledMask, target);
+    }
+
+    // Paso 2: Poner a negro los pxeles que no estn en ninguna mscara
+    Mat hidden;
+    bitwise_not(visible, hidden);
+    image.setTo(Scalar::all(0), hidden);
+}
+
+
+/**
+ * @brief Dibuja todas las primitivas del overlay sobre una imagen con OpenCV.
+ *
+ * Se usa cuando hace falta una imagen anotada (por ejemplo, para guardarla o en `getSegmentedImage`).
+ * Las coordenadas y los grosores se escalan con `scale` para poder dibujar sobre una imagen reducida.
+ *
+ * @param image Imagen de destino, que se modifica en el sitio.
+ * @param overlay Overlay a dibujar.
+ * @param scale Escala de `image` respecto a la imagen original.
+ */
+void drawOverlay(Mat &image, const FrameOverlay &overlay, double scale) {
+    // Paso 1: Mscaras de visibilidad
+    applyOverlayMasks(image, overlay, scale);
+
+    // Paso 2: Rectngulos
+    for (const OverlayBox &box : overlay.boxes) {
+        rectangle(image, scaleRect(box.rect, scale), box.color, std::max(1, cvRound(box.thickness * scale)));
+    }
+
+    // Paso 3: Textos
+    for (const OverlayLabel &label : overlay.labels) {
+        Point origin(cvRound(label.origin.x * scale), cvRound(label.origin.y * scale));
+        putText(image, label.text, origin, FONT_HERSHEY_SIMPLEX, label.fontScale * scale, label.color,
+                std::max(1, cvRound(label.thickness * scale)));
+    }
+}
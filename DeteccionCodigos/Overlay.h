@@ -0,0 +1,83 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include <string>
+#include <vector>
+
+using namespace cv;
+
+/**
+ * @struct OverlayBox
+ * @brief Rectngulo a dibujar sobre el fotograma (coordenadas de la imagen original).
+ */
+struct OverlayBox {
+    Rect rect;                           /**< Rectngulo en coordenadas de la imagen original */
+    Scalar color = Scalar(0, 255, 0);    /**< Color BGR */
+    int thickness = 2;                   /**< Grosor del trazo, en pxeles de la imagen original */
+};
+
+/**
+ * @struct OverlayLabel
+ * @brief Texto a dibujar sobre el fotograma (coordenadas de la imagen original).
+ */
+struct OverlayLabel {
+    std::string text;                    /**< Texto a mostrar */
+    Point origin;                        /**< Esquina inferior izquierda del texto */
+    Scalar color = Scalar(0, 255, 0);    /**< Color BGR */
+    double fontScale = 1;                /**< Escala de la fuente (como en `putText`) */
+    int thickness = 2;                   /**< Grosor del trazo */
+};
+
+/**
+ * @struct OverlayMask
+ * @brief Mscara de visibilidad sobre una regin del fotograma.
+ *
+ * Si un overlay contiene mscaras, solo se muestran los pxeles activos en alguna de ellas; el resto se
+ * muestra en negro (equivalente a `applyMaskToImage`, pero aplicado a la resolucin de salida).
+ */
+struct OverlayMask {
+    Rect roi;                            /**< Regin cubierta por la mscara, en coordenadas de la imagen original */
+    Mat mask;                            /**< Mscara CV_8UC1 del tamao de `roi` (distinto de 0 = visible) */
+};
+
+/**
+ * @struct FrameOverlay
+ * @brief Conjunto de primitivas ligeras que se componen sobre el fotograma original en la capa de visualizacin.
+ *
+ * Permite que el detector no copie ni modifique el fotograma para anotarlo: quien muestra la imagen decide
+ * si dibujar las primitivas, a qu resolucin y con qu medio (OpenCV, QPainter...). Una aplicacin sin
+ * interfaz puede ignorarlas por completo.
+ */
+struct FrameOverlay {
+    std::vector<OverlayBox> boxes;       /**< Rectngulos */
+    std::vector<OverlayLabel> labels;    /**< Textos */
+    std::vector<OverlayMask> masks;      /**< Mscaras de visibilidad */
+
+    /**
+     * @brief Indica si el overlay no contiene ninguna primitiva.
+     */
+    bool empty() const { return boxes.empty() && labels.empty() && masks.empty(); }
+
+    /**
+     * @brief Elimina todas las primitivas.
+     */
+    void clear() { boxes.clear(); labels.clear(); masks.clear(); }
+};
+
+/**
+ * @brief Aplica las mscaras de visibilidad del overlay sobre una imagen.
+ *
+ * @param image Imagen de destino (se modifica). Puede estar reducida respecto a la original.
+ * @param overlay Overlay con las mscaras.
+ * @param scale Escala de `image` respecto a la imagen original.
+ */
+void applyOverlayMasks(Mat &image, const FrameOverlay &overlay, double scale = 1.0);
+
+/**
+ * @brief Dibuja todas las primitivas del overlay (mscaras, rectngulos y textos) sobre una imagen con OpenCV.
+ *
+ * @param image Imagen de destino (se modifica). Puede estar reducida respecto a la original.
+ * @param overlay Overlay a dibujar.
+ * @param scale Escala de `image` respecto a la imagen original.
+ */
+void drawOverlay(Mat &image, const FrameOverlay &overlay, double scale = 1.0);
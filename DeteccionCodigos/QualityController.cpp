@@ -0,0 +1,300 @@
+#include "QualityController.h"
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @brief Lee la configuracin de las claves `quality*` de un fichero de OpenCV.
+ *
+ * @param fileName Nombre del fichero (p. ej. detector.yml).
+ * @param params Configuracin leda; las claves ausentes conservan su valor.
+ *
+ * @return bool true si el fichero se ha podido abrir.
+ */
+bool QualityControllerParams::load(const std::string &fileName, QualityControllerParams &params) {
+    // Paso 1: Abrir el fichero en modo lectura
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+
+    // Paso 2: Leer cada campo solo si est presente en el fichero
+    auto readInt = [&fs](const char *key, int &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    auto readDouble = [&fs](const char *key, double &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    readDouble("qualityBudgetMs", params.budgetMs);
+    readDouble("qualitySmoothing", params.smoothing);
+    readDouble("qualityHeadroom", params.headroom);
+    readInt("qualityDownFrames", params.downFrames);
+    readInt("qualityUpFrames", params.upFrames);
+    readInt("qualityMaxLevel", params.maxLevel);
+    if (!fs["qualityLogFile"].empty()) {
+        params.logFile = static_cast<std::string>( fs["qualityLogFile"] );
+    }
+    return true;
+}
+
+
+/**
+ * @brief Constructor de la clase CQualityController.
+ *
+ * Si se ha configurado `logFile`, se abre para aadir y se escribe la cabecera si est vaco.
+ *
+ * @param baseParams Parmetros del detector del nivel 0.
+ * @param params Configuracin del control.
+ */
+CQualityController::CQualityController(const DetectorParams &baseParams, const QualityControllerParams &params)
+    : params(params), baseParams(baseParams), levelParams(baseParams)
+{
+    this->params.smoothing = std::min(std::max(this->params.smoothing, 0.01), 1.0);
+    this->params.downFrames = std::max(1, this->params.downFrames);
+    this->params.upFrames = std::max(1, this->params.upFrames);
+    this->params.maxLevel = std::min(std::max(this->params.maxLevel, 0), numLevels - 1);
+
+    if (isEnabled() && !this->params.logFile.empty()) {
+        bool isNew;
+        {
+            std::ifstream existing(this->params.logFile, std::ios::binary | std::ios::ate);
+            isNew = !existing || existing.tellg() <= 0;
+        }
+        log.open(this->params.logFile, std::ios::app);
+        if (log && isNew) {
+            log << "timestamp_ms,frame,from_level,to_level,level_name,mean_ms,budget_ms\n";
+        }
+    }
+}
+
+
+/**
+ * @brief Indica si el control est activado.
+ */
+bool CQualityController::isEnabled() const {
+    return params.budgetMs > 0;
+}
+
+
+/**
+ * @brief Indica si el siguiente fotograma se debe procesar en el nivel actual.
+ *
+ * Se cuentan los fotogramas ofrecidos (no los nmeros de fotograma, que pueden saltar si la captura va ms deprisa
+ * que el procesamiento), de modo que en los niveles 4 y 5 se procesa exactamente uno de cada N.
+ *
+ * @return true si hay que procesarlo.
+ */
+bool CQualityController::shouldProcess() {
+    stats.framesAtLevel[level]++;
+    if (offeredAtLevel++ % static_cast<uint64_t>( frameStride(level) ) == 0) {
+        return true;
+    }
+    stats.skippedFrames++;
+    if (skippedMetric) skippedMetric->inc();
+    return false;
+}
+
+
+/**
+ * @brief Registra el tiempo de procesamiento de un fotograma y cambia de nivel si hace falta.
+ *
+ * El tiempo se reparte entre los fotogramas de cada grupo de `frameStride` (el procesado y los omitidos), que es lo
+ * que hay que comparar con el intervalo entre fotogramas. Tras un cambio, la media y los contadores vuelven a
+ * empezar, de modo que cada nivel se evala solo con sus propios fotogramas antes del siguiente cambio.
+ *
+ * @param elapsedMs Tiempo de procesamiento del fotograma, en ms.
+ * @param frameIndex Nmero de fotograma.
+ * @return bool true si ha cambiado el nivel.
+ */
+bool CQualityController::update(double elapsedMs, uint64_t frameIndex) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    // Paso 1: Actualizar la media exponencial del tiempo por fotograma
+    double perFrameMs = elapsedMs / frameStride(level);
+    stats.meanMs = hasMean ? stats.meanMs + params.smoothing * ( perFrameMs - stats.meanMs ) : perFrameMs;
+    hasMean = true;
+
+    // Paso 2: Contar los fotogramas seguidos por encima del presupuesto y con margen
+    if (stats.meanMs > params.budgetMs) {
+        overBudget++;
+        underBudget = 0;
+    }
+    else if (stats.meanMs < params.headroom * params.budgetMs) {
+        underBudget++;
+        overBudget = 0;
+    }
+    else {
+        overBudget = underBudget = 0;
+    }
+
+    // Paso 3: Bajar o subir un nivel si la situacin se ha mantenido lo suficiente
+    if (overBudget >= params.downFrames && level < params.maxLevel) {
+        setLevel(level + 1, frameIndex);
+        return true;
+    }
+    if (underBudget >= params.upFrames && level > 0) {
+        setLevel(level - 1, frameIndex);
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Devuelve el nivel actual.
+ */
+int CQualityController::getLevel() const {
+    return level;
+}
+
+
+/**
+ * @brief Devuelve los parmetros del detector del nivel actual.
+ */
+const DetectorParams &CQualityController::getParams() const {
+    return levelParams;
+}
+
+
+/**
+ * @brief Cambia los parmetros del nivel 0.
+ *
+ * @param newBaseParams Parmetros del nivel 0.
+ */
+void CQualityController::setBaseParams(const DetectorParams &newBaseParams) {
+    baseParams = newBaseParams;
+    levelParams = paramsForLevel(baseParams, level);
+}
+
+
+/**
+ * @brief Devuelve las estadsticas acumuladas.
+ */
+const QualityControllerStats &CQualityController::getStats() const {
+    return stats;
+}
+
+
+/**
+ * @brief Indica una funcin a la que se llama en cada cambio de nivel.
+ *
+ * @param callback Funcin que recibe el cambio.
+ */
+void CQualityController::setChangeCallback(std::function<void(const QualityChange &)> callback) {
+    changeCallback = callback;
+}
+
+
+/**
+ * @brief Registra las mtricas del control de calidad.
+ *
+ * @param registry Registro de mtricas (nullptr para dejar de medir).
+ * @param streamId Identificador del flujo.
+ */
+void CQualityController::setMetrics(CMetricsRegistry *registry, const std::string &streamId) {
+    if (registry == nullptr) {
+        levelMetric = nullptr;
+        skippedMetric = nullptr;
+        return;
+    }
+    MetricLabels labels = { { "stream", streamId } };
+    levelMetric = &registry->gauge("dc_quality_level", "Nivel de calidad del procesamiento (0 = completa)", labels);
+    skippedMetric = &registry->counter("dc_quality_skipped_frames_total", "Fotogramas omitidos por el control de calidad", labels);
+    levelMetric->set(level);
+}
+
+
+/**
+ * @brief Devuelve la descripcin de un nivel.
+ *
+ * @param level Nivel (0 a `numLevels` - 1).
+ */
+const char *CQualityController::levelName(int level) {
+    switch (level) {
+        case 0: return "completa";
+        case 1: return "sin desenfoque del codigo";
+        case 2: return "sobel 5x5";
+        case 3: return "localizacion a media escala";
+        case 4: return "uno de cada 2 fotogramas";
+        case 5: return "uno de cada 3 fotogramas";
+    }
+    return "";
+}
+
+
+/**
+ * @brief Calcula los parmetros del detector de un nivel a partir de los del nivel 0.
+ *
+ * Cada nivel conserva las reducciones de los anteriores, y ninguna aumenta el coste respecto al nivel 0 (un
+ * kernel o una escala ya menores se mantienen).
+ *
+ * @param baseParams Parmetros del nivel 0.
+ * @param level Nivel.
+ * @return DetectorParams Parmetros del nivel.
+ */
+DetectorParams CQualityController::paramsForLevel(const DetectorParams &baseParams, int level) {
+    DetectorParams levelParams = baseParams;
+    if (level >= 1) {
+        levelParams.decodeBlurKernelSize = 1;
+    }
+    if (level >= 2) {
+        levelParams.sobelKernelSize = std::min(levelParams.sobelKernelSize, 5);
+    }
+    if (level >= 3) {
+        double scale = levelParams.pyramidScale > 0 && levelParams.pyramidScale < 1.0 ? levelParams.pyramidScale : 1.0;
+        levelParams.pyramidScale = scale * 0.5;
+    }
+    return levelParams;
+}
+
+
+/**
+ * @brief Fotogramas entre cada dos procesados en un nivel.
+ *
+ * @param level Nivel.
+ * @return int 1 si se procesan todos; N si se procesa uno de cada N.
+ */
+int CQualityController::frameStride(int level) {
+    return level >= 5 ? 3 : level == 4 ? 2 : 1;
+}
+
+
+/**
+ * @brief Cambia al nivel indicado, notificando y registrando el cambio.
+ *
+ * @param newLevel Nivel nuevo.
+ * @param frameIndex Fotograma en el que se produce el cambio.
+ */
+void CQualityController::setLevel(int newLevel, uint64_t frameIndex) {
+    // Paso 1: Aplicar el nivel y reiniciar los contadores
+    QualityChange change;
+    change.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    change.frameIndex = frameIndex + 1;
+    change.fromLevel = level;
+    change.toLevel = newLevel;
+    change.meanMs = stats.meanMs;
+
+    level = newLevel;
+    levelParams = paramsForLevel(baseParams, level);
+    hasMean = false;
+    overBudget = underBudget = 0;
+    offeredAtLevel = 0;
+    stats.levelChanges++;
+    if (levelMetric) levelMetric->set(level);
+
+    // Paso 2: Registrar el cambio en el fichero y notificarlo
+    if (log) {
+        log << change.timestampMs << ',' << change.frameIndex << ',' << change.fromLevel << ',' << change.toLevel << ",\""
+            << levelName(change.toLevel) << "\"," << change.meanMs << ',' << params.budgetMs << '\n';
+        log.flush();
+    }
+    if (changeCallback) {
+        changeCallback(change);
+    }
+}
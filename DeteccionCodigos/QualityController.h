@@ -0,0 +1,188 @@
+#pragma once
+
+#include "CodeDetector.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+
+/**
+ * @struct QualityControllerParams
+ * @brief Configuracin del control adaptativo de la calidad del procesamiento.
+ */
+struct QualityControllerParams {
+    double budgetMs = 0;          /**< Tiempo de procesamiento por fotograma objetivo, en ms (0 = control desactivado) */
+    double smoothing = 0.2;       /**< Peso de cada fotograma en la media exponencial del tiempo de procesamiento */
+    double headroom = 0.6;        /**< Fraccin del presupuesto por debajo de la cual se recupera calidad */
+    int downFrames = 5;           /**< Fotogramas seguidos por encima del presupuesto antes de bajar un nivel */
+    int upFrames = 60;            /**< Fotogramas seguidos con margen antes de subir un nivel */
+    int maxLevel = 5;             /**< Nivel ms bajo de calidad que se puede alcanzar (0-5) */
+    std::string logFile;          /**< Fichero CSV al que se aade cada cambio de nivel (vaco = sin fichero) */
+
+    /**
+     * @brief Lee la configuracin de las claves `quality*` de un fichero YAML/XML de OpenCV (p. ej. detector.yml).
+     *
+     * Claves: `qualityBudgetMs`, `qualitySmoothing`, `qualityHeadroom`, `qualityDownFrames`, `qualityUpFrames`,
+     * `qualityMaxLevel` y `qualityLogFile`. Las claves ausentes conservan su valor.
+     *
+     * @param fileName Nombre del fichero.
+     * @param params Configuracin leda.
+     * @return bool true si el fichero se ha podido abrir.
+     */
+    static bool load(const std::string &fileName, QualityControllerParams &params);
+};
+
+/**
+ * @struct QualityChange
+ * @brief Un cambio de nivel de calidad, para correlacionarlo con la tasa de acierto.
+ */
+struct QualityChange {
+    int64_t timestampMs = 0;      /**< Instante del cambio, en ms desde epoch */
+    uint64_t frameIndex = 0;      /**< Fotograma a partir del cual se aplica el nuevo nivel */
+    int fromLevel = 0;            /**< Nivel anterior */
+    int toLevel = 0;              /**< Nivel nuevo */
+    double meanMs = 0;            /**< Media del tiempo por fotograma que ha provocado el cambio */
+};
+
+/**
+ * @struct QualityControllerStats
+ * @brief Estadsticas acumuladas del control de calidad.
+ */
+struct QualityControllerStats {
+    uint64_t levelChanges = 0;    /**< Cambios de nivel */
+    uint64_t skippedFrames = 0;   /**< Fotogramas omitidos por los niveles que procesan uno de cada N */
+    uint64_t framesAtLevel[6] = {}; /**< Fotogramas ofrecidos en cada nivel */
+    double meanMs = 0;            /**< Media exponencial actual del tiempo por fotograma */
+};
+
+/**
+ * @class CQualityController
+ * @brief Control adaptativo de la calidad del procesamiento para mantener el tiempo por fotograma en un presupuesto.
+ *
+ * Con muchos cdigos a la vista o el equipo cargado, el procesamiento tarda ms que el intervalo entre
+ * fotogramas y la latencia crece sin lmite. El controlador mide el tiempo por fotograma (media exponencial,
+ * repartiendo el de cada fotograma procesado entre los omitidos) y, si supera el presupuesto durante
+ * `downFrames` fotogramas, baja un nivel; si se mantiene por debajo de `headroom` veces el presupuesto durante
+ * `upFrames`, sube uno. Los niveles son acumulativos, de menor a mayor prdida de precisin:
+ *
+ * 0. Parmetros configurados.
+ * 1. Sin el desenfoque de cada cdigo recortado (`decodeBlurKernelSize` = 1).
+ * 2. Sobel de 5x5 en la localizacin (`sobelKernelSize`).
+ * 3. Localizacin a la mitad de escala (`pyramidScale`).
+ * 4. Se procesa uno de cada dos fotogramas.
+ * 5. Se procesa uno de cada tres fotogramas.
+ *
+ * Cada cambio se notifica con `setChangeCallback` y se aade a `logFile`, con el nmero de fotograma, para
+ * poder cruzarlo con los resultados.
+ */
+class CQualityController
+{
+public:
+    /**
+     * @brief Nmero de niveles de calidad.
+     */
+    static constexpr int numLevels = 6;
+
+    /**
+     * @brief Constructor de la clase CQualityController.
+     *
+     * @param baseParams Parmetros del detector del nivel 0.
+     * @param params Configuracin del control.
+     */
+    CQualityController(const DetectorParams &baseParams, const QualityControllerParams &params = QualityControllerParams());
+
+    /**
+     * @brief Indica si el control est activado (presupuesto mayor que 0).
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Indica si el siguiente fotograma se debe procesar en el nivel actual (los niveles 4 y 5 omiten algunos).
+     *
+     * @return true si hay que procesarlo; false si se omite.
+     */
+    bool shouldProcess();
+
+    /**
+     * @brief Registra el tiempo de procesamiento de un fotograma y cambia de nivel si hace falta.
+     *
+     * Se llama solo con los fotogramas procesados (los que `shouldProcess` ha aceptado).
+     *
+     * @param elapsedMs Tiempo de procesamiento del fotograma, en ms.
+     * @param frameIndex Nmero de fotograma.
+     * @return true si ha cambiado el nivel (el llamador debe aplicar los nuevos `getParams`).
+     */
+    bool update(double elapsedMs, uint64_t frameIndex);
+
+    /**
+     * @brief Devuelve el nivel actual (0 = calidad completa).
+     */
+    int getLevel() const;
+
+    /**
+     * @brief Devuelve los parmetros del detector del nivel actual.
+     */
+    const DetectorParams &getParams() const;
+
+    /**
+     * @brief Cambia los parmetros del nivel 0 (p. ej. tras recargar detector.yml) y recalcula los del nivel actual.
+     */
+    void setBaseParams(const DetectorParams &baseParams);
+
+    /**
+     * @brief Devuelve las estadsticas acumuladas.
+     */
+    const QualityControllerStats &getStats() const;
+
+    /**
+     * @brief Indica una funcin a la que se llama en cada cambio de nivel.
+     *
+     * @param callback Funcin que recibe el cambio.
+     */
+    void setChangeCallback(std::function<void(const QualityChange &)> callback);
+
+    /**
+     * @brief Registra el nivel actual (`dc_quality_level`) y los fotogramas omitidos por el control
+     * (`dc_quality_skipped_frames_total`), con el flujo como etiqueta.
+     *
+     * @param registry Registro de mtricas (nullptr para dejar de medir).
+     * @param streamId Identificador del flujo.
+     */
+    void setMetrics(CMetricsRegistry *registry, const std::string &streamId);
+
+    /**
+     * @brief Devuelve la descripcin de un nivel ("completa", "sin desenfoque del codigo"...).
+     */
+    static const char *levelName(int level);
+
+private:
+    /**
+     * @brief Calcula los parmetros del detector de un nivel a partir de los del nivel 0.
+     */
+    static DetectorParams paramsForLevel(const DetectorParams &baseParams, int level);
+
+    /**
+     * @brief Fotogramas entre cada dos procesados en un nivel (1 = todos).
+     */
+    static int frameStride(int level);
+
+    /**
+     * @brief Cambia al nivel indicado, notificando y registrando el cambio.
+     */
+    void setLevel(int newLevel, uint64_t frameIndex);
+
+    QualityControllerParams params;     /**< Configuracin */
+    DetectorParams baseParams;          /**< Parmetros del nivel 0 */
+    DetectorParams levelParams;         /**< Parmetros del nivel actual */
+    QualityControllerStats stats;       /**< Estadsticas acumuladas */
+    int level = 0;                      /**< Nivel actual */
+    bool hasMean = false;               /**< La media ya tiene algn fotograma */
+    int overBudget = 0;                 /**< Fotogramas seguidos por encima del presupuesto */
+    int underBudget = 0;                /**< Fotogramas seguidos con margen */
+    uint64_t offeredAtLevel = 0;        /**< Fotogramas ofrecidos desde el ltimo cambio de nivel */
+    std::ofstream log;                  /**< Fichero de cambios (si se ha configurado) */
+    std::function<void(const QualityChange &)> changeCallback;   /**< Notificacin de cambios */
+
+    CMetricGauge *levelMetric = nullptr;         /**< Mtrica: nivel actual */
+    CMetricCounter *skippedMetric = nullptr;     /**< Mtrica: fotogramas omitidos */
+};
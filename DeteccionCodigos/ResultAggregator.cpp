@@ -0,0 +1,250 @@
+#include "ResultAggregator.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Lee la configuracin de las claves `aggregator*` de un fichero de OpenCV.
+ *
+ * @param fileName Nombre del fichero (p. ej. detector.yml).
+ * @param params Configuracin leda; las claves ausentes conservan su valor.
+ *
+ * @return bool true si el fichero se ha podido abrir.
+ */
+bool ResultAggregatorParams::load(const std::string &fileName, ResultAggregatorParams &params) {
+    // Paso 1: Abrir el fichero en modo lectura
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+
+    // Paso 2: Leer cada campo solo si est presente en el fichero
+    auto readInt = [&fs](const char *key, int &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    auto readDouble = [&fs](const char *key, double &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    int enabled = params.enabled ? 1 : 0;
+    readInt("aggregator", enabled);
+    params.enabled = enabled != 0;
+    readDouble("aggregatorMaxDistance", params.maxDistance);
+    readInt("aggregatorMaxMissedFrames", params.maxMissedFrames);
+    readInt("aggregatorMinFrames", params.minFrames);
+    return true;
+}
+
+
+/**
+ * @brief Constructor de la clase CResultAggregator.
+ *
+ * @param params Configuracin de la agregacin.
+ */
+CResultAggregator::CResultAggregator(const ResultAggregatorParams &params)
+    : params(params)
+{
+}
+
+
+/**
+ * @brief Incorpora los cdigos de un fotograma procesado y los sustituye por los votados.
+ *
+ * @param frameIndex Nmero de fotograma dentro del flujo.
+ * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+ * @param codes Cdigos del fotograma; a la salida, con el cdigo y las confianzas votados.
+ */
+void CResultAggregator::update(uint64_t frameIndex, int64_t timestampMs, std::vector<DecodedCode> &codes) {
+    CTraceScope trace("aggregateResults");
+    stats.observations += codes.size();
+
+    // Paso 1: Calcular todas las parejas (cdigo seguido, deteccin) dentro de la distancia mxima a la posicin
+    // prevista del cdigo seguido en este fotograma
+    struct Candidate {
+        double distance;
+        size_t track;
+        size_t code;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        const Track &track = tracks[t];
+        const double elapsed = frameIndex > track.result.lastFrame ? static_cast<double>( frameIndex - track.result.lastFrame ) : 0.0;
+        const Point2d predicted(track.center.x + track.velocity.x * elapsed, track.center.y + track.velocity.y * elapsed);
+        const Rect &box = track.result.code.boundingBox;
+        const double maxDistance = params.maxDistance * std::max(box.width, box.height);
+        for (size_t c = 0; c < codes.size(); ++c) {
+            const Rect &codeBox = codes[c].boundingBox;
+            const double dx = codeBox.x + codeBox.width / 2.0 - predicted.x;
+            const double dy = codeBox.y + codeBox.height / 2.0 - predicted.y;
+            const double distance = std::sqrt(dx * dx + dy * dy);
+            if (distance <= maxDistance) {
+                candidates.push_back({ distance, t, c });
+            }
+        }
+    }
+
+    // Paso 2: Emparejar de la pareja ms cercana a la ms lejana, cada cdigo seguido y cada deteccin una sola vez
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) { return a.distance < b.distance; });
+    std::vector<int> trackOfCode(codes.size(), -1);
+    std::vector<bool> trackMatched(tracks.size(), false);
+    for (const Candidate &candidate : candidates) {
+        if (!trackMatched[candidate.track] && trackOfCode[candidate.code] < 0) {
+            trackMatched[candidate.track] = true;
+            trackOfCode[candidate.code] = static_cast<int>( candidate.track );
+        }
+    }
+
+    // Paso 3: Los cdigos seguidos que no se han visto envejecen; los que superan `maxMissedFrames` terminan
+    std::vector<int> newIndex(tracks.size(), -1);
+    std::vector<Track> kept;
+    kept.reserve(tracks.size() + codes.size());
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        if (!trackMatched[t] && ++tracks[t].missedFrames > params.maxMissedFrames) {
+            finishTrack(tracks[t]);
+            continue;
+        }
+        newIndex[t] = static_cast<int>( kept.size() );
+        kept.push_back(std::move(tracks[t]));
+    }
+    tracks.swap(kept);
+
+    // Paso 4: Incorporar cada deteccin a su cdigo seguido (o empezar a seguirla) y sustituirla por el cdigo votado
+    for (size_t c = 0; c < codes.size(); ++c) {
+        DecodedCode &code = codes[c];
+        const Point2d center(code.boundingBox.x + code.boundingBox.width / 2.0, code.boundingBox.y + code.boundingBox.height / 2.0);
+        Track *track;
+        if (trackOfCode[c] >= 0) {
+            // Paso 4.1: Actualizar la velocidad media con el desplazamiento desde la ltima deteccin
+            track = &tracks[newIndex[trackOfCode[c]]];
+            const double elapsed = frameIndex > track->result.lastFrame ? static_cast<double>( frameIndex - track->result.lastFrame ) : 1.0;
+            const Point2d step((center.x - track->center.x) / elapsed, (center.y - track->center.y) / elapsed);
+            if (track->result.observations == 1) {
+                track->velocity = step;
+            }
+            else {
+                track->velocity = Point2d(0.5 * ( track->velocity.x + step.x ), 0.5 * ( track->velocity.y + step.y ));
+            }
+            track->missedFrames = 0;
+        }
+        else {
+            // Paso 4.2: Empezar a seguir la deteccin como un cdigo fsico nuevo
+            tracks.emplace_back();
+            track = &tracks.back();
+            track->id = nextId++;
+            track->result.id = track->id;
+            track->result.firstFrame = frameIndex;
+            track->result.firstTimestampMs = timestampMs;
+        }
+        track->center = center;
+        track->result.code = code;
+        track->result.lastFrame = frameIndex;
+        track->result.lastTimestampMs = timestampMs;
+        track->result.observations++;
+        track->readings[code.code]++;
+
+        // Paso 4.3: Cada dgito reconocido vota su valor con su confianza ('X' no vota)
+        for (size_t d = 0; d < track->votes.size() && d < code.code.size(); ++d) {
+            const char digit = code.code[d];
+            if (digit >= '0' && digit <= '9') {
+                const double confidence = d < code.digitConfidence.size() ? code.digitConfidence[d] : 1.0;
+                track->votes[d][digit - '0'] += confidence;
+            }
+        }
+        vote(*track, code);
+    }
+}
+
+
+/**
+ * @brief Escribe el cdigo votado de un cdigo fsico.
+ *
+ * Cada dgito es el valor con mayor suma de confianzas, y su confianza es esa suma dividida entre los fotogramas
+ * en que se ha visto el cdigo: la confianza media del valor ganador, contando como 0 los fotogramas en que se ley
+ * otro valor o no se reconoci. Un dgito que no se ha reconocido en ningn fotograma queda como 'X'.
+ *
+ * @param track Cdigo fsico.
+ * @param code Cdigo que se modifica.
+ */
+void CResultAggregator::vote(const Track &track, DecodedCode &code) const {
+    code.code.assign(track.votes.size(), 'X');
+    code.digitConfidence.assign(track.votes.size(), 0.0);
+    for (size_t d = 0; d < track.votes.size(); ++d) {
+        const std::array<double, 10> &digitVotes = track.votes[d];
+        const auto best = std::max_element(digitVotes.begin(), digitVotes.end());
+        if (*best > 0) {
+            code.code[d] = static_cast<char>( '0' + ( best - digitVotes.begin() ) );
+            code.digitConfidence[d] = *best / std::max(1, track.result.observations);
+        }
+    }
+    code.confidence = *std::min_element(code.digitConfidence.begin(), code.digitConfidence.end());
+}
+
+
+/**
+ * @brief Termina un cdigo fsico.
+ *
+ * @param track Cdigo fsico; si se ha visto en `minFrames` fotogramas o ms, su resultado pasa a `finished`.
+ */
+void CResultAggregator::finishTrack(Track &track) {
+    if (track.result.observations < params.minFrames) {
+        stats.discardedTracks++;
+        return;
+    }
+    AggregatedCode result = track.result;
+    vote(track, result.code);
+    auto agreeing = track.readings.find(result.code.code);
+    stats.correctedObservations += track.result.observations - ( agreeing != track.readings.end() ? agreeing->second : 0 );
+    stats.emittedCodes++;
+    finished.push_back(result);
+}
+
+
+/**
+ * @brief Da por terminados todos los cdigos que se estn siguiendo.
+ */
+void CResultAggregator::finish() {
+    for (Track &track : tracks) {
+        finishTrack(track);
+    }
+    tracks.clear();
+}
+
+
+/**
+ * @brief Devuelve los cdigos fsicos terminados desde la ltima llamada.
+ *
+ * @return std::vector<AggregatedCode> Los cdigos terminados, en el orden en que han dejado de verse.
+ */
+std::vector<AggregatedCode> CResultAggregator::takeFinished() {
+    std::vector<AggregatedCode> result;
+    result.swap(finished);
+    return result;
+}
+
+
+/**
+ * @brief Devuelve el nmero de cdigos que se estn siguiendo.
+ */
+size_t CResultAggregator::getActiveCount() const {
+    return tracks.size();
+}
+
+
+/**
+ * @brief Devuelve las estadsticas acumuladas.
+ */
+const ResultAggregatorStats &CResultAggregator::getStats() const {
+    return stats;
+}
+
+
+/**
+ * @brief Devuelve la configuracin actual.
+ */
+const ResultAggregatorParams &CResultAggregator::getParams() const {
+    return params;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "CodeDetector.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @struct ResultAggregatorParams
+ * @brief Configuracin de la agregacin de los resultados de varios fotogramas en uno por cdigo fsico.
+ */
+struct ResultAggregatorParams {
+    bool enabled = false;         /**< Agregar los resultados (si no, cada fotograma se publica por separado) */
+    double maxDistance = 1.0;     /**< Distancia mxima entre la posicin prevista de un cdigo y una deteccin, en
+                                       mltiplos del lado mayor de su bounding box */
+    int maxMissedFrames = 5;      /**< Fotogramas procesados seguidos sin ver un cdigo antes de darlo por terminado */
+    int minFrames = 2;            /**< Fotogramas en que hay que ver un cdigo para publicarlo (descarta parejas espurias) */
+
+    /**
+     * @brief Lee la configuracin de las claves `aggregator*` de un fichero YAML/XML de OpenCV (p. ej. detector.yml).
+     *
+     * Claves: `aggregator` (0 o 1), `aggregatorMaxDistance`, `aggregatorMaxMissedFrames` y `aggregatorMinFrames`.
+     * Las claves ausentes conservan su valor.
+     *
+     * @param fileName Nombre del fichero.
+     * @param params Configuracin leda.
+     * @return bool true si el fichero se ha podido abrir.
+     */
+    static bool load(const std::string &fileName, ResultAggregatorParams &params);
+};
+
+/**
+ * @struct AggregatedCode
+ * @brief Resultado final de un cdigo fsico, votado entre todos los fotogramas en que se ha visto.
+ */
+struct AggregatedCode {
+    uint64_t id = 0;              /**< Identificador del cdigo fsico dentro del flujo */
+    DecodedCode code;             /**< Cdigo votado, con su confianza; la posicin es la de la ltima deteccin */
+    uint64_t firstFrame = 0;      /**< Primer fotograma en que se ha visto */
+    uint64_t lastFrame = 0;       /**< ltimo fotograma en que se ha visto */
+    int64_t firstTimestampMs = 0; /**< Instante del primer fotograma, en ms desde epoch */
+    int64_t lastTimestampMs = 0;  /**< Instante del ltimo fotograma, en ms desde epoch */
+    int observations = 0;         /**< Fotogramas procesados en que se ha visto */
+};
+
+/**
+ * @struct ResultAggregatorStats
+ * @brief Estadsticas acumuladas de la agregacin.
+ */
+struct ResultAggregatorStats {
+    uint64_t observations = 0;          /**< Detecciones recibidas */
+    uint64_t emittedCodes = 0;          /**< Cdigos fsicos publicados */
+    uint64_t discardedTracks = 0;       /**< Cdigos vistos en menos de `minFrames` fotogramas, no publicados */
+    uint64_t correctedObservations = 0; /**< Detecciones de cdigos publicados cuya lectura difera del cdigo votado */
+};
+
+/**
+ * @class CResultAggregator
+ * @brief Sigue los cdigos de un flujo entre fotogramas y publica un nico cdigo votado por cdigo fsico.
+ *
+ * Cada fotograma se decodifica de forma independiente, as que un mismo cdigo se publica en todos los
+ * fotogramas en que es visible y un error aislado (un dgito 'X' o un 3 ledo como 7 con la relacin de reas
+ * cerca del umbral) llega tal cual al resultado. El agregador asocia las detecciones de cada fotograma a los
+ * cdigos que ya sigue por su posicin, prevista con la velocidad media de cada uno (la cinta los mueve de forma
+ * regular), con un emparejamiento voraz del ms cercano al ms lejano. Cada deteccin vota cada dgito con su
+ * confianza, y los cdigos de `update` se sustituyen por el votado para mostrarlos. Cuando un cdigo deja de verse
+ * durante `maxMissedFrames` fotogramas procesados, se da por terminado y, si se ha visto en `minFrames` o ms,
+ * se publica una sola vez (`takeFinished`).
+ *
+ * Solo cuentan los fotogramas que se pasan a `update`: los que omiten el detector de movimiento o el control de
+ * calidad no envejecen los cdigos, de modo que una pieza parada delante de la cmara no se publica dos veces.
+ */
+class CResultAggregator
+{
+public:
+    /**
+     * @brief Constructor de la clase CResultAggregator.
+     *
+     * @param params Configuracin de la agregacin.
+     */
+    CResultAggregator(const ResultAggregatorParams &params = ResultAggregatorParams());
+
+    /**
+     * @brief Incorpora los cdigos de un fotograma procesado y los sustituye por los votados.
+     *
+     * @param frameIndex Nmero de fotograma dentro del flujo.
+     * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+     * @param codes Cdigos devueltos por `detect`; a la salida, el cdigo y las confianzas son los votados del
+     *              cdigo fsico al que se ha asociado cada uno.
+     */
+    void update(uint64_t frameIndex, int64_t timestampMs, std::vector<DecodedCode> &codes);
+
+    /**
+     * @brief Da por terminados todos los cdigos que se estn siguiendo (al final del flujo).
+     */
+    void finish();
+
+    /**
+     * @brief Devuelve los cdigos fsicos terminados desde la ltima llamada, y los olvida.
+     */
+    std::vector<AggregatedCode> takeFinished();
+
+    /**
+     * @brief Devuelve el nmero de cdigos que se estn siguiendo.
+     */
+    size_t getActiveCount() const;
+
+    /**
+     * @brief Devuelve las estadsticas acumuladas.
+     */
+    const ResultAggregatorStats &getStats() const;
+
+    /**
+     * @brief Devuelve la configuracin actual.
+     */
+    const ResultAggregatorParams &getParams() const;
+
+private:
+    /**
+     * @struct Track
+     * @brief Cdigo fsico que se est siguiendo.
+     */
+    struct Track {
+        uint64_t id = 0;                            /**< Identificador del cdigo fsico */
+        Point2d center;                             /**< Centro de la ltima deteccin */
+        Point2d velocity;                           /**< Desplazamiento medio por fotograma */
+        int missedFrames = 0;                       /**< Fotogramas procesados seguidos sin verlo */
+        AggregatedCode result;                      /**< Resultado acumulado (ltima deteccin y fotogramas) */
+        std::array<std::array<double, 10>, 4> votes{}; /**< Suma de las confianzas de cada valor de cada dgito */
+        std::map<std::string, int> readings;        /**< Veces que se ha ledo cada cdigo */
+    };
+
+    /**
+     * @brief Escribe en `code` el cdigo votado de un cdigo fsico y sus confianzas.
+     *
+     * @param track Cdigo fsico.
+     * @param code Cdigo que se modifica (se conservan la posicin y los marcadores).
+     */
+    void vote(const Track &track, DecodedCode &code) const;
+
+    /**
+     * @brief Termina un cdigo fsico: lo publica si se ha visto suficientes veces o lo descarta.
+     *
+     * @param track Cdigo fsico.
+     */
+    void finishTrack(Track &track);
+
+    ResultAggregatorParams params;          /**< Configuracin */
+    ResultAggregatorStats stats;            /**< Estadsticas acumuladas */
+    std::vector<Track> tracks;              /**< Cdigos fsicos que se estn siguiendo */
+    std::vector<AggregatedCode> finished;   /**< Cdigos terminados pendientes de recoger */
+    uint64_t nextId = 1;                    /**< Identificador del siguiente cdigo fsico */
+};
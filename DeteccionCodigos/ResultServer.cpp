@@ -0,0 +1,351 @@
+#include "ResultServer.h"
+
+/**
+ * @brief Constructor de la clase CResultServer.
+ *
+ * Crea los servidores TCP y HTTP y el temporizador de keep-alive, pero no empieza a escuchar
+ * hasta que se llama a `start`.
+ *
+ * @param params Configuracin del servidor.
+ * @param parent Objeto padre (opcional).
+ */
+CResultServer::CResultServer(const ResultServerParams &params, QObject *parent)
+    : QObject(parent), params(params)
+{
+    tcpServer = new QTcpServer(this);
+    httpServer = new QTcpServer(this);
+    keepAliveTimer = new QTimer(this);
+
+    connect(tcpServer, &QTcpServer::newConnection, this, &CResultServer::acceptTcp);
+    connect(httpServer, &QTcpServer::newConnection, this, &CResultServer::acceptHttp);
+    connect(keepAliveTimer, &QTimer::timeout, this, &CResultServer::sendKeepAlive);
+}
+
+
+/**
+ * @brief Destructor de la clase CResultServer.
+ *
+ * Cierra todas las conexiones. Los servidores y los sockets se liberan como hijos del objeto.
+ */
+CResultServer::~CResultServer()
+{
+    for (QTcpSocket *socket : clients.keys()) {
+        socket->disconnect(this);
+        socket->abort();
+    }
+    clients.clear();
+}
+
+
+/**
+ * @brief Empieza a escuchar en los puertos configurados.
+ *
+ * @return bool true si todos los puertos activos se han podido abrir, false en caso contrario.
+ */
+bool CResultServer::start() {
+    QHostAddress address = params.localOnly ? QHostAddress::LocalHost : QHostAddress::Any;
+    bool ok = true;
+
+    // Paso 1: Servidor TCP plano (una lnea JSON por cdigo)
+    if (params.tcpPort != 0 && !tcpServer->listen(address, params.tcpPort)) {
+        qDebug() << "ERROR: No se ha podido abrir el puerto TCP" << params.tcpPort << tcpServer->errorString();
+        ok = false;
+    }
+
+    // Paso 2: Servidor HTTP con Server-Sent Events
+    if (params.httpPort != 0 && !httpServer->listen(address, params.httpPort)) {
+        qDebug() << "ERROR: No se ha podido abrir el puerto HTTP" << params.httpPort << httpServer->errorString();
+        ok = false;
+    }
+
+    // Paso 3: Keep-alive peridico para que proxies y navegadores no cierren las conexiones SSE
+    if (params.keepAliveMs > 0) {
+        keepAliveTimer->start(params.keepAliveMs);
+    }
+
+    return ok;
+}
+
+
+/**
+ * @brief Publica un resultado a todos los clientes suscritos.
+ *
+ * El resultado se serializa en el hilo que llama y el envo se encola en el hilo del servidor, por lo
+ * que puede llamarse con seguridad desde el hilo de procesamiento.
+ *
+ * @param record Resultado a publicar.
+ */
+void CResultServer::publish(const ResultRecord &record) {
+    QByteArray json = QByteArray::fromStdString(CResultWriter::toJson(record));
+    QMetaObject::invokeMethod(this, [this, json]() { broadcast(json); }, Qt::QueuedConnection);
+}
+
+
+/**
+ * @brief Publica todos los cdigos decodificados en un fotograma.
+ *
+ * @param streamId Identificador del flujo.
+ * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+ * @param frameIndex Nmero de fotograma.
+ * @param codes Cdigos devueltos por `CCodeDetector::detect`.
+ */
+void CResultServer::publish(const std::string &streamId, qint64 timestampMs, quint64 frameIndex, const std::vector<DecodedCode> &codes) {
+    for (const DecodedCode &code : codes) {
+        ResultRecord record;
+        record.streamId = streamId;
+        record.timestampMs = timestampMs;
+        record.frameIndex = frameIndex;
+        record.code = code;
+        publish(record);
+    }
+}
+
+
+/**
+ * @brief Indica el registro de mtricas que se sirve en `GET /metrics`.
+ *
+ * Registra tambin los clientes conectados y los mensajes descartados del servidor; se leen al generar las
+ * mtricas, que se hace en el hilo del servidor.
+ *
+ * @param registry Registro de mtricas (nullptr para no servir mtricas).
+ */
+void CResultServer::setMetrics(CMetricsRegistry *registry) {
+    metrics = registry;
+    if (registry == nullptr) {
+        return;
+    }
+    CMetricGauge *clientGauge = &registry->gauge("dc_result_server_clients", "Clientes conectados al servidor de resultados");
+    CMetricCounter *droppedCounter = &registry->counter("dc_result_server_dropped_messages_total", "Mensajes descartados por clientes lentos");
+    registry->addCollector([this, clientGauge, droppedCounter]() {
+        clientGauge->set(getClientCount());
+        droppedCounter->set(getDropped());
+    });
+}
+
+
+/**
+ * @brief Devuelve el nmero de clientes conectados.
+ */
+int CResultServer::getClientCount() const {
+    return clients.size();
+}
+
+
+/**
+ * @brief Devuelve el nmero total de mensajes descartados por clientes lentos.
+ */
+quint64 CResultServer::getDropped() const {
+    return dropped;
+}
+
+
+/**
+ * @brief Acepta las conexiones pendientes del servidor TCP plano.
+ *
+ * Los clientes TCP quedan suscritos desde el momento de la conexin.
+ */
+void CResultServer::acceptTcp() {
+    while (tcpServer->hasPendingConnections()) {
+        addClient(tcpServer->nextPendingConnection(), false);
+    }
+}
+
+
+/**
+ * @brief Acepta las conexiones pendientes del servidor HTTP.
+ *
+ * Los clientes HTTP no se suscriben hasta que envan `GET /events`.
+ */
+void CResultServer::acceptHttp() {
+    while (httpServer->hasPendingConnections()) {
+        addClient(httpServer->nextPendingConnection(), true);
+    }
+}
+
+
+/**
+ * @brief Registra un socket recin aceptado, o lo cierra si se ha alcanzado el mximo de clientes.
+ *
+ * @param socket Socket aceptado.
+ * @param http Indica si la conexin es HTTP.
+ */
+void CResultServer::addClient(QTcpSocket *socket, bool http) {
+    if (clients.size() >= params.maxClients) {
+        socket->abort();
+        socket->deleteLater();
+        return;
+    }
+
+    Client client;
+    client.http = http;
+    client.subscribed = !http;
+    clients.insert(socket, client);
+
+    connect(socket, &QTcpSocket::disconnected, this, &CResultServer::removeClient);
+    if (http) {
+        connect(socket, &QTcpSocket::readyRead, this, &CResultServer::readHttpRequest);
+    }
+}
+
+
+/**
+ * @brief Elimina un cliente desconectado.
+ */
+void CResultServer::removeClient() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (socket && clients.remove(socket) > 0) {
+        socket->deleteLater();
+    }
+}
+
+
+/**
+ * @brief Lee la peticin de un cliente HTTP y la atiende cuando las cabeceras estn completas.
+ *
+ * Rutas admitidas:
+ * - `GET /events`: flujo Server-Sent Events; el cliente queda suscrito.
+ * - `GET /latest`: array JSON con los ltimos resultados; la conexin se cierra.
+ * - `GET /metrics`: mtricas en el formato de texto de Prometheus (si hay registro); la conexin se cierra.
+ * - `GET /trace`: ltimos eventos de cada hilo en el formato JSON de Chrome (si las trazas estn activadas).
+ * Cualquier otra peticin recibe un 404.
+ */
+void CResultServer::readHttpRequest() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket || !clients.contains(socket)) {
+        return;
+    }
+    Client &client = clients[socket];
+    if (client.subscribed) {
+        // Una vez suscrito se ignora cualquier dato adicional del cliente
+        socket->readAll();
+        return;
+    }
+
+    // Paso 1: Acumular las cabeceras hasta la lnea vaca final (con un lmite de tamao)
+    client.request += socket->readAll();
+    if (client.request.size() > 8192) {
+        sendHttpResponse(socket, "431 Request Header Fields Too Large", "text/plain", "");
+        return;
+    }
+    if (!client.request.contains("\r\n\r\n")) {
+        return;
+    }
+
+    // Paso 2: Interpretar la lnea de peticin
+    QList<QByteArray> requestLine = client.request.left(client.request.indexOf("\r\n")).split(' ');
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+
+    // Paso 3: Atender la ruta solicitada
+    if (method == "GET" && path == "/events") {
+        socket->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/event-stream\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Connection: keep-alive\r\n"
+                      "Access-Control-Allow-Origin: *\r\n\r\n");
+        client.subscribed = true;
+        client.request.clear();
+    }
+    else if (method == "GET" && path == "/latest") {
+        QByteArray body = "[" + latest.join(",") + "]";
+        sendHttpResponse(socket, "200 OK", "application/json", body);
+    }
+    else if (method == "GET" && path == "/metrics" && metrics != nullptr) {
+        sendHttpResponse(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8", QByteArray::fromStdString(metrics->exposition()));
+    }
+    else if (method == "GET" && path == "/trace" && CTracer::instance().isEnabled()) {
+        sendHttpResponse(socket, "200 OK", "application/json", QByteArray::fromStdString(CTracer::instance().toChromeJson()));
+    }
+    else {
+        sendHttpResponse(socket, "404 Not Found", "text/plain", "Rutas disponibles: /events, /latest, /metrics, /trace\n");
+    }
+}
+
+
+/**
+ * @brief Enva un comentario de keep-alive a los clientes SSE.
+ */
+void CResultServer::sendKeepAlive() {
+    for (auto it = clients.begin(); it != clients.end(); ++it) {
+        if (it.value().http && it.value().subscribed) {
+            sendTo(it.key(), ": keep-alive\n\n");
+        }
+    }
+}
+
+
+/**
+ * @brief Enva un resultado ya serializado a todos los clientes suscritos.
+ *
+ * Se ejecuta en el hilo del servidor. Tambin actualiza la lista de resultados recientes de `/latest`.
+ *
+ * @param json Resultado en JSON.
+ */
+void CResultServer::broadcast(const QByteArray &json) {
+    // Paso 1: Guardar el resultado para GET /latest
+    latest.append(json);
+    while (latest.size() > params.latestCount) {
+        latest.removeFirst();
+    }
+
+    // Paso 2: Preparar el mensaje en los dos formatos una sola vez
+    QByteArray line = json + "\n";
+    QByteArray event = "event: code\ndata: " + json + "\n\n";
+
+    // Paso 3: Enviar a cada cliente suscrito
+    for (auto it = clients.begin(); it != clients.end(); ++it) {
+        if (!it.value().subscribed) {
+            continue;
+        }
+        if (!sendTo(it.key(), it.value().http ? event : line)) {
+            it.value().dropped++;
+        }
+    }
+}
+
+
+/**
+ * @brief Escribe datos en un cliente respetando su lmite de bytes pendientes.
+ *
+ * `QTcpSocket::write` nunca bloquea, pero su bfer crece sin lmite; por eso se comprueba antes
+ * cunto queda por enviar y, si el cliente va retrasado, se descarta el mensaje.
+ *
+ * @param socket Cliente de destino.
+ * @param data Datos a enviar.
+ *
+ * @return bool true si los datos se han encolado, false si se han descartado.
+ */
+bool CResultServer::sendTo(QTcpSocket *socket, const QByteArray &data) {
+    if (socket->bytesToWrite() + data.size() > params.maxClientBuffer) {
+        dropped++;
+        return false;
+    }
+    socket->write(data);
+    return true;
+}
+
+
+/**
+ * @brief Enva una respuesta HTTP completa y cierra la conexin cuando se ha enviado.
+ *
+ * A partir de aqu no se atiende ningn dato ms del cliente: los que lleguen mientras se cierra la conexin
+ * no deben interpretarse como otra peticin ni recibir otra respuesta.
+ *
+ * @param socket Cliente de destino.
+ * @param status Lnea de estado (p. ej. "200 OK").
+ * @param contentType Tipo de contenido.
+ * @param body Cuerpo de la respuesta.
+ */
+void CResultServer::sendHttpResponse(QTcpSocket *socket, const QByteArray &status, const QByteArray &contentType, const QByteArray &body) {
+    QByteArray response = "HTTP/1.1 " + status + "\r\n"
+                          "Content-Type: " + contentType + "\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          "Connection: close\r\n\r\n" + body;
+    disconnect(socket, &QTcpSocket::readyRead, this, &CResultServer::readHttpRequest);
+    auto client = clients.find(socket);
+    if (client != clients.end()) {
+        client->request.clear();
+    }
+    socket->write(response);
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "ResultWriter.h"
+#include "Metrics.h"
+#include "Tracer.h"
+
+/**
+ * @struct ResultServerParams
+ * @brief Configuracin del servidor local de resultados.
+ */
+struct ResultServerParams {
+    bool localOnly = true;                 /**< Escuchar solo en localhost (true) o en todas las interfaces */
+    quint16 tcpPort = 5800;                /**< Puerto TCP que emite una lnea JSON por cdigo (0 = desactivado) */
+    quint16 httpPort = 5801;               /**< Puerto HTTP con Server-Sent Events en /events y mtricas en /metrics (0 = desactivado) */
+    qint64 maxClientBuffer = 256 * 1024;   /**< Bytes pendientes de enviar por cliente antes de descartar mensajes */
+    int maxClients = 64;                   /**< Nmero mximo de clientes conectados simultneamente */
+    int latestCount = 32;                  /**< Nmero de resultados recientes devueltos por GET /latest */
+    int keepAliveMs = 15000;               /**< Intervalo de los comentarios de keep-alive en las conexiones SSE */
+};
+
+/**
+ * @class CResultServer
+ * @brief Servidor local, no bloqueante, que publica los cdigos decodificados a cualquier nmero de clientes.
+ *
+ * Ofrece dos interfaces:
+ * - TCP plano (`tcpPort`): cada cdigo se enva como una lnea JSON (mismo formato que `CResultWriter`).
+ * - HTTP (`httpPort`): `GET /events` abre un flujo Server-Sent Events con un evento por cdigo y
+ *   `GET /latest` devuelve los ltimos resultados como un array JSON. Si se ha indicado un registro de
+ *   mtricas (`setMetrics`), `GET /metrics` lo devuelve en el formato de texto de Prometheus. Con las trazas
+ *   activadas (`CTracer`), `GET /trace` devuelve los ltimos eventos de cada hilo para chrome://tracing o Perfetto.
+ *
+ * Cada cliente tiene un lmite de bytes pendientes de envo: si un cliente lento lo supera, los mensajes
+ * para ese cliente se descartan (y se contabilizan) en lugar de acumularse, de modo que nunca frena la
+ * decodificacin ni a los dems clientes. `publish` puede llamarse desde cualquier hilo.
+ *
+ * Para probarlo en local: `nc localhost 5800` o `curl -N http://localhost:5801/events`.
+ */
+class CResultServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor de la clase CResultServer.
+     *
+     * @param params Configuracin del servidor.
+     * @param parent Objeto padre (opcional).
+     */
+    CResultServer(const ResultServerParams &params = ResultServerParams(), QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Cierra las conexiones abiertas.
+     */
+    ~CResultServer();
+
+    /**
+     * @brief Empieza a escuchar en los puertos configurados.
+     *
+     * @return true si todos los puertos activos se han podido abrir.
+     */
+    bool start();
+
+    /**
+     * @brief Publica un resultado a todos los clientes suscritos. Puede llamarse desde cualquier hilo.
+     *
+     * @param record Resultado a publicar.
+     */
+    void publish(const ResultRecord &record);
+
+    /**
+     * @brief Publica todos los cdigos decodificados en un fotograma.
+     *
+     * @param streamId Identificador del flujo.
+     * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+     * @param frameIndex Nmero de fotograma.
+     * @param codes Cdigos devueltos por `CCodeDetector::detect`.
+     */
+    void publish(const std::string &streamId, qint64 timestampMs, quint64 frameIndex, const std::vector<DecodedCode> &codes);
+
+    /**
+     * @brief Indica el registro de mtricas que se sirve en `GET /metrics`, y registra en l las del servidor.
+     *
+     * @param registry Registro de mtricas (nullptr para no servir mtricas). Debe existir mientras exista el servidor.
+     */
+    void setMetrics(CMetricsRegistry *registry);
+
+    /**
+     * @brief Devuelve el nmero de clientes conectados.
+     */
+    int getClientCount() const;
+
+    /**
+     * @brief Devuelve el nmero total de mensajes descartados por clientes lentos.
+     */
+    quint64 getDropped() const;
+
+private slots:
+    /**
+     * @brief Acepta las conexiones pendientes del servidor TCP plano.
+     */
+    void acceptTcp();
+
+    /**
+     * @brief Acepta las conexiones pendientes del servidor HTTP.
+     */
+    void acceptHttp();
+
+    /**
+     * @brief Lee la peticin de un cliente HTTP y la atiende cuando est completa.
+     */
+    void readHttpRequest();
+
+    /**
+     * @brief Elimina un cliente desconectado.
+     */
+    void removeClient();
+
+    /**
+     * @brief Enva un comentario de keep-alive a los clientes SSE.
+     */
+    void sendKeepAlive();
+
+private:
+    /**
+     * @struct Client
+     * @brief Estado de un cliente conectado.
+     */
+    struct Client {
+        bool http = false;         /**< Conexin HTTP (true) o TCP plano (false) */
+        bool subscribed = false;   /**< Recibe los resultados publicados */
+        QByteArray request;        /**< Cabeceras HTTP recibidas hasta el momento */
+        quint64 dropped = 0;       /**< Mensajes descartados para este cliente */
+    };
+
+    ResultServerParams params;             /**< Configuracin del servidor */
+    QTcpServer *tcpServer;                 /**< Servidor TCP plano */
+    QTcpServer *httpServer;                /**< Servidor HTTP / SSE */
+    QTimer *keepAliveTimer;                /**< Temporizador de keep-alive de SSE */
+    QHash<QTcpSocket *, Client> clients;   /**< Clientes conectados */
+    QList<QByteArray> latest;              /**< ltimos resultados publicados (JSON) */
+    quint64 dropped = 0;                   /**< Mensajes descartados en total */
+    CMetricsRegistry *metrics = nullptr;   /**< Registro de mtricas de GET /metrics */
+
+    /**
+     * @brief Registra un socket recin aceptado, o lo cierra si se ha alcanzado el mximo de clientes.
+     *
+     * @param socket Socket aceptado.
+     * @param http Indica si la conexin es HTTP.
+     */
+    void addClient(QTcpSocket *socket, bool http);
+
+    /**
+     * @brief Enva un resultado ya serializado a todos los clientes suscritos (en el hilo del servidor).
+     *
+     * @param json Resultado en JSON.
+     */
+    void broadcast(const QByteArray &json);
+
+    /**
+     * @brief Escribe datos en un cliente respetando su lmite de bytes pendientes.
+     *
+     * @param socket Cliente de destino.
+     * @param data Datos a enviar.
+     * @return true si se han encolado, false si se han descartado.
+     */
+    bool sendTo(QTcpSocket *socket, const QByteArray &data);
+
+    /**
+     * @brief Enva una respuesta HTTP completa y cierra la conexin.
+     *
+     * @param socket Cliente de destino.
+     * @param status Lnea de estado (p. ej. "200 OK").
+     * @param contentType Tipo de contenido.
+     * @param body Cuerpo de la respuesta.
+     */
+    void sendHttpResponse(QTcpSocket *socket, const QByteArray &status, const QByteArray &contentType, const QByteArray &body);
+};
@@ -0,0 +1,313 @@
+#include "ResultWriter.h"
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+/**
+ * @brief Escapa una cadena para incluirla en un valor JSON.
+ *
+ * @param text Cadena original.
+ * @return std::string La cadena con comillas, barras y caracteres de control escapados.
+ */
+static std::string escapeJson(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>( c ) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                }
+                else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+/**
+ * @brief Escapa una cadena para incluirla en un campo CSV (entre comillas si es necesario).
+ *
+ * @param text Cadena original.
+ * @return std::string El campo CSV.
+ */
+static std::string escapeCsv(const std::string &text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string escaped = "\"";
+    for (char c : text) {
+        escaped += c;
+        if (c == '"') escaped += '"';
+    }
+    return escaped + "\"";
+}
+
+/**
+ * @brief Constructor de la clase CResultWriter.
+ *
+ * Crea el directorio de salida si no existe y lanza el hilo de escritura. El primer fichero se abre
+ * con el primer registro, de modo que una ejecucin sin cdigos no deja ficheros vacos.
+ *
+ * @param params Configuracin del escritor.
+ */
+CResultWriter::CResultWriter(const ResultWriterParams &params)
+    : params(params)
+{
+    // Crear el directorio que contendr los ficheros de resultados
+    std::filesystem::path directory = std::filesystem::path(params.basePath).parent_path();
+    if (!directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    // Lanzar el hilo de escritura
+    worker = std::thread(&CResultWriter::run, this);
+}
+
+
+/**
+ * @brief Destructor de la clase CResultWriter.
+ *
+ * Indica al hilo que termine, espera a que escriba los registros pendientes y cierra el fichero.
+ */
+CResultWriter::~CResultWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+
+/**
+ * @brief Encola un registro para su escritura.
+ *
+ * Solo se toma el mutex durante la insercin; el formateo y la escritura se hacen en el hilo propio.
+ *
+ * @param record Registro a escribir.
+ *
+ * @return bool true si se ha encolado, false si la cola estaba llena y el registro se ha descartado.
+ */
+bool CResultWriter::push(const ResultRecord &record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= params.queueCapacity) {
+            dropped++;
+            return false;
+        }
+        queue.push_back(record);
+    }
+    return true;
+}
+
+
+/**
+ * @brief Encola todos los cdigos decodificados en un fotograma.
+ *
+ * @param streamId Identificador del flujo.
+ * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+ * @param frameIndex Nmero de fotograma.
+ * @param codes Cdigos devueltos por `CCodeDetector::detect`.
+ */
+void CResultWriter::push(const std::string &streamId, int64_t timestampMs, uint64_t frameIndex, const std::vector<DecodedCode> &codes) {
+    for (const DecodedCode &code : codes) {
+        ResultRecord record;
+        record.streamId = streamId;
+        record.timestampMs = timestampMs;
+        record.frameIndex = frameIndex;
+        record.code = code;
+        push(record);
+    }
+}
+
+
+/**
+ * @brief Devuelve el nmero de registros escritos en disco.
+ */
+uint64_t CResultWriter::getWritten() const {
+    return written.load();
+}
+
+
+/**
+ * @brief Devuelve el nmero de registros descartados por tener la cola llena.
+ */
+uint64_t CResultWriter::getDropped() const {
+    return dropped.load();
+}
+
+
+/**
+ * @brief Devuelve el nmero de registros pendientes de escribir.
+ */
+size_t CResultWriter::getQueueSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+
+/**
+ * @brief Bucle del hilo de escritura.
+ *
+ * Espera hasta que haya registros o venza el intervalo de volcado, extrae todos los registros pendientes
+ * de una vez (liberando la cola para el productor) y los escribe en disco fuera del mutex.
+ */
+void CResultWriter::run() {
+    std::deque<ResultRecord> pending;
+
+    while (true) {
+        bool finish;
+        {
+            // Paso 1: Esperar a que haya registros, a que venza el intervalo o a la parada
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait_for(lock, std::chrono::milliseconds(params.flushIntervalMs),
+                               [this]() { return stopping || queue.size() >= params.queueCapacity / 2; });
+            pending.swap(queue);
+            finish = stopping;
+        }
+
+        // Paso 2: Serializar y escribir los registros extrados
+        for (const ResultRecord &record : pending) {
+            if (!file.is_open() || fileBytes >= params.maxFileBytes) {
+                rotate();
+            }
+            std::string line = format(record);
+            file << line;
+            fileBytes += line.size();
+            written++;
+        }
+        pending.clear();
+
+        // Paso 3: Volcar a disco en cada ciclo para que los consumidores vean los datos con poco retraso
+        if (file.is_open()) {
+            file.flush();
+        }
+
+        if (finish) {
+            break;
+        }
+    }
+
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+
+/**
+ * @brief Cierra el fichero actual y abre el siguiente.
+ *
+ * El nombre incluye la fecha y hora de creacin y un ndice, p. ej. `codigos_20241118_101500_0.jsonl`.
+ * Si se supera `maxFiles`, se eliminan los ficheros ms antiguos creados por este escritor.
+ */
+void CResultWriter::rotate() {
+    // Paso 1: Cerrar el fichero actual
+    if (file.is_open()) {
+        file.close();
+    }
+
+    // Paso 2: Componer el nombre del nuevo fichero
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    std::ostringstream name;
+    name << params.basePath << '_' << std::put_time(&local, "%Y%m%d_%H%M%S") << '_' << fileIndex++
+         << ( params.format == ResultWriterParams::JsonLines ? ".jsonl" : ".csv" );
+
+    // Paso 3: Abrir el fichero y escribir la cabecera en el caso de CSV
+    file.open(name.str(), std::ios::out | std::ios::trunc);
+    fileBytes = 0;
+    if (params.format == ResultWriterParams::Csv) {
+        std::string header = "timestamp_ms,stream,frame,code,x,y,width,height,angle,confidence,d0,d1,d2,d3\n";
+        file << header;
+        fileBytes += header.size();
+    }
+    fileNames.push_back(name.str());
+
+    // Paso 4: Eliminar los ficheros ms antiguos si se supera el mximo
+    while (params.maxFiles > 0 && static_cast<int>( fileNames.size() ) > params.maxFiles) {
+        std::remove(fileNames.front().c_str());
+        fileNames.pop_front();
+    }
+}
+
+
+/**
+ * @brief Serializa un registro como objeto JSON en una sola lnea.
+ *
+ * Es el formato de las lneas de los ficheros .jsonl y tambin el que publica `CResultServer`.
+ *
+ * @param record Registro a serializar.
+ *
+ * @return std::string El objeto JSON, sin salto de lnea final.
+ */
+std::string CResultWriter::toJson(const ResultRecord &record) {
+    const DecodedCode &code = record.code;
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+
+    json << "{\"timestamp_ms\":" << record.timestampMs
+         << ",\"stream\":\"" << escapeJson(record.streamId) << '"'
+         << ",\"frame\":" << record.frameIndex
+         << ",\"code\":\"" << escapeJson(code.code) << '"'
+         << ",\"box\":[" << code.boundingBox.x << ',' << code.boundingBox.y << ','
+         << code.boundingBox.width << ',' << code.boundingBox.height << ']'
+         << ",\"angle\":" << code.angle
+         << ",\"confidence\":" << code.confidence
+         << ",\"digit_confidence\":[";
+    for (size_t i = 0; i < code.digitConfidence.size(); ++i) {
+        json << ( i ? "," : "" ) << code.digitConfidence[i];
+    }
+    json << "]}";
+
+    return json.str();
+}
+
+
+/**
+ * @brief Serializa un registro en el formato configurado.
+ *
+ * @param record Registro a serializar.
+ *
+ * @return std::string Una lnea JSON o CSV terminada en salto de lnea.
+ */
+std::string CResultWriter::format(const ResultRecord &record) const {
+    const DecodedCode &code = record.code;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3);
+
+    if (params.format == ResultWriterParams::JsonLines) {
+        line << toJson(record) << '\n';
+    }
+    else {
+        line << record.timestampMs << ',' << escapeCsv(record.streamId) << ',' << record.frameIndex << ','
+             << escapeCsv(code.code) << ',' << code.boundingBox.x << ',' << code.boundingBox.y << ','
+             << code.boundingBox.width << ',' << code.boundingBox.height << ','
+             << code.angle << ',' << code.confidence;
+        for (size_t i = 0; i < 4; ++i) {
+            line << ',' << ( i < code.digitConfidence.size() ? code.digitConfidence[i] : 0.0 );
+        }
+        line << '\n';
+    }
+
+    return line.str();
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "CodeDetector.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct ResultRecord
+ * @brief Registro de un cdigo decodificado junto con los datos del fotograma en que se obtuvo.
+ */
+struct ResultRecord {
+    std::string streamId;      /**< Identificador del flujo de vdeo (p. ej. la direccin RTSP) */
+    int64_t timestampMs = 0;   /**< Instante de captura del fotograma, en ms desde epoch */
+    uint64_t frameIndex = 0;   /**< Nmero de fotograma dentro del flujo */
+    DecodedCode code;          /**< Cdigo decodificado con su bounding box, ngulo y confianza */
+};
+
+/**
+ * @struct ResultWriterParams
+ * @brief Configuracin del escritor de resultados.
+ */
+struct ResultWriterParams {
+    enum Format {
+        JsonLines,   /**< Un objeto JSON por lnea (.jsonl) */
+        Csv          /**< Una fila CSV por cdigo, con cabecera en cada fichero (.csv) */
+    };
+
+    std::string basePath = "resultados/codigos";  /**< Ruta base de los ficheros; se aade fecha, ndice y extensin */
+    Format format = JsonLines;                    /**< Formato de salida */
+    size_t maxFileBytes = 16 * 1024 * 1024;       /**< Tamao a partir del cual se rota a un fichero nuevo */
+    int maxFiles = 10;                            /**< Nmero mximo de ficheros conservados (0 = sin lmite) */
+    size_t queueCapacity = 4096;                  /**< Registros pendientes como mximo; los que no caben se descartan */
+    int flushIntervalMs = 500;                    /**< Intervalo mximo entre escrituras a disco */
+};
+
+/**
+ * @class CResultWriter
+ * @brief Escritor asncrono de los cdigos decodificados en ficheros JSON lines o CSV rotativos.
+ *
+ * El hilo de procesamiento solo encola registros (`push`), sin formatear ni tocar el disco. Un hilo
+ * propio vaca la cola peridicamente, serializa los registros y los escribe en el fichero actual,
+ * rotando cuando se supera `maxFileBytes`. Si la cola est llena, el registro se descarta y se
+ * contabiliza en `getDropped`, de forma que la escritura nunca detiene el procesamiento.
+ */
+class CResultWriter
+{
+public:
+    /**
+     * @brief Constructor de la clase CResultWriter. Lanza el hilo de escritura.
+     *
+     * @param params Configuracin del escritor.
+     */
+    CResultWriter(const ResultWriterParams &params = ResultWriterParams());
+
+    /**
+     * @brief Destructor. Escribe los registros pendientes y detiene el hilo.
+     */
+    ~CResultWriter();
+
+    /**
+     * @brief Encola un registro para su escritura. No bloquea ms all de la insercin en la cola.
+     *
+     * @param record Registro a escribir.
+     * @return true si se ha encolado, false si la cola estaba llena y se ha descartado.
+     */
+    bool push(const ResultRecord &record);
+
+    /**
+     * @brief Encola todos los cdigos decodificados en un fotograma.
+     *
+     * @param streamId Identificador del flujo.
+     * @param timestampMs Instante de captura del fotograma, en ms desde epoch.
+     * @param frameIndex Nmero de fotograma.
+     * @param codes Cdigos devueltos por `CCodeDetector::detect`.
+     */
+    void push(const std::string &streamId, int64_t timestampMs, uint64_t frameIndex, const std::vector<DecodedCode> &codes);
+
+    /**
+     * @brief Serializa un registro como objeto JSON en una sola lnea (sin salto de lnea final).
+     *
+     * @param record Registro a serializar.
+     * @return El objeto JSON.
+     */
+    static std::string toJson(const ResultRecord &record);
+
+    /**
+     * @brief Devuelve el nmero de registros escritos en disco.
+     */
+    uint64_t getWritten() const;
+
+    /**
+     * @brief Devuelve el nmero de registros descartados por tener la cola llena.
+     */
+    uint64_t getDropped() const;
+
+    /**
+     * @brief Devuelve el nmero de registros pendientes de escribir.
+     */
+    size_t getQueueSize() const;
+
+private:
+    ResultWriterParams params;             /**< Configuracin del escritor */
+    std::deque<ResultRecord> queue;        /**< Registros pendientes de escribir */
+    mutable std::mutex mutex;              /**< Protege la cola */
+    std::condition_variable condition;     /**< Despierta al hilo de escritura */
+    std::thread worker;                    /**< Hilo de escritura */
+    bool stopping = false;                 /**< Indica al hilo que debe terminar */
+    std::atomic<uint64_t> written{ 0 };    /**< Registros escritos */
+    std::atomic<uint64_t> dropped{ 0 };    /**< Registros descartados */
+
+    std::ofstream file;                    /**< Fichero de salida actual */
+    size_t fileBytes = 0;                  /**< Bytes escritos en el fichero actual */
+    int fileIndex = 0;                     /**< ndice del fichero actual dentro de la ejecucin */
+    std::deque<std::string> fileNames;     /**< Ficheros creados, del ms antiguo al ms reciente */
+
+    /**
+     * @brief Bucle del hilo de escritura.
+     */
+    void run();
+
+    /**
+     * @brief Cierra el fichero actual (si lo hay) y abre el siguiente, eliminando los ms antiguos.
+     */
+    void rotate();
+
+    /**
+     * @brief Serializa un registro en el formato configurado.
+     *
+     * @param record Registro a serializar.
+     * @return La lnea resultante, terminada en salto de lnea.
+     */
+    std::string format(const ResultRecord &record) const;
+};
@@ -0,0 +1,294 @@
+#include "StreamCapture.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+/**
+ * @brief Lee la configuracin de las claves `capture*` de un fichero de OpenCV.
+ *
+ * @param fileName Nombre del fichero (p. ej. detector.yml).
+ * @param params Configuracin leda; las claves ausentes conservan su valor.
+ *
+ * @return bool true si el fichero se ha podido abrir.
+ */
+bool StreamCaptureParams::load(const std::string &fileName, StreamCaptureParams &params) {
+    // Paso 1: Abrir el fichero en modo lectura
+    FileStorage fs;
+    try {
+        if (!fs.open(fileName, FileStorage::READ)) {
+            return false;
+        }
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+
+    // Paso 2: Leer cada campo solo si est presente en el fichero
+    auto readInt = [&fs](const char *key, int &value) {
+        if (!fs[key].empty()) fs[key] >> value;
+    };
+    readInt("captureOpenTimeoutMs", params.openTimeoutMs);
+    readInt("captureReadTimeoutMs", params.readTimeoutMs);
+    readInt("captureMaxFailedReads", params.maxFailedReads);
+    readInt("captureInitialBackoffMs", params.initialBackoffMs);
+    readInt("captureMaxBackoffMs", params.maxBackoffMs);
+    readInt("captureStallTimeoutMs", params.stallTimeoutMs);
+    return true;
+}
+
+
+/**
+ * @brief Instante actual en ns del reloj montono.
+ */
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+ * @brief Constructor de la clase CStreamCapture.
+ *
+ * @param address Direccin del flujo.
+ * @param params Configuracin de la lectura.
+ */
+CStreamCapture::CStreamCapture(const std::string &address, const StreamCaptureParams &params)
+    : address(address), params(params)
+{
+    this->params.maxFailedReads = std::max(1, this->params.maxFailedReads);
+    this->params.initialBackoffMs = std::max(1, this->params.initialBackoffMs);
+    this->params.maxBackoffMs = std::max(this->params.initialBackoffMs, this->params.maxBackoffMs);
+    backoffMs = this->params.initialBackoffMs;
+}
+
+
+/**
+ * @brief Lee la siguiente imagen, reconectando las veces que haga falta.
+ *
+ * Una lectura fallida o una imagen vaca no cierran el flujo por s solas (las cmaras RTSP pierden algn
+ * paquete de vez en cuando); solo `maxFailedReads` seguidas lo dan por perdido. Cada reintento sin xito
+ * duplica la espera hasta el siguiente, y la primera imagen recibida la devuelve a `initialBackoffMs`.
+ *
+ * @param frame Imagen leda.
+ * @return true si se ha ledo una imagen; false si la lectura se ha desactivado o el fichero ha terminado.
+ */
+bool CStreamCapture::read(Mat &frame) {
+    while (enabled.load(std::memory_order_relaxed)) {
+        // Paso 1: Abrir el flujo si no lo est, esperando antes de cada reintento
+        if (!capture.isOpened()) {
+            if (state.load(std::memory_order_relaxed) != Connecting) {
+                reconnects++;
+                if (reconnectsMetric) reconnectsMetric->inc();
+            }
+            if (!open()) {
+                if (!params.reconnect) {
+                    setState(Stopped, "No se ha podido abrir " + address);
+                    return false;
+                }
+                setState(Reconnecting, "No se ha podido abrir " + address + "; nuevo intento en " + std::to_string(backoffMs) + " ms");
+                if (!waitFor(backoffMs)) {
+                    break;
+                }
+                backoffMs = std::min(backoffMs * 2, params.maxBackoffMs);
+                continue;
+            }
+            failedReads = 0;
+        }
+
+        // Paso 2: Leer una imagen (como mucho readTimeoutMs con los backends que lo admiten)
+        bool ok;
+        {
+            CMetricTimer timer(readSecondsMetric);
+            CTraceScope trace("read", "capture");
+            try {
+                ok = capture.read(frame);
+            }
+            catch (const cv::Exception &) {
+                ok = false;
+            }
+        }
+        if (ok && !frame.empty()) {
+            failedReads = 0;
+            backoffMs = params.initialBackoffMs;
+            frames++;
+            lastFrameNs.store(steadyNowNs(), std::memory_order_relaxed);
+            if (state.load(std::memory_order_relaxed) != Streaming) {
+                if (upMetric) upMetric->set(1.0);
+                setState(Streaming, "Recibiendo imagenes de " + address);
+            }
+            return true;
+        }
+
+        // Paso 3: Contar el fallo y, si se repite, dar el flujo por perdido y reconectar
+        ( ok ? empty : failed )++;
+        if (readErrorsMetric) readErrorsMetric->inc();
+        if (++failedReads < params.maxFailedReads) {
+            continue;
+        }
+        capture.release();
+        if (!params.reconnect) {
+            setState(Stopped, "Final de " + address);
+            return false;
+        }
+        outages++;
+        if (upMetric) upMetric->set(0.0);
+        setState(Reconnecting, "Flujo perdido tras " + std::to_string(failedReads) + " lecturas fallidas; nuevo intento en " +
+                 std::to_string(backoffMs) + " ms");
+        if (!waitFor(backoffMs)) {
+            break;
+        }
+        backoffMs = std::min(backoffMs * 2, params.maxBackoffMs);
+    }
+    setState(Stopped, "Lectura detenida");
+    return false;
+}
+
+
+/**
+ * @brief Activa o desactiva la lectura, interrumpiendo la espera entre reintentos si la hay.
+ *
+ * @param enable true para leer; false para parar.
+ */
+void CStreamCapture::setEnabled(bool enable) {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        enabled.store(enable, std::memory_order_relaxed);
+    }
+    waitCondition.notify_all();
+}
+
+
+/**
+ * @brief Devuelve el estado del flujo.
+ *
+ * El estado Stalled no lo fija el hilo de lectura (que puede estar bloqueado en la lectura), sino que se deduce
+ * aqu del tiempo transcurrido desde la ltima imagen.
+ *
+ * @return State El estado actual.
+ */
+CStreamCapture::State CStreamCapture::getState() const {
+    State current = static_cast<State>( state.load(std::memory_order_relaxed) );
+    int64_t sinceLastFrame = getMillisSinceLastFrame();
+    if (current == Streaming && sinceLastFrame > params.stallTimeoutMs) {
+        return Stalled;
+    }
+    return current;
+}
+
+
+/**
+ * @brief Devuelve el tiempo transcurrido desde la ltima imagen.
+ *
+ * @return int64_t Milisegundos desde la ltima imagen (-1 si an no ha llegado ninguna).
+ */
+int64_t CStreamCapture::getMillisSinceLastFrame() const {
+    int64_t last = lastFrameNs.load(std::memory_order_relaxed);
+    return last == 0 ? -1 : ( steadyNowNs() - last ) / 1000000;
+}
+
+
+/**
+ * @brief Devuelve las estadsticas acumuladas.
+ */
+StreamCaptureStats CStreamCapture::getStats() const {
+    StreamCaptureStats stats;
+    stats.frames = frames.load();
+    stats.failedReads = failed.load();
+    stats.emptyFrames = empty.load();
+    stats.reconnects = reconnects.load();
+    stats.outages = outages.load();
+    return stats;
+}
+
+
+/**
+ * @brief Indica la funcin a la que se llama cada vez que cambia el estado.
+ *
+ * @param callback Funcin que recibe el nuevo estado y un mensaje descriptivo.
+ */
+void CStreamCapture::setStateCallback(std::function<void(State, const std::string &)> callback) {
+    stateCallback = callback;
+}
+
+
+/**
+ * @brief Registra las mtricas de la lectura.
+ *
+ * @param registry Registro de mtricas (nullptr para dejar de medir).
+ */
+void CStreamCapture::setMetrics(CMetricsRegistry *registry) {
+    if (registry == nullptr) {
+        upMetric = nullptr;
+        readErrorsMetric = reconnectsMetric = nullptr;
+        readSecondsMetric = nullptr;
+        return;
+    }
+    MetricLabels labels = { { "stream", address } };
+    upMetric = &registry->gauge("dc_capture_up", "1 si se estan recibiendo imagenes del flujo, 0 si se ha perdido", labels);
+    readErrorsMetric = &registry->counter("dc_capture_read_errors_total", "Lecturas fallidas o vacias del flujo de video", labels);
+    reconnectsMetric = &registry->counter("dc_capture_reconnects_total", "Intentos de reconexion con el flujo de video", labels);
+    readSecondsMetric = &registry->histogram("dc_capture_read_seconds", "Duracion de cada lectura del flujo de video, en segundos", labels);
+}
+
+
+/**
+ * @brief Devuelve el nombre de un estado.
+ */
+const char *CStreamCapture::stateName(State state) {
+    switch (state) {
+        case Connecting: return "conectando";
+        case Streaming: return "recibiendo";
+        case Stalled: return "detenido";
+        case Reconnecting: return "reconectando";
+        case Stopped: return "parado";
+    }
+    return "";
+}
+
+
+/**
+ * @brief Abre el flujo con los tiempos mximos de apertura y de lectura de la configuracin.
+ *
+ * Una direccin formada solo por dgitos se interpreta como el ndice de una cmara local.
+ *
+ * @return bool true si el flujo se ha abierto.
+ */
+bool CStreamCapture::open() {
+    capture.release();
+    const std::vector<int> properties = { CAP_PROP_OPEN_TIMEOUT_MSEC, params.openTimeoutMs,
+                                          CAP_PROP_READ_TIMEOUT_MSEC, params.readTimeoutMs };
+    bool isIndex = !address.empty() && std::all_of(address.begin(), address.end(), [](char c) { return std::isdigit(static_cast<unsigned char>( c )) != 0; });
+    try {
+        return isIndex ? capture.open(std::stoi(address), CAP_ANY, properties) : capture.open(address, CAP_ANY, properties);
+    }
+    catch (const cv::Exception &) {
+        return false;
+    }
+}
+
+
+/**
+ * @brief Espera el tiempo indicado o hasta que se desactive la lectura.
+ *
+ * @param milliseconds Tiempo de espera.
+ * @return bool true si la lectura sigue activa.
+ */
+bool CStreamCapture::waitFor(int milliseconds) {
+    std::unique_lock<std::mutex> lock(waitMutex);
+    waitCondition.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return !enabled.load(std::memory_order_relaxed); });
+    return enabled.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief Cambia el estado y avisa a la funcin de notificacin.
+ *
+ * @param newState Nuevo estado.
+ * @param message Mensaje descriptivo (motivo del cambio).
+ */
+void CStreamCapture::setState(State newState, const std::string &message) {
+    state.store(newState, std::memory_order_relaxed);
+    if (stateCallback) {
+        stateCallback(newState, message);
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+#include "Metrics.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+using namespace cv;
+
+/**
+ * @struct StreamCaptureParams
+ * @brief Configuracin de la lectura supervisada de un flujo de vdeo.
+ */
+struct StreamCaptureParams {
+    int openTimeoutMs = 5000;       /**< Tiempo mximo para abrir el flujo (CAP_PROP_OPEN_TIMEOUT_MSEC) */
+    int readTimeoutMs = 2000;       /**< Tiempo mximo de cada lectura (CAP_PROP_READ_TIMEOUT_MSEC) */
+    int maxFailedReads = 5;         /**< Lecturas fallidas o vacas seguidas a partir de las cuales se reconecta */
+    int initialBackoffMs = 500;     /**< Espera antes del primer reintento de conexin; se duplica en cada fallo */
+    int maxBackoffMs = 30000;       /**< Espera mxima entre reintentos */
+    int stallTimeoutMs = 3000;      /**< Tiempo sin imgenes a partir del cual el flujo se considera detenido */
+    bool reconnect = true;          /**< Reconectar al perder el flujo (false en ficheros: el fallo es el final) */
+
+    /**
+     * @brief Lee la configuracin de las claves `capture*` de un fichero YAML/XML de OpenCV (p. ej. detector.yml).
+     *
+     * Claves: `captureOpenTimeoutMs`, `captureReadTimeoutMs`, `captureMaxFailedReads`, `captureInitialBackoffMs`,
+     * `captureMaxBackoffMs` y `captureStallTimeoutMs`. Las claves ausentes conservan su valor.
+     *
+     * @param fileName Nombre del fichero.
+     * @param params Configuracin leda.
+     * @return bool true si el fichero se ha podido abrir.
+     */
+    static bool load(const std::string &fileName, StreamCaptureParams &params);
+};
+
+/**
+ * @struct StreamCaptureStats
+ * @brief Estadsticas acumuladas de la lectura de un flujo.
+ */
+struct StreamCaptureStats {
+    uint64_t frames = 0;        /**< Imgenes ledas */
+    uint64_t failedReads = 0;   /**< Lecturas fallidas (incluidas las que superan el tiempo mximo) */
+    uint64_t emptyFrames = 0;   /**< Lecturas correctas que han devuelto una imagen vaca */
+    uint64_t reconnects = 0;    /**< Reconexiones realizadas (intentos, con xito o no) */
+    uint64_t outages = 0;       /**< Prdidas del flujo (cada vez que deja de estar disponible) */
+};
+
+/**
+ * @class CStreamCapture
+ * @brief Lectura supervisada de un flujo de vdeo que se recupera sola de las cadas de la red o de la cmara.
+ *
+ * Abre el flujo con tiempos mximos de apertura y de lectura, de modo que una cmara cada no bloquea la lectura
+ * indefinidamente. Las lecturas fallidas y las imgenes vacas se cuentan; tras `maxFailedReads` seguidas se cierra
+ * el flujo y se reintenta con esperas exponenciales (de `initialBackoffMs` a `maxBackoffMs`). `read` no devuelve
+ * hasta que hay una imagen o se desactiva la lectura con `setEnabled(false)`, que interrumpe tambin las esperas.
+ * El estado se puede consultar desde cualquier hilo y los cambios se notifican con `setStateCallback`. Los tiempos
+ * mximos los aplican los backends de FFmpeg y GStreamer (los de las cmaras RTSP); con otros backends, una lectura
+ * bloqueada se detecta igualmente como `Stalled` desde fuera del hilo de lectura.
+ */
+class CStreamCapture
+{
+public:
+    /**
+     * @enum State
+     * @brief Estado del flujo.
+     */
+    enum State {
+        Connecting,     /**< Abriendo el flujo por primera vez */
+        Streaming,      /**< Recibiendo imgenes */
+        Stalled,        /**< Conectado, pero sin imgenes desde hace ms de `stallTimeoutMs` */
+        Reconnecting,   /**< Flujo perdido; esperando para reintentar la conexin */
+        Stopped,        /**< Lectura desactivada o final del fichero */
+    };
+
+    /**
+     * @brief Constructor de la clase CStreamCapture. No abre el flujo: se abre en la primera lectura.
+     *
+     * @param address Direccin del flujo (URL, fichero o ndice de cmara como texto, p. ej. "0").
+     * @param params Configuracin de la lectura.
+     */
+    CStreamCapture(const std::string &address, const StreamCaptureParams &params = StreamCaptureParams());
+
+    /**
+     * @brief Lee la siguiente imagen, reconectando las veces que haga falta.
+     *
+     * @param frame Imagen leda (se reutiliza su memoria si el tamao no cambia).
+     * @return true si se ha ledo una imagen; false si la lectura se ha desactivado o el fichero ha terminado.
+     */
+    bool read(Mat &frame);
+
+    /**
+     * @brief Activa o desactiva la lectura. Desactivarla hace que `read` devuelva false en cuanto termine la
+     * lectura en curso (como mucho `readTimeoutMs`) o inmediatamente si est esperando para reconectar.
+     *
+     * @param enabled true para leer; false para parar.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Devuelve el estado del flujo (Stalled si lleva ms de `stallTimeoutMs` sin imgenes).
+     */
+    State getState() const;
+
+    /**
+     * @brief Devuelve el tiempo transcurrido desde la ltima imagen, en ms (-1 si an no ha llegado ninguna).
+     */
+    int64_t getMillisSinceLastFrame() const;
+
+    /**
+     * @brief Devuelve las estadsticas acumuladas.
+     */
+    StreamCaptureStats getStats() const;
+
+    /**
+     * @brief Indica una funcin a la que se llama (en el hilo de lectura) cada vez que cambia el estado y en cada
+     * reintento de conexin. Debe llamarse antes de la primera lectura.
+     *
+     * @param callback Funcin que recibe el nuevo estado y un mensaje descriptivo.
+     */
+    void setStateCallback(std::function<void(State, const std::string &)> callback);
+
+    /**
+     * @brief Registra las mtricas de la lectura (`dc_capture_up`, `dc_capture_read_errors_total`,
+     * `dc_capture_reconnects_total`, `dc_capture_read_seconds`), con la direccin como etiqueta `stream`. Debe
+     * llamarse antes de la primera lectura.
+     *
+     * @param registry Registro de mtricas (nullptr para dejar de medir).
+     */
+    void setMetrics(CMetricsRegistry *registry);
+
+    /**
+     * @brief Devuelve el nombre de un estado ("conectando", "recibiendo"...).
+     */
+    static const char *stateName(State state);
+
+private:
+    /**
+     * @brief Abre el flujo con los tiempos mximos de la configuracin.
+     */
+    bool open();
+
+    /**
+     * @brief Espera el tiempo indicado o hasta que se desactive la lectura.
+     *
+     * @return true si la lectura sigue activa al terminar la espera.
+     */
+    bool waitFor(int milliseconds);
+
+    /**
+     * @brief Cambia el estado y avisa a la funcin de notificacin.
+     */
+    void setState(State state, const std::string &message);
+
+    std::string address;                     /**< Direccin del flujo */
+    StreamCaptureParams params;              /**< Configuracin de la lectura */
+    VideoCapture capture;                    /**< Flujo abierto (solo lo usa el hilo de lectura) */
+    int failedReads = 0;                     /**< Lecturas fallidas o vacas seguidas */
+    int backoffMs = 0;                       /**< Espera antes del siguiente reintento */
+    std::function<void(State, const std::string &)> stateCallback;   /**< Notificacin de cambios de estado */
+
+    std::atomic<bool> enabled{ true };       /**< Lectura activa */
+    std::mutex waitMutex;                    /**< Protege la espera entre reintentos */
+    std::condition_variable waitCondition;   /**< Interrumpe la espera al desactivar la lectura */
+    std::atomic<int> state{ Connecting };    /**< Estado del flujo (sin contar la detencin por falta de imgenes) */
+    std::atomic<int64_t> lastFrameNs{ 0 };   /**< Instante de la ltima imagen, en ns del reloj montono (0 = ninguna) */
+
+    std::atomic<uint64_t> frames{ 0 };       /**< Imgenes ledas */
+    std::atomic<uint64_t> failed{ 0 };       /**< Lecturas fallidas */
+    std::atomic<uint64_t> empty{ 0 };        /**< Imgenes vacas */
+    std::atomic<uint64_t> reconnects{ 0 };   /**< Reconexiones */
+    std::atomic<uint64_t> outages{ 0 };      /**< Prdidas del flujo */
+
+    CMetricGauge *upMetric = nullptr;                /**< Mtrica: 1 si se reciben imgenes */
+    CMetricCounter *readErrorsMetric = nullptr;      /**< Mtrica: lecturas fallidas o vacas */
+    CMetricCounter *reconnectsMetric = nullptr;      /**< Mtrica: reconexiones */
+    CMetricHistogram *readSecondsMetric = nullptr;   /**< Mtrica: duracin de cada lectura */
+};
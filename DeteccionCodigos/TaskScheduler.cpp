@@ -0,0 +1,326 @@
+#include "TaskScheduler.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @brief Planificador y trabajador del hilo actual (nullptr y -1 si el hilo no es un trabajador).
+ */
+static thread_local const CTaskScheduler *currentScheduler = nullptr;
+static thread_local int currentWorkerIndex = -1;
+
+/**
+ * @brief Constructor de la clase CTaskScheduler.
+ *
+ * @param params Configuracin del planificador.
+ */
+CTaskScheduler::CTaskScheduler(const TaskSchedulerParams &params)
+{
+    // Paso 1: Ncleos de la ubicacin y nmero de trabajadores
+    const std::vector<int> cores = params.placement.resolveCores();
+    int numWorkers = params.numWorkers;
+    if (numWorkers <= 0) {
+        numWorkers = cores.empty() ? static_cast<int>( std::thread::hardware_concurrency() ) : static_cast<int>( cores.size() );
+    }
+    numWorkers = std::max(1, numWorkers);
+
+    // Paso 2: Crear todas las colas antes de arrancar los hilos, que pueden robar de cualquiera
+    for (int i = 0; i < numWorkers; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+        if (!cores.empty()) {
+            workers.back()->core = cores[i % cores.size()];
+        }
+    }
+
+    // Paso 3: Arrancar los trabajadores
+    for (int i = 0; i < numWorkers; ++i) {
+        workers[i]->thread = std::thread(&CTaskScheduler::workerLoop, this, i);
+    }
+}
+
+
+/**
+ * @brief Destructor de la clase CTaskScheduler.
+ *
+ * Los trabajadores vacan sus colas antes de terminar.
+ */
+CTaskScheduler::~CTaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+
+/**
+ * @brief Lanza una tarea en un grupo.
+ *
+ * Desde un trabajador, la tarea va al final de su propia cola; desde otro hilo, a la siguiente cola de
+ * forma circular.
+ *
+ * @param group Grupo al que pertenece la tarea.
+ * @param task Tarea.
+ */
+void CTaskScheduler::spawn(CTaskGroup &group, std::function<void()> task) {
+    // Paso 1: Contar la tarea en el grupo antes de que nadie pueda ejecutarla
+    group.pending.fetch_add(1);
+
+    // Paso 2: Encolarla
+    int self = currentWorker();
+    int queue = self >= 0 ? self : static_cast<int>( nextQueue.fetch_add(1) % workers.size() );
+    {
+        std::lock_guard<std::mutex> lock(workers[queue]->mutex);
+        workers[queue]->tasks.push_back({ std::move(task), &group });
+    }
+    queuedTasks.fetch_add(1);
+
+    // Paso 3: Despertar a un trabajador. Se toma el mutex para que ninguno compruebe `queuedTasks` y se
+    // duerma entre el incremento y la notificacin
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+
+/**
+ * @brief Espera a que terminen todas las tareas del grupo.
+ *
+ * Mientras quedan tareas, el hilo que espera ejecuta tareas de su cola (si es un trabajador) o robadas.
+ * Si no hay ninguna disponible (las que quedan se estn ejecutando en otros hilos), espera a que el grupo
+ * termine o, como mucho, un milisegundo antes de volver a buscar, por si esas tareas lanzan otras.
+ *
+ * @param group Grupo de tareas.
+ */
+void CTaskScheduler::wait(CTaskGroup &group) {
+    int self = currentWorker();
+    Counters &counters = self >= 0 ? workers[self]->counters : callerCounters;
+    while (group.pending.load() > 0) {
+        Task task;
+        if (( self >= 0 && popLocal(self, task) ) || steal(self, task, counters)) {
+            execute(task, counters);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(group.mutex);
+        group.done.wait_for(lock, std::chrono::milliseconds(1), [&]() { return group.pending.load() == 0; });
+    }
+
+    // Relanzar la primera excepcin del grupo, dejndolo listo para reutilizarse
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        std::swap(error, group.error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+
+/**
+ * @brief Toma la ltima tarea de la cola de un trabajador (la ms reciente).
+ *
+ * @param worker ndice del trabajador.
+ * @param task Tarea tomada.
+ *
+ * @return bool true si haba alguna tarea.
+ */
+bool CTaskScheduler::popLocal(int worker, Task &task) {
+    std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+    std::deque<Task> &tasks = workers[worker]->tasks;
+    if (tasks.empty()) {
+        return false;
+    }
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    queuedTasks.fetch_sub(1);
+    return true;
+}
+
+
+/**
+ * @brief Roba la primera tarea (la ms antigua) de la cola de otro trabajador.
+ *
+ * Las colas se recorren empezando por la siguiente a la del ladrn, para que no todos roben de la misma.
+ *
+ * @param thief ndice del trabajador que roba (-1 si no es un trabajador).
+ * @param task Tarea robada.
+ * @param counters Estadsticas del ladrn.
+ *
+ * @return bool true si se ha robado alguna tarea.
+ */
+bool CTaskScheduler::steal(int thief, Task &task, Counters &counters) {
+    if (queuedTasks.load() == 0) {
+        return false;
+    }
+    const int numWorkers = static_cast<int>( workers.size() );
+    const int first = thief >= 0 ? thief + 1 : static_cast<int>( nextQueue.load() );
+    for (int k = 0; k < numWorkers; ++k) {
+        int victim = ( first + k ) % numWorkers;
+        if (victim == thief) {
+            continue;
+        }
+        counters.stealAttempts.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(workers[victim]->mutex);
+        std::deque<Task> &tasks = workers[victim]->tasks;
+        if (!tasks.empty()) {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            queuedTasks.fetch_sub(1);
+            counters.stolenTasks.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Ejecuta una tarea y avisa al grupo si era la ltima pendiente.
+ *
+ * Las excepciones de la tarea se guardan en el grupo (la primera) y se relanzan en `wait`.
+ *
+ * @param task Tarea.
+ * @param counters Estadsticas del hilo que la ejecuta.
+ */
+void CTaskScheduler::execute(Task &task, Counters &counters) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        task.body();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(task.group->mutex);
+        if (!task.group->error) {
+            task.group->error = std::current_exception();
+        }
+    }
+    counters.busyNs.fetch_add(static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count() ), std::memory_order_relaxed);
+    counters.executedTasks.fetch_add(1, std::memory_order_relaxed);
+
+    // El grupo puede destruirse en cuanto `pending` llega a 0 y el que espera lo ve, as que se notifica
+    // con su mutex tomado (el que espera comprueba `pending` con el mismo mutex)
+    CTaskGroup *group = task.group;
+    task.body = nullptr;
+    std::lock_guard<std::mutex> lock(group->mutex);
+    if (group->pending.fetch_sub(1) == 1) {
+        group->done.notify_all();
+    }
+}
+
+
+/**
+ * @brief Bucle de un trabajador.
+ *
+ * @param index ndice del trabajador.
+ */
+void CTaskScheduler::workerLoop(int index) {
+    // Paso 1: Registrar el hilo como trabajador de este planificador y fijarlo en su ncleo
+    currentScheduler = this;
+    currentWorkerIndex = index;
+    Worker &worker = *workers[index];
+    if (worker.core >= 0 && !pinCurrentThread({ worker.core })) {
+        worker.core = -1;
+    }
+    CTracer::instance().setThreadName("tareas " + std::to_string(index));
+
+    // Paso 2: Ejecutar tareas propias o robadas; dormir cuando no hay ninguna en cola
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task, worker.counters)) {
+            execute(task, worker.counters);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [&]() { return stopping.load() || queuedTasks.load() > 0; });
+        if (stopping.load() && queuedTasks.load() == 0) {
+            break;
+        }
+    }
+    currentScheduler = nullptr;
+    currentWorkerIndex = -1;
+}
+
+
+/**
+ * @brief ndice del trabajador del hilo actual.
+ *
+ * @return int ndice en `workers`, o -1 si el hilo no es un trabajador de este planificador.
+ */
+int CTaskScheduler::currentWorker() const {
+    return currentScheduler == this ? currentWorkerIndex : -1;
+}
+
+
+/**
+ * @brief Devuelve el nmero de hilos trabajadores.
+ *
+ * @return int Nmero de trabajadores.
+ */
+int CTaskScheduler::getNumWorkers() const {
+    return static_cast<int>( workers.size() );
+}
+
+
+/**
+ * @brief Convierte unos contadores en estadsticas.
+ */
+static WorkerStats toStats(int core, uint64_t executed, uint64_t stolen, uint64_t attempts, uint64_t busyNs) {
+    WorkerStats stats;
+    stats.core = core;
+    stats.executedTasks = executed;
+    stats.stolenTasks = stolen;
+    stats.stealAttempts = attempts;
+    stats.busyUs = busyNs / 1000.0;
+    return stats;
+}
+
+
+/**
+ * @brief Devuelve las estadsticas de cada trabajador.
+ *
+ * @return std::vector<WorkerStats> Estadsticas, en el orden de los trabajadores.
+ */
+std::vector<WorkerStats> CTaskScheduler::getStats() const {
+    std::vector<WorkerStats> stats;
+    for (const auto &worker : workers) {
+        const Counters &c = worker->counters;
+        stats.push_back(toStats(worker->core, c.executedTasks.load(), c.stolenTasks.load(), c.stealAttempts.load(), c.busyNs.load()));
+    }
+    return stats;
+}
+
+
+/**
+ * @brief Devuelve las estadsticas de los hilos que han ejecutado tareas en `wait` sin ser trabajadores.
+ *
+ * @return WorkerStats Estadsticas (con `core` = -1).
+ */
+WorkerStats CTaskScheduler::getCallerStats() const {
+    const Counters &c = callerCounters;
+    return toStats(-1, c.executedTasks.load(), c.stolenTasks.load(), c.stealAttempts.load(), c.busyNs.load());
+}
+
+
+/**
+ * @brief Pone a cero las estadsticas.
+ */
+void CTaskScheduler::resetStats() {
+    std::vector<Counters *> all = { &callerCounters };
+    for (auto &worker : workers) {
+        all.push_back(&worker->counters);
+    }
+    for (Counters *c : all) {
+        c->executedTasks = 0;
+        c->stolenTasks = 0;
+        c->stealAttempts = 0;
+        c->busyNs = 0;
+    }
+}
+
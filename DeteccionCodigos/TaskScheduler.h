@@ -0,0 +1,192 @@
+#pragma once
+
+#include "CpuAffinity.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct TaskSchedulerParams
+ * @brief Configuracin del planificador de tareas.
+ */
+struct TaskSchedulerParams {
+    int numWorkers = 0;        /**< Hilos trabajadores (0 = uno por ncleo de `placement`, o uno por ncleo del equipo) */
+    CpuPlacement placement;    /**< Ncleos o nodo NUMA en los que se fijan los trabajadores, uno por ncleo de forma circular (vaco = sin fijar) */
+};
+
+/**
+ * @struct WorkerStats
+ * @brief Estadsticas acumuladas de un hilo trabajador (o de los hilos que esperan a un grupo).
+ */
+struct WorkerStats {
+    int core = -1;                 /**< Ncleo en el que est fijado el hilo (-1 = sin fijar) */
+    uint64_t executedTasks = 0;    /**< Tareas ejecutadas */
+    uint64_t stolenTasks = 0;      /**< Tareas robadas de la cola de otro trabajador */
+    uint64_t stealAttempts = 0;    /**< Intentos de robo (con xito o sin l) */
+    double busyUs = 0;             /**< Tiempo ejecutando tareas, en microsegundos */
+};
+
+/**
+ * @class CTaskGroup
+ * @brief Conjunto de tareas lanzadas con `CTaskScheduler::spawn` que se esperan juntas con `CTaskScheduler::wait`.
+ *
+ * Una tarea puede lanzar ms tareas en el mismo grupo; `wait` no vuelve hasta que han terminado todas.
+ */
+class CTaskGroup
+{
+public:
+    CTaskGroup() = default;
+    CTaskGroup(const CTaskGroup &) = delete;
+    CTaskGroup &operator=(const CTaskGroup &) = delete;
+
+private:
+    friend class CTaskScheduler;
+
+    std::atomic<int> pending{ 0 };   /**< Tareas lanzadas que no han terminado */
+    std::mutex mutex;                /**< Protege `error` y la espera en `done` */
+    std::condition_variable done;    /**< Se notifica cuando `pending` llega a 0 */
+    std::exception_ptr error;        /**< Primera excepcin lanzada por una tarea del grupo */
+};
+
+/**
+ * @class CTaskScheduler
+ * @brief Planificador de tareas con robo de trabajo (work stealing) sobre un conjunto de ncleos configurable.
+ *
+ * Cada trabajador tiene su propia cola. Las tareas que lanza un trabajador van al final de su cola y l
+ * las toma del final (la ltima lanzada, cuyos datos siguen en cach); cuando su cola se vaca roba del
+ * principio de la cola de otro trabajador (la tarea ms antigua, normalmente la ms grande). Las tareas
+ * lanzadas desde fuera del planificador se reparten entre las colas de forma circular. El hilo que espera
+ * a un grupo ejecuta tareas mientras tanto, de modo que esperar dentro de una tarea no bloquea un trabajador.
+ *
+ * Las colas estn protegidas por un mutex cada una (no son colas sin bloqueo): las tareas del detector duran
+ * de decenas de microsegundos a milisegundos, y la contencin en una cola es despreciable frente a eso.
+ */
+class CTaskScheduler
+{
+public:
+    /**
+     * @brief Constructor de la clase CTaskScheduler. Arranca los trabajadores y los fija en sus ncleos.
+     *
+     * @param params Configuracin del planificador.
+     */
+    explicit CTaskScheduler(const TaskSchedulerParams &params = TaskSchedulerParams());
+
+    /**
+     * @brief Destructor de la clase CTaskScheduler. Ejecuta las tareas pendientes y detiene los trabajadores.
+     */
+    ~CTaskScheduler();
+
+    CTaskScheduler(const CTaskScheduler &) = delete;
+    CTaskScheduler &operator=(const CTaskScheduler &) = delete;
+
+    /**
+     * @brief Lanza una tarea en un grupo. Puede llamarse desde cualquier hilo, tambin desde una tarea.
+     *
+     * @param group Grupo al que pertenece la tarea.
+     * @param task Tarea.
+     */
+    void spawn(CTaskGroup &group, std::function<void()> task);
+
+    /**
+     * @brief Espera a que terminen todas las tareas del grupo, ejecutando tareas mientras tanto.
+     *
+     * Si alguna tarea del grupo ha lanzado una excepcin, se relanza aqu la primera.
+     *
+     * @param group Grupo de tareas.
+     */
+    void wait(CTaskGroup &group);
+
+    /**
+     * @brief Devuelve el nmero de hilos trabajadores.
+     */
+    int getNumWorkers() const;
+
+    /**
+     * @brief Devuelve las estadsticas de cada trabajador.
+     */
+    std::vector<WorkerStats> getStats() const;
+
+    /**
+     * @brief Devuelve las estadsticas de las tareas ejecutadas por los hilos que esperan en `wait` sin ser trabajadores.
+     */
+    WorkerStats getCallerStats() const;
+
+    /**
+     * @brief Pone a cero las estadsticas de todos los trabajadores.
+     */
+    void resetStats();
+
+private:
+    /**
+     * @struct Task
+     * @brief Tarea en cola y grupo al que pertenece.
+     */
+    struct Task {
+        std::function<void()> body;    /**< Tarea */
+        CTaskGroup *group = nullptr;   /**< Grupo de la tarea */
+    };
+
+    /**
+     * @struct Counters
+     * @brief Contadores de `WorkerStats`, atmicos para poder leerlos mientras los trabajadores estn activos.
+     */
+    struct Counters {
+        std::atomic<uint64_t> executedTasks{ 0 };
+        std::atomic<uint64_t> stolenTasks{ 0 };
+        std::atomic<uint64_t> stealAttempts{ 0 };
+        std::atomic<uint64_t> busyNs{ 0 };
+    };
+
+    /**
+     * @struct Worker
+     * @brief Cola, hilo y estadsticas de un trabajador.
+     */
+    struct Worker {
+        std::mutex mutex;           /**< Protege `tasks` */
+        std::deque<Task> tasks;     /**< Cola de tareas del trabajador */
+        std::thread thread;         /**< Hilo del trabajador */
+        int core = -1;              /**< Ncleo en el que est fijado (-1 = sin fijar) */
+        Counters counters;          /**< Estadsticas */
+    };
+
+    /**
+     * @brief Toma la ltima tarea de la cola de un trabajador.
+     */
+    bool popLocal(int worker, Task &task);
+
+    /**
+     * @brief Roba la primera tarea de la cola de otro trabajador, empezando por el siguiente a `thief`.
+     */
+    bool steal(int thief, Task &task, Counters &counters);
+
+    /**
+     * @brief Ejecuta una tarea, actualiza las estadsticas y avisa al grupo si era la ltima.
+     */
+    void execute(Task &task, Counters &counters);
+
+    /**
+     * @brief Bucle de un trabajador: ejecutar tareas propias, robar y dormir si no hay ninguna.
+     */
+    void workerLoop(int index);
+
+    /**
+     * @brief ndice del trabajador del hilo actual en este planificador (-1 si no es uno de sus trabajadores).
+     */
+    int currentWorker() const;
+
+    std::vector<std::unique_ptr<Worker>> workers;   /**< Trabajadores */
+    Counters callerCounters;                        /**< Estadsticas de los hilos que esperan sin ser trabajadores */
+    std::atomic<int> queuedTasks{ 0 };              /**< Tareas en cola entre todos los trabajadores */
+    std::atomic<unsigned> nextQueue{ 0 };           /**< Siguiente cola para las tareas lanzadas desde fuera */
+    std::atomic<bool> stopping{ false };            /**< Se activa en el destructor */
+    std::mutex sleepMutex;                          /**< Protege la espera de los trabajadores sin tareas */
+    std::condition_variable wakeUp;                 /**< Despierta a los trabajadores al lanzar una tarea */
+};
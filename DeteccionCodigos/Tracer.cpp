@@ -0,0 +1,235 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/**
+ * @brief Fotograma que procesa cada hilo (lo heredan los eventos sin fotograma explcito).
+ */
+static thread_local int64_t threadFrame = -1;
+
+/**
+ * @brief Escapa un texto para incluirlo en una cadena JSON.
+ */
+static std::string escapeJson(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>( c ) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            escaped += buffer;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+/**
+ * @brief Devuelve el registro de trazas del proceso.
+ */
+CTracer &CTracer::instance() {
+    static CTracer tracer;
+    return tracer;
+}
+
+
+/**
+ * @brief Activa las trazas, descartando los eventos anteriores.
+ *
+ * Los bferes se reservan con la nueva capacidad en el primer evento de cada hilo.
+ *
+ * @param eventsPerThread Eventos que se conservan por hilo.
+ */
+void CTracer::start(size_t eventsPerThread) {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled.store(false, std::memory_order_relaxed);
+    for (const std::shared_ptr<ThreadBuffer> &buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->written = 0;
+    }
+    capacity.store(std::max<size_t>(eventsPerThread, 1), std::memory_order_relaxed);
+    originNs.store(nowNs(), std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_release);
+}
+
+
+/**
+ * @brief Desactiva las trazas.
+ */
+void CTracer::stop() {
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief Da nombre al hilo que llama.
+ *
+ * @param name Nombre del hilo.
+ */
+void CTracer::setThreadName(const std::string &name) {
+    ThreadBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+
+/**
+ * @brief Fija el fotograma que procesa el hilo que llama.
+ *
+ * @param frame Nmero de fotograma (-1 para ninguno).
+ */
+void CTracer::setThreadFrame(int64_t frame) {
+    threadFrame = frame;
+}
+
+
+/**
+ * @brief Registra un evento en el bfer circular del hilo que llama, sobrescribiendo el ms antiguo si est lleno.
+ *
+ * @param event Evento.
+ */
+void CTracer::record(TraceEvent event) {
+    if (!isEnabled()) {
+        return;
+    }
+    if (event.frame < 0) {
+        event.frame = threadFrame;
+    }
+    ThreadBuffer &buffer = threadBuffer();
+    size_t size = capacity.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() != size) {
+        buffer.events.assign(size, TraceEvent());
+        buffer.written = 0;
+    }
+    buffer.events[buffer.written % size] = event;
+    buffer.written++;
+}
+
+
+/**
+ * @brief Genera la traza en el formato JSON de Chrome (`traceEvents`).
+ *
+ * Cada hilo aparece con su nombre (evento de metadatos `thread_name`) y cada etapa como un evento completo
+ * (`"ph":"X"`) con su inicio y su duracin en microsegundos desde `start`, y el fotograma en `args`.
+ *
+ * @return std::string El documento JSON.
+ */
+std::string CTracer::toChromeJson() {
+    // Paso 1: Copiar la lista de bferes para no bloquear el registro de hilos nuevos mientras se exporta
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = buffers;
+    }
+    int64_t origin = originNs.load(std::memory_order_relaxed);
+
+    // Paso 2: Escribir los eventos de cada hilo, del ms antiguo al ms reciente
+    std::ostringstream json;
+    json.setf(std::ios::fixed);
+    json.precision(3);
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer> &buffer : snapshot) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (!buffer->name.empty()) {
+            json << ( first ? "" : "," ) << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                 << ",\"args\":{\"name\":\"" << escapeJson(buffer->name) << "\"}}";
+            first = false;
+        }
+        size_t size = buffer->events.size();
+        uint64_t count = std::min<uint64_t>(buffer->written, size);
+        for (uint64_t i = buffer->written - count; i < buffer->written; ++i) {
+            const TraceEvent &event = buffer->events[i % size];
+            json << ( first ? "" : "," ) << "\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                 << "\",\"ph\":\"X\",\"ts\":" << ( event.startNs - origin ) * 1e-3 << ",\"dur\":" << event.durationNs * 1e-3
+                 << ",\"pid\":1,\"tid\":" << buffer->tid;
+            if (event.frame >= 0) {
+                json << ",\"args\":{\"frame\":" << event.frame << '}';
+            }
+            json << '}';
+            first = false;
+        }
+    }
+    json << "\n]}\n";
+    return json.str();
+}
+
+
+/**
+ * @brief Escribe la traza en un fichero.
+ *
+ * @param fileName Nombre del fichero.
+ * @return bool true si se ha podido escribir.
+ */
+bool CTracer::dump(const std::string &fileName) {
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file << toChromeJson();
+    return static_cast<bool>( file );
+}
+
+
+/**
+ * @brief Instante actual en ns del reloj montono.
+ */
+int64_t CTracer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+ * @brief Devuelve el bfer del hilo que llama, crendolo y registrndolo la primera vez.
+ *
+ * @return ThreadBuffer& El bfer del hilo; el registro lo mantiene vivo aunque el hilo termine.
+ */
+CTracer::ThreadBuffer &CTracer::threadBuffer() {
+    static thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer->tid = static_cast<int>( buffers.size() ) + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+
+/**
+ * @brief Empieza a medir (solo si las trazas estn activadas).
+ *
+ * @param name Nombre de la etapa (cadena esttica).
+ * @param category Categora de la etapa (cadena esttica).
+ * @param frame Nmero de fotograma (-1 para heredar el del hilo).
+ */
+CTraceScope::CTraceScope(const char *name, const char *category, int64_t frame) {
+    if (CTracer::instance().isEnabled()) {
+        event.name = name;
+        event.category = category;
+        event.frame = frame;
+        event.startNs = CTracer::nowNs();
+    }
+}
+
+
+/**
+ * @brief Registra el evento con la duracin del mbito.
+ */
+CTraceScope::~CTraceScope() {
+    if (event.name != nullptr) {
+        event.durationNs = CTracer::nowNs() - event.startNs;
+        CTracer::instance().record(event);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file Tracer.h
+ * @brief Trazas de eventos del pipeline (inicio y duracin de cada etapa, por hilo) en el formato JSON de Chrome.
+ *
+ * Los ficheros generados se abren en `chrome://tracing` o en https://ui.perfetto.dev y muestran, hilo a hilo
+ * (captura, procesamiento, planificador de tareas, interfaz), cundo empez y cunto dur cada etapa de cada
+ * fotograma, de modo que un fotograma lento se puede atribuir a la etapa y al hilo que lo retrasaron.
+ *
+ * Cada hilo escribe en su propio bfer circular (solo l lo escribe, as que su mutex no tiene competencia
+ * salvo mientras se exporta la traza) y guarda los ltimos `eventsPerThread` eventos. Con las trazas
+ * desactivadas, un `CTraceScope` solo lee un atmico.
+ */
+
+/**
+ * @struct TraceEvent
+ * @brief Un evento completo (etapa con inicio y duracin).
+ */
+struct TraceEvent {
+    const char *name = nullptr;       /**< Nombre de la etapa (cadena esttica) */
+    const char *category = nullptr;   /**< Categora: "capture", "detector", "decode", "gui"... (cadena esttica) */
+    int64_t startNs = 0;              /**< Inicio, en ns del reloj montono */
+    int64_t durationNs = 0;           /**< Duracin, en ns */
+    int64_t frame = -1;               /**< Nmero de fotograma (-1 si no se conoce) */
+};
+
+/**
+ * @class CTracer
+ * @brief Registro de trazas del proceso.
+ *
+ * Es nico por proceso porque cada hilo tiene un nico bfer de eventos, sea cual sea el componente que lo
+ * instrumenta. Los bferes de los hilos que terminan se conservan, para no perder sus eventos.
+ */
+class CTracer
+{
+public:
+    /**
+     * @brief Devuelve el registro de trazas del proceso.
+     */
+    static CTracer &instance();
+
+    /**
+     * @brief Activa las trazas, descartando los eventos anteriores.
+     *
+     * @param eventsPerThread Eventos que se conservan por hilo (los ms recientes).
+     */
+    void start(size_t eventsPerThread = 65536);
+
+    /**
+     * @brief Desactiva las trazas. Los eventos registrados se conservan hasta el siguiente `start`.
+     */
+    void stop();
+
+    /**
+     * @brief Indica si las trazas estn activadas.
+     */
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Da nombre al hilo que llama, para identificarlo en el visor ("captura", "interfaz"...).
+     *
+     * @param name Nombre del hilo.
+     */
+    void setThreadName(const std::string &name);
+
+    /**
+     * @brief Fija el fotograma que procesa el hilo que llama; los eventos sin fotograma explcito lo heredan.
+     *
+     * @param frame Nmero de fotograma (-1 para ninguno).
+     */
+    static void setThreadFrame(int64_t frame);
+
+    /**
+     * @brief Registra un evento en el bfer del hilo que llama (si las trazas estn activadas).
+     *
+     * @param event Evento; si no tiene fotograma, se le asigna el del hilo.
+     */
+    void record(TraceEvent event);
+
+    /**
+     * @brief Genera la traza con los eventos conservados de todos los hilos en el formato JSON de Chrome.
+     */
+    std::string toChromeJson();
+
+    /**
+     * @brief Escribe la traza en un fichero.
+     *
+     * @param fileName Nombre del fichero (normalmente con extensin .json).
+     * @return bool true si se ha podido escribir.
+     */
+    bool dump(const std::string &fileName);
+
+    /**
+     * @brief Instante actual en ns del reloj montono.
+     */
+    static int64_t nowNs();
+
+private:
+    /**
+     * @struct ThreadBuffer
+     * @brief Bfer circular de eventos de un hilo.
+     */
+    struct ThreadBuffer {
+        std::mutex mutex;                /**< Protege los eventos frente a la exportacin */
+        int tid = 0;                     /**< Identificador del hilo en la traza */
+        std::string name;                /**< Nombre del hilo */
+        std::vector<TraceEvent> events;  /**< Bfer circular (vaco hasta el primer evento) */
+        uint64_t written = 0;            /**< Eventos escritos desde el ltimo `start` */
+    };
+
+    CTracer() = default;
+
+    /**
+     * @brief Devuelve el bfer del hilo que llama, crendolo y registrndolo la primera vez.
+     */
+    ThreadBuffer &threadBuffer();
+
+    std::atomic<bool> enabled{ false };                   /**< Trazas activadas */
+    std::atomic<size_t> capacity{ 0 };                    /**< Eventos por hilo */
+    std::atomic<int64_t> originNs{ 0 };                   /**< Instante de `start`, origen de tiempos de la traza */
+    std::mutex mutex;                                     /**< Protege la lista de bferes */
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;   /**< Bferes de todos los hilos que han registrado eventos */
+};
+
+/**
+ * @class CTraceScope
+ * @brief Registra un evento con la duracin de un mbito. Con las trazas desactivadas no mide nada.
+ */
+class CTraceScope
+{
+public:
+    /**
+     * @brief Empieza a medir.
+     *
+     * @param name Nombre de la etapa (debe ser una cadena esttica, p. ej. un literal).
+     * @param category Categora de la etapa (cadena esttica).
+     * @param frame Nmero de fotograma (-1 para heredar el del hilo).
+     */
+    explicit CTraceScope(const char *name, const char *category = "detector", int64_t frame = -1);
+
+    /**
+     * @brief Registra el evento.
+     */
+    ~CTraceScope();
+
+    CTraceScope(const CTraceScope &) = delete;
+    CTraceScope &operator=(const CTraceScope &) = delete;
+
+private:
+    TraceEvent event;   /**< Evento en curso (sin nombre si las trazas estaban desactivadas) */
+};
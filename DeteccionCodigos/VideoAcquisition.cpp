@@ -1,85 +1,191 @@
 #include "VideoAcquisition.h"
 
 //constructor
-CVideoAcquisition::CVideoAcquisition(QString videoStreamAddress)
+CVideoAcquisition::CVideoAcquisition(QString videoStreamAddress, const CpuPlacement &cpuPlacement, const StreamCaptureParams &captureParams)
 {
-	//crea el objeto que se utiliza para capturar imagenes
-	vidcap = new VideoCapture();
+	//se guarda la ubicacin del hilo de captura (se aplica al arrancar el hilo)
+	placement = cpuPlacement;
 
-	//conexin con webcam
-	// cameraOK = vidcap->open(0);
+	//crea el objeto que se utiliza para capturar imagenes; el flujo se abre (y se reabre si se pierde) en el
+	//hilo de captura, con tiempos mximos de apertura y de lectura, de modo que una cmara cada no bloquea
+	//ni la interfaz ni el procesamiento
+	streamParams = captureParams;
+	stream = new CStreamCapture(videoStreamAddress.toStdString(), streamParams);
 
-	//conexin con cmara ip
-	cameraOK = vidcap->open(videoStreamAddress.toStdString());
+	//los cambios de estado del flujo se notifican con una seal (se entrega en el hilo de quien la conecte)
+	stream->setStateCallback([this](CStreamCapture::State state, const std::string &message) {
+		emit captureStateChanged(static_cast<int>(state), QString::fromStdString(message));
+	});
 
 	//inicializacin para no empezar a capturar imgenes
 	capturing = false;
+
+	//se guarda la direccin como identificador del flujo
+	address = videoStreamAddress;
+	timestamp = 0;
+	frameCount = 0;
+	lastReadFrame = 0;
+
+	//sin mtricas hasta que se llame a setMetrics
+	capturedFrames = nullptr;
+	droppedFrames = nullptr;
 }
 
 //destructor
 CVideoAcquisition::~CVideoAcquisition(void)
 {
-	//parar captura
+	//parar captura: se desactiva la lectura, lo que interrumpe la espera de una reconexin
 	startStopCapture(false);
 
-	//terminar el hilo
-	this->terminate();
+	//esperar a que el hilo termine la lectura o la apertura en curso (las dos tienen tiempo mximo); solo si el
+	//backend no los respeta y la lectura sigue bloqueada se termina el hilo a la fuerza
+	if (!this->wait(streamParams.openTimeoutMs + streamParams.readTimeoutMs + 1000))
+	{
+		qDebug() << QString("AVISO: La lectura del flujo no ha terminado a tiempo; se termina el hilo de captura");
+		this->terminate();
+		this->wait();
+	}
 
-	//liberar la memoria del objeto
-	vidcap->release();
+	//liberar la memoria del objeto (cierra el flujo)
+	delete stream;
 }
 
 //funcion para empezar a capturar imagenes o parar
 void CVideoAcquisition::startStopCapture(bool startCapture)
 {
-	//si se ha podido abrir la cmara
-	if (cameraOK)
+	//si hay que capturar
+	if (startCapture)
 	{
-		//si hay que capturar
-		if (startCapture)
-		{
-			//se habilita la captura
-			capturing = true;
-			//se lanza el hilo de captura
+		//si el hilo de captura se estaba parando, se espera a que termine la lectura en curso (tiene tiempo mximo):
+		//al devolver false el hilo sale del bucle aunque se haya vuelto a habilitar la captura
+		if (!capturing && this->isRunning())
+			this->wait();
+		//se habilita la captura
+		capturing = true;
+		stream->setEnabled(true);
+		//se lanza el hilo de captura si no est en marcha
+		if (!this->isRunning())
 			this->start();
-		}
-		else
-			//si no hay que capturar, se deshabilita la captura
-			capturing = false;
 	}
 	else
-		//si la cmara no se ha podido abrir, se lanza un mensaje de error
-		qDebug() << QString("ERROR: La cmara no ha podido ser abierta");
+	{
+		//si no hay que capturar, se deshabilita la captura; la lectura termina en cuanto acaba la que est en curso
+		capturing = false;
+		stream->setEnabled(false);
+	}
 }
 
 //funcin que captura imgenes cada 10ms
 void CVideoAcquisition::run(void)
 {
+	//se fija el hilo en sus ncleos antes de capturar, de modo que las imgenes (que se reservan en las primeras
+	//lecturas y se reutilizan despus) queden en la memoria del nodo NUMA de esos ncleos
+	if (!placement.empty() && !pinCurrentThread(placement.resolveCores()))
+		qDebug() << QString("AVISO: No se ha podido fijar el hilo de captura en") << QString::fromStdString(placement.toString());
+	//nombre del hilo en las trazas
+	CTracer::instance().setThreadName("captura");
+
 	//mientras haya que capturar
 	while (capturing)
 	{
+		//se lee la siguiente imagen sin bloquear el hilo: una lectura lenta, una reconexin o una cada del flujo
+		//no impiden que getImage devuelva la ltima imagen. read solo devuelve false si se ha parado la captura o
+		//si el flujo ha terminado sin reconexin (p. ej. un fichero de vdeo): en los dos casos se deja de capturar,
+		//ya que volver a leer reabrira el flujo
+		CTracer::setThreadFrame(static_cast<int64_t>(frameCount + 1));
+		if (!stream->read(nextImage))
+		{
+			capturing = false;
+			break;
+		}
 		//se bloquea el hilo
 		mutex.lock();
-		//se captura la imagen y se guarda en la variable image
-		vidcap->read(image);
-		//se lanza la seal de que ya hay disponible una nueva imagen
-		emit newImageSignal(image);			
+		//la imagen leda pasa a ser la ltima y la anterior se reutiliza para la siguiente lectura
+		cv::swap(image, nextImage);
+		//la anterior se ha publicado con newImageSignal: si algn receptor conserva todava una referencia, la
+		//siguiente lectura no puede escribir en ella, as que se suelta y la lectura reserva una imagen nueva
+		if (nextImage.u != nullptr && CV_XADD(&nextImage.u->refcount, 0) > 1)
+			nextImage.release();
+		//se guarda el instante de captura y se incrementa el nmero de imagen
+		timestamp = QDateTime::currentMSecsSinceEpoch();
+		frameCount++;
+		if (capturedFrames)
+			capturedFrames->inc();
+		Mat published = image;
 		//se desbloquea el hilo
 		mutex.unlock();
+		//se lanza la seal de que ya hay disponible una nueva imagen
+		emit newImageSignal(published);
 		//se esperan 10ms para realizar la siguiente captura
 		this_thread::sleep_for(chrono::milliseconds(10));		
 	}
 }
 
 //funcin que devuelve la ultima imagen obtenida
-Mat CVideoAcquisition::getImage()
+Mat CVideoAcquisition::getImage(qint64 *timestampMs, quint64 *frameIndex)
 {
+	//en las trazas, "getImage" incluye la espera a que termine la lectura en curso y "clone" solo la copia
+	CTraceScope trace("getImage", "capture");
 	//se bloquea el hilo
 	mutex.lock();
 	//se guarda la ultima imagen capturada
-	Mat img = image.clone();
+	Mat img;
+	{
+		CTraceScope cloneTrace("clone", "capture", static_cast<int64_t>(frameCount));
+		img = image.clone();
+	}
+	//se devuelven el instante de captura y el nmero de imagen si se han pedido
+	if (timestampMs)
+		*timestampMs = timestamp;
+	if (frameIndex)
+		*frameIndex = frameCount;
+	//las imgenes capturadas desde la ltima lectura, salvo la actual, se han perdido
+	if (droppedFrames && frameCount > lastReadFrame + 1)
+		droppedFrames->inc(frameCount - lastReadFrame - 1);
+	lastReadFrame = frameCount;
 	//se desbloquea el hilo
 	mutex.unlock();
 	//re devuelve la imagen
 	return img;
+}
+
+//funcin que devuelve la direccin del flujo de vdeo
+QString CVideoAcquisition::getAddress() const
+{
+	return address;
+}
+
+//funcin que devuelve el estado del flujo
+CStreamCapture::State CVideoAcquisition::getState() const
+{
+	return stream->getState();
+}
+
+//funcin que devuelve los milisegundos transcurridos desde la ltima imagen
+qint64 CVideoAcquisition::getMillisSinceLastFrame() const
+{
+	return stream->getMillisSinceLastFrame();
+}
+
+//funcin que devuelve las estadsticas de la lectura del flujo
+StreamCaptureStats CVideoAcquisition::getStreamStats() const
+{
+	return stream->getStats();
+}
+
+//funcin que registra las mtricas de la captura
+void CVideoAcquisition::setMetrics(CMetricsRegistry* registry)
+{
+	//sin registro se dejan de medir
+	//las de la lectura del flujo (disponibilidad, errores, reconexiones y duracin) las registra el propio flujo
+	stream->setMetrics(registry);
+	if (registry == nullptr)
+	{
+		capturedFrames = droppedFrames = nullptr;
+		return;
+	}
+	//todas las series llevan la direccin del flujo como etiqueta
+	MetricLabels labels = { { "stream", address.toStdString() } };
+	capturedFrames = &registry->counter("dc_capture_frames_total", "Imagenes capturadas", labels);
+	droppedFrames = &registry->counter("dc_capture_dropped_frames_total", "Imagenes capturadas que se han sustituido por la siguiente sin procesarlas", labels);
 }
\ No newline at end of file
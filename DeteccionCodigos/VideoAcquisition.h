@@ -1,6 +1,11 @@
 #include <QObject>
 #include <QtCore>
 #include "opencv2/opencv.hpp"
+#include "CpuAffinity.h"
+#include "Metrics.h"
+#include "StreamCapture.h"
+#include "Tracer.h"
+#include <atomic>
 
 using namespace cv;
 using namespace std;
@@ -12,31 +17,59 @@ class CVideoAcquisition : public QThread
 
 private:
 	//variables de la clase de acceso privado
-	VideoCapture* vidcap; //variable para gestionar la captura de imagenes 
+	CStreamCapture* stream; //lectura supervisada del flujo (tiempos mximos, reconexin y deteccin de imgenes vacas)
+	StreamCaptureParams streamParams; //configuracin de la lectura del flujo
 	Mat image; //variable para guardar la ltima imagen
+	Mat nextImage; //imagen en la que se lee la siguiente, fuera del bloqueo, antes de intercambiarla con image (nunca una imagen publicada que siga en uso)
 	QMutex mutex; //variable para bloquear el hilo de lectura de imgenes
-	bool capturing; //variable para habilitar/deshabilitar la captura
-	bool cameraOK; //variable para indicar si se ha realizado la comunicacin con la cmara
+	std::atomic<bool> capturing; //variable para habilitar/deshabilitar la captura
+	QString address; //direccin del flujo de vdeo (identificador del flujo)
+	qint64 timestamp; //instante de captura de la ltima imagen, en ms desde epoch
+	quint64 frameCount; //nmero de imgenes capturadas
+	CpuPlacement placement; //ncleos o nodo NUMA en los que se fija el hilo de captura
+	quint64 lastReadFrame; //nmero de la ltima imagen devuelta por getImage
+	CMetricCounter* capturedFrames; //mtrica: imgenes capturadas (nullptr si no se miden)
+	CMetricCounter* droppedFrames; //mtrica: imgenes sustituidas por la siguiente sin que nadie las leyera
 
 private:
 	//mtodo que se ejecutar cuando se llame a la funcin start de esta clase
 	void run();
 
 public:
-	//constructor por defecto
-	CVideoAcquisition(QString videoStreamAddress);
+	//constructor: direccin del flujo y, opcionalmente, ncleos o nodo NUMA del hilo de captura y configuracin de la
+	//lectura del flujo (el flujo no se abre aqu, sino en el hilo de captura, para no bloquear a quien lo crea)
+	CVideoAcquisition(QString videoStreamAddress, const CpuPlacement &cpuPlacement = CpuPlacement(),
+		const StreamCaptureParams &captureParams = StreamCaptureParams());
 
 	//destructor
 	~CVideoAcquisition();
 
-	//funcin que devuelve la ltima imagen
-	Mat getImage();
+	//funcin que devuelve la ltima imagen y, opcionalmente, su instante de captura y su nmero de imagen
+	Mat getImage(qint64 *timestampMs = nullptr, quint64 *frameIndex = nullptr);
+
+	//funcin que devuelve la direccin del flujo de vdeo
+	QString getAddress() const;
+
+	//funcin que devuelve el estado del flujo (Stalled si lleva demasiado tiempo sin imgenes, aunque la lectura siga bloqueada)
+	CStreamCapture::State getState() const;
+
+	//funcin que devuelve los milisegundos transcurridos desde la ltima imagen (-1 si an no ha llegado ninguna)
+	qint64 getMillisSinceLastFrame() const;
+
+	//funcin que devuelve las estadsticas de la lectura del flujo (lecturas fallidas, reconexiones, cadas)
+	StreamCaptureStats getStreamStats() const;
+
+	//funcin que registra las mtricas de la captura (etiqueta stream = direccin); llamar antes de empezar a capturar
+	void setMetrics(CMetricsRegistry* registry);
 
 //seales
 signals:	
 	//seal que se produce cada vez que hay una nueva imagen disponible
 	void newImageSignal(Mat img);
 
+	//seal que se produce cuando cambia el estado del flujo (CStreamCapture::State) o se reintenta la conexin
+	void captureStateChanged(int state, QString message);
+
 //slots
 public slots:	
 	//slot para ejecutar/parar la adquisicin de imgenes
@@ -0,0 +1,518 @@
+#include "../DeteccionCodigos/CodeDetector.h"
+#include "../DeteccionCodigos/DetectorVariants.h"
+#include "../DeteccionCodigos/FrameDataset.h"
+#include "../DeteccionCodigos/MotionGate.h"
+#include "../DeteccionCodigos/QualityController.h"
+#include "../DeteccionCodigos/ResultAggregator.h"
+#include "../DeteccionCodigos/ResultWriter.h"
+#include "../DeteccionCodigos/StreamCapture.h"
+#include "../DeteccionCodigos/TaskScheduler.h"
+#include "../DeteccionCodigos/Tracer.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+
+/**
+ * @file DetectorCLI.cpp
+ * @brief Deteccin de cdigos sin interfaz grfica, para equipos de inspeccin sin escritorio.
+ *
+ * Procesa una imagen, un directorio de imgenes JPG, un fichero de vdeo o un flujo (p. ej. RTSP) con
+ * `CCodeDetector::detect` y escribe cada cdigo decodificado como una lnea JSON en la salida estndar.
+ * Opcionalmente guarda los resultados con `CResultWriter` (ficheros rotativos JSON-lines o CSV).
+ * No dibuja nada: las anotaciones (`buildOverlay`) solo son necesarias en la aplicacin grfica.
+ * `--fixed-point` activa la variante entera del detector (`DetectorParams::fixedPoint`) para equipos
+ * con una FPU lenta, sin necesidad de un fichero de parmetros, `--components` el localizador de marcadores
+ * por componentes conexas (`DetectorParams::componentLocator`) y `--scanlines` el decodificador por perfiles
+ * de proyeccin (`DetectorParams::scanlineDecoder`). Se usa la variante del detector
+ * especializada en compilacin para los parmetros, sin anotaciones (`createDetectorPipeline`); su nombre
+ * se escribe por la salida de error. Cada `--roi` aade una zona rectangular donde pueden aparecer los
+ * cdigos (adems de las `rois` del fichero de parmetros); solo se procesan esas zonas.
+ * En vdeos y flujos, `--motion-gate` solo ejecuta el detector cuando la fraccin de pxeles que han cambiado
+ * desde el ltimo fotograma procesado supera la indicada (p. ej. 0.005), y reutiliza el resultado anterior
+ * en los dems (`CMotionGate`). Con un directorio de imgenes, `--batch N` las procesa en lotes de N con
+ * `CCodeDetector::detectBatch` (mismo resultado, ms imgenes por segundo). `--workers N` y/o `--cores 0-3,6`
+ * reparten cada fotograma (o cada lote) en tareas de un planificador con robo de trabajo (`CTaskScheduler`)
+ * de N hilos fijados en esos ncleos (o en los de un nodo NUMA con `--cores node:1`), y al terminar escriben las
+ * estadsticas de cada hilo por la salida de error. `--placement node:1` (o una lista de ncleos) fija el hilo
+ * principal, que captura y decodifica, en ese nodo o esos ncleos, y tambin los trabajadores del planificador
+ * si no se indica `--cores`; al terminar se escribe la utilizacin de cada uno de esos ncleos.
+ * La entrada tambin puede ser un conjunto de fotogramas empaquetado con DatasetPacker (.dcf): se lee mapeado
+ * en memoria, sin abrir ni decodificar ficheros, en lotes de `--batch` fotogramas (el siguiente lote se pide al
+ * disco mientras se procesa el actual), y cada resultado lleva la etiqueta y el instante del fotograma original.
+ * Los flujos (direcciones con "://") se leen con `CStreamCapture`: con tiempos mximos de apertura y de lectura
+ * y, si se pierden, se reabren con esperas crecientes en lugar de terminar; los cambios de estado se escriben por la
+ * salida de error. Los tiempos y las esperas se configuran con las claves `capture*` del fichero de parmetros.
+ * En vdeos y flujos, `--budget-ms 25` (o la clave `qualityBudgetMs` del fichero de parmetros) activa el control
+ * adaptativo de la calidad (`CQualityController`): si el procesamiento de cada fotograma supera ese tiempo, se baja la
+ * calidad por niveles hasta omitir fotogramas, y se recupera cuando sobra tiempo; cada cambio se escribe por la
+ * salida de error.
+ * En vdeos y flujos, `--aggregate` (o la clave `aggregator` del fichero de parmetros) sigue cada cdigo entre
+ * fotogramas (`CResultAggregator`) y, en lugar de los cdigos de cada fotograma, escribe uno solo por cdigo fsico
+ * cuando deja de verse, con sus dgitos votados entre todos los fotogramas en que se ha ledo.
+ * `--trace traza.json` registra el inicio y la duracin de cada etapa de cada fotograma en cada hilo (`CTracer`)
+ * y al terminar los escribe en el formato JSON de Chrome, para abrirlos en chrome://tracing o en Perfetto.
+ *
+ * Uso: DetectorCLI <imagen|directorio|conjunto.dcf|video|url> [--params detector.yml] [--out base] [--csv] [--fixed-point] [--components] [--scanlines] [--roi x,y,ancho,alto]... [--motion-gate fraccion] [--budget-ms ms] [--aggregate] [--batch N] [--workers N] [--cores lista|node:N] [--placement lista|node:N] [--trace traza.json] [--quiet]
+ */
+
+/**
+ * @brief Indica si una ruta tiene extensin de imagen.
+ *
+ * @param path Ruta del fichero.
+ * @return bool true si la extensin es de imagen (jpg, jpeg, png, bmp).
+ */
+static bool isImageFile(const std::string &path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp";
+}
+
+
+/**
+ * @brief Muestra por la salida estndar y guarda los cdigos de un fotograma.
+ *
+ * @param codes Cdigos decodificados.
+ * @param writer Escritor de resultados (puede ser nullptr).
+ * @param streamId Identificador del flujo o nombre del fichero.
+ * @param frameIndex Nmero de fotograma.
+ * @param quiet Si es true no se escribe nada por la salida estndar.
+ * @param timestampMs Instante de captura del fotograma, en ms desde epoch (0 = el instante actual).
+ *
+ * @return size_t Nmero de cdigos.
+ */
+static size_t emitCodes(const std::vector<DecodedCode> &codes, CResultWriter *writer, const std::string &streamId,
+                        uint64_t frameIndex, bool quiet, int64_t timestampMs = 0) {
+    if (timestampMs == 0) {
+        timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    if (!quiet) {
+        for (const DecodedCode &code : codes) {
+            ResultRecord record;
+            record.streamId = streamId;
+            record.timestampMs = timestampMs;
+            record.frameIndex = frameIndex;
+            record.code = code;
+            std::cout << CResultWriter::toJson(record) << "\n";
+        }
+    }
+    if (writer) {
+        writer->push(streamId, timestampMs, frameIndex, codes);
+    }
+    return codes.size();
+}
+
+
+/**
+ * @brief Muestra por la salida estndar y guarda los cdigos fsicos terminados del agregador.
+ *
+ * @param aggregated Cdigos fsicos terminados; cada uno se escribe con el nmero e instante de su ltimo fotograma.
+ * @param writer Escritor de resultados (puede ser nullptr).
+ * @param streamId Identificador del flujo.
+ * @param quiet Si es true no se escribe nada por la salida estndar.
+ *
+ * @return size_t Nmero de cdigos.
+ */
+static size_t emitAggregatedCodes(const std::vector<AggregatedCode> &aggregated, CResultWriter *writer,
+                                  const std::string &streamId, bool quiet) {
+    for (const AggregatedCode &result : aggregated) {
+        emitCodes({ result.code }, writer, streamId, result.lastFrame, quiet, result.lastTimestampMs);
+    }
+    return aggregated.size();
+}
+
+
+/**
+ * @brief Procesa un fotograma: detecta los cdigos, los muestra por la salida estndar y los guarda.
+ *
+ * @param pipeline Variante del detector configurada.
+ * @param scheduler Planificador de tareas (nullptr para detectar con la variante en el hilo actual).
+ * @param gate Detector de movimiento (puede ser nullptr para procesar todos los fotogramas).
+ * @param lastCodes Cdigos del ltimo fotograma procesado; se reutilizan si `gate` indica que no hay cambios.
+ * @param aggregator Agregador de resultados (nullptr para escribir los cdigos de cada fotograma); con l solo se
+ *                   escriben los cdigos fsicos que dejan de verse.
+ * @param writer Escritor de resultados (puede ser nullptr).
+ * @param streamId Identificador del flujo o nombre del fichero.
+ * @param frameIndex Nmero de fotograma.
+ * @param frame Fotograma BGR.
+ * @param quiet Si es true no se escribe nada por la salida estndar.
+ *
+ * @return size_t Nmero de cdigos decodificados.
+ */
+static size_t processFrame(CDetectorPipeline &pipeline, CTaskScheduler *scheduler, CMotionGate *gate, std::vector<DecodedCode> &lastCodes,
+                           CResultAggregator *aggregator, CResultWriter *writer, const std::string &streamId, uint64_t frameIndex, const Mat &frame,
+                           bool quiet) {
+    CTracer::setThreadFrame(static_cast<int64_t>( frameIndex ));
+    bool changed;
+    {
+        CTraceScope trace("motionGate");
+        changed = gate == nullptr || gate->check(frame);
+    }
+    if (changed) {
+        CTraceScope trace("detect");
+        if (scheduler) {
+            lastCodes = pipeline.getDetector().detectBatch({ frame }, *scheduler).front();
+        }
+        else {
+            lastCodes = pipeline.detect(frame, nullptr);
+        }
+        // Los fotogramas sin cambios no se pasan al agregador: repetiran los mismos votos y envejeceran los
+        // cdigos de una pieza parada
+        if (aggregator) {
+            int64_t timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            aggregator->update(frameIndex, timestampMs, lastCodes);
+        }
+    }
+    if (aggregator) {
+        return emitAggregatedCodes(aggregator->takeFinished(), writer, streamId, quiet);
+    }
+    return emitCodes(lastCodes, writer, streamId, frameIndex, quiet);
+}
+
+
+int main(int argc, char *argv[])
+{
+    // Paso 1: Leer los argumentos de la lnea de comandos
+    if (argc < 2) {
+        std::cerr << "Uso: DetectorCLI <imagen|directorio|conjunto.dcf|video|url> [--params detector.yml] [--out base] [--csv] [--fixed-point] [--components] [--scanlines] [--roi x,y,ancho,alto]... [--motion-gate fraccion] [--budget-ms ms] [--aggregate] [--batch N] [--workers N] [--cores lista|node:N] [--placement lista|node:N] [--trace traza.json] [--quiet]" << std::endl;
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string paramsFile;
+    std::string outBase;
+    bool csv = false;
+    bool quiet = false;
+    bool fixedPoint = false;
+    bool componentLocator = false;
+    bool scanlineDecoder = false;
+    bool aggregate = false;
+    std::vector<std::vector<Point>> rois;
+    double motionFraction = 0.0;
+    double budgetMs = 0.0;
+    int batchSize = 1;
+    TaskSchedulerParams schedulerParams;
+    bool useScheduler = false;
+    CpuPlacement placement;
+    std::string traceFile;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--params" && i + 1 < argc) paramsFile = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outBase = argv[++i];
+        else if (arg == "--csv") csv = true;
+        else if (arg == "--fixed-point") fixedPoint = true;
+        else if (arg == "--components") componentLocator = true;
+        else if (arg == "--scanlines") scanlineDecoder = true;
+        else if (arg == "--aggregate") aggregate = true;
+        else if (arg == "--quiet") quiet = true;
+        else if (arg == "--trace" && i + 1 < argc) traceFile = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) batchSize = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--workers" && i + 1 < argc) {
+            schedulerParams.numWorkers = std::max(1, std::atoi(argv[++i]));
+            useScheduler = true;
+        }
+        else if (arg == "--cores" && i + 1 < argc) {
+            if (!CpuPlacement::parse(argv[++i], schedulerParams.placement)) {
+                std::cerr << "Lista de nucleos no valida: " << argv[i] << " (formato 0-3,6 o node:N)" << std::endl;
+                return 1;
+            }
+            useScheduler = true;
+        }
+        else if (arg == "--placement" && i + 1 < argc) {
+            if (!CpuPlacement::parse(argv[++i], placement)) {
+                std::cerr << "Ubicacion no valida: " << argv[i] << " (formato 0-3,6 o node:N)" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--motion-gate" && i + 1 < argc) motionFraction = std::atof(argv[++i]);
+        else if (arg == "--budget-ms" && i + 1 < argc) budgetMs = std::atof(argv[++i]);
+        else if (arg == "--roi" && i + 1 < argc) {
+            int x = 0, y = 0, width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%d,%d,%d,%d", &x, &y, &width, &height) != 4 || width <= 0 || height <= 0) {
+                std::cerr << "ROI no valida: " << argv[i] << " (formato x,y,ancho,alto)" << std::endl;
+                return 1;
+            }
+            rois.push_back({ Point(x, y), Point(x + width, y), Point(x + width, y + height), Point(x, y + height) });
+        }
+    }
+
+    // Paso 2: Fijar el hilo principal (captura y decodificacin) en su ubicacin antes de reservar ninguna
+    // imagen, para que la memoria de los fotogramas quede en su nodo NUMA. Los hilos que crean OpenCV y la
+    // captura de vdeo heredan la ubicacin
+    if (!placement.empty()) {
+        if (!pinCurrentThread(placement.resolveCores())) {
+            std::cerr << "No se ha podido fijar el hilo principal en " << placement.toString() << std::endl;
+        }
+        if (schedulerParams.placement.empty()) {
+            schedulerParams.placement = placement;
+        }
+    }
+    CCpuUsageMonitor cpuUsage;
+    if (!traceFile.empty()) {
+        CTracer::instance().setThreadName("principal");
+        CTracer::instance().start();
+    }
+
+    // Paso 3: Configurar el detector y, si se ha pedido, el escritor de resultados
+    CCodeDetector detector;
+    if (!paramsFile.empty() && !detector.loadParams(paramsFile)) {
+        std::cerr << "No se han podido cargar los parametros de " << paramsFile << std::endl;
+        return 1;
+    }
+    if (fixedPoint || componentLocator || scanlineDecoder || !rois.empty()) {
+        DetectorParams params = detector.getParams();
+        params.fixedPoint = params.fixedPoint || fixedPoint;
+        params.componentLocator = params.componentLocator || componentLocator;
+        params.scanlineDecoder = params.scanlineDecoder || scanlineDecoder;
+        params.rois.insert(params.rois.end(), rois.begin(), rois.end());
+        detector.setParams(params);
+    }
+    std::unique_ptr<CDetectorPipeline> pipeline = createDetectorPipeline(detector.getParams(), false);
+    if (!quiet) {
+        std::cerr << "Variante del detector: " << pipeline->getName() << std::endl;
+    }
+    std::unique_ptr<CResultWriter> writer;
+    if (!outBase.empty()) {
+        ResultWriterParams writerParams;
+        writerParams.basePath = outBase;
+        writerParams.format = csv ? ResultWriterParams::Csv : ResultWriterParams::JsonLines;
+        writer.reset(new CResultWriter(writerParams));
+    }
+
+    // Con el planificador, el paralelismo lo dan sus tareas: las funciones de OpenCV se ejecutan en un solo
+    // hilo dentro de cada tarea para no repartir dos veces los mismos ncleos
+    std::unique_ptr<CTaskScheduler> scheduler;
+    if (useScheduler) {
+        setNumThreads(1);
+        scheduler.reset(new CTaskScheduler(schedulerParams));
+    }
+
+    // Paso 4: Procesar la entrada (imgenes sueltas, conjunto de fotogramas o vdeo/flujo)
+    std::vector<DecodedCode> lastCodes;
+    uint64_t frames = 0;
+    size_t codes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<String> files;
+    if (isImageFile(input)) {
+        files.push_back(input);
+    }
+    else if (std::filesystem::is_directory(input)) {
+        glob(input + "/*.jpg", files, false);
+    }
+
+    if (CFrameDatasetReader::isDataset(input)) {
+        // Conjunto de fotogramas mapeado en memoria: los fotogramas BGR se procesan directamente sobre el mapeo
+        CFrameDatasetReader dataset;
+        if (!dataset.open(input)) {
+            std::cerr << "No se ha podido abrir el conjunto " << input << std::endl;
+            return 1;
+        }
+        const size_t batchFrames = static_cast<size_t>( batchSize );
+        dataset.prefetch(0, batchFrames);
+        std::vector<Mat> batch;
+        std::vector<size_t> batchIndices;
+        for (size_t first = 0; first < dataset.size(); first += batchFrames) {
+            size_t last = std::min(dataset.size(), first + batchFrames);
+            dataset.prefetch(last, batchFrames);
+            for (size_t f = first; f < last; ++f) {
+                Mat image = dataset.getFrame(f);
+                if (image.empty()) {
+                    std::cerr << "No se ha podido leer el fotograma " << f << " (" << dataset.getRecord(f).label << ")" << std::endl;
+                    continue;
+                }
+                batch.push_back(image);
+                batchIndices.push_back(f);
+            }
+            std::vector<std::vector<DecodedCode>> batchCodes;
+            if (scheduler) {
+                batchCodes = pipeline->getDetector().detectBatch(batch, *scheduler);
+            }
+            else if (batch.size() > 1) {
+                batchCodes = pipeline->getDetector().detectBatch(batch);
+            }
+            else {
+                for (const Mat &image : batch) {
+                    batchCodes.push_back(pipeline->detect(image, nullptr));
+                }
+            }
+            for (size_t b = 0; b < batch.size(); ++b) {
+                const FrameRecord &record = dataset.getRecord(batchIndices[b]);
+                codes += emitCodes(batchCodes[b], writer.get(), record.label, frames++, quiet, record.timestampMs);
+            }
+            batch.clear();
+            batchIndices.clear();
+        }
+    }
+    else if (!files.empty() && batchSize > 1) {
+        // Lotes de imgenes procesados etapa a etapa con detectBatch
+        std::vector<Mat> batch;
+        std::vector<std::string> batchFiles;
+        for (size_t f = 0; f < files.size(); ++f) {
+            Mat image = imread(files[f], IMREAD_COLOR);
+            if (image.empty()) {
+                std::cerr << "No se ha podido leer " << files[f] << std::endl;
+            }
+            else {
+                batch.push_back(image);
+                batchFiles.push_back(files[f]);
+            }
+            if (!batch.empty() && ( static_cast<int>( batch.size() ) == batchSize || f + 1 == files.size() )) {
+                std::vector<std::vector<DecodedCode>> batchCodes = scheduler ? pipeline->getDetector().detectBatch(batch, *scheduler)
+                                                                             : pipeline->getDetector().detectBatch(batch);
+                for (size_t b = 0; b < batch.size(); ++b) {
+                    codes += emitCodes(batchCodes[b], writer.get(), batchFiles[b], frames++, quiet);
+                }
+                batch.clear();
+                batchFiles.clear();
+            }
+        }
+    }
+    else if (!files.empty()) {
+        for (const auto &file : files) {
+            Mat image = imread(file, IMREAD_COLOR);
+            if (image.empty()) {
+                std::cerr << "No se ha podido leer " << file << std::endl;
+                continue;
+            }
+            codes += processFrame(*pipeline, scheduler.get(), nullptr, lastCodes, nullptr, writer.get(), file, frames++, image, quiet);
+        }
+    }
+    else {
+        // Vdeo o flujo: los flujos y las cmaras locales se reabren si se pierden; en un fichero, un fallo de lectura
+        // es el final
+        StreamCaptureParams captureParams;
+        if (!paramsFile.empty()) {
+            StreamCaptureParams::load(paramsFile, captureParams);
+        }
+        captureParams.reconnect = input.find("://") != std::string::npos || input.find_first_not_of("0123456789") == std::string::npos;
+        CStreamCapture capture(input, captureParams);
+        capture.setStateCallback([](CStreamCapture::State state, const std::string &message) {
+            std::cerr << "Flujo " << CStreamCapture::stateName(state) << ": " << message << std::endl;
+        });
+        std::unique_ptr<CMotionGate> gate;
+        if (motionFraction > 0) {
+            MotionGateParams gateParams;
+            gateParams.changedFraction = motionFraction;
+            gate.reset(new CMotionGate(gateParams));
+        }
+        QualityControllerParams qualityParams;
+        if (!paramsFile.empty()) {
+            QualityControllerParams::load(paramsFile, qualityParams);
+        }
+        if (budgetMs > 0) {
+            qualityParams.budgetMs = budgetMs;
+        }
+        CQualityController quality(detector.getParams(), qualityParams);
+        quality.setChangeCallback([](const QualityChange &change) {
+            std::cerr << std::fixed << std::setprecision(1) << "Calidad " << change.fromLevel << " -> " << change.toLevel
+                      << " (" << CQualityController::levelName(change.toLevel) << ") en el fotograma " << change.frameIndex
+                      << ": " << change.meanMs << " ms por fotograma" << std::endl;
+        });
+        ResultAggregatorParams aggregatorParams;
+        if (!paramsFile.empty()) {
+            ResultAggregatorParams::load(paramsFile, aggregatorParams);
+        }
+        std::unique_ptr<CResultAggregator> aggregator;
+        if (aggregate || aggregatorParams.enabled) {
+            aggregator.reset(new CResultAggregator(aggregatorParams));
+        }
+        Mat frame;
+        while (true) {
+            CTracer::setThreadFrame(static_cast<int64_t>( frames ));
+            if (!capture.read(frame)) {
+                break;
+            }
+            // En los niveles ms bajos de calidad se omiten fotogramas; si cambia el nivel, se crea la variante del
+            // detector de los nuevos parmetros
+            if (!quality.shouldProcess()) {
+                frames++;
+                continue;
+            }
+            auto frameStart = std::chrono::steady_clock::now();
+            codes += processFrame(*pipeline, scheduler.get(), gate.get(), lastCodes, aggregator.get(), writer.get(), input, frames, frame, quiet);
+            double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            if (quality.update(frameMs, frames)) {
+                pipeline = createDetectorPipeline(quality.getParams(), false);
+            }
+            frames++;
+        }
+        if (aggregator) {
+            aggregator->finish();
+            codes += emitAggregatedCodes(aggregator->takeFinished(), writer.get(), input, quiet);
+            const ResultAggregatorStats &stats = aggregator->getStats();
+            std::cerr << "Codigos fisicos: " << stats.emittedCodes << " de " << stats.observations << " lecturas, "
+                      << stats.correctedObservations << " lecturas corregidas por la votacion, " << stats.discardedTracks
+                      << " descartados (vistos en menos de " << aggregatorParams.minFrames << " fotogramas)" << std::endl;
+        }
+        StreamCaptureStats captureStats = capture.getStats();
+        if (captureStats.frames == 0) {
+            std::cerr << "No se ha podido leer " << input << std::endl;
+            return 1;
+        }
+        if (captureParams.reconnect) {
+            std::cerr << "Lecturas fallidas: " << captureStats.failedReads << ", vacias: " << captureStats.emptyFrames
+                      << ", caidas del flujo: " << captureStats.outages << ", reconexiones: " << captureStats.reconnects << std::endl;
+        }
+        if (quality.isEnabled()) {
+            const QualityControllerStats &stats = quality.getStats();
+            std::cerr << "Cambios de calidad: " << stats.levelChanges << ", fotogramas omitidos: " << stats.skippedFrames
+                      << ", fotogramas por nivel:";
+            for (int level = 0; level < CQualityController::numLevels; ++level) {
+                std::cerr << " " << level << ":" << stats.framesAtLevel[level];
+            }
+            std::cerr << std::endl;
+        }
+        if (gate) {
+            const MotionGateStats &stats = gate->getStats();
+            std::cerr << std::fixed << std::setprecision(1)
+                      << "Fotogramas omitidos sin movimiento: " << stats.skippedFrames << " de " << stats.checkedFrames
+                      << ", comprobacion media " << stats.meanCheckUs << " us (maxima " << stats.maxCheckUs << " us)" << std::endl;
+        }
+    }
+
+    // Paso 5: Resumen (por la salida de errores, para no mezclarlo con el JSON)
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << std::fixed << std::setprecision(3)
+              << "Fotogramas: " << frames << ", codigos: " << codes
+              << ", " << ( frames ? elapsedMs / frames : 0.0 ) << " ms/fotograma" << std::endl;
+    if (scheduler) {
+        std::vector<WorkerStats> workerStats = scheduler->getStats();
+        workerStats.push_back(scheduler->getCallerStats());
+        for (size_t w = 0; w < workerStats.size(); ++w) {
+            const WorkerStats &stats = workerStats[w];
+            std::cerr << std::fixed << std::setprecision(1)
+                      << ( w + 1 < workerStats.size() ? "Hilo " + std::to_string(w) : std::string("Hilo principal") )
+                      << ( stats.core >= 0 ? " (nucleo " + std::to_string(stats.core) + ")" : std::string() )
+                      << ": " << stats.executedTasks << " tareas, " << stats.stolenTasks << " robadas, "
+                      << ( elapsedMs > 0 ? 100.0 * stats.busyUs / ( elapsedMs * 1000.0 ) : 0.0 ) << " % ocupado" << std::endl;
+        }
+    }
+
+    if (!placement.empty()) {
+        std::vector<double> usage = cpuUsage.sample();
+        std::cerr << "Utilizacion por nucleo:";
+        for (int core : placement.resolveCores()) {
+            if (core < static_cast<int>( usage.size() )) {
+                std::cerr << " " << core << ":" << std::setprecision(0) << 100.0 * usage[core] << "%";
+            }
+        }
+        std::cerr << std::endl;
+    }
+
+    if (!traceFile.empty()) {
+        CTracer::instance().stop();
+        if (!CTracer::instance().dump(traceFile)) {
+            std::cerr << "No se ha podido escribir la traza en " << traceFile << std::endl;
+        }
+    }
+
+    // El destructor del escritor vaca la cola antes de terminar
+    writer.reset();
+    return 0;
+}
@@ -0,0 +1,359 @@
+#include "../DeteccionCodigos/CodeDetector.h"
+#include "../DeteccionCodigos/FrameDataset.h"
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+/**
+ * @file ParameterTuner.cpp
+ * @brief Bsqueda automtica de parmetros del detector sobre el conjunto etiquetado de `Imagenes/`.
+ *
+ * La herramienta evala configuraciones de `DetectorParams` (tamaos de desenfoque, kernel de Sobel,
+ * rangos HSV, escala de localizacin y parmetros de `thresholdImage`) en paralelo, midiendo para cada
+ * una la precisin por coincidencia exacta con la etiqueta del nombre de fichero y el tiempo medio por
+ * imagen. Al terminar escribe todas las evaluaciones en CSV y guarda como YAML las configuraciones del
+ * frente de Pareto (mxima precisin frente a mnimo tiempo), que pueden cargarse con
+ * `CCodeDetector::loadParams` (la aplicacin grfica lee `detector.yml`).
+ *
+ * La configuracin original se evala tambin en punto fijo (`DetectorParams::fixedPoint`), con el localizador
+ * de componentes conexas (`DetectorParams::componentLocator`) y con el decodificador por perfiles de proyeccin
+ * (`DetectorParams::scanlineDecoder`), y se muestra cuntas imgenes etiquetadas cambian de resultado respecto a
+ * la configuracin original.
+ *
+ * En lugar del directorio se puede indicar un conjunto empaquetado con DatasetPacker (.dcf): las imgenes
+ * son vistas sobre el fichero mapeado en memoria, sin decodificar ni copiar, y la etiqueta se toma del
+ * nombre del fichero original guardado en el conjunto.
+ *
+ * Uso: ParameterTuner <directorioImagenes|conjunto.dcf> [--samples N] [--threads N] [--seed S] [--out directorio]
+ */
+
+/**
+ * @struct Sample
+ * @brief Imagen del conjunto de evaluacin junto con su etiqueta.
+ */
+struct Sample {
+    std::string name;   /**< Nombre del fichero */
+    std::string label;  /**< Cdigo esperado (vaco si la imagen no tiene etiqueta, p. ej. "mix") */
+    Mat image;          /**< Imagen decodificada en memoria */
+};
+
+/**
+ * @struct Evaluation
+ * @brief Resultado de evaluar una configuracin sobre todo el conjunto.
+ */
+struct Evaluation {
+    DetectorParams params;    /**< Configuracin evaluada */
+    int correct = 0;          /**< Imgenes etiquetadas decodificadas correctamente */
+    int labelled = 0;         /**< Imgenes etiquetadas evaluadas */
+    double accuracy = 0;      /**< Fraccin de imgenes etiquetadas correctas */
+    double msPerFrame = 0;    /**< Tiempo medio de `detect` por imagen, en milisegundos */
+    std::vector<bool> sampleCorrect; /**< Resultado de cada imagen etiquetada, en el orden del conjunto */
+    bool pareto = false;      /**< true si la configuracin pertenece al frente de Pareto */
+};
+
+/**
+ * @brief Obtiene la etiqueta de una imagen a partir de su nombre ("1103_G1_12.jpg" -> "1103").
+ *
+ * @param fileName Ruta del fichero.
+ * @return std::string El cdigo de 4 dgitos, o una cadena vaca si el nombre no empieza por uno.
+ */
+static std::string labelFromFileName(const std::string &fileName) {
+    // Paso 1: Quedarse con el nombre sin directorio
+    size_t slash = fileName.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+
+    // Paso 2: Tomar el prefijo hasta el primer '_' y comprobar que son 4 dgitos
+    std::string prefix = name.substr(0, name.find('_'));
+    if (prefix.size() != 4 || !std::all_of(prefix.begin(), prefix.end(), [](char c) { return std::isdigit(static_cast<unsigned char>( c )) != 0; })) {
+        return "";
+    }
+    return prefix;
+}
+
+/**
+ * @brief Carga todas las imgenes JPG del directorio indicado o todos los fotogramas de un conjunto .dcf.
+ *
+ * @param directory Directorio con las imgenes o conjunto de fotogramas.
+ * @param dataset Lector del conjunto; las imgenes apuntan a su mapeo, as que debe seguir abierto mientras se usen.
+ * @return std::vector<Sample> Las imgenes cargadas con sus etiquetas.
+ */
+static std::vector<Sample> loadSamples(const std::string &directory, CFrameDatasetReader &dataset) {
+    if (CFrameDatasetReader::isDataset(directory)) {
+        std::vector<Sample> samples;
+        if (!dataset.open(directory)) {
+            return samples;
+        }
+        for (size_t f = 0; f < dataset.size(); ++f) {
+            Sample sample;
+            sample.name = dataset.getRecord(f).label;
+            sample.label = labelFromFileName(sample.name);
+            sample.image = dataset.getFrame(f);
+            if (!sample.image.empty()) {
+                samples.push_back(sample);
+            }
+        }
+        return samples;
+    }
+
+    std::vector<String> files;
+    glob(directory + "/*.jpg", files, false);
+
+    std::vector<Sample> samples;
+    for (const auto &file : files) {
+        Sample sample;
+        sample.name = file;
+        sample.label = labelFromFileName(file);
+        sample.image = imread(file, IMREAD_COLOR);
+        if (!sample.image.empty()) {
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+/**
+ * @brief Genera una configuracin aleatoria dentro del espacio de bsqueda.
+ *
+ * Cada parmetro se elige de un conjunto discreto de valores alrededor de los valores originales.
+ *
+ * @param rng Generador de nmeros aleatorios.
+ * @return DetectorParams La configuracin generada.
+ */
+static DetectorParams randomParams(std::mt19937 &rng) {
+    auto pick = [&rng](const std::vector<double> &values) {
+        std::uniform_int_distribution<size_t> dist(0, values.size() - 1);
+        return values[dist(rng)];
+    };
+
+    DetectorParams p;
+    p.blurKernelSize = static_cast<int>( pick({ 3, 5, 7, 9 }) );
+    p.sobelKernelSize = static_cast<int>( pick({ 3, 5, 7, 9, 11 }) );
+    p.sobelThreshold = static_cast<int>( pick({ 20, 30, 40 }) );
+
+    double redMin = pick({ 40, 50, 60, 70 });
+    p.redLow1 = Scalar(0, redMin, redMin);
+    p.redHigh1 = Scalar(pick({ 8, 10, 12 }), 255, 255);
+    p.redLow2 = Scalar(pick({ 140, 150, 160 }), redMin, redMin);
+    p.redHigh2 = Scalar(179, 255, 255);
+
+    double greenMin = pick({ 45, 55, 65 });
+    p.greenLow = Scalar(pick({ 25, 30, 35 }), greenMin, greenMin);
+    p.greenHigh = Scalar(pick({ 85, 90, 95 }), 255, 255);
+
+    p.pyramidScale = pick({ 1.0, 0.75, 0.5, 0.35 });
+    p.decodeBlurKernelSize = static_cast<int>( pick({ 5, 7, 9, 11, 13 }) );
+    p.thresholdBlockSize = static_cast<int>( pick({ 7, 9, 11, 15, 21 }) );
+    p.thresholdOffset = static_cast<int>( pick({ 1, 2, 3, 4 }) );
+    p.fixedPoint = pick({ 0, 1 }) != 0;
+    p.componentLocator = pick({ 0, 1 }) != 0;
+    p.componentMinFill = pick({ 0.3, 0.4, 0.5 });
+    p.scanlineDecoder = pick({ 0, 1 }) != 0;
+    p.scanlineMargin = pick({ 0.1, 0.15, 0.2 });
+    return p;
+}
+
+/**
+ * @brief Evala una configuracin sobre todas las imgenes.
+ *
+ * Una imagen etiquetada se considera correcta si se ha detectado al menos un cdigo y todos los
+ * cdigos detectados coinciden exactamente con la etiqueta.
+ *
+ * @param params Configuracin a evaluar.
+ * @param samples Conjunto de imgenes.
+ * @return Evaluation Precisin y tiempo medio de la configuracin.
+ */
+static Evaluation evaluate(const DetectorParams &params, const std::vector<Sample> &samples) {
+    Evaluation eval;
+    eval.params = params;
+
+    CCodeDetector detector(params);
+    double totalMs = 0;
+
+    for (const Sample &sample : samples) {
+        // Paso 1: Medir el tiempo de la deteccin completa
+        auto start = std::chrono::steady_clock::now();
+        std::vector<DecodedCode> codes;
+        try {
+            codes = detector.detect(sample.image);
+        }
+        catch (const cv::Exception &) {
+            // Algunas combinaciones de parmetros no son vlidas para OpenCV; cuentan como fallo
+            codes.clear();
+        }
+        auto end = std::chrono::steady_clock::now();
+        totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+        // Paso 2: Comparar con la etiqueta (solo imgenes etiquetadas)
+        if (sample.label.empty()) {
+            continue;
+        }
+        eval.labelled++;
+        bool ok = !codes.empty() && std::all_of(codes.begin(), codes.end(),
+            [&sample](const DecodedCode &c) { return c.code == sample.label; });
+        eval.sampleCorrect.push_back(ok);
+        if (ok) {
+            eval.correct++;
+        }
+    }
+
+    eval.accuracy = eval.labelled > 0 ? static_cast<double>( eval.correct ) / eval.labelled : 0;
+    eval.msPerFrame = samples.empty() ? 0 : totalMs / samples.size();
+    return eval;
+}
+
+/**
+ * @brief Marca las evaluaciones que pertenecen al frente de Pareto.
+ *
+ * Una evaluacin es Pareto-ptima si ninguna otra tiene mayor o igual precisin y menor o igual tiempo
+ * siendo estrictamente mejor en alguno de los dos.
+ *
+ * @param evaluations Evaluaciones a analizar (se modifica el campo `pareto`).
+ */
+static void markParetoFront(std::vector<Evaluation> &evaluations) {
+    for (auto &a : evaluations) {
+        a.pareto = true;
+        for (const auto &b : evaluations) {
+            bool dominates = b.accuracy >= a.accuracy && b.msPerFrame <= a.msPerFrame &&
+                             ( b.accuracy > a.accuracy || b.msPerFrame < a.msPerFrame );
+            if (dominates) {
+                a.pareto = false;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Escribe una fila CSV con la configuracin y sus mtricas.
+ */
+static void writeCsvRow(std::ostream &out, const Evaluation &e) {
+    const DetectorParams &p = e.params;
+    out << e.accuracy << ',' << e.msPerFrame << ',' << e.correct << ',' << e.labelled << ',' << ( e.pareto ? 1 : 0 ) << ','
+        << p.blurKernelSize << ',' << p.sobelKernelSize << ',' << p.sobelThreshold << ','
+        << p.redLow1[1] << ',' << p.redHigh1[0] << ',' << p.redLow2[0] << ','
+        << p.greenLow[0] << ',' << p.greenHigh[0] << ',' << p.greenLow[1] << ','
+        << p.pyramidScale << ',' << p.decodeBlurKernelSize << ',' << p.thresholdBlockSize << ',' << p.thresholdOffset << ','
+        << ( p.fixedPoint ? 1 : 0 ) << ',' << ( p.componentLocator ? 1 : 0 ) << ',' << p.componentMinFill << ','
+        << ( p.scanlineDecoder ? 1 : 0 ) << ',' << p.scanlineMargin << '\n';
+}
+
+int main(int argc, char *argv[])
+{
+    // Paso 1: Leer los argumentos de la lnea de comandos
+    if (argc < 2) {
+        std::cerr << "Uso: ParameterTuner <directorioImagenes|conjunto.dcf> [--samples N] [--threads N] [--seed S] [--out directorio]" << std::endl;
+        return 1;
+    }
+    std::string directory = argv[1];
+    int numSamples = 200;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned seed = 42;
+    std::string outDir = ".";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--samples") numSamples = std::atoi(argv[i + 1]);
+        else if (arg == "--threads") numThreads = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--seed") seed = static_cast<unsigned>( std::atoi(argv[i + 1]) );
+        else if (arg == "--out") outDir = argv[i + 1];
+    }
+
+    // Paso 2: Cargar las imgenes una sola vez; la decodificacin JPEG no forma parte de la medida
+    CFrameDatasetReader dataset;
+    std::vector<Sample> samples = loadSamples(directory, dataset);
+    if (samples.empty()) {
+        std::cerr << "No se han encontrado imagenes en " << directory << std::endl;
+        return 1;
+    }
+    std::cout << "Imagenes cargadas: " << samples.size() << std::endl;
+
+    // Paso 3: Generar las configuraciones; las cuatro primeras son siempre la configuracin original en coma
+    // flotante, en punto fijo, con el localizador de componentes conexas y con el decodificador por perfiles
+    std::mt19937 rng(seed);
+    DetectorParams fixedBaseline;
+    fixedBaseline.fixedPoint = true;
+    DetectorParams componentBaseline;
+    componentBaseline.componentLocator = true;
+    DetectorParams scanlineBaseline;
+    scanlineBaseline.scanlineDecoder = true;
+    std::vector<DetectorParams> configs{ DetectorParams(), fixedBaseline, componentBaseline, scanlineBaseline };
+    for (int i = 0; i < numSamples; ++i) {
+        configs.push_back(randomParams(rng));
+    }
+
+    // Paso 4: Evaluar en paralelo, una configuracin por tarea. OpenCV se limita a un hilo para que
+    // el tiempo medido sea la latencia de un nico flujo y no compita con los dems trabajadores.
+    setNumThreads(1);
+    std::vector<Evaluation> evaluations(configs.size());
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < configs.size(); i = next++) {
+                evaluations[i] = evaluate(configs[i], samples);
+                size_t finished = ++done;
+                if (finished % 10 == 0) {
+                    std::cout << "Evaluadas " << finished << "/" << configs.size() << std::endl;
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    // Paso 5: Calcular el frente de Pareto y ordenarlo por tiempo
+    markParetoFront(evaluations);
+    std::vector<Evaluation> front;
+    for (const auto &e : evaluations) {
+        if (e.pareto) front.push_back(e);
+    }
+    std::sort(front.begin(), front.end(),
+              [](const Evaluation &a, const Evaluation &b) { return a.msPerFrame < b.msPerFrame; });
+
+    // Paso 6: Escribir todas las evaluaciones en CSV
+    std::ofstream csv(outDir + "/tuning_results.csv");
+    csv << "accuracy,ms_per_frame,correct,labelled,pareto,blur,sobel_ksize,sobel_threshold,"
+           "red_sv_min,red_h1_high,red_h2_low,green_h_low,green_h_high,green_sv_min,"
+           "pyramid_scale,decode_blur,threshold_block,threshold_offset,fixed_point,component_locator,component_min_fill,"
+           "scanline_decoder,scanline_margin\n";
+    for (const auto &e : evaluations) {
+        writeCsvRow(csv, e);
+    }
+
+    // Paso 7: Mostrar el frente de Pareto y guardar cada configuracin como YAML
+    const Evaluation &baseline = evaluations.front();
+    std::cout << std::fixed << std::setprecision(3)
+              << "Configuracion original: precision " << baseline.accuracy
+              << ", " << baseline.msPerFrame << " ms/imagen" << std::endl;
+
+    // Precisin de la variante en punto fijo, del localizador de componentes conexas y del decodificador por
+    // perfiles frente a la configuracin original, imagen a imagen
+    auto compareWithBaseline = [&baseline](const char *name, const Evaluation &eval) {
+        int improved = 0, worsened = 0;
+        for (size_t i = 0; i < baseline.sampleCorrect.size() && i < eval.sampleCorrect.size(); ++i) {
+            if (eval.sampleCorrect[i] && !baseline.sampleCorrect[i]) improved++;
+            if (!eval.sampleCorrect[i] && baseline.sampleCorrect[i]) worsened++;
+        }
+        std::cout << "Configuracion original " << name << ": precision " << eval.accuracy
+                  << ", " << eval.msPerFrame << " ms/imagen (" << improved << " imagenes mejoran y "
+                  << worsened << " empeoran)" << std::endl;
+    };
+    compareWithBaseline("en punto fijo", evaluations[1]);
+    compareWithBaseline("con componentes conexas", evaluations[2]);
+    compareWithBaseline("con perfiles de proyeccion", evaluations[3]);
+    std::cout << "Frente de Pareto (" << front.size() << " configuraciones):" << std::endl;
+    for (size_t i = 0; i < front.size(); ++i) {
+        std::string fileName = outDir + "/pareto_" + std::to_string(i) + ".yml";
+        CCodeDetector(front[i].params).saveParams(fileName);
+        std::cout << "  " << fileName << ": precision " << front[i].accuracy
+                  << " (" << front[i].correct << "/" << front[i].labelled << "), "
+                  << front[i].msPerFrame << " ms/imagen" << std::endl;
+    }
+
+    return 0;
+}